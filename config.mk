@@ -13,6 +13,9 @@ CXX?=g++
 # Flags for the C++ compiler
 CFLAGS+=-Wall -ansi -pedantic -O3
 
+# Uncomment to enable the multithreaded routines using OpenMP
+#CFLAGS+=-fopenmp
+
 # Relative include and library paths for compilation of the examples
 E_INC=-I../../src
 E_LIB=-L../../src
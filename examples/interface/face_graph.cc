@@ -0,0 +1,120 @@
+// Example code demonstrating the print_face_graph function
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set the number of particles
+const int particles=3000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// The area and unit normal of a face in the face graph, stored by the IDs of
+// the two particles that it separates
+typedef std::map<std::pair<int,int>,std::vector<double> > face_map;
+
+// This function reads a file written by print_face_graph(), returning the
+// number of lines and storing the area and normal of each face. Each pair of
+// particles should appear only once, with the lower ID first.
+int read_graph(const char *filename,face_map &fm,int &dup,int &order) {
+	int i,j,n=0;
+	double a,nx,ny,nz,cx,cy,cz;
+	FILE *fp=safe_fopen(filename,"r");
+	fm.clear();dup=order=0;
+	while(fscanf(fp,"%d %d %lg %lg %lg %lg %lg %lg %lg",&i,&j,&a,&nx,&ny,&nz,&cx,&cy,&cz)==9) {
+		n++;
+		if(i>=j) order++;
+		std::vector<double> &f=fm[std::make_pair(i,j)];
+		if(!f.empty()) dup++;
+		f.resize(4);f[0]=a;f[1]=nx;f[2]=ny;f[3]=nz;
+	}
+	fclose(fp);
+	return n;
+}
+
+// This function computes every cell in a container with the neighbors(),
+// face_areas(), and normals() routines, and checks each face against the face
+// graph. A face seen from the particle with the higher ID must have the
+// opposite normal. Faces that normals() reports as (0,0,0), which happens for
+// degenerate faces that are too small for it to find a normal, are counted
+// separately, since shared_faces() always normalizes the vector area.
+template<class c_class,class c_loop>
+void check(const char *name,c_class &con,c_loop &vl) {
+	int i,j,k,pid,n,dup,order,faces=0,miss=0,degen=0;
+	double s,da=0,dn=0,d;
+	face_map fm;
+	face_map::iterator it;
+	voronoicell_neighbor c(con);
+	std::vector<int> nb;
+	std::vector<double> fa,no;
+
+	FILE *fp=safe_fopen("face_graph.out","w");
+	con.print_face_graph(fp);
+	fclose(fp);
+	n=read_graph("face_graph.out",fm,dup,order);
+
+	if(vl.start()) do if(con.compute_cell(c,vl)) {
+		pid=vl.pid();
+		c.neighbors(nb);c.face_areas(fa);c.normals(no);
+		for(i=0;i<(signed int) nb.size();i++) {
+			j=nb[i];
+			if(j<0||j==pid) continue;
+			faces++;
+			it=pid<j?fm.find(std::make_pair(pid,j)):fm.find(std::make_pair(j,pid));
+			if(it==fm.end()) {miss++;continue;}
+			std::vector<double> &f=it->second;
+			if(fabs(f[0]-fa[i])>da) da=fabs(f[0]-fa[i]);
+			if(no[3*i]==0&&no[3*i+1]==0&&no[3*i+2]==0) {degen++;continue;}
+			s=pid<j?1:-1;
+			for(k=0;k<3;k++) {
+				d=fabs(s*f[k+1]-no[3*i+k]);
+				if(d>dn) dn=d;
+			}
+		}
+	} while(vl.inc());
+	remove("face_graph.out");
+
+	printf("%s:\n"
+	       "  face graph lines          : %d\n"
+	       "  faces from neighbor lists : %d (twice the graph)\n"
+	       "  repeated or unordered     : %d\n"
+	       "  faces missing from graph  : %d\n"
+	       "  max face area difference  : %g\n"
+	       "  max normal difference     : %g\n"
+	       "  faces with no normal      : %d\n",
+	       name,n,faces,dup+order,miss,da,dn,degen);
+}
+
+int main() {
+	int i;
+	double x,y,z;
+
+	// Create a non-periodic container_poly and a triclinic periodic
+	// container, and add random particles to each
+	container_poly pcon(0,1,0,1,0,1,8,8,8,false,false,false,8);
+	container_periodic prd(1,0.3,1,-0.2,0.4,1,8,8,8,8);
+	for(i=0;i<particles;i++) {
+		x=rnd();y=rnd();z=rnd();
+		pcon.put(i,x,y,z,0.01+0.03*rnd());
+		prd.put(i,x,y,z);
+	}
+
+	// Check the face graph of each container, using one thread and then
+	// several
+	c_loop_all pvl(pcon);
+	check("container_poly (non-periodic)",pcon,pvl);
+	pcon.nthreads=4;
+	check("container_poly (non-periodic, 4 threads)",pcon,pvl);
+	c_loop_all_periodic rvl(prd);
+	check("container_periodic (triclinic)",prd,rvl);
+	prd.nthreads=4;
+	check("container_periodic (triclinic, 4 threads)",prd,rvl);
+}
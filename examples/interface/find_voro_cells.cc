@@ -0,0 +1,110 @@
+// Example code demonstrating the find_voronoi_cells function
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <vector>
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set the number of particles, and the number of vectors to locate
+const int particles=2000;
+const int queries=20000;
+
+// The number of threads to use for the multithreaded searches
+const int threads=4;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function records the position of each particle in a container by its
+// ID, as stored after any periodic remapping
+template<class c_loop>
+void positions(c_loop &vl,std::vector<double> &ps) {
+	double x,y,z;
+	ps.resize(3*particles);
+	if(vl.start()) do {
+		vl.pos(x,y,z);
+		ps[3*vl.pid()]=x;ps[3*vl.pid()+1]=y;ps[3*vl.pid()+2]=z;
+	} while(vl.inc());
+}
+
+// This function locates a list of vectors with find_voronoi_cells(), first
+// with one thread and then with several, and checks the results against
+// find_voronoi_cell() for each vector. The position returned by
+// find_voronoi_cell() must be the stored particle position plus the periodic
+// image in sh multiplied by the unit cell vectors, which are given in lv.
+template<class c_class>
+void check(const char *name,c_class &con,std::vector<double> &ps,
+		std::vector<double> &q,const double *lv) {
+	int i,j,pid,pe=0,se=0,te=0,miss=0;
+	double rx,ry,rz;
+	std::vector<int> id(queries),sh(3*queries),id2(queries),sh2(3*queries);
+
+	con.nthreads=1;
+	con.find_voronoi_cells(queries,&q[0],&id[0],&sh[0]);
+	con.nthreads=threads;
+	con.find_voronoi_cells(queries,&q[0],&id2[0],&sh2[0]);
+	con.nthreads=1;
+
+	for(i=0;i<queries;i++) {
+		if(!con.find_voronoi_cell(q[3*i],q[3*i+1],q[3*i+2],rx,ry,rz,pid)) pid=-1;
+		if(pid==-1) miss++;
+		if(id[i]!=pid) pe++;
+		else if(pid>=0) {
+			double dx=ps[3*pid],dy=ps[3*pid+1],dz=ps[3*pid+2];
+			for(j=0;j<3;j++) {
+				dx+=sh[3*i+j]*lv[3*j];
+				dy+=sh[3*i+j]*lv[3*j+1];
+				dz+=sh[3*i+j]*lv[3*j+2];
+			}
+			if(fabs(dx-rx)>1e-10||fabs(dy-ry)>1e-10||fabs(dz-rz)>1e-10) se++;
+		}
+		if(id2[i]!=id[i]||sh2[3*i]!=sh[3*i]||sh2[3*i+1]!=sh[3*i+1]||sh2[3*i+2]!=sh[3*i+2]) te++;
+	}
+	printf("%s:\n"
+	       "  vectors outside container : %d\n"
+	       "  particle ID mismatches    : %d\n"
+	       "  periodic image mismatches : %d\n"
+	       "  threaded result mismatches: %d\n",name,miss,pe,se,te);
+}
+
+int main() {
+	int i;
+	double x,y,z;
+	std::vector<double> ps,q(3*queries);
+
+	// Create a container that is periodic in x and y but not in z, a
+	// non-periodic polydisperse container, and a triclinic periodic
+	// container, and add random particles to each
+	container con(0,1,0,1,0,1,6,6,6,true,true,false,8);
+	container_poly pcon(0,1,0,1,0,1,6,6,6,false,false,false,8);
+	container_periodic prd(1,0.3,1,-0.2,0.4,1,6,6,6,8);
+	for(i=0;i<particles;i++) {
+		x=rnd();y=rnd();z=rnd();
+		con.put(i,x,y,z);
+		pcon.put(i,x,y,z,0.01+0.04*rnd());
+		prd.put(i,x,y,z);
+	}
+
+	// Create vectors that extend beyond the unit cube, so that some of
+	// them fall in periodic images, and some lie outside the
+	// non-periodic containers
+	for(i=0;i<3*queries;i++) q[i]=-0.25+1.5*rnd();
+
+	// Check each container. The unit cell vectors of the rectangular
+	// containers are the axes, and those of the triclinic container are
+	// (bx,0,0), (bxy,by,0), and (bxz,byz,bz).
+	const double lv[9]={1,0,0,0,1,0,0,0,1},lvp[9]={1,0,0,0.3,1,0,-0.2,0.4,1};
+	c_loop_all vl(con);
+	positions(vl,ps);
+	check("container (periodic in x and y)",con,ps,q,lv);
+	c_loop_all pvl(pcon);
+	positions(pvl,ps);
+	check("container_poly (non-periodic)",pcon,ps,q,lv);
+	c_loop_all_periodic rvl(prd);
+	positions(rvl,ps);
+	check("container_periodic (triclinic)",prd,ps,q,lvp);
+}
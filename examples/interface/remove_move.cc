@@ -0,0 +1,154 @@
+// Example code demonstrating the remove and move functions
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <vector>
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=-1,x_max=1;
+const double y_min=-1,y_max=1;
+const double z_min=-1,z_max=1;
+const double cvol=(x_max-x_min)*(y_max-y_min)*(z_max-z_min);
+
+// Set up the number of blocks that the container is divided into
+const int n_x=6,n_y=6,n_z=6;
+
+// Set the number of particles, and the number of removals and moves to carry
+// out, including moves to positions outside the container
+const int particles=4000;
+const int removals=1000;
+const int moves=4000;
+const int outside_moves=100;
+
+// Set a particle ID that is larger than the arrays of the ID index can hold
+const int big_id=2000000000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function computes the cell volume of every particle in a container,
+// storing it by particle ID, and returns the number of particles
+template<class c_class,class c_loop>
+int volumes(c_class &con,c_loop &vl,std::vector<double> &v) {
+	int n=0;
+	voronoicell c;
+	v.assign(particles,-1);
+	if(vl.start()) do {
+		if(con.compute_cell(c,vl)) v[vl.pid()]=c.volume();
+		n++;
+	} while(vl.inc());
+	return n;
+}
+
+// This function compares the volumes of two containers, and prints the
+// results of the checks
+void compare(const char *name,int n1,int n2,int alive,double tv1,double tv2,
+		std::vector<double> &v1,std::vector<double> &v2) {
+	double md=0;
+	for(int i=0;i<particles;i++) if(fabs(v1[i]-v2[i])>md) md=fabs(v1[i]-v2[i]);
+	printf("%s:\n"
+	       "  particles       : %d (edited), %d (rebuilt), %d (expected)\n"
+	       "  total volume    : %g (edited), %g (rebuilt), %g (container)\n"
+	       "  max volume diff : %g\n",name,n1,n2,alive,tv1,tv2,cvol,md);
+}
+
+int main() {
+	int i,n,alive=particles,rem=0,rem2=0,mv=0;
+	std::vector<double> x(particles),y(particles),z(particles),r(particles),v1,v2;
+	std::vector<bool> in(particles,true);
+
+	// Create a non-periodic container, a polydisperse container, and a
+	// periodic container, and add the same random particles to each
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,false,false,false,8);
+	container_poly pcon(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,false,false,false,8);
+	container_periodic prd(x_max-x_min,0,y_max-y_min,0,0,z_max-z_min,n_x,n_y,n_z,8);
+	for(i=0;i<particles;i++) {
+		x[i]=x_min+rnd()*(x_max-x_min);
+		y[i]=y_min+rnd()*(y_max-y_min);
+		z[i]=z_min+rnd()*(z_max-z_min);
+		r[i]=0.02+0.03*rnd();
+		con.put(i,x[i],y[i],z[i]);
+		pcon.put(i,x[i],y[i],z[i],r[i]);
+		prd.put(i,x[i]-x_min,y[i]-y_min,z[i]-z_min);
+	}
+
+	// Compute the periodic cells once, so that periodic images exist when
+	// the particles are edited, and must be cleared
+	prd.sum_cell_volumes();
+
+	// Remove random particles. Removing a particle that has already gone
+	// must return false and leave the containers unchanged.
+	for(i=0;i<removals;i++) {
+		n=rand()%particles;
+		bool a=con.remove(n),b=pcon.remove(n),c=prd.remove(n);
+		if(a!=in[n]||b!=in[n]||c!=in[n])
+			fprintf(stderr,"Removal of particle %d gave the wrong result\n",n);
+		if(in[n]) {in[n]=false;alive--;rem++;} else rem2++;
+	}
+
+	// Move random particles, alternating between small displacements that
+	// usually stay within the same block, and jumps to anywhere in the
+	// container, which usually change the block. Moving a removed particle
+	// must return false.
+	for(i=0;i<moves;i++) {
+		n=rand()%particles;
+		double nx,ny,nz,nr=0.02+0.03*rnd();
+		if(i&1) {
+			nx=x[n]+0.02*(rnd()-0.5);if(nx<x_min||nx>x_max) nx=x[n];
+			ny=y[n]+0.02*(rnd()-0.5);if(ny<y_min||ny>y_max) ny=y[n];
+			nz=z[n]+0.02*(rnd()-0.5);if(nz<z_min||nz>z_max) nz=z[n];
+		} else {
+			nx=x_min+rnd()*(x_max-x_min);
+			ny=y_min+rnd()*(y_max-y_min);
+			nz=z_min+rnd()*(z_max-z_min);
+		}
+		bool a=con.move(n,nx,ny,nz),b=pcon.move(n,nx,ny,nz,nr),
+		     c=prd.move(n,nx-x_min,ny-y_min,nz-z_min);
+		if(a!=in[n]||b!=in[n]||c!=in[n])
+			fprintf(stderr,"Move of particle %d gave the wrong result\n",n);
+		if(in[n]) {x[n]=nx;y[n]=ny;z[n]=nz;r[n]=nr;mv++;}
+	}
+
+	// Try to move random particles outside the non-periodic containers.
+	// This must return false and leave the particles where they were.
+	for(i=0;i<outside_moves;i++) {
+		n=rand()%particles;
+		bool a=con.move(n,x_max+1,y[n],z[n]),b=pcon.move(n,x[n],y[n],z_min-1,r[n]);
+		if(a||b) fprintf(stderr,"Move of particle %d outside the container succeeded\n",n);
+	}
+	printf("%d particles removed, %d repeated removals, %d particles moved\n\n",rem,rem2,mv);
+
+	// Add, move, and remove a particle whose ID is too large for the
+	// arrays of the ID index, so that it is stored in the index's map
+	con.put(big_id,0.5*x_min,0.5*y_min,0.5*z_min);
+	if(!con.move(big_id,0.5*x_max,0.5*y_max,0.5*z_max)||!con.remove(big_id)||con.remove(big_id))
+		fputs("Editing a particle with a large ID gave the wrong result\n",stderr);
+
+	// Build fresh containers from the final particle positions, and check
+	// that their cells match the edited containers
+	container con2(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,false,false,false,8);
+	container_poly pcon2(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,false,false,false,8);
+	container_periodic prd2(x_max-x_min,0,y_max-y_min,0,0,z_max-z_min,n_x,n_y,n_z,8);
+	for(i=0;i<particles;i++) if(in[i]) {
+		con2.put(i,x[i],y[i],z[i]);
+		pcon2.put(i,x[i],y[i],z[i],r[i]);
+		prd2.put(i,x[i]-x_min,y[i]-y_min,z[i]-z_min);
+	}
+
+	c_loop_all vl1(con),vl2(con2);
+	int n1=volumes(con,vl1,v1),n2=volumes(con2,vl2,v2);
+	compare("container",n1,n2,alive,con.sum_cell_volumes(),con2.sum_cell_volumes(),v1,v2);
+
+	c_loop_all pl1(pcon),pl2(pcon2);
+	n1=volumes(pcon,pl1,v1);n2=volumes(pcon2,pl2,v2);
+	compare("container_poly",n1,n2,alive,pcon.sum_cell_volumes(),pcon2.sum_cell_volumes(),v1,v2);
+
+	c_loop_all_periodic rl1(prd),rl2(prd2);
+	n1=volumes(prd,rl1,v1);n2=volumes(prd2,rl2,v2);
+	compare("container_periodic",n1,n2,alive,prd.sum_cell_volumes(),prd2.sum_cell_volumes(),v1,v2);
+}
@@ -0,0 +1,64 @@
+// Memory arena timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=20;
+const double y_min=0,y_max=20;
+const double z_min=0,z_max=20;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=12,n_y=12,n_z=12;
+
+// Set the number of particles and the number of ghost cell queries
+const int particles=8000,queries=100000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i;
+	clock_t t0,t1,t2;
+	double vh=0,va=0,*q=new double[3*queries];
+
+	// Create a container with randomly placed particles, and a list of
+	// random query points
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0;i<particles;i++)
+		con.put(i,x_min+rnd()*(x_max-x_min),y_min+rnd()*(y_max-y_min),z_min+rnd()*(z_max-z_min));
+	for(i=0;i<3*queries;i+=3) {
+		q[i]=x_min+rnd()*(x_max-x_min);
+		q[i+1]=y_min+rnd()*(y_max-y_min);
+		q[i+2]=z_min+rnd()*(z_max-z_min);
+	}
+
+	// Compute a ghost cell at each query point, creating a fresh cell for
+	// each one. The cells first take their memory from the heap, and then
+	// from an arena.
+	cell_arena ar;
+	t0=clock();
+	for(i=0;i<3*queries;i+=3) {
+		voronoicell_neighbor c(con);
+		if(con.compute_ghost_cell(c,q[i],q[i+1],q[i+2])) vh+=c.volume();
+	}
+	t1=clock();
+	for(i=0;i<3*queries;i+=3) {
+		voronoicell_neighbor c(con,ar);
+		if(con.compute_ghost_cell(c,q[i],q[i+1],q[i+2])) va+=c.volume();
+	}
+	t2=clock();
+
+	printf("Heap  : %g s\nArena : %g s\nVolume difference : %g\n\n",
+	       double(t1-t0)/CLOCKS_PER_SEC,double(t2-t1)/CLOCKS_PER_SEC,va-vh);
+	ar.print_stats();
+	delete [] q;
+}
@@ -0,0 +1,65 @@
+// Timing test for the batch vertex classification
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// The number of cells to construct for each plane count
+const int cells=2000;
+
+// This function returns a random double between -1 and 1
+double rnd() {return 2*double(rand())/RAND_MAX-1;}
+
+// Constructs a number of cells by cutting a cube with random planes, and
+// returns the elapsed time. If shell is false, the planes come from points in
+// a cube, so that the cells are small and most planes do not cut them. If
+// shell is true, the planes come from points in a thin spherical shell, so
+// that most planes cut the cells and the number of vertices grows with the
+// number of planes. The total number of vertices and the total volume are
+// accumulated, so that the graph search and the batch classification can be
+// compared.
+double build_cells(voronoicell &c,int planes,bool shell,int bv,double &vert,double &vol) {
+	int i,j;double x,y,z,r;
+	clock_t start=clock();
+	c.set_batch_classify(bv);
+	srand(1);vert=vol=0;
+	for(i=0;i<cells;i++) {
+		c.init(-2,2,-2,2,-2,2);
+		for(j=0;j<planes;) {
+			x=rnd();y=rnd();z=rnd();
+			if(shell) {
+				r=x*x+y*y+z*z;
+				if(r>1||r<1e-6) continue;
+				r=(1+0.1*rand()/RAND_MAX)/sqrt(r);
+				x*=r;y*=r;z*=r;
+			}
+			c.plane(x,y,z);j++;
+		}
+		vert+=c.p;vol+=c.volume();
+	}
+	return double(clock()-start)/CLOCKS_PER_SEC;
+}
+
+int main() {
+	voronoicell c;
+	int planes,s;
+	double t0,t1,v0,v1,w0,w1;
+
+	// For both plane distributions and a range of plane counts, print the
+	// mean number of vertices and the times taken by the two methods
+	for(s=0;s<2;s++) {
+		printf("# %s: planes, vertices, graph search time, batch time\n",s?"Shell":"Cube");
+		for(planes=16;planes<=1024;planes<<=1) {
+			t0=build_cells(c,planes,s==1,0,v0,w0);
+			t1=build_cells(c,planes,s==1,1,v1,w1);
+			if(v0!=v1||w0!=w1) fputs("Warning: the two methods gave different cells\n",stderr);
+			printf("%d %g %g %g\n",planes,v0/cells,t0,t1);
+		}
+	}
+}
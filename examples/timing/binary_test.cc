@@ -0,0 +1,74 @@
+// Binary particle file timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=60;
+const double y_min=0,y_max=60;
+const double z_min=0,z_max=60;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=36,n_y=36,n_z=36;
+
+// Set the number of particles
+const int particles=1000000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i;
+	clock_t t0,t1;
+	vector<int> id(particles);
+	vector<double> pos(3*particles);
+
+	// Write the same random particles to a text file and a binary file
+	FILE *fp=safe_fopen("binary_test.dat","w");
+	for(i=0;i<particles;i++) {
+		id[i]=i;
+		pos[3*i]=x_min+rnd()*(x_max-x_min);
+		pos[3*i+1]=y_min+rnd()*(y_max-y_min);
+		pos[3*i+2]=z_min+rnd()*(z_max-z_min);
+		fprintf(fp,"%d %.17g %.17g %.17g\n",i,pos[3*i],pos[3*i+1],pos[3*i+2]);
+	}
+	fclose(fp);
+	particle_file::write("binary_test.bin",particles,&id[0],&pos[0],false);
+
+	// Time the import of each file into a container
+	container con1(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	t0=clock();
+	con1.import("binary_test.dat");
+	t1=clock();
+	printf("Text import   : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+
+	container con2(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	t0=clock();
+	con2.import_binary("binary_test.bin");
+	t1=clock();
+	printf("Binary import : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+
+	// Check that the two containers hold the same particles, by comparing
+	// the sum of the positions in each block
+	double d=0,s1,s2;
+	for(int ijk=0;ijk<con1.nxyz;ijk++) {
+		if(con1.co[ijk]!=con2.co[ijk]) {d=1;break;}
+		s1=s2=0;
+		for(i=0;i<3*con1.co[ijk];i++) {s1+=con1.p[ijk][i];s2+=con2.p[ijk][i];}
+		d+=fabs(s1-s2);
+	}
+	printf("Particles     : %d and %d\nDifference    : %g\n",
+	       con1.total_particles(),con2.total_particles(),d);
+	remove("binary_test.dat");
+	remove("binary_test.bin");
+}
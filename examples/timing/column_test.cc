@@ -0,0 +1,114 @@
+// Binary columnar output timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <ctime>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=1;
+const double y_min=0,y_max=1;
+const double z_min=0,z_max=1;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=26,n_y=26,n_z=26;
+
+// Set the number of particles and the number of threads
+const int particles=100000;
+const int threads=8;
+
+// The custom output format to test
+const char *format="%i %v %F %c %f %n";
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function returns the wall clock time, or the processor time if OpenMP
+// is not available
+double wtime() {
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return double(clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+int main() {
+	int i;
+	double t0,t1;
+
+	// Create a container and add random particles
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0;i<particles;i++) con.put(i,rnd(),rnd(),rnd());
+
+	// Time the text and binary output of the same format, with one thread
+	// and with several. The binary file is written twice, the second time
+	// by appending to it with several threads, which must give the same
+	// chunks as the serial output.
+	t0=wtime();
+	con.print_custom(format,"column_test.txt");
+	t1=wtime();
+	printf("Text output   : %g s\n",t1-t0);
+	t0=wtime();
+	con.print_columns(format,"column_test.col");
+	t1=wtime();
+	printf("Binary output : %g s\n",t1-t0);
+	con.nthreads=threads;
+	t0=wtime();
+	con.print_custom(format,"column_test.txt");
+	t1=wtime();
+	printf("Text output   : %g s (%d threads)\n",t1-t0,threads);
+	t0=wtime();
+	con.print_columns(format,"column_test.col",true);
+	t1=wtime();
+	printf("Binary output : %g s (%d threads)\n",t1-t0,threads);
+
+	// Read the binary file back and walk through its chunks, summing the
+	// volumes and counting the neighbors. The columns of the format are
+	// %i, %v, %F, %c, %f, and %n, in that order.
+	FILE *fp=safe_fopen("column_test.col","rb");
+	fseek(fp,0,SEEK_END);
+	size_t len=ftell(fp);
+	fseek(fp,0,SEEK_SET);
+	vector<double> buf((len+7)>>3);
+	char *b=reinterpret_cast<char*>(&buf[0]);
+	if(fread(b,1,len,fp)!=len) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	fclose(fp);
+	unsigned int *hd=reinterpret_cast<unsigned int*>(b+8);
+	size_t o=24+16*hd[2],l;
+	int rows=0,nb=0,n,*off;
+	double vol=0,*v;
+	while(o<len) {
+		hd=reinterpret_cast<unsigned int*>(b+o);
+		n=hd[0];o+=8;rows+=n;
+
+		// Skip the ID, read the volumes, skip the surface areas and
+		// centroids, and skip the ragged face area column
+		o+=(4*n+7)&~7;
+		v=reinterpret_cast<double*>(b+o);
+		for(i=0;i<n;i++) vol+=v[i];
+		o+=8*n+8*n+24*n;
+		off=reinterpret_cast<int*>(b+o);
+		l=(4*(n+1)+7)&~7;
+		o+=l+8*off[n];
+
+		// Count the neighbors
+		off=reinterpret_cast<int*>(b+o);
+		nb+=off[n];
+		o+=l+((4*off[n]+7)&~7);
+	}
+	printf("Cells         : %d\nTotal volume  : %.15g\nNeighbors     : %d\n",
+	       rows,vol,nb);
+	remove("column_test.txt");
+	remove("column_test.col");
+}
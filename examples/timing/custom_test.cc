@@ -0,0 +1,84 @@
+// Compiled custom output timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=1;
+const double y_min=0,y_max=1;
+const double z_min=0,z_max=1;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=26,n_y=26,n_z=26;
+
+// Set the number of particles
+const int particles=100000;
+
+// The custom output format to test
+const char *format="%i %v %F %c %f %n";
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function outputs the same information as the format string above,
+// calling a separate routine for each directive, as the original
+// output_custom() routine did
+void output_separate(voronoicell_neighbor &c,int i,FILE *fp) {
+	vector<double> vd;vector<int> vi;
+	double cx,cy,cz;
+	fprintf(fp,"%d %g %g ",i,c.volume(),c.surface_area());
+	c.centroid(cx,cy,cz);
+	fprintf(fp,"%g %g %g ",cx,cy,cz);
+	c.face_areas(vd);voro_print_vector(vd,fp);
+	putc(' ',fp);
+	c.neighbors(vi);voro_print_vector(vi,fp);
+	fputs("\n",fp);
+}
+
+int main() {
+	int i,pid;
+	double x,y,z;
+	clock_t t0,t1,ts=0,tc=0;
+
+	// Create a container and add random particles
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0;i<particles;i++) con.put(i,rnd(),rnd(),rnd());
+
+	// Compute each cell, and time the two ways of outputting it, writing
+	// the results to two files
+	FILE *fp1=safe_fopen("custom_test1.out","w"),
+	     *fp2=safe_fopen("custom_test2.out","w");
+	custom_plan cp(format);
+	voronoicell_neighbor c(con);
+	c_loop_all vl(con);
+	if(vl.start()) do if(con.compute_cell(c,vl)) {
+		vl.pos(x,y,z);pid=vl.pid();
+		t0=clock();
+		output_separate(c,pid,fp1);
+		t1=clock();ts+=t1-t0;
+		c.output_custom(cp,pid,x,y,z,default_radius,fp2);
+		tc+=clock()-t1;
+	} while(vl.inc());
+	fclose(fp1);fclose(fp2);
+	printf("Separate routines : %g s\nCompiled plan     : %g s\n",
+	       double(ts)/CLOCKS_PER_SEC,double(tc)/CLOCKS_PER_SEC);
+
+	// Check that the two files are identical
+	fp1=safe_fopen("custom_test1.out","r");
+	fp2=safe_fopen("custom_test2.out","r");
+	int a,b;
+	do {a=getc(fp1);b=getc(fp2);} while(a==b&&a!=EOF);
+	printf("Identical         : %s\n",a==b?"yes":"no");
+	fclose(fp1);fclose(fp2);
+	remove("custom_test1.out");
+	remove("custom_test2.out");
+}
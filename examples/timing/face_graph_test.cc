@@ -0,0 +1,82 @@
+// Face graph timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=1;
+const double y_min=0,y_max=1;
+const double z_min=0,z_max=1;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=26,n_y=26,n_z=26;
+
+// Set the number of particles
+const int particles=100000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function returns the size of a file in bytes, and removes it
+long file_size(const char *filename) {
+	FILE *fp=safe_fopen(filename,"r");
+	fseek(fp,0,SEEK_END);
+	long l=ftell(fp);
+	fclose(fp);
+	remove(filename);
+	return l;
+}
+
+int main() {
+	int pid;
+	unsigned int nf=0,ns=0;
+	double x,y,z;
+	clock_t t0,t1,ts=0,tc=0;
+	vector<int> nb,v;
+	vector<double> fa,no,w;
+
+	// Create a container and add random particles
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(int i=0;i<particles;i++) con.put(i,rnd(),rnd(),rnd());
+
+	// Compute each cell, and time the face routines on it. The first
+	// method finds the neighbors, areas, and normals of every face with
+	// separate routines, as the custom output does for the "%n %f %l"
+	// directives. The second finds the area, normal, and centroid of
+	// the faces shared with a particle of higher ID in a single traversal.
+	voronoicell_neighbor c(con);
+	c_loop_all vl(con);
+	if(vl.start()) do if(con.compute_cell(c,vl)) {
+		vl.pos(x,y,z);pid=vl.pid();
+		t0=clock();
+		c.neighbors(nb);c.face_areas(fa);c.normals(no);
+		t1=clock();ts+=t1-t0;
+		c.shared_faces(pid,x,y,z,v,w);
+		tc+=clock()-t1;
+		nf+=nb.size();ns+=v.size();
+	} while(vl.inc());
+	printf("Separate routines : %g s, %u faces\n"
+	       "shared_faces      : %g s, %u faces\n",
+	       double(ts)/CLOCKS_PER_SEC,nf,double(tc)/CLOCKS_PER_SEC,ns);
+
+	// Time the complete output of each method, including the cell
+	// computation
+	t0=clock();
+	con.print_custom("%i %n %f %l","face_graph_test1.out");
+	t1=clock();
+	con.print_face_graph("face_graph_test2.out");
+	tc=clock();
+	printf("print_custom      : %g s, %ld bytes\n"
+	       "print_face_graph  : %g s, %ld bytes\n",
+	       double(t1-t0)/CLOCKS_PER_SEC,file_size("face_graph_test1.out"),
+	       double(tc-t1)/CLOCKS_PER_SEC,file_size("face_graph_test2.out"));
+}
@@ -0,0 +1,53 @@
+// Frozen container timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=40;
+const double y_min=0,y_max=40;
+const double z_min=0,z_max=40;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=24,n_y=24,n_z=24;
+
+// Set the number of particles
+const int particles=200000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i;
+	clock_t t0,t1;
+	double v1,v2;
+
+	// Create a container with randomly placed particles
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0;i<particles;i++)
+		con.put(i,x_min+rnd()*(x_max-x_min),y_min+rnd()*(y_max-y_min),z_min+rnd()*(z_max-z_min));
+
+	// Time the computation of all the cells before and after freezing the
+	// container, and compare the memory used to store the particles
+	printf("Particle memory    : %lu bytes\n",static_cast<unsigned long>(con.particle_memory()));
+	t0=clock();
+	v1=con.sum_cell_volumes();
+	t1=clock();
+	printf("Unfrozen container : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+
+	con.freeze();
+	printf("\nParticle memory    : %lu bytes\n",static_cast<unsigned long>(con.particle_memory()));
+	t0=clock();
+	v2=con.sum_cell_volumes();
+	t1=clock();
+	printf("Frozen container   : %g s\n\nVolume difference  : %g\n",
+	       double(t1-t0)/CLOCKS_PER_SEC,v1-v2);
+}
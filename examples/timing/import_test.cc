@@ -0,0 +1,91 @@
+// Text import timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=60;
+const double y_min=0,y_max=60;
+const double z_min=0,z_max=60;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=36,n_y=36,n_z=36;
+
+// Set the number of particles and the number of threads
+const int particles=1000000;
+const int threads=8;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function returns the wall clock time, or the processor time if OpenMP
+// is not available
+double wtime() {
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return double(clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+int main() {
+	int i,j;
+	double x,y,z,t0,t1,mb;
+
+	// Write random particles to a text file, using several number formats
+	FILE *fp=safe_fopen("import_test.dat","w");
+	for(i=0;i<particles;i++) {
+		x=x_min+rnd()*(x_max-x_min);
+		y=y_min+rnd()*(y_max-y_min);
+		z=z_min+rnd()*(z_max-z_min);
+		if(i&1) fprintf(fp,"%d %.17g %.17g %.17g\n",i,x,y,z);
+		else fprintf(fp,"%d %g %.6f %e\n",i,x,y,z);
+	}
+	mb=ftell(fp)*1e-6;
+	fclose(fp);
+
+	// Time the original fscanf() loop
+	container con1(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	t0=wtime();
+	fp=safe_fopen("import_test.dat","r");
+	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) con1.put(i,x,y,z);
+	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	fclose(fp);
+	t1=wtime();
+	printf("fscanf() loop     : %g s, %.0f MB/s\n",t1-t0,mb/(t1-t0));
+
+	// Time the import() function with one thread and with several
+	for(int nt=1;nt<=threads;nt+=threads-1) {
+		container con2(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+				false,false,false,8);
+		con2.nthreads=nt;
+		t0=wtime();
+		con2.import("import_test.dat");
+		t1=wtime();
+		printf("import(), %d thread%s : %g s, %.0f MB/s\n",nt,nt==1?" ":"s",t1-t0,mb/(t1-t0));
+
+		// Check that the containers hold exactly the same particles
+		// in the same order
+		bool same=true;
+		for(int ijk=0;ijk<con1.nxyz&&same;ijk++) {
+			if(con1.co[ijk]!=con2.co[ijk]) same=false;
+			for(int q=0;q<con1.co[ijk]&&same;q++)
+				if(con1.id[ijk][q]!=con2.id[ijk][q]||con1.p[ijk][3*q]!=con2.p[ijk][3*q]
+				 ||con1.p[ijk][3*q+1]!=con2.p[ijk][3*q+1]||con1.p[ijk][3*q+2]!=con2.p[ijk][3*q+2])
+					same=false;
+		}
+		printf("Identical         : %s\n",same?"yes":"no");
+	}
+	remove("import_test.dat");
+}
@@ -0,0 +1,95 @@
+// Incremental computation timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=20;
+const double y_min=0,y_max=20;
+const double z_min=0,z_max=20;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=12,n_y=12,n_z=12;
+
+// Set the number of particles, the number of frames, the maximum distance
+// that a particle moves in each coordinate direction per frame, and the skin
+// distance used by the incremental computation
+const int particles=8000,frames=20;
+const double step=0.01,skin=0.3;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function moves a coordinate by a small random amount, and remaps it
+// into the periodic domain
+inline void move(double &a,double a_min,double a_max) {
+	a+=step*(2*rnd()-1);
+	if(a<a_min) a+=a_max-a_min;
+	else if(a>=a_max) a-=a_max-a_min;
+}
+
+int main() {
+	int i,f;
+	clock_t t0,t1,t2;
+	double ti=0,tf=0,err=0,vi,*q,*pe;
+	vector<double> p(3*particles),v(particles);
+
+	// Create a periodic container, and an incremental computation class
+	// that caches the particle lists between frames
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			true,true,true,8);
+	voro_incremental inc(con,skin);
+	voronoicell c(con);
+	for(i=0;i<particles;i++) {
+		p[3*i]=x_min+rnd()*(x_max-x_min);
+		p[3*i+1]=y_min+rnd()*(y_max-y_min);
+		p[3*i+2]=z_min+rnd()*(z_max-z_min);
+	}
+
+	for(f=0;f<frames;f++) {
+
+		// Move the particles, and put them into the container
+		con.clear();
+		for(i=0,q=&p[0],pe=q+3*particles;q<pe;i++,q+=3) {
+			move(*q,x_min,x_max);move(q[1],y_min,y_max);move(q[2],z_min,z_max);
+			con.put(i,*q,q[1],q[2]);
+		}
+
+		// Compute the cell volumes incrementally, and then with the
+		// full computation
+		c_loop_all vl(con);
+		t0=clock();
+		inc.update();
+		if(vl.start()) do if(inc.compute_cell(c,vl)) v[vl.pid()]=c.volume();
+		while(vl.inc());
+		t1=clock();
+		if(vl.start()) do if(con.compute_cell(c,vl)) {
+			vi=fabs(c.volume()-v[vl.pid()]);
+			if(vi>err) err=vi;
+		} while(vl.inc());
+		t2=clock();
+
+		// The first frame builds all of the lists, so it is not
+		// included in the timings
+		if(f>0) {ti+=t1-t0;tf+=t2-t1;}
+	}
+
+	// Print the timings, the number of cells computed by each method,
+	// and the largest volume difference
+	printf("Incremental time : %g s\n"
+	       "Full time        : %g s\n"
+	       "Speedup          : %g\n"
+	       "Cached cells     : %d\n"
+	       "Full cells       : %d\n"
+	       "Max volume error : %g\n",ti/CLOCKS_PER_SEC,tf/CLOCKS_PER_SEC,
+	       tf/ti,inc.cached,inc.full,err);
+}
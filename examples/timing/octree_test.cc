@@ -0,0 +1,99 @@
+// Octree container timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=40;
+const double y_min=0,y_max=40;
+const double z_min=0,z_max=40;
+
+// Set the number of particles, the number of clusters that they are placed
+// in, and the number of threads for the multithreaded computation
+const int particles=60000,clusters=20,threads=4;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i,j,nx,ny,nz,nd=0;
+	double cx[clusters],cy[clusters],cz[clusters],x,y,z,r,vg,vo,vt,dv=0;
+	clock_t t0,t1;
+
+	// Place most of the particles in tight clusters, and spread the rest
+	// uniformly, so that the density varies by several orders of magnitude
+	pre_container pcon(x_min,x_max,y_min,y_max,z_min,z_max,false,false,false);
+	container_octree ocon(x_min,x_max,y_min,y_max,z_min,z_max);
+	for(j=0;j<clusters;j++) {
+		cx[j]=x_min+4+rnd()*(x_max-x_min-8);
+		cy[j]=y_min+4+rnd()*(y_max-y_min-8);
+		cz[j]=z_min+4+rnd()*(z_max-z_min-8);
+	}
+	for(i=0;i<particles;i++) {
+		if(i%10==0) {
+			x=x_min+rnd()*(x_max-x_min);
+			y=y_min+rnd()*(y_max-y_min);
+			z=z_min+rnd()*(z_max-z_min);
+		} else {
+			j=i%clusters;
+			do {
+				x=2*rnd()-1;y=2*rnd()-1;z=2*rnd()-1;
+			} while(x*x+y*y+z*z>1);
+			r=2*rnd()*rnd();
+			x=cx[j]+r*x;y=cy[j]+r*y;z=cz[j]+r*z;
+		}
+		pcon.put(i,x,y,z);
+		ocon.put(i,x,y,z);
+	}
+
+	// Compute the cells with a grid-based container
+	pcon.guess_optimal(nx,ny,nz);
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,nx,ny,nz,
+			false,false,false,8);
+	pcon.setup(con);
+	t0=clock();
+	vg=con.sum_cell_volumes();
+	t1=clock();
+	printf("Grid container     : %g s, volume %g\n",double(t1-t0)/CLOCKS_PER_SEC,vg);
+
+	// Compute the cells with the octree container
+	t0=clock();
+	vo=ocon.sum_cell_volumes();
+	t1=clock();
+	printf("Octree container   : %g s, volume %g\n\n",double(t1-t0)/CLOCKS_PER_SEC,vo);
+	ocon.print_stats();
+
+	// Check that both containers give the same volume and neighbor list
+	// for every particle
+	vector<double> gv(particles,0);
+	vector<int> gn(particles,0),v;
+	voronoicell_neighbor c(con);
+	c_loop_all cl(con);
+	if(cl.start()) do if(con.compute_cell(c,cl)) {
+		gv[cl.pid()]=c.volume();
+		c.neighbors(v);
+		for(j=0;j<int(v.size());j++) gn[cl.pid()]+=v[j];
+	} while(cl.inc());
+	c_loop_all ol(ocon);
+	if(ol.start()) do if(ocon.compute_cell(c,ol)) {
+		i=ol.pid();
+		if(fabs(gv[i]-c.volume())>dv) dv=fabs(gv[i]-c.volume());
+		c.neighbors(v);
+		for(j=0;j<int(v.size());j++) gn[i]-=v[j];
+		if(gn[i]!=0) nd++;
+	} while(ol.inc());
+	printf("\nMaximum volume difference   : %g\n"
+	       "Differing neighbor lists    : %d\n",dv,nd);
+
+	// Check the multithreaded computation
+	ocon.set_threads(threads);
+	vt=ocon.sum_cell_volumes();
+	printf("Multithreaded volume        : %g\n",vt);
+}
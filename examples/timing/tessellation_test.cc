@@ -0,0 +1,84 @@
+// Stored tessellation timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=20;
+const double y_min=0,y_max=20;
+const double z_min=0,z_max=20;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=12,n_y=12,n_z=12;
+
+// Set the number of particles, and the number of threads for the
+// multithreaded computation
+const int particles=40000,threads=4;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i,j,f,nf=0;
+	clock_t t0,t1,t2;
+	double fa=0,fb=0;
+	bool same;
+
+	// Create a container with randomly placed particles
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0;i<particles;i++)
+		con.put(i,x_min+rnd()*(x_max-x_min),y_min+rnd()*(y_max-y_min),z_min+rnd()*(z_max-z_min));
+
+	// Store the tessellation, and then count the faces of each cell
+	// that are shared with a particle of higher ID, reading the faces
+	// from the stored tables and from a fresh computation
+	tessellation ts;
+	t0=clock();
+	ts.compute(con);
+	t1=clock();
+	for(i=0;i<ts.cells();i++)
+		for(f=ts.fo[i];f<ts.fo[i+1];f++) if(ts.ne[f]>ts.id[i]) fa+=ts.face_order(f);
+	t2=clock();
+	printf("Store tessellation : %g s\nRead tessellation  : %g s\n",
+	       double(t1-t0)/CLOCKS_PER_SEC,double(t2-t1)/CLOCKS_PER_SEC);
+
+	voronoicell_neighbor c(con);
+	vector<int> v,w;
+	c_loop_all cl(con);
+	t0=clock();
+	if(cl.start()) do if(con.compute_cell(c,cl)) {
+		c.neighbors(v);c.face_vertices(w);
+		for(j=f=0;f<int(v.size());f++,j+=w[j]+1) if(v[f]>cl.pid()) fb+=w[j];
+	} while(cl.inc());
+	t1=clock();
+	printf("Recompute cells    : %g s\nDifference         : %g\n\n",double(t1-t0)/CLOCKS_PER_SEC,fa-fb);
+
+	// Check that the multithreaded computation gives the same tables
+	tessellation tp;
+	con.set_threads(threads);
+	tp.compute(con);
+	same=ts.id==tp.id&&ts.vol==tp.vol&&ts.pts==tp.pts&&ts.vo==tp.vo&&ts.fo==tp.fo
+	   &&ts.fvo==tp.fvo&&ts.fv==tp.fv&&ts.ne==tp.ne;
+	printf("Multithreaded tables match : %s\n\n",same?"yes":"no");
+
+	// Compare the memory use with keeping a cell class for each
+	// particle, measuring the arrays of a computed cell with an arena
+	cell_arena ar;
+	voronoicell_neighbor ca(con,ar);
+	if(cl.start()) con.compute_cell(ca,cl);
+	ts.print_stats();
+	for(i=0;i<ts.cells();i++) nf+=ts.vertices(i);
+	printf("Bytes per vertex   : %g\n"
+	       "Bytes per cell     : %g\n"
+	       "Cell class bytes   : %lu\n",double(ts.memory_used())/nf,
+	       double(ts.memory_used())/ts.cells(),
+	       static_cast<unsigned long>(sizeof(voronoicell_neighbor)+ar.bytes));
+}
@@ -0,0 +1,101 @@
+// Timing test for skipping planes that only touch a cell
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// The number of lattice sites in each direction, and the number of blocks
+// that the container is divided into
+const int n=24;
+
+// The number of times to compute the cells for each method. The fastest time
+// is reported.
+const int reps=5;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// Computes all of the cells in a container, storing the neighbor list and
+// volume of each, and returns the fastest of several runs
+double compute_cells(container &con,bool st,vector<vector<int> > &nb,vector<double> &vol) {
+	voronoicell_neighbor c;
+	c.set_skip_touching(st);
+	c_loop_all vl(con);
+	double t,tmin=large_number;
+	nb.resize(con.total_particles());vol.resize(nb.size());
+	for(int r=0;r<reps;r++) {
+		clock_t start=clock();
+		if(vl.start()) do if(con.compute_cell(c,vl)) {
+			c.neighbors(nb[vl.pid()]);
+			vol[vl.pid()]=c.volume();
+		} while(vl.inc());
+		t=double(clock()-start)/CLOCKS_PER_SEC;
+		if(t<tmin) tmin=t;
+	}
+	return tmin;
+}
+
+// Fills a container with a set of particles, computes the cells with and
+// without skipping touching planes, and prints the times together with the
+// number of cells whose neighbor lists differ and the largest difference in
+// volume. The neighbor lists are compared both as stored, and after sorting
+// them. If type is 0, the particles are random. Otherwise they are on a
+// simple cubic lattice (type 1), a tetragonal lattice (type 2), a
+// body-centered cubic lattice (type 3), or a face-centered cubic lattice
+// (type 4), whose sites are displaced by random amounts of size eps.
+void run(const char *name,int type,double eps) {
+	static const double bcc[6]={0,0,0,0.5,0.5,0.5},
+		fcc[12]={0,0,0,0.5,0.5,0,0.5,0,0.5,0,0.5,0.5};
+	const double *bp=type==3?bcc:fcc;
+	int i,j,k,l,nb=type==3?2:(type==4?4:1),id=0;
+	double sz=type==2?1.3:1;
+	container con(0,n,0,n,0,n*sz,n,n,n,false,false,false,8);
+	srand(1);
+	if(type==0) {
+		for(i=0;i<n*n*n;i++) con.put(i,n*rnd(),n*rnd(),n*sz*rnd());
+	} else for(k=0;k<n;k++) for(j=0;j<n;j++) for(i=0;i<n;i++) for(l=0;l<nb;l++) {
+		double x=i,y=j,z=k;
+		if(nb>1) {x+=bp[3*l];y+=bp[3*l+1];z+=bp[3*l+2];}
+		con.put(id++,x+0.25+eps*(rnd()-0.5),y+0.25+eps*(rnd()-0.5),
+			(z+0.25+eps*(rnd()-0.5))*sz);
+	}
+
+	// Compute the cells with both methods, and compare them
+	vector<vector<int> > nb0,nb1;
+	vector<double> v0,v1;
+	double t0=compute_cells(con,false,nb0,v0),t1=compute_cells(con,true,nb1,v1),vd=0;
+	int nd=0,ns=0;
+	for(i=0;i<(int) nb0.size();i++) {
+		if(nb0[i]!=nb1[i]) {
+			nd++;
+			sort(nb0[i].begin(),nb0[i].end());
+			sort(nb1[i].begin(),nb1[i].end());
+			if(nb0[i]!=nb1[i]) ns++;
+		}
+		if(fabs(v0[i]-v1[i])>vd) vd=fabs(v0[i]-v1[i]);
+	}
+	printf("%-22s %7.3f %7.3f %5.2f %6d %6d %g\n",name,t0,t1,t0/t1,nd,ns,vd);
+	if(type==0&&nd>0) fputs("Warning: the neighbor lists differ for random particles\n",stderr);
+}
+
+int main() {
+	puts("# Input, time without skip, time with skip, speedup, differing neighbor\n"
+	     "# lists, differing sorted neighbor lists, max volume difference");
+	run("random",0,0);
+	run("cubic",1,0);
+	run("cubic, eps=1e-10",1,1e-10);
+	run("cubic, eps=1e-8",1,1e-8);
+	run("tetragonal",2,0);
+	run("tetragonal, eps=1e-9",2,1e-9);
+	run("tetragonal, eps=1e-7",2,1e-7);
+	run("bcc",3,0);
+	run("fcc",4,0);
+}
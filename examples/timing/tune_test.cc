@@ -0,0 +1,88 @@
+// Grid tuning timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=40;
+const double y_min=0,y_max=40;
+const double z_min=0,z_max=40;
+
+// Set the number of particles, and the number of clusters that they are
+// placed in
+const int particles=100000,clusters=20;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// The number of times to time the computation of all of the cells with each
+// grid
+const int runs=5;
+
+// Sets up a container with the grid chosen by the pre_container, and times
+// the computation of all of the cells several times, printing the shortest
+// and longest times
+void run(pre_container &pcon,const char *name) {
+	int nx,ny,nz;
+	double t,tb=large_number,tw=0;
+	pcon.guess_optimal(nx,ny,nz);
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,nx,ny,nz,
+			false,false,false,8);
+	pcon.setup(con);
+	for(int r=0;r<runs;r++) {
+		clock_t t0=clock();
+		con.compute_all_cells();
+		t=double(clock()-t0)/CLOCKS_PER_SEC;
+		if(t<tb) tb=t;
+		if(t>tw) tw=t;
+	}
+	printf("%-11s: grid %d %d %d, %.3g particles per block, %g s to %g s\n",name,nx,ny,nz,
+	       pcon.opt,tb,tw);
+}
+
+int main() {
+	int i,j;
+	double cx[clusters],cy[clusters],cz[clusters],x,y,z,r;
+	clock_t t0;
+
+	// Place half of the particles in clusters that are densest at their
+	// centers, and spread the other half uniformly
+	pre_container pcon(x_min,x_max,y_min,y_max,z_min,z_max,false,false,false);
+	for(j=0;j<clusters;j++) {
+		cx[j]=x_min+4+rnd()*(x_max-x_min-8);
+		cy[j]=y_min+4+rnd()*(y_max-y_min-8);
+		cz[j]=z_min+4+rnd()*(z_max-z_min-8);
+	}
+	for(i=0;i<particles;i++) {
+		if(i&1) {
+			x=x_min+rnd()*(x_max-x_min);
+			y=y_min+rnd()*(y_max-y_min);
+			z=z_min+rnd()*(z_max-z_min);
+		} else {
+			j=i%clusters;
+			do {
+				x=2*rnd()-1;y=2*rnd()-1;z=2*rnd()-1;
+			} while(x*x+y*y+z*z>1);
+			r=4*rnd();
+			x=cx[j]+r*x;y=cy[j]+r*y;z=cz[j]+r*z;
+		}
+		pcon.put(i,x,y,z);
+	}
+
+	// Compare the default grid with the sampled and tuned grids
+	run(pcon,"Default");
+	pcon.sample_optimal();
+	run(pcon,"Sampled");
+	t0=clock();
+	pcon.tune_optimal(true);
+	printf("\nTuning time : %g s\n",double(clock()-t0)/CLOCKS_PER_SEC);
+	pcon.print_tuning();
+	run(pcon,"Tuned");
+}
@@ -0,0 +1,121 @@
+// Container view timing example code
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+#include <ctime>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+#include "voro++.cc"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=40;
+const double y_min=0,y_max=40;
+const double z_min=0,z_max=40;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=24,n_y=24,n_z=24;
+
+// Set the number of particles, and the number of floating point numbers
+// stored for each particle in the simulation array, which holds a position,
+// a radius, and three velocity components
+const int particles=100000,stride=7;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// Computes the volume of each cell visited by a loop, storing it by ID
+template<class c_class,class c_loop>
+void volumes(c_class &con,c_loop &vl,vector<double> &vol) {
+	voronoicell c;
+	if(vl.start()) do if(con.compute_cell(c,vl)) vol[vl.pid()]=c.volume();
+	while(vl.inc());
+}
+
+// Returns the largest difference between two lists of volumes
+double max_diff(vector<double> &v1,vector<double> &v2) {
+	double d=0;
+	for(int i=0;i<particles;i++) if(fabs(v1[i]-v2[i])>d) d=fabs(v1[i]-v2[i]);
+	return d;
+}
+
+int main() {
+	int i;
+	clock_t t0,t1;
+	double *pp;
+	vector<double> sim(stride*particles),v1(particles),v2(particles);
+
+	// Fill the simulation array with randomly placed particles
+	for(i=0,pp=&sim[0];i<particles;i++,pp+=stride) {
+		*pp=x_min+rnd()*(x_max-x_min);
+		pp[1]=y_min+rnd()*(y_max-y_min);
+		pp[2]=z_min+rnd()*(z_max-z_min);
+		pp[3]=0.2+0.3*rnd();
+		pp[4]=pp[5]=pp[6]=0;
+	}
+
+	// Copy the particles into a container, and compute all of the cells
+	t0=clock();
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0,pp=&sim[0];i<particles;i++,pp+=stride) con.put(i,*pp,pp[1],pp[2]);
+	t1=clock();
+	printf("Container fill      : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+	c_loop_all vl1(con);
+	t0=clock();
+	volumes(con,vl1,v1);
+	t1=clock();
+	printf("Container compute   : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+
+	// Bind the simulation array to a view, and compute all of the cells
+	container_view cv(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false);
+	t0=clock();
+	cv.bind(particles,&sim[0],stride);
+	t1=clock();
+	printf("View bind           : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+	c_loop_all vl2(cv);
+	t0=clock();
+	volumes(cv,vl2,v2);
+	t1=clock();
+	printf("View compute        : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+	printf("Volume difference   : %g\n",max_diff(v1,v2));
+	printf("Memory              : %lu and %lu bytes\n\n",
+	       static_cast<unsigned long>(con.particle_memory()),
+	       static_cast<unsigned long>(cv.particle_memory()));
+
+	// Repeat the comparison for the radical tessellation, using the radii
+	// stored in the simulation array
+	container_poly conp(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0,pp=&sim[0];i<particles;i++,pp+=stride) conp.put(i,*pp,pp[1],pp[2],pp[3]);
+	c_loop_all vl3(conp);
+	t0=clock();
+	volumes(conp,vl3,v1);
+	t1=clock();
+	printf("Poly container      : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+	container_view_poly cvp(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false);
+	cvp.bind(particles,&sim[0],stride);
+	c_loop_all vl4(cvp);
+	t0=clock();
+	volumes(cvp,vl4,v2);
+	t1=clock();
+	printf("Poly view           : %g s\n",double(t1-t0)/CLOCKS_PER_SEC);
+	printf("Volume difference   : %g\n\n",max_diff(v1,v2));
+
+	// Check that a subset loop and the threaded routines work with a view
+	c_loop_subset vls(cv);
+	vls.setup_sphere(20,20,20,5,true);
+	v2.assign(particles,0);
+	volumes(cv,vls,v2);
+	double sv=0;
+	for(i=0;i<particles;i++) sv+=v2[i];
+	printf("Sphere volume       : %g\n",sv);
+	cv.set_threads(4);
+	printf("Threaded total      : %g\n",cv.sum_cell_volumes());
+}
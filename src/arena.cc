@@ -0,0 +1,138 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file arena.cc
+ * \brief Function implementations for the cell_arena and cell_arena_pool
+ * classes. */
+
+#include "arena.hh"
+
+namespace voro {
+
+/** The class constructor sets up an empty arena. No memory is taken from the
+ * heap until the first block is requested.
+ * \param[in] slab_size_ the size of each slab in bytes. Blocks that are larger
+ *                       than this are given a slab of their own. */
+cell_arena::cell_arena(size_t slab_size_) : allocs(0), reused(0), heap_allocs(0),
+	bytes(0), peak(0), slab_bytes(0), slab_size(slab_size_), cs(0), cp(NULL), ce(NULL) {
+	for(int k=0;k<arena_size_classes;k++) fl[k]=NULL;
+}
+
+/** The class destructor frees the slabs. */
+cell_arena::~cell_arena() {
+	for(unsigned int i=0;i<sl.size();i++) delete [] sl[i];
+}
+
+/** Allocates a block of memory, reusing a released block of the same size if
+ * one is available, and otherwise carving a new one from the current slab.
+ * \param[in] n the number of bytes required.
+ * \return A pointer to the block. */
+void *cell_arena::allocate(size_t n) {
+	int k=size_class(n);
+	size_t bs=block_size(k);
+	void *ptr;
+	if(k>=arena_size_classes) voro_fatal_error("Arena block size exceeded absolute maximum",VOROPP_MEMORY_ERROR);
+	allocs++;
+	bytes+=bs;
+	if(bytes>peak) peak=bytes;
+	if(fl[k]!=NULL) {
+		reused++;
+		ptr=fl[k];fl[k]=*static_cast<void**>(ptr);
+		return ptr;
+	}
+	if(cp==NULL||size_t(ce-cp)<bs) next_slab(bs);
+	ptr=cp;cp+=bs;
+	return ptr;
+}
+
+/** Moves on to the next slab that can hold a block, allocating a new slab from
+ * the heap if none of the remaining ones are large enough. Any space left in
+ * the current slab is unused until the arena is reset.
+ * \param[in] n the size of the block in bytes. */
+void cell_arena::next_slab(size_t n) {
+	if(cp!=NULL) cs++;
+	while(cs<sl.size()&&ss[cs]<n) cs++;
+	if(cs==sl.size()) {
+		size_t m=n>slab_size?n:slab_size;
+#if VOROPP_VERBOSE >=3
+		fprintf(stderr,"Arena slab of %lu bytes allocated\n",static_cast<unsigned long>(m));
+#endif
+		sl.push_back(new char[m]);
+		ss.push_back(m);
+		heap_allocs++;
+		slab_bytes+=m;
+	}
+	cp=sl[cs];ce=cp+ss[cs];
+}
+
+/** Resets the arena, so that blocks are carved from the start of the first
+ * slab again and the free lists are emptied. The slabs are kept for reuse.
+ * This can only be called when no cell is using the arena. */
+void cell_arena::reset() {
+	if(bytes>0) voro_fatal_error("Arena reset while blocks are still in use",VOROPP_INTERNAL_ERROR);
+	for(int k=0;k<arena_size_classes;k++) fl[k]=NULL;
+	cs=0;cp=ce=NULL;
+}
+
+/** Sets the allocation counts to zero, and sets the peak memory use to the
+ * current memory use. */
+void cell_arena::clear_stats() {
+	allocs=reused=heap_allocs=0;
+	peak=bytes;
+}
+
+/** Prints the allocation counts and memory use of the arena.
+ * \param[in] fp the file handle to write to. */
+void cell_arena::print_stats(FILE *fp) {
+	fprintf(fp,"Blocks allocated   : %ld\n"
+		   "Blocks reused      : %ld\n"
+		   "Heap allocations   : %ld\n"
+		   "Bytes in use       : %lu\n"
+		   "Peak bytes in use  : %lu\n"
+		   "Bytes in slabs     : %lu\n",allocs,reused,heap_allocs,
+		static_cast<unsigned long>(bytes),static_cast<unsigned long>(peak),
+		static_cast<unsigned long>(slab_bytes));
+}
+
+/** The class constructor creates the arenas.
+ * \param[in] n_ the number of arenas. If this is zero or negative, then one is
+ *               created for each thread that OpenMP may use.
+ * \param[in] slab_size the size of each slab in bytes. */
+cell_arena_pool::cell_arena_pool(int n_,size_t slab_size) :
+#ifdef _OPENMP
+	n(n_>0?n_:omp_get_max_threads()),
+#else
+	n(n_>0?n_:1),
+#endif
+	a(new cell_arena*[n]) {
+	for(int i=0;i<n;i++) a[i]=new cell_arena(slab_size);
+}
+
+/** The class destructor frees the arenas. */
+cell_arena_pool::~cell_arena_pool() {
+	for(int i=n-1;i>=0;i--) delete a[i];
+	delete [] a;
+}
+
+/** Resets all of the arenas in the pool. */
+void cell_arena_pool::reset() {
+	for(int i=0;i<n;i++) a[i]->reset();
+}
+
+/** Prints the allocation counts and memory use summed over all of the arenas
+ * in the pool. The peak memory use is the sum of the peaks of the arenas.
+ * \param[in] fp the file handle to write to. */
+void cell_arena_pool::print_stats(FILE *fp) {
+	cell_arena t;
+	for(int i=0;i<n;i++) {
+		t.allocs+=a[i]->allocs;t.reused+=a[i]->reused;
+		t.heap_allocs+=a[i]->heap_allocs;t.bytes+=a[i]->bytes;
+		t.peak+=a[i]->peak;t.slab_bytes+=a[i]->slab_bytes;
+	}
+	t.print_stats(fp);
+}
+
+}
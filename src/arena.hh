@@ -0,0 +1,142 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file arena.hh
+ * \brief Header file for the cell_arena and cell_arena_pool classes. */
+
+#ifndef VOROPP_ARENA_HH
+#define VOROPP_ARENA_HH
+
+#include <cstdio>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "config.hh"
+#include "common.hh"
+
+namespace voro {
+
+/** \brief A memory pool that the Voronoi cell classes can draw their arrays
+ * from.
+ *
+ * A Voronoi cell allocates around a hundred arrays when it is constructed,
+ * most of them for the edge tables of the different vertex orders, and it
+ * frees them all again when it is destroyed. Code that creates a fresh cell
+ * for each of many short computations therefore spends much of its time in
+ * the heap allocator. A cell that is constructed with a cell_arena instead
+ * takes its memory from large slabs held by the arena. Each block is rounded
+ * up to a power of two times arena_min_block, and blocks that are released
+ * are kept on a free list for their size, so the next cell reuses them
+ * without touching the heap.
+ *
+ * An arena must only be used by one thread at a time, and it must outlive
+ * every cell that uses it. The cell_arena_pool class holds one arena for each
+ * thread. */
+class cell_arena {
+	public:
+		/** The number of blocks that have been requested. */
+		long allocs;
+		/** The number of requests that were served by reusing a
+		 * released block. */
+		long reused;
+		/** The number of slabs that have been requested from the
+		 * heap. */
+		long heap_allocs;
+		/** The number of bytes in the blocks that are currently in
+		 * use. */
+		size_t bytes;
+		/** The largest number of bytes that have been in use at
+		 * once. */
+		size_t peak;
+		/** The total size of the slabs in bytes. */
+		size_t slab_bytes;
+		cell_arena(size_t slab_size_=arena_slab_size);
+		~cell_arena();
+		void *allocate(size_t n);
+		/** Returns a block to the arena, putting it on the free list
+		 * for its size.
+		 * \param[in] ptr a pointer to the block.
+		 * \param[in] n the number of bytes that was requested when
+		 *              the block was allocated. */
+		inline void release(void *ptr,size_t n) {
+			int k=size_class(n);
+			*static_cast<void**>(ptr)=fl[k];fl[k]=ptr;
+			bytes-=block_size(k);
+		}
+		void reset();
+		void clear_stats();
+		void print_stats(FILE *fp=stdout);
+	private:
+		/** The default size of a slab in bytes. */
+		const size_t slab_size;
+		/** The slabs that have been taken from the heap. */
+		std::vector<char*> sl;
+		/** The sizes of the slabs in bytes. */
+		std::vector<size_t> ss;
+		/** The index of the slab that blocks are currently carved
+		 * from. */
+		unsigned int cs;
+		/** A pointer to the next free byte in the current slab. */
+		char *cp;
+		/** A pointer to the end of the current slab. */
+		char *ce;
+		/** The heads of the free lists for each block size. */
+		void *fl[arena_size_classes];
+		/** Computes the size class of a block.
+		 * \param[in] n the number of bytes requested.
+		 * \return The index of the smallest block size that can hold
+		 *         the bytes. */
+		inline int size_class(size_t n) {
+			int k=0;
+			while(k<arena_size_classes&&block_size(k)<n) k++;
+			return k;
+		}
+		/** Returns the number of bytes in a block of a given size
+		 * class. */
+		inline size_t block_size(int k) {return size_t(arena_min_block)<<k;}
+		void next_slab(size_t n);
+};
+
+/** \brief A set of cell_arena classes, one for each thread.
+ *
+ * This class holds a separate arena for each thread, so that the Voronoi cells
+ * that are created within a parallel region can take their memory from a pool
+ * without any locking. Each thread finds its own arena with the local()
+ * function. */
+class cell_arena_pool {
+	public:
+		/** The number of arenas in the pool. */
+		const int n;
+		cell_arena_pool(int n_=0,size_t slab_size=arena_slab_size);
+		~cell_arena_pool();
+		/** Returns the arena for the calling thread. If the code is
+		 * not compiled with OpenMP, then this is always the first
+		 * arena. */
+		inline cell_arena &local() {
+#ifdef _OPENMP
+			int t=omp_get_thread_num();
+			if(t>=n) voro_fatal_error("Thread number exceeds the number of arenas in the pool",VOROPP_INTERNAL_ERROR);
+			return *a[t];
+#else
+			return **a;
+#endif
+		}
+		/** Returns one of the arenas in the pool.
+		 * \param[in] i the index of the arena. */
+		inline cell_arena &operator[](int i) {return *a[i];}
+		void reset();
+		void print_stats(FILE *fp=stdout);
+	private:
+		/** The arenas. */
+		cell_arena **a;
+};
+
+}
+
+#endif
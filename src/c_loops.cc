@@ -7,6 +7,10 @@
 /** \file c_loops.cc
  * \brief Function implementations for the loop classes. */
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "c_loops.hh"
 
 namespace voro {
@@ -110,7 +114,7 @@ void c_loop_subset::setup_box(double xmin,double xmax,double ymin,double ymax,do
  * current loop setup.
  * \return True if the point is out of bounds, false otherwise. */
 bool c_loop_subset::out_of_bounds() {
-	double *pp=p[ijk]+ps*q;
+	double *pp=ppos();
 	if(mode==sphere) {
 		double fx(*pp+px-v0),fy(pp[1]+py-v1),fz(pp[2]+pz-v2);
 		return fx*fx+fy*fy+fz*fz>v3;
@@ -124,17 +128,17 @@ bool c_loop_subset::out_of_bounds() {
 /** Returns the next block to be tested in a loop, and updates the periodicity
  * vector if necessary. */
 bool c_loop_subset::next_block() {
-	if(i<bi) {
-		i++;
-		if(ci<nx-1) {ci++;ijk++;} else {ci=0;ijk+=1-nx;px+=sx;}
+	if(ci<bi) {
+		ci++;
+		if(i<nx-1) {i++;ijk++;} else {i=0;ijk+=1-nx;px+=sx;}
 		return true;
-	} else if(j<bj) {
-		i=ai;ci=di;px=apx;j++;
-		if(cj<ny-1) {cj++;ijk+=inc1;} else {cj=0;ijk+=inc1-nxy;py+=sy;}
+	} else if(cj<bj) {
+		ci=ai;i=di;px=apx;cj++;
+		if(j<ny-1) {j++;ijk+=inc1;} else {j=0;ijk+=inc1-nxy;py+=sy;}
 		return true;
-	} else if(k<bk) {
-		i=ai;ci=di;j=aj;cj=dj;px=apx;py=apy;k++;
-		if(ck<nz-1) {ck++;ijk+=inc2;} else {ck=0;ijk+=inc2-nxyz;pz+=sz;}
+	} else if(ck<bk) {
+		ci=ai;i=di;cj=aj;j=dj;px=apx;py=apy;ck++;
+		if(k<nz-1) {k++;ijk+=inc2;} else {k=0;ijk+=inc2-nxyz;pz+=sz;}
 		return true;
 	} else return false;
 }
@@ -147,4 +151,61 @@ void particle_order::add_ordering_memory() {
 	size<<=1;o=no;op=nop;
 }
 
+/** Computes the position of a point along a space-filling curve. The point is
+ * given by three integer coordinates in the range from 0 to 2^bits-1. For the
+ * Hilbert curve, the coordinates are first converted into the transposed form
+ * of the Hilbert index using the method of J. Skilling (AIP Conf. Proc. 707,
+ * 381 (2004)), and the bits are then interleaved in the same way as for the
+ * Morton curve.
+ * \param[in] ct the space-filling curve to use.
+ * \param[in] (x,y,z) the coordinates of the point.
+ * \param[in] bits the number of bits per coordinate, which must be between 1
+ *                 and 10.
+ * \return The position along the curve. */
+unsigned int curve_key(c_loop_curve_type ct,unsigned int x,unsigned int y,unsigned int z,int bits) {
+	unsigned int m=1u<<(bits-1),p,q,t,key=0;
+	if(ct==curve_hilbert) {
+
+		// Undo the excess work in the inverse Hilbert transform
+		for(q=m;q>1;q>>=1) {
+			p=q-1;
+			if(x&q) x^=p;
+			if(y&q) x^=p;else {t=(x^y)&p;x^=t;y^=t;}
+			if(z&q) x^=p;else {t=(x^z)&p;x^=t;z^=t;}
+		}
+
+		// Gray encode
+		y^=x;z^=y;
+		for(t=0,q=m;q>1;q>>=1) if(z&q) t^=q-1;
+		x^=t;y^=t;z^=t;
+	}
+
+	// Interleave the bits of the three coordinates
+	for(q=m;q>0;q>>=1) {
+		key<<=3;
+		if(x&q) key|=4;
+		if(y&q) key|=2;
+		if(z&q) key|=1;
+	}
+	return key;
+}
+
+/** Computes the order in which to visit the computational blocks, by sorting
+ * them according to their position along a space-filling curve. If the grid
+ * has more than 1024 blocks in any direction, the block coordinates are
+ * scaled down to fit, and blocks with the same scaled coordinates are visited
+ * in order of their index.
+ * \param[in] ct the space-filling curve to use. */
+void c_loop_curve::setup_order(c_loop_curve_type ct) {
+	int b=1,sh=0,m=nx>ny?nx:ny,ii,jj,kk,l=0;
+	if(nz>m) m=nz;
+	while((1<<b)<m) b++;
+	if(b>10) {sh=b-10;b=10;}
+	std::vector<std::pair<unsigned int,int> > ke(nxyz);
+	for(kk=0;kk<nz;kk++) for(jj=0;jj<ny;jj++) for(ii=0;ii<nx;ii++,l++)
+		ke[l]=std::make_pair(curve_key(ct,ii>>sh,jj>>sh,kk>>sh,b),l);
+	std::sort(ke.begin(),ke.end());
+	for(l=0;l<nxyz;l++) bl[l]=ke[l].second;
+}
+
 }
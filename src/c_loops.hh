@@ -10,6 +10,8 @@
 #ifndef VOROPP_C_LOOPS_HH
 #define VOROPP_C_LOOPS_HH
 
+#include <cstddef>
+
 #include "config.hh"
 
 namespace voro {
@@ -22,6 +24,15 @@ enum c_loop_subset_mode {
 	no_check
 };
 
+/** A type determining which space-filling curve to use when ordering the
+ * computational blocks, or the particles within them. */
+enum c_loop_curve_type {
+	curve_morton,
+	curve_hilbert
+};
+
+unsigned int curve_key(c_loop_curve_type ct,unsigned int x,unsigned int y,unsigned int z,int bits);
+
 /** \brief A class for storing ordering information when particles are added to
  * a container.
  *
@@ -68,6 +79,27 @@ class particle_order {
 		void add_ordering_memory();
 };
 
+/** \brief A template that gives the loop classes access to the particle
+ * positions of a container.
+ *
+ * Most of the container classes store the positions of their particles in
+ * arrays for each block, which the loop classes read directly. The view
+ * container classes instead read the positions from an array owned by the
+ * caller, and this template is specialized for them. */
+template<class c_class>
+struct c_loop_source {
+	/** Returns the arrays of particle positions for each block.
+	 * \param[in] con the container class to use. */
+	static inline double** blocks(c_class &con) {return con.p;}
+	/** Returns the external array of particle positions, or NULL if the
+	 * container stores its own positions.
+	 * \param[in] con the container class to use. */
+	static inline double* external(c_class &con) {return NULL;}
+	/** Returns the stride of the external array of particle positions.
+	 * \param[in] con the container class to use. */
+	static inline int stride(c_class &con) {return 0;}
+};
+
 /** \brief Base class for looping over particles in a container.
  *
  * This class forms the base of all classes that can loop over a subset of
@@ -102,6 +134,14 @@ class c_loop_base {
 		/** A pointer to the particle counts in the associated
 		 * container data structure. */
 		int *co;
+		/** For container classes that read the particles from an
+		 * array owned by the caller, a pointer to the start of the
+		 * array, and NULL otherwise. In the first case, the particle
+		 * IDs are the indices into the array. */
+		double *xp;
+		/** The number of floating point numbers between consecutive
+		 * particles in the external array. */
+		int xs;
 		/** The current x-index of the block under consideration by the
 		 * loop. */
 		int i;
@@ -123,12 +163,17 @@ class c_loop_base {
 		template<class c_class>
 		c_loop_base(c_class &con) : nx(con.nx), ny(con.ny), nz(con.nz),
 					    nxy(con.nxy), nxyz(con.nxyz), ps(con.ps),
-					    p(con.p), id(con.id), co(con.co) {}
+					    p(c_loop_source<c_class>::blocks(con)), id(con.id), co(con.co),
+					    xp(c_loop_source<c_class>::external(con)),
+					    xs(c_loop_source<c_class>::stride(con)) {}
+		/** Returns a pointer to the position of the particle currently
+		 * being considered by the loop. */
+		inline double* ppos() {return xp==NULL?p[ijk]+ps*q:xp+xs*id[ijk][q];}
 		/** Returns the position vector of the particle currently being
 		 * considered by the loop.
 		 * \param[out] (x,y,z) the position vector of the particle. */
 		inline void pos(double &x,double &y,double &z) {
-			double *pp=p[ijk]+ps*q;
+			double *pp=ppos();
 			x=*(pp++);y=*(pp++);z=*pp;
 		}
 		/** Returns the ID, position vector, and radius of the particle
@@ -140,19 +185,19 @@ class c_loop_base {
 		 * 		 value is returned. */
 		inline void pos(int &pid,double &x,double &y,double &z,double &r) {
 			pid=id[ijk][q];
-			double *pp=p[ijk]+ps*q;
+			double *pp=ppos();
 			x=*(pp++);y=*(pp++);z=*pp;
 			r=ps==3?default_radius:*(++pp);
 		}
 		/** Returns the x position of the particle currently being
 		 * considered by the loop. */
-		inline double x() {return p[ijk][ps*q];}
+		inline double x() {return *ppos();}
 		/** Returns the y position of the particle currently being
 		 * considered by the loop. */
-		inline double y() {return p[ijk][ps*q+1];}
+		inline double y() {return ppos()[1];}
 		/** Returns the z position of the particle currently being
 		 * considered by the loop. */
-		inline double z() {return p[ijk][ps*q+2];}
+		inline double z() {return ppos()[2];}
 		/** Returns the ID of the particle currently being considered
 		 * by the loop. */
 		inline int pid() {return id[ijk][q];}
@@ -209,6 +254,84 @@ class c_loop_all : public c_loop_base {
 		}
 };
 
+/** \brief Class for looping over all of the particles in a container, visiting
+ * the blocks along a space-filling curve.
+ *
+ * This class visits the same particles as the c_loop_all class, but the
+ * computational blocks are visited in the order of a Morton or Hilbert curve
+ * rather than in the order of their indices. Blocks that are close together
+ * on the curve are close together in space, so that the neighboring blocks
+ * that are searched when computing consecutive cells are more likely to still
+ * be in the cache. The particles within each block are visited in the order
+ * that they are stored, which can be changed using the sort_particles()
+ * routine of the container. */
+class c_loop_curve : public c_loop_base {
+	public:
+		/** The constructor copies several necessary constants from the
+		 * base container class, and computes the order in which to
+		 * visit the blocks.
+		 * \param[in] con the container class to use.
+		 * \param[in] ct the space-filling curve to use. */
+		template<class c_class>
+		c_loop_curve(c_class &con,c_loop_curve_type ct=curve_hilbert)
+			: c_loop_base(con), bl(new int[nxyz]), be(bl+nxyz) {
+			setup_order(ct);
+		}
+		/** The destructor frees the dynamically allocated memory. */
+		~c_loop_curve() {
+			delete [] bl;
+		}
+		/** Sets the class to consider the first particle.
+		 * \return True if there is any particle to consider, false
+		 * otherwise. */
+		inline bool start() {
+			bp=bl;ijk=*bp;decode();q=0;
+			while(co[ijk]==0) if(!next_block()) return false;
+			return true;
+		}
+		/** Finds the next particle to test.
+		 * \return True if there is another particle, false if no more
+		 * particles are available. */
+		inline bool inc() {
+			q++;
+			if(q>=co[ijk]) {
+				q=0;
+				do {
+					if(!next_block()) return false;
+				} while(co[ijk]==0);
+			}
+			return true;
+		}
+		/** The list of block indices, in the order that they are
+		 * visited. */
+		int *bl;
+	private:
+		/** A pointer to the current position in the block list. */
+		int *bp;
+		/** A pointer to the end of the block list. */
+		int *be;
+		void setup_order(c_loop_curve_type ct);
+		/** Updates the internal variables to find the next
+		 * computational block on the curve.
+		 * \return True if another block is found, false if there are
+		 * no more blocks. */
+		inline bool next_block() {
+			if(++bp==be) return false;
+			ijk=*bp;decode();
+			return true;
+		}
+		/** Takes the current block index and computes indices in the
+		 * x, y, and z directions. */
+		inline void decode() {
+			k=ijk/nxy;
+			int ijkt=ijk-nxy*k;
+			j=ijkt/nx;
+			i=ijkt-j*nx;
+		}
+		c_loop_curve(const c_loop_curve &);
+		c_loop_curve& operator=(const c_loop_curve &);
+};
+
 /** \brief Class for looping over a subset of particles in a container.
  *
  * This class can loop over a subset of particles in a certain geometrical
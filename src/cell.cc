@@ -16,43 +16,48 @@
 
 namespace voro {
 
-/** Constructs a Voronoi cell and sets up the initial memory. */
-voronoicell_base::voronoicell_base(double max_len_sq) :
+/** Constructs a Voronoi cell and sets up the initial memory.
+ * \param[in] max_len_sq the squared length scale of the cell, used to set the
+ *                       tolerances.
+ * \param[in] arena_ a pointer to an arena to take the memory from, or NULL to
+ *                   use the heap. */
+voronoicell_base::voronoicell_base(double max_len_sq,cell_arena *arena_) :
 	current_vertices(init_vertices), current_vertex_order(init_vertex_order),
 	current_delete_size(init_delete_size), current_delete2_size(init_delete2_size),
-	current_xsearch_size(init_xsearch_size),
-	ed(new int*[current_vertices]), nu(new int[current_vertices]),
-	mask(new unsigned int[current_vertices]),
-	pts(new double[current_vertices<<2]), tol(tolerance*max_len_sq),
-	tol_cu(tol*sqrt(tol)), big_tol(big_tolerance_fac*tol), mem(new int[current_vertex_order]),
-	mec(new int[current_vertex_order]),
-	mep(new int*[current_vertex_order]), ds(new int[current_delete_size]),
-	stacke(ds+current_delete_size), ds2(new int[current_delete2_size]),
-	stacke2(ds2+current_delete2_size), xse(new int[current_xsearch_size]),
+	current_xsearch_size(init_xsearch_size), arena(arena_),
+	ed(cell_alloc<int*>(current_vertices)), nu(cell_alloc<int>(current_vertices)),
+	mask(cell_alloc<unsigned int>(current_vertices)),
+	pts(cell_alloc<double>(current_vertices<<2)), tol(tolerance*max_len_sq),
+	tol_cu(tol*sqrt(tol)), big_tol(big_tolerance_fac*tol), batch_vertices(0),
+	skip_touching(true), mem(cell_alloc<int>(current_vertex_order)),
+	mec(cell_alloc<int>(current_vertex_order)),
+	mep(cell_alloc<int*>(current_vertex_order)), ds(cell_alloc<int>(current_delete_size)),
+	stacke(ds+current_delete_size), ds2(cell_alloc<int>(current_delete2_size)),
+	stacke2(ds2+current_delete2_size), xse(cell_alloc<int>(current_xsearch_size)),
 	stacke3(xse+current_xsearch_size), maskc(0) {
 	int i;
 	for(i=0;i<current_vertices;i++) mask[i]=0;
 	for(i=0;i<3;i++) {
 		mem[i]=init_n_vertices;mec[i]=0;
-		mep[i]=new int[init_n_vertices*((i<<1)+1)];
+		mep[i]=cell_alloc<int>(init_n_vertices*((i<<1)+1));
 	}
 	mem[3]=init_3_vertices;mec[3]=0;
-	mep[3]=new int[init_3_vertices*7];
+	mep[3]=cell_alloc<int>(init_3_vertices*7);
 	for(i=4;i<current_vertex_order;i++) {
 		mem[i]=init_n_vertices;mec[i]=0;
-		mep[i]=new int[init_n_vertices*((i<<1)+1)];
+		mep[i]=cell_alloc<int>(init_n_vertices*((i<<1)+1));
 	}
 }
 
 /** The voronoicell destructor deallocates all the dynamic memory. */
 voronoicell_base::~voronoicell_base() {
-	for(int i=current_vertex_order-1;i>=0;i--) if(mem[i]>0) delete [] mep[i];
-	delete [] xse;
-	delete [] ds2;delete [] ds;
-	delete [] mep;delete [] mec;
-	delete [] mem;delete [] pts;
-	delete [] mask;
-	delete [] nu;delete [] ed;
+	for(int i=current_vertex_order-1;i>=0;i--) if(mem[i]>0) cell_free(mep[i],mem[i]*((i<<1)+1));
+	cell_free(xse,current_xsearch_size);
+	cell_free(ds2,current_delete2_size);cell_free(ds,current_delete_size);
+	cell_free(mep,current_vertex_order);cell_free(mec,current_vertex_order);
+	cell_free(mem,current_vertex_order);cell_free(pts,current_vertices<<2);
+	cell_free(mask,current_vertices);
+	cell_free(nu,current_vertices);cell_free(ed,current_vertices);
 }
 
 /** Ensures that enough memory is allocated prior to carrying out a copy.
@@ -132,7 +137,7 @@ void voronoicell_base::add_memory(vc_class &vc,int i) {
 	int s=(i<<1)+1;
 	if(mem[i]==0) {
 		vc.n_allocate(i,init_n_vertices);
-		mep[i]=new int[init_n_vertices*s];
+		mep[i]=cell_alloc<int>(init_n_vertices*s);
 		mem[i]=init_n_vertices;
 #if VOROPP_VERBOSE >=2
 		fprintf(stderr,"Order %d vertex memory created\n",i);
@@ -144,7 +149,7 @@ void voronoicell_base::add_memory(vc_class &vc,int i) {
 #if VOROPP_VERBOSE >=2
 		fprintf(stderr,"Order %d vertex memory scaled up to %d\n",i,mem[i]);
 #endif
-		l=new int[s*mem[i]];
+		l=cell_alloc<int>(s*mem[i]);
 		int m=0;
 		vc.n_allocate_aux1(i);
 		while(j<s*mec[i]) {
@@ -178,7 +183,7 @@ void voronoicell_base::add_memory(vc_class &vc,int i) {
 			for(k=0;k<s;k++,j++) l[j]=mep[i][j];
 			for(k=0;k<i;k++,m++) vc.n_copy_to_aux1(i,m);
 		}
-		delete [] mep[i];
+		cell_free(mep[i],s*(mem[i]>>1));
 		mep[i]=l;
 		vc.n_switch_to_aux1(i);
 	}
@@ -198,20 +203,20 @@ void voronoicell_base::add_memory_vertices(vc_class &vc) {
 	fprintf(stderr,"Vertex memory scaled up to %d\n",i);
 #endif
 	double *ppts;
-	pp=new int*[i];
+	pp=cell_alloc<int*>(i);
 	for(j=0;j<current_vertices;j++) pp[j]=ed[j];
-	delete [] ed;ed=pp;
+	cell_free(ed,current_vertices);ed=pp;
 	vc.n_add_memory_vertices(i);
-	pnu=new int[i];
+	pnu=cell_alloc<int>(i);
 	for(j=0;j<current_vertices;j++) pnu[j]=nu[j];
-	delete [] nu;nu=pnu;
-	pmask=new unsigned int[i];
+	cell_free(nu,current_vertices);nu=pnu;
+	pmask=cell_alloc<unsigned int>(i);
 	for(j=0;j<current_vertices;j++) pmask[j]=mask[j];
 	while(j<i) pmask[j++]=0;
-	delete [] mask;mask=pmask;
-	ppts=new double[i<<2];
+	cell_free(mask,current_vertices);mask=pmask;
+	ppts=cell_alloc<double>(i<<2);
 	for(j=0;j<(current_vertices<<2);j++) ppts[j]=pts[j];
-	delete [] pts;pts=ppts;
+	cell_free(pts,current_vertices<<2);pts=ppts;
 	current_vertices=i;
 }
 
@@ -227,17 +232,17 @@ void voronoicell_base::add_memory_vorder(vc_class &vc) {
 #if VOROPP_VERBOSE >=2
 	fprintf(stderr,"Vertex order memory scaled up to %d\n",i);
 #endif
-	p1=new int[i];
+	p1=cell_alloc<int>(i);
 	for(j=0;j<current_vertex_order;j++) p1[j]=mem[j];
 	while(j<i) p1[j++]=0;
-	delete [] mem;mem=p1;
-	p2=new int*[i];
+	cell_free(mem,current_vertex_order);mem=p1;
+	p2=cell_alloc<int*>(i);
 	for(j=0;j<current_vertex_order;j++) p2[j]=mep[j];
-	delete [] mep;mep=p2;
-	p1=new int[i];
+	cell_free(mep,current_vertex_order);mep=p2;
+	p1=cell_alloc<int>(i);
 	for(j=0;j<current_vertex_order;j++) p1[j]=mec[j];
 	while(j<i) p1[j++]=0;
-	delete [] mec;mec=p1;
+	cell_free(mec,current_vertex_order);mec=p1;
 	vc.n_add_memory_vorder(i);
 	current_vertex_order=i;
 }
@@ -251,9 +256,9 @@ void voronoicell_base::add_memory_ds() {
 #if VOROPP_VERBOSE >=2
 	fprintf(stderr,"Delete stack 1 memory scaled up to %d\n",current_delete_size);
 #endif
-	int *dsn=new int[current_delete_size],*dsnp=dsn,*dsp=ds;
+	int *dsn=cell_alloc<int>(current_delete_size),*dsnp=dsn,*dsp=ds;
 	while(dsp<stackp) *(dsnp++)=*(dsp++);
-	delete [] ds;ds=dsn;stackp=dsnp;
+	cell_free(ds,current_delete_size>>1);ds=dsn;stackp=dsnp;
 	stacke=ds+current_delete_size;
 }
 
@@ -266,9 +271,9 @@ void voronoicell_base::add_memory_ds2() {
 #if VOROPP_VERBOSE >=2
 	fprintf(stderr,"Delete stack 2 memory scaled up to %d\n",current_delete2_size);
 #endif
-	int *dsn=new int[current_delete2_size],*dsnp=dsn,*dsp=ds2;
+	int *dsn=cell_alloc<int>(current_delete2_size),*dsnp=dsn,*dsp=ds2;
 	while(dsp<stackp2) *(dsnp++)=*(dsp++);
-	delete [] ds2;ds2=dsn;stackp2=dsnp;
+	cell_free(ds2,current_delete2_size>>1);ds2=dsn;stackp2=dsnp;
 	stacke2=ds2+current_delete2_size;
 }
 
@@ -281,9 +286,9 @@ void voronoicell_base::add_memory_xse() {
 #if VOROPP_VERBOSE >=2
 	fprintf(stderr,"Extra search stack memory scaled up to %d\n",current_xsearch_size);
 #endif
-	int *dsn=new int[current_xsearch_size],*dsnp=dsn,*dsp=xse;
+	int *dsn=cell_alloc<int>(current_xsearch_size),*dsnp=dsn,*dsp=xse;
 	while(dsp<stackp3) *(dsnp++)=*(dsp++);
-	delete [] xse;xse=dsn;stackp3=dsnp;
+	cell_free(xse,current_xsearch_size>>1);xse=dsn;stackp3=dsnp;
 	stacke3=xse+current_xsearch_size;
 }
 
@@ -461,6 +466,38 @@ inline bool voronoicell_base::search_for_outside_edge(int &up) {
 	return false;
 }
 
+/** Starting from a point within the current cutting plane, this routine checks
+ * whether the plane only touches the cell. It searches through the connected
+ * group of points that are within the plane, and tests their neighbors. If no
+ * neighbor is inside the cutting space, but at least one is outside it, then
+ * by convexity the plane does not cut the cell, and the facet construction can
+ * be skipped. This is common for crystalline arrangements of particles, where
+ * many of the planes from more distant particles pass exactly through the
+ * vertices, edges, or faces of the cell.
+ * \param[in] up the point within the cutting plane to start from.
+ * \return True if the plane only touches the cell, false otherwise. */
+inline bool voronoicell_base::plane_touches(int up) {
+	int i,lp,lw,*j=stackp2,sc2=stackp2-ds2;
+	bool outside=false;
+	double l;
+	*(stackp2++)=up;
+	while(j<stackp2) {
+		up=*(j++);
+		for(i=0;i<nu[up];i++) {
+			lp=ed[up][i];
+			lw=m_test(lp,l);
+			if(lw==2) {
+				stackp2=ds2+sc2;
+				return false;
+			}
+			else if(lw==1) add_to_stack(sc2,lp);
+			else outside=true;
+		}
+	}
+	stackp2=ds2+sc2;
+	return outside;
+}
+
 /** Adds a point to the auxiliary delete stack if it is not already there.
  * \param[in] vc a reference to the specialized version of the calling class.
  * \param[in] lp the index of the point to add.
@@ -728,6 +765,10 @@ bool voronoicell_base::nplane(vc_class &vc,double x,double y,double z,double rsq
 	maskc+=4;
 	if(maskc<4) reset_mask();
 
+	// If batch classification is enabled, test all of the vertices now.
+	// If none of them are outside the plane, then there is no cut.
+	if(batch_vertices>0&&p>=batch_vertices&&!m_calc_all()) return true;
+
 	uw=m_test(up,u);
 	if(uw==2) {
 		if(!search_downward(lw,lp,ls,us,l,u)) return false;
@@ -742,6 +783,10 @@ bool voronoicell_base::nplane(vc_class &vc,double x,double y,double z,double rsq
 	// Set stack pointers
 	stackp=ds;stackp2=ds2;stackp3=xse;
 
+	// If the search finished at a point within the plane, then check
+	// whether the plane just touches the cell before constructing a facet
+	if(skip_touching&&lp==-1&&uw==1&&plane_touches(up)) return true;
+
 	// Store initial number of vertices
 	int op=p;
 
@@ -2058,6 +2103,42 @@ unsigned int voronoicell_base::m_calc(int n,double &ans) {
 	return maskr;
 }
 
+/** Classifies all of the vertices against the test plane, storing the
+ * results in the same way as m_calc(), so that subsequent calls to m_test()
+ * use the stored values. The scalar products are evaluated in a separate loop
+ * that the compiler can vectorize. If no vertex is outside the plane, so that
+ * the plane at most touches the cell, then the starting vertex for the next
+ * search is set to the inside vertex that is closest to the plane, which is
+ * next to where the graph search would have finished. If skip_touching is
+ * false, then vertices on the plane are treated in the same way as vertices
+ * outside it.
+ * \return True if the plane may cut the cell, false otherwise. */
+bool voronoicell_base::m_calc_all() {
+	int i,im=0;
+	bool cut=false;
+	double *pp=pts,ans,amax=-large_number;
+	for(i=0;i<p;i++,pp+=4) {
+		ans=*pp*px;
+		ans+=pp[1]*py;
+		ans+=pp[2]*pz-prsq;
+		pp[3]=ans;
+	}
+	for(i=0,pp=pts+3;i<p;i++,pp+=4) {
+		if(*pp<-tol) {
+			mask[i]=maskc;
+			if(*pp>amax) {amax=*pp;im=i;}
+		} else if(*pp>tol) {
+			mask[i]=maskc|2;
+			cut=true;
+		} else {
+			mask[i]=maskc|1;
+			if(!skip_touching) cut=true;
+		}
+	}
+	if(!cut&&amax>-large_number) {up=im;return false;}
+	return true;
+}
+
 /** Checks to see if a given vertex is inside, outside or within the test
  * plane. If the point is far away from the test plane, the routine immediately
  * returns whether it is inside or outside. If the routine is close the the
@@ -2472,10 +2553,52 @@ int voronoicell_base::number_of_edges() {
 	return edges>>1;
 }
 
+/** Compiles a custom output format string. The string is split into
+ * directives and literal strings, and the quantities needed by the directives
+ * are recorded. A percent sign that is not followed by a known directive
+ * character is output literally, along with the character, and a percent sign
+ * at the end of the string is ignored.
+ * \param[in] format the custom format string to compile. */
+custom_plan::custom_plan(const char *format) : areas(false), surface(false),
+	perimeters(false), orders(false), count(false), face_verts(false),
+	neighbors(false), volume(false), centroid(false) {
+	const char *fmp=format;
+	std::string s;
+	while(*fmp!=0) {
+		if(*fmp=='%') {
+			fmp++;
+			if(*fmp==0) break;
+			if(strchr("ixyzqrwpPomgEesFAaftlnvcC",*fmp)!=NULL) {
+				if(!s.empty()) {text.push_back(s);code.push_back(0);s.clear();}
+				code.push_back(*fmp);
+				switch(*fmp) {
+					case 'e': perimeters=true;break;
+					case 's': count=true;break;
+					case 'F': surface=true;break;
+					case 'A':
+					case 'a': orders=true;break;
+					case 'f': areas=true;break;
+					case 't': face_verts=true;break;
+					case 'n': neighbors=true;break;
+					case 'v': volume=true;break;
+					case 'c':
+					case 'C': centroid=true;
+				}
+			} else {s+='%';s+=*fmp;}
+		} else s+=*fmp;
+		fmp++;
+	}
+	s+='\n';
+	text.push_back(s);code.push_back(0);
+	faces=areas||surface||perimeters||orders||count||face_verts||neighbors||volume||centroid;
+}
+
 /** Outputs a custom string of information about the Voronoi cell. The string
  * of information follows a similar style as the C printf command, and detailed
  * information about its format is available at
- * http://math.lbl.gov/voro++/doc/custom.html.
+ * http://math.lbl.gov/voro++/doc/custom.html. The string is compiled into a
+ * custom_plan for each call, so when many cells are output with the same
+ * string, it is faster to compile it once and use the routine below.
  * \param[in] format the custom string to print.
  * \param[in] i the ID of the particle associated with this Voronoi cell.
  * \param[in] (x,y,z) the position of the particle associated with this Voronoi
@@ -2483,78 +2606,188 @@ int voronoicell_base::number_of_edges() {
  * \param[in] r a radius associated with the particle.
  * \param[in] fp the file handle to write to. */
 void voronoicell_base::output_custom(const char *format,int i,double x,double y,double z,double r,FILE *fp) {
-	char *fmp=(const_cast<char*>(format));
+	custom_plan cp(format);
+	output_custom(cp,i,x,y,z,r,fp);
+}
+
+/** Computes a frequency table of the face orders.
+ * \param[out] v the vector to store the results in, where v[q] is the number
+ *               of faces with q edges. */
+void custom_data::freq_table(std::vector<int> &v) {
+	v.clear();
+	for(std::vector<int>::iterator it=orders.begin();it!=orders.end();it++) {
+		if((unsigned int) *it>=v.size()) v.resize(*it+1,0);
+		v[*it]++;
+	}
+}
+
+/** Computes the face-based quantities that a compiled custom format needs, in
+ * a single traversal of the faces, which marks each edge once. The arithmetic
+ * is the same as in the face_areas(), surface_area(), face_perimeters(),
+ * face_orders(), face_vertices(), neighbors(), volume(), and centroid()
+ * routines, so that the results are identical.
+ * \param[in] cp the compiled format.
+ * \param[out] cd the class to store the results in. */
+void voronoicell_base::custom_compute(const custom_plan &cp,custom_data &cd) {
+	cd.areas.clear();cd.perimeters.clear();cd.orders.clear();
+	cd.face_verts.clear();cd.neighbors.clear();
+	cd.faces=0;cd.surface=cd.volume=cd.cx=cd.cy=cd.cz=0;
+	if(!cp.faces) return;
+
+	std::vector<int> &vt=cd.face_verts;
+	int **nep=cp.neighbors?neighbor_table():NULL;
+	int a,j,k,l,m,n,q,vs=0;
+	bool tri=cp.areas||cp.surface,tet=cp.volume||cp.centroid;
+	double ux=0,uy=0,uz=0,vx=0,vy=0,vz=0,wx,wy,wz,tvol;
+	double ax,ay,az,bx,by,bz,hx,hy,hz,h,area=0,perim=0;
+	double sa=0,vol=0,cx=0,cy=0,cz=0;
+	for(a=1;a<p;a++) {
+		if(tet) {
+			ux=*pts-pts[4*a];
+			uy=pts[1]-pts[4*a+1];
+			uz=pts[2]-pts[4*a+2];
+		}
+		for(j=0;j<nu[a];j++) {
+			k=ed[a][j];
+			if(k<0) continue;
+			cd.faces++;
+			if(nep!=NULL) cd.neighbors.push_back(nep[a][j]);
+			if(cp.face_verts) {
+				vs=vt.size();
+				vt.push_back(0);
+				vt.push_back(a);
+			}
+			if(cp.perimeters) {
+				ax=pts[k<<2]-pts[a<<2];
+				ay=pts[(k<<2)+1]-pts[(a<<2)+1];
+				az=pts[(k<<2)+2]-pts[(a<<2)+2];
+				perim=sqrt(ax*ax+ay*ay+az*az);
+			}
+			if(tet) {
+				vx=pts[4*k]-*pts;
+				vy=pts[4*k+1]-pts[1];
+				vz=pts[4*k+2]-pts[2];
+			}
+			q=2;area=0;
+			ed[a][j]=-1-k;
+			l=cycle_up(ed[a][nu[a]+j],k);
+			m=ed[k][l];ed[k][l]=-1-m;
+			while(true) {
+				if(cp.face_verts) vt.push_back(k);
+				if(cp.perimeters) {
+					ax=pts[m<<2]-pts[k<<2];
+					ay=pts[(m<<2)+1]-pts[(k<<2)+1];
+					az=pts[(m<<2)+2]-pts[(k<<2)+2];
+					perim+=sqrt(ax*ax+ay*ay+az*az);
+				}
+				if(m==a) break;
+				q++;
+				n=cycle_up(ed[k][nu[k]+l],m);
+				if(tri) {
+					ax=pts[4*k]-pts[4*a];
+					ay=pts[4*k+1]-pts[4*a+1];
+					az=pts[4*k+2]-pts[4*a+2];
+					bx=pts[4*m]-pts[4*a];
+					by=pts[4*m+1]-pts[4*a+1];
+					bz=pts[4*m+2]-pts[4*a+2];
+					hx=ay*bz-az*by;
+					hy=az*bx-ax*bz;
+					hz=ax*by-ay*bx;
+					h=sqrt(hx*hx+hy*hy+hz*hz);
+					area+=h;sa+=h;
+				}
+				if(tet) {
+					wx=pts[4*m]-*pts;
+					wy=pts[4*m+1]-pts[1];
+					wz=pts[4*m+2]-pts[2];
+					tvol=ux*vy*wz+uy*vz*wx+uz*vx*wy-uz*vy*wx-uy*vx*wz-ux*vz*wy;
+					vol+=tvol;
+					cx+=(wx+vx-ux)*tvol;
+					cy+=(wy+vy-uy)*tvol;
+					cz+=(wz+vz-uz)*tvol;
+					vx=wx;vy=wy;vz=wz;
+				}
+				k=m;l=n;
+				m=ed[k][l];ed[k][l]=-1-m;
+			}
+			if(cp.areas) cd.areas.push_back(0.125*area);
+			if(cp.perimeters) cd.perimeters.push_back(0.5*perim);
+			if(cp.orders) cd.orders.push_back(q);
+			if(cp.face_verts) vt[vs]=vt.size()-vs-1;
+		}
+	}
+	reset_edges();
+	cd.surface=0.125*sa;
+	cd.volume=vol*(1/48.0);
+	if(cp.centroid&&vol>tol_cu) {
+		tvol=0.125/vol;
+		cd.cx=cx*tvol+0.5*(*pts);
+		cd.cy=cy*tvol+0.5*pts[1];
+		cd.cz=cz*tvol+0.5*pts[2];
+	}
+}
+
+/** Outputs a custom string of information about the Voronoi cell, using a
+ * compiled format. The face-based quantities that the format needs are
+ * computed by custom_compute() in a single traversal of the faces.
+ * \param[in] cp the compiled format to use.
+ * \param[in] i the ID of the particle associated with this Voronoi cell.
+ * \param[in] (x,y,z) the position of the particle associated with this Voronoi
+ *                    cell.
+ * \param[in] r a radius associated with the particle.
+ * \param[in] fp the file handle to write to. */
+void voronoicell_base::output_custom(const custom_plan &cp,int i,double x,double y,double z,double r,FILE *fp) {
+	custom_data cd;
 	std::vector<int> vi;
 	std::vector<double> vd;
-	while(*fmp!=0) {
-		if(*fmp=='%') {
-			fmp++;
-			switch(*fmp) {
-
-				// Particle-related output
-				case 'i': fprintf(fp,"%d",i);break;
-				case 'x': fprintf(fp,"%g",x);break;
-				case 'y': fprintf(fp,"%g",y);break;
-				case 'z': fprintf(fp,"%g",z);break;
-				case 'q': fprintf(fp,"%g %g %g",x,y,z);break;
-				case 'r': fprintf(fp,"%g",r);break;
-
-				// Vertex-related output
-				case 'w': fprintf(fp,"%d",p);break;
-				case 'p': output_vertices(fp);break;
-				case 'P': output_vertices(x,y,z,fp);break;
-				case 'o': output_vertex_orders(fp);break;
-				case 'm': fprintf(fp,"%g",0.25*max_radius_squared());break;
-
-				// Edge-related output
-				case 'g': fprintf(fp,"%d",number_of_edges());break;
-				case 'E': fprintf(fp,"%g",total_edge_distance());break;
-				case 'e': face_perimeters(vd);voro_print_vector(vd,fp);break;
-
-				// Face-related output
-				case 's': fprintf(fp,"%d",number_of_faces());break;
-				case 'F': fprintf(fp,"%g",surface_area());break;
-				case 'A': {
-						  face_freq_table(vi);
-						  voro_print_vector(vi,fp);
-					  } break;
-				case 'a': face_orders(vi);voro_print_vector(vi,fp);break;
-				case 'f': face_areas(vd);voro_print_vector(vd,fp);break;
-				case 't': {
-						  face_vertices(vi);
-						  voro_print_face_vertices(vi,fp);
-					  } break;
-				case 'l': normals(vd);
-					  voro_print_positions(vd,fp);
-					  break;
-				case 'n': neighbors(vi);
-					  voro_print_vector(vi,fp);
-					  break;
-
-				// Volume-related output
-				case 'v': fprintf(fp,"%g",volume());break;
-				case 'c': {
-						  double cx,cy,cz;
-						  centroid(cx,cy,cz);
-						  fprintf(fp,"%g %g %g",cx,cy,cz);
-					  } break;
-				case 'C': {
-						  double cx,cy,cz;
-						  centroid(cx,cy,cz);
-						  fprintf(fp,"%g %g %g",x+cx,y+cy,z+cz);
-					  } break;
-
-				// End-of-string reached
-				case 0: fmp--;break;
-
-				// The percent sign is not part of a
-				// control sequence
-				default: putc('%',fp);putc(*fmp,fp);
-			}
-		} else putc(*fmp,fp);
-		fmp++;
+	custom_compute(cp,cd);
+
+	// Print the directives and literal strings in order
+	int t=0;
+	for(std::vector<char>::const_iterator cc=cp.code.begin();cc!=cp.code.end();cc++) {
+		switch(*cc) {
+
+			// Literal text
+			case 0: fputs(cp.text[t++].c_str(),fp);break;
+
+			// Particle-related output
+			case 'i': fprintf(fp,"%d",i);break;
+			case 'x': fprintf(fp,"%g",x);break;
+			case 'y': fprintf(fp,"%g",y);break;
+			case 'z': fprintf(fp,"%g",z);break;
+			case 'q': fprintf(fp,"%g %g %g",x,y,z);break;
+			case 'r': fprintf(fp,"%g",r);break;
+
+			// Vertex-related output
+			case 'w': fprintf(fp,"%d",p);break;
+			case 'p': output_vertices(fp);break;
+			case 'P': output_vertices(x,y,z,fp);break;
+			case 'o': output_vertex_orders(fp);break;
+			case 'm': fprintf(fp,"%g",0.25*max_radius_squared());break;
+
+			// Edge-related output
+			case 'g': fprintf(fp,"%d",number_of_edges());break;
+			case 'E': fprintf(fp,"%g",total_edge_distance());break;
+			case 'e': voro_print_vector(cd.perimeters,fp);break;
+
+			// Face-related output
+			case 's': fprintf(fp,"%d",cd.faces);break;
+			case 'F': fprintf(fp,"%g",cd.surface);break;
+			case 'A': cd.freq_table(vi);voro_print_vector(vi,fp);break;
+			case 'a': voro_print_vector(cd.orders,fp);break;
+			case 'f': voro_print_vector(cd.areas,fp);break;
+			case 't': voro_print_face_vertices(cd.face_verts,fp);break;
+			case 'l': normals(vd);
+				  voro_print_positions(vd,fp);
+				  break;
+			case 'n': voro_print_vector(cd.neighbors,fp);break;
+
+			// Volume-related output
+			case 'v': fprintf(fp,"%g",cd.volume);break;
+			case 'c': fprintf(fp,"%g %g %g",cd.cx,cd.cy,cd.cz);break;
+			case 'C': fprintf(fp,"%g %g %g",x+cd.cx,y+cd.cy,z+cd.cz);
+		}
 	}
-	fputs("\n",fp);
 }
 
 /** This initializes the class to be a rectangular box. It calls the base class
@@ -2641,19 +2874,19 @@ void voronoicell_neighbor::check_facets() {
 /** The class constructor allocates memory for storing neighbor information. */
 void voronoicell_neighbor::memory_setup() {
 	int i;
-	mne=new int*[current_vertex_order];
-	ne=new int*[current_vertices];
-	for(i=0;i<3;i++) mne[i]=new int[init_n_vertices*i];
-	mne[3]=new int[init_3_vertices*3];
-	for(i=4;i<current_vertex_order;i++) mne[i]=new int[init_n_vertices*i];
+	mne=cell_alloc<int*>(current_vertex_order);
+	ne=cell_alloc<int*>(current_vertices);
+	for(i=0;i<3;i++) mne[i]=cell_alloc<int>(init_n_vertices*i);
+	mne[3]=cell_alloc<int>(init_3_vertices*3);
+	for(i=4;i<current_vertex_order;i++) mne[i]=cell_alloc<int>(init_n_vertices*i);
 }
 
 /** The class destructor frees the dynamically allocated memory for storing
  * neighbor information. */
 voronoicell_neighbor::~voronoicell_neighbor() {
-	for(int i=current_vertex_order-1;i>=0;i--) if(mem[i]>0) delete [] mne[i];
-	delete [] mne;
-	delete [] ne;
+	for(int i=current_vertex_order-1;i>=0;i--) if(mem[i]>0) cell_free(mne[i],i*mem[i]);
+	cell_free(mne,current_vertex_order);
+	cell_free(ne,current_vertices);
 }
 
 /** Computes a vector list of neighbors. */
@@ -2677,6 +2910,80 @@ void voronoicell_neighbor::neighbors(std::vector<int> &v) {
 	reset_edges();
 }
 
+/** Computes the area, unit normal, and centroid of each face that the cell
+ * shares with a particle of higher ID. Every interior face of a tessellation
+ * is then evaluated by exactly one of the two cells that it separates, so
+ * that whole-system quantities such as a face-area-weighted neighbor graph
+ * can be assembled without duplicating any face work. Faces against walls,
+ * which have negative IDs, and faces against the particle's own periodic
+ * images are skipped.
+ *
+ * The normal of each face is its summed vector area, normalized to unit
+ * length. It therefore agrees with the normals() routine, except on
+ * degenerate faces whose edges are close to the numerical tolerance. On these
+ * faces normals() may return (0,0,0), since it cannot find two edges whose
+ * vector product is above the tolerance, whereas this routine returns a unit
+ * vector whose direction is dominated by roundoff error. Only a face of
+ * exactly zero area gets a zero normal.
+ * \param[in] pid the ID of the particle.
+ * \param[in] (x,y,z) the position of the particle, which is added to the
+ *                    centroids.
+ * \param[out] v the vector to store the neighbor IDs of the faces in.
+ * \param[out] w the vector to store the area, the three components of the
+ *               outward normal, and the three components of the centroid of
+ *               each face in. */
+void voronoicell_neighbor::shared_faces(int pid,double x,double y,double z,std::vector<int> &v,std::vector<double> &w) {
+	int i,j,k,l,m,n;
+	double ux,uy,uz,vx,vy,vz,wx,wy,wz,a,area,sx,sy,sz,cx,cy,cz;
+	v.clear();w.clear();
+	for(i=1;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		if(k>=0) {
+			ed[i][j]=-1-k;
+			l=cycle_up(ed[i][nu[i]+j],k);
+			m=ed[k][l];ed[k][l]=-1-m;
+			if(ne[i][j]>pid) {
+
+				// Divide the face into a fan of triangles about
+				// vertex i, and accumulate their areas, their
+				// vector areas, and their area-weighted
+				// centroids
+				area=sx=sy=sz=cx=cy=cz=0;
+				while(m!=i) {
+					n=cycle_up(ed[k][nu[k]+l],m);
+					ux=pts[4*k]-pts[4*i];
+					uy=pts[4*k+1]-pts[4*i+1];
+					uz=pts[4*k+2]-pts[4*i+2];
+					vx=pts[4*m]-pts[4*i];
+					vy=pts[4*m+1]-pts[4*i+1];
+					vz=pts[4*m+2]-pts[4*i+2];
+					wx=uz*vy-uy*vz;
+					wy=ux*vz-uz*vx;
+					wz=uy*vx-ux*vy;
+					a=sqrt(wx*wx+wy*wy+wz*wz);
+					area+=a;sx+=wx;sy+=wy;sz+=wz;
+					cx+=a*(ux+vx);cy+=a*(uy+vy);cz+=a*(uz+vz);
+					k=m;l=n;
+					m=ed[k][l];ed[k][l]=-1-m;
+				}
+				v.push_back(ne[i][j]);
+				w.push_back(0.125*area);
+				a=sqrt(sx*sx+sy*sy+sz*sz);
+				if(a>0) a=1/a;
+				w.push_back(sx*a);w.push_back(sy*a);w.push_back(sz*a);
+				a=area>0?1/(6*area):0;
+				w.push_back(x+0.5*pts[4*i]+cx*a);
+				w.push_back(y+0.5*pts[4*i+1]+cy*a);
+				w.push_back(z+0.5*pts[4*i+2]+cz*a);
+			} else while(m!=i) {
+				l=cycle_up(ed[k][nu[k]+l],m);
+				k=m;m=ed[k][l];ed[k][l]=-1-m;
+			}
+		}
+	}
+	reset_edges();
+}
+
 /** Prints the vertices, their edges, the relation table, and also notifies if
  * any memory errors are visible. */
 void voronoicell_base::print_edges() {
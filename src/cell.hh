@@ -10,13 +10,88 @@
 #ifndef VOROPP_CELL_HH
 #define VOROPP_CELL_HH
 
+#include <string>
 #include <vector>
 
 #include "config.hh"
 #include "common.hh"
+#include "arena.hh"
 
 namespace voro {
 
+/** \brief A class holding a custom output format string that has been
+ * compiled into a list of operations.
+ *
+ * The output_custom() routine originally interpreted the format string
+ * character by character for each cell, and each directive made its own
+ * traversal of the cell, so that a format such as "%i %v %F %c %f %n" would
+ * walk over every face five times. This class parses the format once, into a
+ * sequence of directives and literal strings, and records which per-face and
+ * per-cell quantities are needed. Those quantities are then computed together
+ * in a single traversal of the faces, with the same arithmetic as the
+ * individual routines, so that the output is unchanged. A plan is not modified
+ * by output_custom(), so one plan can be shared between threads. */
+class custom_plan {
+	public:
+		/** The directives in the format string, in order. A zero
+		 * entry prints the next string in the text array. */
+		std::vector<char> code;
+		/** The literal strings in the format. */
+		std::vector<std::string> text;
+		/** Whether the areas of the faces are needed. */
+		bool areas;
+		/** Whether the total surface area is needed. */
+		bool surface;
+		/** Whether the perimeters of the faces are needed. */
+		bool perimeters;
+		/** Whether the orders of the faces are needed. */
+		bool orders;
+		/** Whether the number of faces is needed. */
+		bool count;
+		/** Whether the vertices of the faces are needed. */
+		bool face_verts;
+		/** Whether the neighbors of the faces are needed. */
+		bool neighbors;
+		/** Whether the volume is needed. */
+		bool volume;
+		/** Whether the centroid is needed. */
+		bool centroid;
+		/** Whether any quantity requires a traversal of the faces. */
+		bool faces;
+		custom_plan(const char *format);
+};
+
+/** \brief A class holding the face-based quantities of a Voronoi cell that
+ * are computed for a custom_plan.
+ *
+ * The vectors are cleared rather than freed by each computation, so reusing
+ * one instance for many cells avoids repeated memory allocation. Only the
+ * quantities that the plan needs are filled in. */
+class custom_data {
+	public:
+		/** The number of faces. */
+		int faces;
+		/** The total surface area. */
+		double surface;
+		/** The volume. */
+		double volume;
+		/** The centroid, relative to the particle position. */
+		double cx,cy,cz;
+		/** The areas of the faces. */
+		std::vector<double> areas;
+		/** The perimeters of the faces. */
+		std::vector<double> perimeters;
+		/** The number of edges of each face. */
+		std::vector<int> orders;
+		/** The vertices of each face, given as the number of vertices
+		 * followed by the vertex indices, in the same format as
+		 * voronoicell_base::face_vertices(). */
+		std::vector<int> face_verts;
+		/** The neighboring particle IDs of the faces. */
+		std::vector<int> neighbors;
+		void freq_table(std::vector<int> &v);
+};
+
 /** \brief A class representing a single Voronoi cell.
  *
  * This class represents a single Voronoi cell, as a collection of vertices
@@ -60,6 +135,9 @@ class voronoicell_base {
 		 * algorithm may consider many planes with similar vectors
 		 * concurrently. */
 		int up;
+		/** A pointer to the arena that the cell takes its memory from,
+		 * or NULL if the memory is taken from the heap. */
+		cell_arena *const arena;
 		/** This is a two dimensional array that holds information
 		 * about the edge connections of the vertices that make up the
 		 * cell. The two dimensional array is not allocated in the
@@ -89,8 +167,39 @@ class voronoicell_base {
 		double tol;
 		double tol_cu;
 		double big_tol;
-		voronoicell_base(double max_len_sq);
+		/** If this is positive, then when a plane cut is carried out
+		 * on a cell with at least this many vertices, all of the
+		 * vertices are classified against the plane in a single pass
+		 * before the cut begins. If it is zero, then the vertices are
+		 * only classified as the search reaches them. */
+		int batch_vertices;
+		/** If this is true, then a plane whose search ends on a vertex
+		 * within the plane is checked to see whether it only touches
+		 * the cell, in which case the facet construction is skipped.
+		 * If it is false, the facet is always constructed. */
+		bool skip_touching;
+		voronoicell_base(double max_len_sq,cell_arena *arena_=NULL);
 		~voronoicell_base();
+		/** Selects how the vertices are classified during a plane cut.
+		 * Classifying all of the vertices at once avoids walking the
+		 * edge graph for planes that do not cut the cell, at the
+		 * expense of testing vertices that the search would not have
+		 * visited. Both methods produce the same cell.
+		 * \param[in] bv the minimum number of vertices for which to
+		 *               classify all of the vertices at once, or zero
+		 *               to always use the graph search. */
+		inline void set_batch_classify(int bv) {batch_vertices=bv;}
+		/** Selects whether planes that only touch the cell are
+		 * detected and skipped. This is much faster for lattices of
+		 * particles, where many planes pass through vertices, edges,
+		 * or faces of the cell. The classification of vertices uses
+		 * the same tolerance either way, but skipping the facet
+		 * construction changes the order of the vertices, and
+		 * therefore the order of the neighbor list. When two faces
+		 * are tied, the recorded neighbor can also differ.
+		 * \param[in] st true to skip touching planes, false to always
+		 *                construct the facet. */
+		inline void set_skip_touching(bool st) {skip_touching=st;}
 		void init_base(double xmin,double xmax,double ymin,double ymax,double zmin,double zmax);
 		void init_octahedron_base(double l);
 		void init_tetrahedron_base(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3);
@@ -195,6 +304,8 @@ class voronoicell_base {
 		 * \param[in] fp the file handle to write to. */
 		inline void output_custom(const char *format,FILE *fp=stdout) {output_custom(format,0,0,0,0,default_radius,fp);}
 		void output_custom(const char *format,int i,double x,double y,double z,double r,FILE *fp=stdout);
+		void output_custom(const custom_plan &cp,int i,double x,double y,double z,double r,FILE *fp=stdout);
+		void custom_compute(const custom_plan &cp,custom_data &cd);
 		template<class vc_class>
 		bool nplane(vc_class &vc,double x,double y,double z,double rsq,int p_id);
 		bool plane_intersects(double x,double y,double z,double rsq);
@@ -221,6 +332,12 @@ class voronoicell_base {
 		 * routine does nothing.
 		 * \param[in] i the vertex to consider. */
 		virtual void print_edges_neighbors(int i) {};
+		/** This is a virtual function that is overridden by a routine
+		 * to return the table of neighboring particle IDs for each
+		 * edge. By default, when no neighbor information is
+		 * available, it returns a null pointer.
+		 * \return A pointer to the table. */
+		virtual int** neighbor_table() {return NULL;}
 		/** This is a simple inline function for picking out the index
 		 * of the next edge counterclockwise at the current vertex.
 		 * \param[in] a the index of an edge of the current vertex.
@@ -253,6 +370,23 @@ class voronoicell_base {
 		template<class vc_class>
 		void check_memory_for_copy(vc_class &vc,voronoicell_base* vb);
 		void copy(voronoicell_base* vb);
+		/** Allocates an array, taking the memory from the cell's arena
+		 * if it has one.
+		 * \param[in] n the number of elements.
+		 * \return A pointer to the array. */
+		template<class T>
+		inline T* cell_alloc(int n) {
+			return arena==NULL?new T[n]:static_cast<T*>(arena->allocate(n*sizeof(T)));
+		}
+		/** Frees an array that was allocated with cell_alloc().
+		 * \param[in] ptr a pointer to the array.
+		 * \param[in] n the number of elements that the array was
+		 *              allocated with. */
+		template<class T>
+		inline void cell_free(T *ptr,int n) {
+			if(arena==NULL) delete [] ptr;
+			else arena->release(ptr,n*sizeof(T));
+		}
 	private:
 		/** This is the delete stack, used to store the vertices which
 		 * are going to be deleted during the plane cutting procedure.
@@ -291,6 +425,7 @@ class voronoicell_base {
 		template<class vc_class>
 		bool delete_connection(vc_class &vc,int j,int k,bool hand);
 		inline bool search_for_outside_edge(int &up);
+		inline bool plane_touches(int up);
 		inline void add_to_stack(int sc2,int lp);
 		inline void reset_mask() {
 			for(int i=0;i<current_vertices;i++) mask[i]=0;
@@ -309,6 +444,7 @@ class voronoicell_base {
 		inline unsigned int m_test(int n,double &ans);
 		inline unsigned int m_testx(int n,double &ans);
 		unsigned int m_calc(int n,double &ans);
+		bool m_calc_all();
 		inline void flip(int tp) {ed[tp][nu[tp]<<1]=-1-ed[tp][nu[tp]<<1];}
 		int check_marginal(int n,double &ans);
 		friend class voronoicell;
@@ -328,6 +464,18 @@ class voronoicell : public voronoicell_base {
 		voronoicell(double max_len_sq_) : voronoicell_base(max_len_sq_) {}
 		template<class c_class>
 		voronoicell(c_class &con) : voronoicell_base(con.max_len_sq) {}
+		/** Constructs a Voronoi cell that takes its memory from an
+		 * arena.
+		 * \param[in] max_len_sq_ the squared length scale of the
+		 *                        cell, used to set the tolerances.
+		 * \param[in] ar the arena to use. */
+		voronoicell(double max_len_sq_,cell_arena &ar) : voronoicell_base(max_len_sq_,&ar) {}
+		/** Constructs a Voronoi cell for use with a container, that
+		 * takes its memory from an arena.
+		 * \param[in] con the container class.
+		 * \param[in] ar the arena to use. */
+		template<class c_class>
+		voronoicell(c_class &con,cell_arena &ar) : voronoicell_base(con.max_len_sq,&ar) {}
 		/** Copies the information from another voronoicell class into
 		 * this class, extending memory allocation if necessary.
 		 * \param[in] c the class to copy. */
@@ -454,6 +602,22 @@ class voronoicell_neighbor : public voronoicell_base {
 		voronoicell_neighbor(c_class &con) : voronoicell_base(con.max_len_sq) {
 			memory_setup();
 		}
+		/** Constructs a Voronoi cell that takes its memory from an
+		 * arena.
+		 * \param[in] max_len_sq_ the squared length scale of the
+		 *                        cell, used to set the tolerances.
+		 * \param[in] ar the arena to use. */
+		voronoicell_neighbor(double max_len_sq_,cell_arena &ar) : voronoicell_base(max_len_sq_,&ar) {
+			memory_setup();
+		}
+		/** Constructs a Voronoi cell for use with a container, that
+		 * takes its memory from an arena.
+		 * \param[in] con the container class.
+		 * \param[in] ar the arena to use. */
+		template<class c_class>
+		voronoicell_neighbor(c_class &con,cell_arena &ar) : voronoicell_base(con.max_len_sq,&ar) {
+			memory_setup();
+		}
 		~voronoicell_neighbor();
 		void operator=(voronoicell &c);
 		void operator=(voronoicell_neighbor &c);
@@ -506,25 +670,30 @@ class voronoicell_neighbor : public voronoicell_base {
 		void init_tetrahedron(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3);
 		void check_facets();
 		virtual void neighbors(std::vector<int> &v);
+		void shared_faces(int pid,double x,double y,double z,std::vector<int> &v,std::vector<double> &w);
 		virtual void print_edges_neighbors(int i);
 		virtual void output_neighbors(FILE *fp=stdout) {
 			std::vector<int> v;neighbors(v);
 			voro_print_vector(v,fp);
 		}
+		/** Returns the table of neighboring particle IDs for each
+		 * edge.
+		 * \return A pointer to the ne array. */
+		virtual int** neighbor_table() {return ne;}
 	private:
 		int *paux1;
 		int *paux2;
 		void memory_setup();
-		inline void n_allocate(int i,int m) {mne[i]=new int[m*i];}
+		inline void n_allocate(int i,int m) {mne[i]=cell_alloc<int>(m*i);}
 		inline void n_add_memory_vertices(int i) {
-			int **pp=new int*[i];
+			int **pp=cell_alloc<int*>(i);
 			for(int j=0;j<current_vertices;j++) pp[j]=ne[j];
-			delete [] ne;ne=pp;
+			cell_free(ne,current_vertices);ne=pp;
 		}
 		inline void n_add_memory_vorder(int i) {
-			int **p2=new int*[i];
+			int **p2=cell_alloc<int*>(i);
 			for(int j=0;j<current_vertex_order;j++) p2[j]=mne[j];
-			delete [] mne;mne=p2;
+			cell_free(mne,current_vertex_order);mne=p2;
 		}
 		inline void n_set_pointer(int p,int n) {
 			ne[p]=mne[n]+n*mec[n];
@@ -541,8 +710,8 @@ class voronoicell_neighbor : public voronoicell_base {
 		inline void n_copy_pointer(int a,int b) {ne[a]=ne[b];}
 		inline void n_set_to_aux1(int j) {ne[j]=paux1;}
 		inline void n_set_to_aux2(int j) {ne[j]=paux2;}
-		inline void n_allocate_aux1(int i) {paux1=new int[i*mem[i]];}
-		inline void n_switch_to_aux1(int i) {delete [] mne[i];mne[i]=paux1;}
+		inline void n_allocate_aux1(int i) {paux1=cell_alloc<int>(i*mem[i]);}
+		inline void n_switch_to_aux1(int i) {cell_free(mne[i],i*(mem[i]>>1));mne[i]=paux1;}
 		inline void n_copy_to_aux1(int i,int m) {paux1[m]=mne[i][m];}
 		inline void n_set_to_aux1_offset(int k,int m) {ne[k]=paux1+m;}
 		friend class voronoicell_base;
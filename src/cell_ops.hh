@@ -0,0 +1,299 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file cell_ops.hh
+ * \brief Header file for the voro_cell_loop() template, and the classes for
+ * the operations that it carries out on each Voronoi cell. */
+
+#ifndef VOROPP_CELL_OPS_HH
+#define VOROPP_CELL_OPS_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+#include "common.hh"
+#include "cell.hh"
+#include "scheduler.hh"
+#include "ordered_writer.hh"
+#include "column_output.hh"
+
+namespace voro {
+
+/** Computes the Voronoi cells for all of the particles visited by a loop
+ * class, and passes each computed cell to an operation class. This routine
+ * contains the loop that is shared by the container routines that process
+ * every cell, such as compute_all_cells(), sum_cell_volumes(),
+ * print_custom(), print_columns(), and print_face_graph().
+ *
+ * If the container's nthreads is larger than one, then the particles are
+ * divided into tasks by a block scheduler, and each thread uses its own
+ * workspace and Voronoi cell. The scheduler is local to the call, so several
+ * threads of a program can carry out computations on the same container at
+ * once. Otherwise the loop class is used directly, with the container's own
+ * workspace. The operation class must
+ * have the following routines:
+ *
+ * - setup(nt,ntasks), which is called before any cells are computed, with
+ *   the number of threads and tasks. For a serial computation, both are
+ *   one.
+ * - start(t,tk) and end(t,tk), which are called by thread t before and after
+ *   it carries out task tk. For a serial computation, t and tk are zero.
+ * - cell(c,t,tk,pid,pp,r), which is called for each cell that is computed,
+ *   with the ID, the position, and the radius of the particle.
+ * - finish(), which is called once all of the cells have been computed.
+ *
+ * Any preparation that the container needs before several threads can
+ * compute cells at once, such as creating the periodic images, must be
+ * carried out before calling this routine.
+ * \param[in] con the container to use.
+ * \param[in] vl the loop class to use.
+ * \param[in] op the operation to carry out. */
+template<class v_cell,class c_workspace,class c_class,class c_loop,class c_op>
+void voro_cell_loop(c_class &con,c_loop &vl,c_op &op) {
+	if(con.nthreads>1) {
+		block_scheduler sched;
+		sched.setup(vl,con.nthreads);
+		op.setup(con.nthreads,sched.ntasks);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(con.nthreads)
+#endif
+		{
+			c_workspace ws;
+			v_cell c(con);
+			int t=sched.thread_num(),tk,*rp,*re,q;
+			double *pp;
+			while(sched.next_task(t,tk)) {
+				op.start(t,tk);
+				for(rp=sched.task_begin(tk),re=sched.task_end(tk);rp<re;rp+=3)
+					for(q=rp[1];q<rp[2];q++) if(con.compute_cell(c,*rp,q,ws)) {
+						pp=con.particle_pos(*rp,q);
+						op.cell(c,t,tk,con.id[*rp][q],pp,con.ps==4?pp[3]:default_radius);
+					}
+				op.end(t,tk);
+			}
+		}
+#if VOROPP_VERBOSE >=3
+		sched.print_report(stderr);
+#endif
+	} else {
+		v_cell c(con);
+		double *pp;
+		op.setup(1,1);
+		op.start(0,0);
+		if(vl.start()) do if(con.compute_cell(c,vl)) {
+			pp=con.particle_pos(vl.ijk,vl.q);
+			op.cell(c,0,0,con.id[vl.ijk][vl.q],pp,con.ps==4?pp[3]:default_radius);
+		} while(vl.inc());
+		op.end(0,0);
+	}
+	op.finish();
+}
+
+/** \brief An operation for voro_cell_loop() that computes the Voronoi cells
+ * but does nothing with them. */
+class cell_op_compute {
+	public:
+		inline void setup(int nt,int ntasks) {}
+		inline void start(int t,int tk) {}
+		template<class v_cell>
+		inline void cell(v_cell &c,int t,int tk,int pid,double *pp,double r) {}
+		inline void end(int t,int tk) {}
+		inline void finish() {}
+};
+
+/** \brief An operation for voro_cell_loop() that sums the volumes of the
+ * Voronoi cells.
+ *
+ * The volumes are summed task by task, and the task sums are then added in
+ * order, so the result of a multithreaded computation may differ from the
+ * serial result by a roundoff error. */
+class cell_op_volume {
+	public:
+		/** The sum of the volumes, which is available after the
+		 * computation. */
+		double vol;
+		cell_op_volume() : vol(0) {}
+		/** Sets up a sum for each task.
+		 * \param[in] nt the number of threads.
+		 * \param[in] ntasks the number of tasks. */
+		inline void setup(int nt,int ntasks) {tv.assign(ntasks,0.);}
+		inline void start(int t,int tk) {}
+		/** Adds the volume of a computed cell to the sum of its task.
+		 * \param[in] c the computed cell.
+		 * \param[in] tk the task that the cell is part of. */
+		template<class v_cell>
+		inline void cell(v_cell &c,int t,int tk,int pid,double *pp,double r) {
+			tv[tk]+=c.volume();
+		}
+		inline void end(int t,int tk) {}
+		/** Adds up the sums of the tasks. */
+		inline void finish() {
+			vol=0;
+			for(unsigned int tk=0;tk<tv.size();tk++) vol+=tv[tk];
+		}
+	private:
+		/** The sum of the volumes in each task. */
+		std::vector<double> tv;
+};
+
+/** \brief A base class for operations for voro_cell_loop() that write text
+ * output for each cell.
+ *
+ * In a serial computation the output is written straight to the file. In a
+ * multithreaded computation the output of each task is formatted by an
+ * ordered_writer and written in task order, so that the output is the same as
+ * for a serial computation. The derived classes write the output of a cell to the file
+ * handle tf[t]. */
+class cell_op_writer {
+	public:
+		/** Sets up the file handles of the threads, and the
+		 * ordered_writer for a multithreaded computation.
+		 * \param[in] nt the number of threads.
+		 * \param[in] ntasks the number of tasks. */
+		inline void setup(int nt,int ntasks) {
+			tf.assign(nt,fp);
+			if(nt>1) {
+				ow=new ordered_writer(nt);
+				ow->setup(ntasks,fp);
+			}
+		}
+		/** Starts the output of a task.
+		 * \param[in] (t,tk) the thread and the task. */
+		inline void start(int t,int tk) {
+			if(ow!=NULL) tf[t]=ow->start_chunk(t,tk);
+		}
+		/** Finishes the output of a task.
+		 * \param[in] (t,tk) the thread and the task. */
+		inline void end(int t,int tk) {
+			if(ow!=NULL) ow->end_chunk(t,tk);
+		}
+		/** Writes any remaining output of the tasks to the file. */
+		inline void finish() {
+			if(ow!=NULL) ow->finish();
+		}
+	protected:
+		/** The file handle to write to. */
+		FILE *fp;
+		/** The ordered_writer used in a multithreaded computation, or
+		 * NULL otherwise. */
+		ordered_writer *ow;
+		/** The file handle that each thread writes to. */
+		std::vector<FILE*> tf;
+		/** The class constructor sets the file to write to.
+		 * \param[in] fp_ the file handle to write to. */
+		cell_op_writer(FILE *fp_) : fp(fp_), ow(NULL) {}
+		~cell_op_writer() {delete ow;}
+	private:
+		cell_op_writer(const cell_op_writer&);
+		void operator=(const cell_op_writer&);
+};
+
+/** \brief An operation for voro_cell_loop() that saves customized
+ * information about each Voronoi cell, using a compiled custom output
+ * format. */
+class cell_op_custom : public cell_op_writer {
+	public:
+		/** The class constructor sets the format and the file.
+		 * \param[in] cp_ the compiled custom output format to use.
+		 * \param[in] fp_ the file handle to write to. */
+		cell_op_custom(const custom_plan &cp_,FILE *fp_) : cell_op_writer(fp_), cp(cp_) {}
+		/** Saves the information about a computed cell.
+		 * \param[in] c the computed cell.
+		 * \param[in] t the thread that computed the cell.
+		 * \param[in] pid the ID of the particle.
+		 * \param[in] pp the position of the particle.
+		 * \param[in] r the radius of the particle. */
+		template<class v_cell>
+		inline void cell(v_cell &c,int t,int tk,int pid,double *pp,double r) {
+			c.output_custom(cp,pid,*pp,pp[1],pp[2],r,tf[t]);
+		}
+	private:
+		/** The compiled custom output format. */
+		const custom_plan &cp;
+};
+
+/** \brief An operation for voro_cell_loop() that saves customized information
+ * about each Voronoi cell in the binary columnar format of the column_writer
+ * class.
+ *
+ * In a multithreaded computation, each task adds its cells to its own buffer
+ * in the column_writer, and the buffers are appended to the file in task
+ * order, so that the file is the same as for a serial computation. */
+class cell_op_columns {
+	public:
+		/** The class constructor sets the column writer.
+		 * \param[in] cw_ the column writer to add the cells to. */
+		cell_op_columns(column_writer &cw_) : cw(cw_), thr(false) {}
+		/** Sets up a buffer for each task in a multithreaded
+		 * computation.
+		 * \param[in] nt the number of threads.
+		 * \param[in] ntasks the number of tasks. */
+		inline void setup(int nt,int ntasks) {
+			thr=nt>1;
+			if(thr) cw.set_tasks(ntasks);
+		}
+		inline void start(int t,int tk) {}
+		/** Adds a computed cell to the column writer.
+		 * \param[in] c the computed cell.
+		 * \param[in] tk the task that the cell is part of.
+		 * \param[in] pid the ID of the particle.
+		 * \param[in] pp the position of the particle.
+		 * \param[in] r the radius of the particle. */
+		template<class v_cell>
+		inline void cell(v_cell &c,int t,int tk,int pid,double *pp,double r) {
+			if(thr) cw.add_task(tk,c,pid,*pp,pp[1],pp[2],r);
+			else cw.add(c,pid,*pp,pp[1],pp[2],r);
+		}
+		/** Finishes a task, so that its buffer can be written.
+		 * \param[in] tk the task. */
+		inline void end(int t,int tk) {
+			if(thr) cw.end_task(tk);
+		}
+		inline void finish() {}
+	private:
+		/** The column writer to add the cells to. */
+		column_writer &cw;
+		/** Whether the computation is multithreaded. */
+		bool thr;
+};
+
+/** \brief An operation for voro_cell_loop() that saves the faces between
+ * pairs of particles as an edge list, using the shared_faces() routine of
+ * the voronoicell_neighbor class. */
+class cell_op_face_graph : public cell_op_writer {
+	public:
+		/** The class constructor sets the file.
+		 * \param[in] fp_ the file handle to write to. */
+		cell_op_face_graph(FILE *fp_) : cell_op_writer(fp_) {}
+		/** Sets up the file handles and the face storage of the
+		 * threads.
+		 * \param[in] nt the number of threads.
+		 * \param[in] ntasks the number of tasks. */
+		inline void setup(int nt,int ntasks) {
+			cell_op_writer::setup(nt,ntasks);
+			v.resize(nt);w.resize(nt);
+		}
+		/** Saves the faces of a computed cell that are shared with a
+		 * particle of higher ID.
+		 * \param[in] c the computed cell.
+		 * \param[in] t the thread that computed the cell.
+		 * \param[in] pid the ID of the particle.
+		 * \param[in] pp the position of the particle. */
+		inline void cell(voronoicell_neighbor &c,int t,int tk,int pid,double *pp,double r) {
+			c.shared_faces(pid,*pp,pp[1],pp[2],v[t],w[t]);
+			voro_print_face_graph(pid,v[t],w[t],tf[t]);
+		}
+	private:
+		/** The neighbor IDs of the faces for each thread. */
+		std::vector<std::vector<int> > v;
+		/** The face information for each thread. */
+		std::vector<std::vector<double> > w;
+};
+
+}
+
+#endif
@@ -15,7 +15,8 @@ using namespace voro;
 enum blocks_mode {
 	none,
 	length_scale,
-	specified
+	specified,
+	tuned
 };
 
 // A maximum allowed number of regions, to prevent enormous amounts of memory
@@ -31,6 +32,9 @@ void help_message() {
 	     "computes the Voronoi cell for each, and then creates <filename.vol> with an\n"
 	     "additional column containing the volume of each Voronoi cell.\n\n"
 	     "Available options:\n"
+	     " -a         : Automatically tune the internal grid by timing trial\n"
+	     "              computations on a subset of the particles\n"
+	     " -b         : Read the input file in the binary particle format\n"
 	     " -c <str>   : Specify a custom output string\n"
 	     " -g         : Turn on the gnuplot output to <filename.gnu>\n"
 	     " -h/--help  : Print this information\n"
@@ -47,6 +51,8 @@ void help_message() {
 	     " -py        : Make container periodic in the y direction\n"
 	     " -pz        : Make container periodic in the z direction\n"
 	     " -r         : Assume the input file has an extra coordinate for radii\n"
+	     " -t <num>   : Use <num> threads for the computation, or all available\n"
+	     "              cores if <num> is zero (requires OpenMP support)\n"
 	     " -v         : Verbose output\n"
 	     " --version  : Print version information\n"
 	     " -wb [6]    : Add six plane wall objects to make rectangular box containing\n"
@@ -120,55 +126,96 @@ void error_message() {
 	fputs("voro++: Unrecognized command-line options; type \"voro++ -h\" for more\ninformation.\n",stderr);
 }
 
+// A file written by the command-line utility. This gives access to the file
+// handle that each thread should write to, so that a multithreaded
+// computation writes the same file as a serial one.
+class cmd_line_file : public cell_op_writer {
+	public:
+		cmd_line_file(FILE *fp_) : cell_op_writer(fp_) {}
+		inline FILE* file(int t) {return tf[t];}
+};
+
+// The operation carried out by voro_cell_loop() on each computed cell. Each
+// requested output file is written through its own cmd_line_file, and in
+// verbose mode the volumes are summed task by task.
+class cmd_line_op {
+	public:
+		double vol;
+		int vcc;
+		cmd_line_op(const custom_plan &cp_,int ps_,FILE* outfile,FILE* gnu_file,FILE* povp_file,FILE* povv_file,bool verbose_)
+			: vol(0), vcc(0), cp(cp_), ps(ps_), verbose(verbose_) {
+			fw[0]=outfile==NULL?NULL:new cmd_line_file(outfile);
+			fw[1]=gnu_file==NULL?NULL:new cmd_line_file(gnu_file);
+			fw[2]=povp_file==NULL?NULL:new cmd_line_file(povp_file);
+			fw[3]=povv_file==NULL?NULL:new cmd_line_file(povv_file);
+		}
+		~cmd_line_op() {
+			for(int k=0;k<4;k++) delete fw[k];
+		}
+		inline void setup(int nt,int ntasks) {
+			for(int k=0;k<4;k++) if(fw[k]!=NULL) fw[k]->setup(nt,ntasks);
+			tv.assign(ntasks,0.);tc.assign(ntasks,0);
+		}
+		inline void start(int t,int tk) {
+			for(int k=0;k<4;k++) if(fw[k]!=NULL) fw[k]->start(t,tk);
+		}
+		template<class v_cell>
+		inline void cell(v_cell &c,int t,int tk,int pid,double *pp,double r) {
+			double x=*pp,y=pp[1],z=pp[2];
+			if(fw[0]!=NULL) c.output_custom(cp,pid,x,y,z,r,fw[0]->file(t));
+			if(fw[1]!=NULL) c.draw_gnuplot(x,y,z,fw[1]->file(t));
+			if(fw[2]!=NULL) {
+				FILE *fp=fw[2]->file(t);
+				fprintf(fp,"// id %d\n",pid);
+				if(ps==4) fprintf(fp,"sphere{<%g,%g,%g>,%g}\n",x,y,z,r);
+				else fprintf(fp,"sphere{<%g,%g,%g>,s}\n",x,y,z);
+			}
+			if(fw[3]!=NULL) {
+				FILE *fp=fw[3]->file(t);
+				fprintf(fp,"// cell %d\n",pid);
+				c.draw_pov(x,y,z,fp);
+			}
+			if(verbose) {tv[tk]+=c.volume();tc[tk]++;}
+		}
+		inline void end(int t,int tk) {
+			for(int k=0;k<4;k++) if(fw[k]!=NULL) fw[k]->end(t,tk);
+		}
+		inline void finish() {
+			for(int k=0;k<4;k++) if(fw[k]!=NULL) fw[k]->finish();
+			for(unsigned int tk=0;tk<tv.size();tk++) {vol+=tv[tk];vcc+=tc[tk];}
+		}
+	private:
+		const custom_plan &cp;
+		const int ps;
+		const bool verbose;
+		cmd_line_file *fw[4];
+		std::vector<double> tv;
+		std::vector<int> tc;
+};
+
 // Carries out the Voronoi computation and outputs the results to the requested
-// files
+// files. If more than one thread has been requested, then the particles are
+// divided into tasks by a block scheduler, and the output of each task is
+// formatted separately, so that the files are the same as for a serial
+// computation.
 template<class c_loop,class c_class>
 void cmd_line_output(c_loop &vl,c_class &con,const char* format,FILE* outfile,FILE* gnu_file,FILE* povp_file,FILE* povv_file,bool verbose,double &vol,int &vcc,int &tp) {
-	int pid,ps=con.ps;double x,y,z,r;
-	if(con.contains_neighbor(format)) {
-		voronoicell_neighbor c(con);
-		if(vl.start()) do if(con.compute_cell(c,vl)) {
-			vl.pos(pid,x,y,z,r);
-			if(outfile!=NULL) c.output_custom(format,pid,x,y,z,r,outfile);
-			if(gnu_file!=NULL) c.draw_gnuplot(x,y,z,gnu_file);
-			if(povp_file!=NULL) {
-				fprintf(povp_file,"// id %d\n",pid);
-				if(ps==4) fprintf(povp_file,"sphere{<%g,%g,%g>,%g}\n",x,y,z,r);
-				else fprintf(povp_file,"sphere{<%g,%g,%g>,s}\n",x,y,z);
-			}
-			if(povv_file!=NULL) {
-				fprintf(povv_file,"// cell %d\n",pid);
-				c.draw_pov(x,y,z,povv_file);
-			}
-			if(verbose) {vol+=c.volume();vcc++;}
-		} while(vl.inc());
-	} else {
-		voronoicell c(con);
-		if(vl.start()) do if(con.compute_cell(c,vl)) {
-			vl.pos(pid,x,y,z,r);
-			if(outfile!=NULL) c.output_custom(format,pid,x,y,z,r,outfile);
-			if(gnu_file!=NULL) c.draw_gnuplot(x,y,z,gnu_file);
-			if(povp_file!=NULL) {
-				fprintf(povp_file,"// id %d\n",pid);
-				if(ps==4) fprintf(povp_file,"sphere{<%g,%g,%g>,%g}\n",x,y,z,r);
-				else fprintf(povp_file,"sphere{<%g,%g,%g>,s}\n",x,y,z);
-			}
-			if(povv_file!=NULL) {
-				fprintf(povv_file,"// cell %d\n",pid);
-				c.draw_pov(x,y,z,povv_file);
-			}
-			if(verbose) {vol+=c.volume();vcc++;}
-		} while(vl.inc());
+	custom_plan cp(format);
+	cmd_line_op op(cp,con.ps,outfile,gnu_file,povp_file,povv_file,verbose);
+	if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(con,vl,op);
+	else voro_cell_loop<voronoicell,compute_workspace>(con,vl,op);
+	if(verbose) {
+		vol+=op.vol;vcc+=op.vcc;
+		tp=con.total_particles();
 	}
-	if(verbose) tp=con.total_particles();
 }
 
 int main(int argc,char **argv) {
-	int i=1,j=-7,custom_output=0,nx,ny,nz,init_mem(8);
+	int i=1,j=-7,custom_output=0,nx,ny,nz,init_mem(8),nthreads(1);
 	double ls=0;
 	blocks_mode bm=none;
 	bool gnuplot_output=false,povp_output=false,povv_output=false,polydisperse=false;
-	bool xperiodic=false,yperiodic=false,zperiodic=false,ordered=false,verbose=false;
+	bool xperiodic=false,yperiodic=false,zperiodic=false,ordered=false,verbose=false,binary=false;
 	pre_container *pcon=NULL;pre_container_poly *pconp=NULL;
 	wall_list wl;
 
@@ -197,7 +244,16 @@ int main(int argc,char **argv) {
 	// We have enough arguments. Now start searching for command-line
 	// options.
 	while(i<argc-7) {
-		if(strcmp(argv[i],"-c")==0) {
+		if(strcmp(argv[i],"-a")==0) {
+			if(bm!=none) {
+				fputs("voro++: Conflicting options about grid setup (-a/-l/-n)\n",stderr);
+				wl.deallocate();
+				return VOROPP_CMD_LINE_ERROR;
+			}
+			bm=tuned;
+		} else if(strcmp(argv[i],"-b")==0) {
+			binary=true;
+		} else if(strcmp(argv[i],"-c")==0) {
 			if(i>=argc-8) {error_message();wl.deallocate();return VOROPP_CMD_LINE_ERROR;}
 			if(custom_output==0) {
 				custom_output=++i;
@@ -215,7 +271,7 @@ int main(int argc,char **argv) {
 		} else if(strcmp(argv[i],"-l")==0) {
 			if(i>=argc-8) {error_message();wl.deallocate();return VOROPP_CMD_LINE_ERROR;}
 			if(bm!=none) {
-				fputs("voro++: Conflicting options about grid setup (-l/-n)\n",stderr);
+				fputs("voro++: Conflicting options about grid setup (-a/-l/-n)\n",stderr);
 				wl.deallocate();
 				return VOROPP_CMD_LINE_ERROR;
 			}
@@ -226,7 +282,7 @@ int main(int argc,char **argv) {
 		} else if(strcmp(argv[i],"-n")==0) {
 			if(i>=argc-10) {error_message();wl.deallocate();return VOROPP_CMD_LINE_ERROR;}
 			if(bm!=none) {
-				fputs("voro++: Conflicting options about grid setup (-l/-n)\n",stderr);
+				fputs("voro++: Conflicting options about grid setup (-a/-l/-n)\n",stderr);
 				wl.deallocate();
 				return VOROPP_CMD_LINE_ERROR;
 			}
@@ -253,6 +309,9 @@ int main(int argc,char **argv) {
 			zperiodic=true;
 		} else if(strcmp(argv[i],"-r")==0) {
 			polydisperse=true;
+		} else if(strcmp(argv[i],"-t")==0) {
+			if(i>=argc-8) {error_message();wl.deallocate();return VOROPP_CMD_LINE_ERROR;}
+			i++;nthreads=atoi(argv[i]);
 		} else if(strcmp(argv[i],"-v")==0) {
 			verbose=true;
 		} else if(strcmp(argv[i],"--version")==0) {
@@ -324,6 +383,13 @@ int main(int argc,char **argv) {
 		return VOROPP_CMD_LINE_ERROR;
 	}
 
+	// Check the number of threads is not negative
+	if(nthreads<0) {
+		fputs("voro++: The number of threads must not be negative\n",stderr);
+		wl.deallocate();
+		return VOROPP_CMD_LINE_ERROR;
+	}
+
 	// Read in the dimensions of the test box, and estimate the number of
 	// boxes to divide the region up into
 	double ax=atof(argv[i]),bx=atof(argv[i+1]);
@@ -348,14 +414,18 @@ int main(int argc,char **argv) {
 		return VOROPP_CMD_LINE_ERROR;
 	}
 
-	if(bm==none) {
+	if(bm==none||bm==tuned) {
 		if(polydisperse) {
 			pconp=new pre_container_poly(ax,bx,ay,by,az,bz,xperiodic,yperiodic,zperiodic);
-			pconp->import(argv[i+6]);
+			if(binary) pconp->import_binary(argv[i+6]);
+			else pconp->import(argv[i+6]);
+			if(bm==tuned) pconp->tune_optimal();
 			pconp->guess_optimal(nx,ny,nz);
 		} else {
 			pcon=new pre_container(ax,bx,ay,by,az,bz,xperiodic,yperiodic,zperiodic);
-			pcon->import(argv[i+6]);
+			if(binary) pcon->import_binary(argv[i+6]);
+			else pcon->import(argv[i+6]);
+			if(bm==tuned) pcon->tune_optimal();
 			pcon->guess_optimal(nx,ny,nz);
 		}
 	} else {
@@ -433,19 +503,25 @@ int main(int argc,char **argv) {
 			particle_order vo;
 			container_poly con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,init_mem);
 			con.add_wall(wl);
-			if(bm==none) {
+			con.set_threads(nthreads);
+			if(bm==none||bm==tuned) {
 				pconp->setup(vo,con);delete pconp;
-			} else con.import(vo,argv[i+6]);
+			} else if(binary) con.import_binary(vo,argv[i+6]);
+			else con.import(vo,argv[i+6]);
+			con.freeze();
 
 			c_loop_order vlo(con,vo);
 			cmd_line_output(vlo,con,c_str,outfile,gnu_file,povp_file,povv_file,verbose,vol,vcc,tp);
 		} else {
 			container_poly con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,init_mem);
 			con.add_wall(wl);
+			con.set_threads(nthreads);
 
-			if(bm==none) {
+			if(bm==none||bm==tuned) {
 				pconp->setup(con);delete pconp;
-			} else con.import(argv[i+6]);
+			} else if(binary) con.import_binary(argv[i+6]);
+			else con.import(argv[i+6]);
+			con.freeze();
 
 			c_loop_all vla(con);
 			cmd_line_output(vla,con,c_str,outfile,gnu_file,povp_file,povv_file,verbose,vol,vcc,tp);
@@ -455,18 +531,24 @@ int main(int argc,char **argv) {
 			particle_order vo;
 			container con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,init_mem);
 			con.add_wall(wl);
-			if(bm==none) {
+			con.set_threads(nthreads);
+			if(bm==none||bm==tuned) {
 				pcon->setup(vo,con);delete pcon;
-			} else con.import(vo,argv[i+6]);
+			} else if(binary) con.import_binary(vo,argv[i+6]);
+			else con.import(vo,argv[i+6]);
+			con.freeze();
 
 			c_loop_order vlo(con,vo);
 			cmd_line_output(vlo,con,c_str,outfile,gnu_file,povp_file,povv_file,verbose,vol,vcc,tp);
 		} else {
 			container con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,init_mem);
 			con.add_wall(wl);
-			if(bm==none) {
+			con.set_threads(nthreads);
+			if(bm==none||bm==tuned) {
 				pcon->setup(con);delete pcon;
-			} else con.import(argv[i+6]);
+			} else if(binary) con.import_binary(argv[i+6]);
+			else con.import(argv[i+6]);
+			con.freeze();
 			c_loop_all vla(con);
 			cmd_line_output(vla,con,c_str,outfile,gnu_file,povp_file,povv_file,verbose,vol,vcc,tp);
 		}
@@ -478,8 +560,8 @@ int main(int argc,char **argv) {
 		       "Computational grid size   : %d by %d by %d (%s)\n"
 		       "Filename                  : %s\n"
 		       "Output string             : %s%s\n",ax,bx,ay,by,az,bz,nx,ny,nz,
-		       bm==none?"estimated from file":(bm==length_scale?
-		       "estimated using length scale":"directly specified"),
+		       bm==none?"estimated from file":(bm==tuned?"tuned by trial computations":
+		       (bm==length_scale?"estimated using length scale":"directly specified")),
 		       argv[i+6],c_str,custom_output==0?" (default)":"");
 		printf("Total imported particles  : %d (%.2g per grid block)\n"
 		       "Total V. cells computed   : %d\n"
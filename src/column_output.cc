@@ -0,0 +1,293 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file column_output.cc
+ * \brief Function implementations for the column_writer class. */
+
+#include <cstring>
+
+#include "column_output.hh"
+#include "common.hh"
+
+namespace voro {
+
+const int column_writer::int_column;
+const int column_writer::double_column;
+const int column_writer::ragged_int_column;
+const int column_writer::ragged_double_column;
+const unsigned int column_writer::version;
+
+/** The class constructor sets up a column for each directive of a compiled
+ * custom output format, while the literal text is ignored.
+ * \param[in] cp the compiled format. */
+column_buffer::column_buffer(const custom_plan &cp) : rows(0) {
+	for(std::vector<char>::const_iterator cc=cp.code.begin();cc!=cp.code.end();cc++) {
+		if(*cc==0) continue;
+		column_data cl;
+		cl.dir=*cc;cl.width=1;
+		switch(*cc) {
+			case 'i': case 'w': case 'g': case 's':
+				cl.type=column_writer::int_column;break;
+			case 'q': case 'c': case 'C':
+				cl.type=column_writer::double_column;cl.width=3;break;
+			case 'x': case 'y': case 'z': case 'r':
+			case 'm': case 'E': case 'F': case 'v':
+				cl.type=column_writer::double_column;break;
+			case 'p': case 'P': case 'l':
+				cl.type=column_writer::ragged_double_column;cl.width=3;break;
+			case 'e': case 'f':
+				cl.type=column_writer::ragged_double_column;break;
+			default:
+				cl.type=column_writer::ragged_int_column;
+		}
+		if(cl.type>=column_writer::ragged_int_column) cl.off.push_back(0);
+		col.push_back(cl);
+	}
+}
+
+/** Adds a Voronoi cell to the buffer.
+ * \param[in] cp the compiled format.
+ * \param[in] c a reference to the Voronoi cell.
+ * \param[in] i the ID of the particle associated with this Voronoi cell.
+ * \param[in] (x,y,z) the position of the particle associated with this Voronoi
+ *                    cell.
+ * \param[in] r a radius associated with the particle. */
+void column_buffer::add(const custom_plan &cp,voronoicell_base &c,int i,double x,double y,double z,double r) {
+	c.custom_compute(cp,cd);
+	for(std::vector<column_data>::iterator cl=col.begin();cl!=col.end();cl++) {
+		std::vector<int> &ci=cl->iv;
+		std::vector<double> &cv=cl->dv;
+		switch(cl->dir) {
+
+			// Particle-related output
+			case 'i': ci.push_back(i);break;
+			case 'x': cv.push_back(x);break;
+			case 'y': cv.push_back(y);break;
+			case 'z': cv.push_back(z);break;
+			case 'q': cv.push_back(x);cv.push_back(y);cv.push_back(z);break;
+			case 'r': cv.push_back(r);break;
+
+			// Vertex-related output
+			case 'w': ci.push_back(c.p);break;
+			case 'p': c.vertices(vd);add_ragged(*cl,vd);break;
+			case 'P': c.vertices(x,y,z,vd);add_ragged(*cl,vd);break;
+			case 'o': c.vertex_orders(vi);add_ragged(*cl,vi);break;
+			case 'm': cv.push_back(0.25*c.max_radius_squared());break;
+
+			// Edge-related output
+			case 'g': ci.push_back(c.number_of_edges());break;
+			case 'E': cv.push_back(c.total_edge_distance());break;
+			case 'e': add_ragged(*cl,cd.perimeters);break;
+
+			// Face-related output
+			case 's': ci.push_back(cd.faces);break;
+			case 'F': cv.push_back(cd.surface);break;
+			case 'A': cd.freq_table(vi);add_ragged(*cl,vi);break;
+			case 'a': add_ragged(*cl,cd.orders);break;
+			case 'f': add_ragged(*cl,cd.areas);break;
+			case 't': add_ragged(*cl,cd.face_verts);break;
+			case 'l': c.normals(vd);add_ragged(*cl,vd);break;
+			case 'n': add_ragged(*cl,cd.neighbors);break;
+
+			// Volume-related output
+			case 'v': cv.push_back(cd.volume);break;
+			case 'c': cv.push_back(cd.cx);cv.push_back(cd.cy);cv.push_back(cd.cz);break;
+			case 'C': cv.push_back(x+cd.cx);cv.push_back(y+cd.cy);cv.push_back(z+cd.cz);
+		}
+	}
+	rows++;
+}
+
+/** Appends a range of the cells of another buffer to this one.
+ * \param[in] b the buffer to take the cells from, which must have the same
+ *              columns.
+ * \param[in] r0 the first cell to take.
+ * \param[in] k the number of cells to take. */
+void column_buffer::append(column_buffer &b,int r0,int k) {
+	int a,e,j,base;
+	for(unsigned int l=0;l<col.size();l++) {
+		column_data &d=col[l],&s=b.col[l];
+		bool iy=d.type==column_writer::int_column||d.type==column_writer::ragged_int_column;
+		if(d.type>=column_writer::ragged_int_column) {
+			a=s.off[r0]*d.width;e=s.off[r0+k]*d.width;
+			base=int(iy?d.iv.size():d.dv.size())/d.width-s.off[r0];
+			for(j=1;j<=k;j++) d.off.push_back(base+s.off[r0+j]);
+		} else {a=r0*d.width;e=(r0+k)*d.width;}
+		if(iy) d.iv.insert(d.iv.end(),s.iv.begin()+a,s.iv.begin()+e);
+		else d.dv.insert(d.dv.end(),s.dv.begin()+a,s.dv.begin()+e);
+	}
+	rows+=k;
+}
+
+/** Removes all of the cells from the buffer. */
+void column_buffer::clear() {
+	for(std::vector<column_data>::iterator cl=col.begin();cl!=col.end();cl++) {
+		if(cl->type>=column_writer::ragged_int_column) cl->off.resize(1);
+		cl->iv.clear();cl->dv.clear();
+	}
+	rows=0;
+}
+
+/** The class constructor compiles the format string into a list of columns,
+ * and opens the file. If the file is being appended to, then its header is
+ * checked against the format, and the routine causes a fatal error if they
+ * do not match.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] format the custom output string to use.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+column_writer::column_writer(const char *filename,const char *format,bool append) : cp(format), buf(cp), nxt(0) {
+
+	// Open the file, checking the header of an existing file if it is
+	// being appended to
+	FILE *rfp;
+	if(append&&(rfp=fopen(filename,"rb"))!=NULL) {
+		fseek(rfp,0,SEEK_END);
+		bool empty=ftell(rfp)==0;
+		if(!empty) {
+			fseek(rfp,0,SEEK_SET);
+			check_header(rfp);
+		}
+		fclose(rfp);
+		fp=safe_fopen(filename,"ab");
+		if(empty) write_header();
+	} else {
+		fp=safe_fopen(filename,"wb");
+		write_header();
+	}
+}
+
+/** The class destructor writes any buffered cells and closes the file. */
+column_writer::~column_writer() {
+	flush();
+	fclose(fp);
+}
+
+/** Checks that the header of an existing file matches the columns, and causes
+ * a fatal error otherwise.
+ * \param[in] rfp a file handle to read the header from. */
+void column_writer::check_header(FILE *rfp) {
+	char mg[8];
+	unsigned int hd[4];
+	bool ok=fread(mg,1,8,rfp)==8&&memcmp(mg,"VORO++CO",8)==0
+	      &&fread(hd,sizeof(unsigned int),4,rfp)==4&&*hd==0x01020304u
+	      &&hd[1]==version&&hd[2]==buf.col.size();
+	for(std::vector<column_data>::iterator cl=buf.col.begin();ok&&cl!=buf.col.end();cl++)
+		ok=fread(hd,sizeof(unsigned int),4,rfp)==4&&*hd==static_cast<unsigned char>(cl->dir)
+		 &&int(hd[1])==cl->type&&int(hd[2])==cl->width;
+	if(!ok) voro_fatal_error("File is not a column file with the same format",VOROPP_FILE_ERROR);
+}
+
+/** Writes the file header and the column descriptors. */
+void column_writer::write_header() {
+	unsigned int hd[4]={0x01020304u,version,static_cast<unsigned int>(buf.col.size()),0};
+	if(fwrite("VORO++CO",1,8,fp)!=8) voro_fatal_error("File output error",VOROPP_FILE_ERROR);
+	write_array(hd,sizeof(unsigned int),4);
+	for(std::vector<column_data>::iterator cl=buf.col.begin();cl!=buf.col.end();cl++) {
+		*hd=static_cast<unsigned char>(cl->dir);
+		hd[1]=cl->type;hd[2]=cl->width;
+		write_array(hd,sizeof(unsigned int),4);
+	}
+}
+
+/** Writes an array to the file, followed by zeros to pad it to a multiple of
+ * eight bytes.
+ * \param[in] p a pointer to the array.
+ * \param[in] size the size of each value.
+ * \param[in] n the number of values. */
+void column_writer::write_array(const void *p,size_t size,size_t n) {
+	static const char zero[8]={0,0,0,0,0,0,0,0};
+	if(n==0) return;
+	size_t pad=padded(size,n)-size*n;
+	if(fwrite(p,size,n,fp)!=n||fwrite(zero,1,pad,fp)!=pad)
+		voro_fatal_error("File output error",VOROPP_FILE_ERROR);
+}
+
+/** Adds a Voronoi cell to the current chunk, and writes the chunk if it is
+ * full.
+ * \param[in] c a reference to the Voronoi cell.
+ * \param[in] i the ID of the particle associated with this Voronoi cell.
+ * \param[in] (x,y,z) the position of the particle associated with this Voronoi
+ *                    cell.
+ * \param[in] r a radius associated with the particle. */
+void column_writer::add(voronoicell_base &c,int i,double x,double y,double z,double r) {
+	buf.add(cp,c,i,x,y,z,r);
+	if(buf.rows==column_chunk_rows) flush();
+}
+
+/** Sets up a buffer for each task of a multithreaded computation.
+ * \param[in] ntasks the number of tasks. */
+void column_writer::set_tasks(int ntasks) {
+	tb.assign(ntasks,column_buffer(cp));
+	done.assign(ntasks,0);
+	nxt=0;
+}
+
+/** Marks a task as ended. The buffers of all of the tasks that have ended,
+ * and that follow the last task to be appended without a gap, are then
+ * appended to the output in order and freed. Several threads can call this
+ * routine at once.
+ * \param[in] tk the task. */
+void column_writer::end_task(int tk) {
+#ifdef _OPENMP
+#pragma omp critical(voro_column_writer)
+#endif
+	{
+		done[tk]=1;
+		while(nxt<int(tb.size())&&done[nxt]) {
+			append(tb[nxt]);
+
+			// Free the memory of the buffer, which clear() would
+			// keep
+			column_buffer(cp).col.swap(tb[nxt].col);
+			nxt++;
+		}
+	}
+}
+
+/** Appends the cells of a buffer to the output, writing a chunk each time
+ * that one is full, so that the chunks are the same as if the cells had been
+ * added one by one.
+ * \param[in] b the buffer to append. */
+void column_writer::append(column_buffer &b) {
+	int r0=0,k;
+	while(r0<b.rows) {
+		k=column_chunk_rows-buf.rows;
+		if(k>b.rows-r0) k=b.rows-r0;
+		buf.append(b,r0,k);
+		r0+=k;
+		if(buf.rows==column_chunk_rows) flush();
+	}
+}
+
+/** Writes the buffered cells to the file as a chunk. */
+void column_writer::flush() {
+	if(buf.rows==0) return;
+	std::vector<column_data>::iterator cl;
+
+	// Compute the length of the chunk, so that readers can skip it
+	size_t len=0;
+	for(cl=buf.col.begin();cl!=buf.col.end();cl++) {
+		if(cl->type>=ragged_int_column) len+=padded(sizeof(int),buf.rows+1);
+		len+=cl->type==int_column||cl->type==ragged_int_column?padded(sizeof(int),cl->iv.size())
+			:padded(sizeof(double),cl->dv.size());
+	}
+	unsigned int ch[2]={static_cast<unsigned int>(buf.rows),static_cast<unsigned int>(len)};
+	write_array(ch,sizeof(unsigned int),2);
+
+	// Write the columns, and clear them for the next chunk
+	for(cl=buf.col.begin();cl!=buf.col.end();cl++) {
+		if(cl->type>=ragged_int_column) {
+			write_array(&cl->off[0],sizeof(int),cl->off.size());
+		}
+		if(!cl->iv.empty()) write_array(&cl->iv[0],sizeof(int),cl->iv.size());
+		if(!cl->dv.empty()) write_array(&cl->dv[0],sizeof(double),cl->dv.size());
+	}
+	fflush(fp);
+	buf.clear();
+}
+
+}
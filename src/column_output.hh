@@ -0,0 +1,188 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file column_output.hh
+ * \brief Header file for the column_writer class, which saves per-cell
+ * information in a binary columnar format. */
+
+#ifndef VOROPP_COLUMN_OUTPUT_HH
+#define VOROPP_COLUMN_OUTPUT_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+#include "cell.hh"
+
+namespace voro {
+
+/** \brief A class holding the data of one column of a column_writer for the
+ * current chunk. */
+class column_data {
+	public:
+		/** The custom output directive that the column holds. */
+		char dir;
+		/** The type of the column, which is one of the column_writer
+		 * type constants. */
+		int type;
+		/** The number of values in each element of the column. */
+		int width;
+		/** The integer values of the column. */
+		std::vector<int> iv;
+		/** The floating point values of the column. */
+		std::vector<double> dv;
+		/** The offsets of each row in a ragged column, in elements. */
+		std::vector<int> off;
+};
+
+/** \brief A class holding the columns of a group of cells that are waiting
+ * to be written by a column_writer.
+ *
+ * The column_writer class uses one of these for the chunk that it is
+ * currently filling. In a multithreaded computation it also uses one for
+ * each task of the block scheduler, which is filled by the thread carrying
+ * out the task, and is then appended to the current chunk in task order. */
+class column_buffer {
+	public:
+		/** The columns. */
+		std::vector<column_data> col;
+		/** The number of cells in the buffer. */
+		int rows;
+		column_buffer(const custom_plan &cp);
+		void add(const custom_plan &cp,voronoicell_base &c,int i,double x,double y,double z,double r);
+		void append(column_buffer &b,int r0,int k);
+		void clear();
+	private:
+		/** Storage for the face-based quantities of each cell. */
+		custom_data cd;
+		/** Temporary storage for integer vectors. */
+		std::vector<int> vi;
+		/** Temporary storage for floating point vectors. */
+		std::vector<double> vd;
+		/** Adds a row of integers to a ragged column.
+		 * \param[in] cl the column.
+		 * \param[in] v the integers to add. */
+		static inline void add_ragged(column_data &cl,std::vector<int> &v) {
+			cl.iv.insert(cl.iv.end(),v.begin(),v.end());
+			cl.off.push_back(int(cl.iv.size())/cl.width);
+		}
+		/** Adds a row of doubles to a ragged column.
+		 * \param[in] cl the column.
+		 * \param[in] v the doubles to add. */
+		static inline void add_ragged(column_data &cl,std::vector<double> &v) {
+			cl.dv.insert(cl.dv.end(),v.begin(),v.end());
+			cl.off.push_back(int(cl.dv.size())/cl.width);
+		}
+};
+
+/** \brief A class for saving per-cell information in a binary columnar
+ * format.
+ *
+ * This class is a binary alternative to the print_custom() routines. It
+ * takes the same format string as output_custom(), and each directive in the
+ * string becomes a column, while the literal text is ignored. Quantities with
+ * a fixed size, such as the ID, volume, surface area, centroid, and counts,
+ * are stored in fixed-width columns, and quantities with a variable length,
+ * such as the neighbor list, face areas, and face vertices, are stored as an
+ * array of offsets and an array of values. All numbers are written at full
+ * precision, in the byte order of the machine that wrote the file.
+ *
+ * The cells are buffered, and are written in chunks of column_chunk_rows
+ * cells, so that large tessellations can be streamed to a file. Every part of
+ * the file starts on an eight-byte boundary, so that the file can be mapped
+ * into memory and the arrays used in place. The file has a header followed by
+ * any number of chunks:
+ *
+ * - The header is made up of the eight characters "VORO++CO", followed by
+ *   four 32-bit integers: the byte-order mark 0x01020304, the format version,
+ *   the number of columns nc, and zero. It is followed by nc column
+ *   descriptors of four 32-bit integers: the directive character, the column
+ *   type, the width, and zero.
+ * - Each chunk starts with two 32-bit integers: the number of cells n, and the
+ *   length in bytes of the rest of the chunk, so that chunks can be skipped.
+ *   The column arrays then follow in order. A fixed-width column holds n*width
+ *   values. A ragged column holds n+1 32-bit offsets, measured in elements
+ *   from the start of the chunk, followed by the values, with width values in
+ *   each element. Each array is padded with zeros to a multiple of eight
+ *   bytes.
+ *
+ * Integers are 32 bits, and floating point numbers are doubles. The face
+ * vertex lists of the %t directive are stored as a ragged integer column, in
+ * the same format as voronoicell_base::face_vertices(), and the vertex
+ * positions and normal vectors are stored with a width of three. A file can be
+ * reopened for appending with the same format string, in which case the
+ * header is checked and the new chunks are added at the end.
+ *
+ * In a multithreaded computation, set_tasks() gives each task of the block
+ * scheduler its own column_buffer. The thread carrying out a task adds its
+ * cells with add_task(), and once end_task() has been called for a task and
+ * all of the tasks before it, their buffers are appended to the output in
+ * task order. The file is therefore the same as for a serial computation. */
+class column_writer {
+	public:
+		/** The type of a column of fixed-width integers. */
+		static const int int_column=0;
+		/** The type of a column of fixed-width doubles. */
+		static const int double_column=1;
+		/** The type of a ragged column of integers. */
+		static const int ragged_int_column=2;
+		/** The type of a ragged column of doubles. */
+		static const int ragged_double_column=3;
+		/** The version of the format that is written. */
+		static const unsigned int version=1;
+		column_writer(const char *filename,const char *format,bool append=false);
+		~column_writer();
+		void add(voronoicell_base &c,int i,double x,double y,double z,double r);
+		void set_tasks(int ntasks);
+		/** Adds a Voronoi cell to the buffer of a task. Several
+		 * threads can call this routine at once, as long as they are
+		 * carrying out different tasks.
+		 * \param[in] tk the task.
+		 * \param[in] c a reference to the Voronoi cell.
+		 * \param[in] i the ID of the particle associated with this
+		 *              Voronoi cell.
+		 * \param[in] (x,y,z) the position of the particle associated
+		 *                    with this Voronoi cell.
+		 * \param[in] r a radius associated with the particle. */
+		inline void add_task(int tk,voronoicell_base &c,int i,double x,double y,double z,double r) {
+			tb[tk].add(cp,c,i,x,y,z,r);
+		}
+		void end_task(int tk);
+		void flush();
+		/** Returns whether the format needs neighbor information, in
+		 * which case the cells must be computed with the
+		 * voronoicell_neighbor class.
+		 * \return True if neighbor information is needed, false
+		 *         otherwise. */
+		inline bool neighbors() {return cp.neighbors;}
+	private:
+		/** The file handle to write to. */
+		FILE *fp;
+		/** The compiled format. */
+		custom_plan cp;
+		/** The cells of the current chunk. */
+		column_buffer buf;
+		/** The buffers of the tasks in a multithreaded computation. */
+		std::vector<column_buffer> tb;
+		/** Whether each task has ended. */
+		std::vector<char> done;
+		/** The first task whose buffer has not been appended. */
+		int nxt;
+		void append(column_buffer &b);
+		void check_header(FILE *rfp);
+		void write_header();
+		void write_array(const void *p,size_t size,size_t n);
+		/** Returns the length in bytes of an array, padded to a
+		 * multiple of eight bytes.
+		 * \param[in] size the size of each value.
+		 * \param[in] n the number of values.
+		 * \return The padded length. */
+		static inline size_t padded(size_t size,size_t n) {return (size*n+7)&~size_t(7);}
+};
+
+}
+
+#endif
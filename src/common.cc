@@ -135,4 +135,19 @@ void voro_print_face_vertices(std::vector<int> &v,FILE *fp) {
 	}
 }
 
+/** \brief Prints the shared faces of a Voronoi cell as an edge list.
+ *
+ * Prints one line for each face computed by the shared_faces() routine of the
+ * voronoicell_neighbor class, containing the IDs of the two particles, the
+ * face area, the unit normal, and the centroid.
+ * \param[in] pid the ID of the particle.
+ * \param[in] v the neighbor IDs of the faces.
+ * \param[in] w the seven values for each face.
+ * \param[in] fp the file stream to print to. */
+void voro_print_face_graph(int pid,std::vector<int> &v,std::vector<double> &w,FILE *fp) {
+	double *wp=w.empty()?NULL:&w[0];
+	for(unsigned int k=0;k<v.size();k++,wp+=7)
+		fprintf(fp,"%d %d %g %g %g %g %g %g %g\n",pid,v[k],*wp,wp[1],wp[2],wp[3],wp[4],wp[5],wp[6]);
+}
+
 }
@@ -26,6 +26,7 @@ FILE* safe_fopen(const char *filename,const char *mode);
 void voro_print_vector(std::vector<int> &v,FILE *fp=stdout);
 void voro_print_vector(std::vector<double> &v,FILE *fp=stdout);
 void voro_print_face_vertices(std::vector<int> &v,FILE *fp=stdout);
+void voro_print_face_graph(int pid,std::vector<int> &v,std::vector<double> &w,FILE *fp=stdout);
 
 }
 
@@ -37,6 +37,10 @@ const int init_wall_size=32;
 const int init_ordering_size=4096;
 /** The initial size of the pre_container chunk index. */
 const int init_chunk_size=256;
+/** The initial number of particle IDs in the voro_incremental class. */
+const int init_incremental_memory=4096;
+/** The initial number of particle IDs in the container index. */
+const int init_index_size=4096;
 
 // If the initial memory is too small, the program dynamically allocates more.
 // However, if the limits below are reached, then the program bails out.
@@ -58,12 +62,26 @@ const int max_particle_memory=16777216;
 const int max_wall_size=2048;
 /** The maximum size for the ordering class. */
 const int max_ordering_size=67108864;
+/** The maximum number of particle IDs in the voro_incremental class. */
+const int max_incremental_memory=67108864;
+/** The number of particle IDs that the container index stores in arrays.
+ * Larger IDs are stored in a map instead. */
+const int max_index_size=67108864;
 /** The maximum size for the pre_container chunk index. */
 const int max_chunk_size=65536;
 
 /** The chunk size in the pre_container classes. */
 const int pre_container_chunk_size=1024;
 
+/** The size in bytes of each slab of memory that the cell_arena class takes
+ * from the heap. */
+const int arena_slab_size=1048576;
+/** The smallest block size in bytes that the cell_arena class hands out.
+ * Larger blocks are this size multiplied by a power of two. */
+const int arena_min_block=16;
+/** The number of different block sizes in the cell_arena class. */
+const int arena_size_classes=40;
+
 #ifndef VOROPP_VERBOSE
 /** Voro++ can print a number of different status and debugging messages to
  * notify the user of special behavior, and this macro sets the amount which
@@ -71,7 +89,8 @@ const int pre_container_chunk_size=1024;
  * about unusual cases during cell construction are printed, such as when the
  * plane routine bails out due to floating point problems. At level 2, general
  * messages about memory expansion are printed. At level 3, technical details
- * about memory management are printed. */
+ * about memory management, and the load balance of each multithreaded
+ * computation, are printed. */
 #define VOROPP_VERBOSE 2
 #endif
 
@@ -96,6 +115,84 @@ const int max_unit_voro_shells=10;
  * container grid. */
 const double optimal_particles=5.6;
 
+/** The mean number of particles in each bin when the grid tuner samples the
+ * particle distribution. */
+const double tune_bin_particles=64.;
+
+/** The number of cells that the grid tuner computes in each trial. */
+const int tune_samples=2000;
+
+/** The number of times that the grid tuner repeats each trial. The shortest
+ * time is used, and the spread of the times is used to judge whether one trial
+ * is faster than another. */
+const int tune_repeats=5;
+
+/** The smallest fractional reduction in time that a trial grid must give for
+ * the grid tuner to accept it. If the spread of the repeated timings is
+ * larger, then the trial grid must beat the current one by the spread
+ * instead. */
+const double tune_threshold=0.03;
+
+/** The factor by which the grid tuner multiplies the required reduction in
+ * time when it tries an anisotropic block shape, so that the shape is only
+ * changed when it clearly wins. */
+const double tune_aniso_margin=2.;
+
+/** The factor by which the grid tuner changes the number of particles per
+ * block between trials. */
+const double tune_factor=2.;
+
+/** The factor by which the grid tuner stretches the blocks along one axis
+ * when it searches for an anisotropic grid. */
+const double tune_stretch=1.5;
+
+/** The default maximum number of particles in a leaf of the octree
+ * containers. */
+const int oct_leaf_max=32;
+
+/** The maximum depth of the octree containers. Leaves at this depth are not
+ * split, and their memory is increased instead, which prevents endless
+ * splitting when many particles are at the same position. */
+const int oct_max_depth=24;
+
+/** The number of bytes that the text_importer class reads from a file at a
+ * time. Each buffer is parsed by all of the threads together, and the
+ * particles in it are then added to the container in bulk. */
+const int import_buffer_size=16777216;
+
+/** The number of cells that the column_writer class buffers before writing
+ * them to the file as a chunk. */
+const int column_chunk_rows=65536;
+
+/** The number of tasks per thread that the block_scheduler class aims to
+ * create. Using several tasks per thread gives idle threads work to steal
+ * when the particle distribution is not uniform. */
+const int tasks_per_thread=16;
+
+#ifndef VOROPP_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+/** If this is set to 1, then the particle_file class reads binary particle
+ * files by mapping them into memory with mmap(), which requires a POSIX
+ * system. If this is set to 0, the files are read into a buffer instead. */
+#define VOROPP_MMAP 1
+#else
+#define VOROPP_MMAP 0
+#endif
+#endif
+
+#ifndef VOROPP_MEMSTREAM
+#if defined(__unix__) || defined(__APPLE__)
+/** If this is set to 1, then the ordered_writer class formats the output of
+ * each chunk into a memory buffer with open_memstream(), which requires a
+ * POSIX system, and writes the chunks while the computation is running. If
+ * this is set to 0, the chunks are formatted into temporary files instead,
+ * and are copied to the output once the computation has finished. */
+#define VOROPP_MEMSTREAM 1
+#else
+#define VOROPP_MEMSTREAM 0
+#endif
+#endif
+
 /** If this is set to 1, then the code reports any instances of particles being
  * put outside of the container geometry. */
 #define VOROPP_REPORT_OUT_OF_BOUNDS 0
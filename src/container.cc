@@ -7,7 +7,12 @@
 /** \file container.cc
  * \brief Function implementations for the container and related classes. */
 
+#include <algorithm>
+#include <utility>
+
 #include "container.hh"
+#include "particle_file.hh"
+#include "text_import.hh"
 
 namespace voro {
 
@@ -34,7 +39,8 @@ container_base::container_base(double ax_,double bx_,double ay_,double by_,doubl
 	max_len_sq((bx-ax)*(bx-ax)*(xperiodic_?0.25:1)+(by-ay)*(by-ay)*(yperiodic_?0.25:1)
 		  +(bz-az)*(bz-az)*(zperiodic_?0.25:1)),
 	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_),
-	id(new int*[nxyz]), p(new double*[nxyz]), co(new int[nxyz]), mem(new int[nxyz]), ps(ps_) {
+	id(new int*[nxyz]), p(new double*[nxyz]), co(new int[nxyz]), mem(new int[nxyz]), ps(ps_),
+	bo(NULL), indexed(false), ixmem(0), ixb(NULL), ixq(NULL) {
 
 	int l;
 	for(l=0;l<nxyz;l++) co[l]=0;
@@ -46,12 +52,20 @@ container_base::container_base(double ax_,double bx_,double ay_,double by_,doubl
 /** The container destructor frees the dynamically allocated memory. */
 container_base::~container_base() {
 	int l;
-	for(l=0;l<nxyz;l++) delete [] p[l];
-	for(l=0;l<nxyz;l++) delete [] id[l];
+	if(bo!=NULL) {
+		delete [] *p;
+		delete [] *id;
+		delete [] bo;
+	} else {
+		for(l=0;l<nxyz;l++) delete [] p[l];
+		for(l=0;l<nxyz;l++) delete [] id[l];
+	}
 	delete [] id;
 	delete [] p;
 	delete [] co;
 	delete [] mem;
+	delete [] ixq;
+	delete [] ixb;
 }
 
 /** The class constructor sets up the geometry of container.
@@ -91,6 +105,7 @@ void container::put(int n,double x,double y,double z) {
 	int ijk;
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
+		index_add(n,ijk,co[ijk]);
 		double *pp=p[ijk]+3*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*pp=z;
 	}
@@ -104,6 +119,7 @@ void container_poly::put(int n,double x,double y,double z,double r) {
 	int ijk;
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
+		index_add(n,ijk,co[ijk]);
 		double *pp=p[ijk]+4*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
 		if(max_radius<r) max_radius=r;
@@ -119,6 +135,7 @@ void container::put(particle_order &vo,int n,double x,double y,double z) {
 	int ijk;
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
+		index_add(n,ijk,co[ijk]);
 		vo.add(ijk,co[ijk]);
 		double *pp=p[ijk]+3*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*pp=z;
@@ -135,6 +152,7 @@ void container_poly::put(particle_order &vo,int n,double x,double y,double z,dou
 	int ijk;
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
+		index_add(n,ijk,co[ijk]);
 		vo.add(ijk,co[ijk]);
 		double *pp=p[ijk]+4*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
@@ -142,6 +160,123 @@ void container_poly::put(particle_order &vo,int n,double x,double y,double z,dou
 	}
 }
 
+/** Adds a list of particles to the container, allocating exactly the memory
+ * that is needed in each block. See container_base::bulk_put() for details.
+ * \param[in] n the number of particles.
+ * \param[in] pid an array of the particles' numerical IDs, or NULL to number
+ *                the particles from 0 to n-1.
+ * \param[in] pos an array of 3*n floating point numbers holding the (x,y,z)
+ *                position of each particle in turn. */
+void container::put_bulk(int n,const int *pid,const double *pos) {
+	bulk_put(n,pid,pos,NULL);
+}
+
+/** Adds a list of particles to the container, allocating exactly the memory
+ * that is needed in each block, and also recording into which regions they
+ * were stored. See container_base::bulk_put() for details.
+ * \param[in] vo the ordering class in which to record the regions.
+ * \param[in] n the number of particles.
+ * \param[in] pid an array of the particles' numerical IDs, or NULL to number
+ *                the particles from 0 to n-1.
+ * \param[in] pos an array of 3*n floating point numbers holding the (x,y,z)
+ *                position of each particle in turn. */
+void container::put_bulk(particle_order &vo,int n,const int *pid,const double *pos) {
+	bulk_put(n,pid,pos,&vo);
+}
+
+/** Adds a list of particles to the container, allocating exactly the memory
+ * that is needed in each block. See container_base::bulk_put() for details.
+ * \param[in] n the number of particles.
+ * \param[in] pid an array of the particles' numerical IDs, or NULL to number
+ *                the particles from 0 to n-1.
+ * \param[in] pos an array of 4*n floating point numbers holding the (x,y,z)
+ *                position and the radius of each particle in turn. */
+void container_poly::put_bulk(int n,const int *pid,const double *pos) {
+	bulk_put(n,pid,pos,NULL);
+	update_max_radius();
+}
+
+/** Adds a list of particles to the container, allocating exactly the memory
+ * that is needed in each block, and also recording into which regions they
+ * were stored. See container_base::bulk_put() for details.
+ * \param[in] vo the ordering class in which to record the regions.
+ * \param[in] n the number of particles.
+ * \param[in] pid an array of the particles' numerical IDs, or NULL to number
+ *                the particles from 0 to n-1.
+ * \param[in] pos an array of 4*n floating point numbers holding the (x,y,z)
+ *                position and the radius of each particle in turn. */
+void container_poly::put_bulk(particle_order &vo,int n,const int *pid,const double *pos) {
+	bulk_put(n,pid,pos,&vo);
+	update_max_radius();
+}
+
+/** Moves a particle to a new position. If the new position is in the same
+ * block, then the particle is updated in place. Otherwise it is removed from
+ * its block as described in container_base::remove(), and added to the new
+ * block.
+ * \param[in] n the numerical ID of the particle to move.
+ * \param[in] (x,y,z) the new position of the particle.
+ * \return True if the particle was moved. False if there was no particle
+ * with this ID, or if the new position is outside the container, in which
+ * case the particle is left where it was. */
+bool container::move(int n,double x,double y,double z) {
+	int ijk,q,nijk;
+	if(!find_particle(n,ijk,q)||!put_locate_block(nijk,x,y,z)) return false;
+	if(nijk!=ijk) {
+		remove_slot(ijk,q);
+		q=co[nijk]++;
+		id[nijk][q]=n;
+		set_index(n,nijk,q);
+	}
+	double *pp=p[nijk]+3*q;
+	*(pp++)=x;*(pp++)=y;*pp=z;
+	return true;
+}
+
+/** Moves a particle to a new position, keeping its radius. See
+ * container::move() for details.
+ * \param[in] n the numerical ID of the particle to move.
+ * \param[in] (x,y,z) the new position of the particle.
+ * \return True if the particle was moved. False if there was no particle
+ * with this ID, or if the new position is outside the container, in which
+ * case the particle is left where it was. */
+bool container_poly::move(int n,double x,double y,double z) {
+	int ijk,q;
+	return find_particle(n,ijk,q)&&move(n,x,y,z,p[ijk][4*q+3]);
+}
+
+/** Moves a particle to a new position and changes its radius. See
+ * container::move() for details. The maximum radius is increased if
+ * necessary, but it is not decreased.
+ * \param[in] n the numerical ID of the particle to move.
+ * \param[in] (x,y,z) the new position of the particle.
+ * \param[in] r the new radius of the particle.
+ * \return True if the particle was moved. False if there was no particle
+ * with this ID, or if the new position is outside the container, in which
+ * case the particle is left where it was. */
+bool container_poly::move(int n,double x,double y,double z,double r) {
+	int ijk,q,nijk;
+	if(!find_particle(n,ijk,q)||!put_locate_block(nijk,x,y,z)) return false;
+	if(nijk!=ijk) {
+		remove_slot(ijk,q);
+		q=co[nijk]++;
+		id[nijk][q]=n;
+		set_index(n,nijk,q);
+	}
+	double *pp=p[nijk]+4*q;
+	*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
+	if(max_radius<r) max_radius=r;
+	return true;
+}
+
+/** Scans all of the stored particles and updates the maximum radius. */
+void container_poly::update_max_radius() {
+	double *pp,*pe;
+	for(int ijk=0;ijk<nxyz;ijk++)
+		for(pp=p[ijk]+3,pe=p[ijk]+4*co[ijk];pp<pe;pp+=4)
+			if(max_radius<*pp) max_radius=*pp;
+}
+
 /** This routine takes a particle position vector, tries to remap it into the
  * primary domain. If successful, it computes the region into which it can be
  * stored and checks that there is enough memory within this region to store
@@ -152,6 +287,7 @@ void container_poly::put(particle_order &vo,int n,double x,double y,double z,dou
  * \return True if the particle can be successfully placed into the container,
  * false otherwise. */
 bool container_base::put_locate_block(int &ijk,double &x,double &y,double &z) {
+	check_unfrozen();
 	if(put_remap(ijk,x,y,z)) {
 		if(co[ijk]==mem[ijk]) add_particle_memory(ijk);
 		return true;
@@ -200,7 +336,7 @@ inline bool container_base::put_remap(int &ijk,double &x,double &y,double &z) {
  * \param[out] ijk the block index that the vector is within.
  * \return True if the particle is within the container or can be remapped into
  * it, false if it lies outside of the container bounds. */
-inline bool container_base::remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk) {
+inline bool container_base::remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk) const {
 	ci=step_int((x-ax)*xsp);
 	if(ci<0||ci>=nx) {
 		if(xperiodic) {ai=step_div(ci,nx);x-=ai*(bx-ax);ci-=ai*nx;}
@@ -223,6 +359,31 @@ inline bool container_base::remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &c
 	return true;
 }
 
+/** Takes a position vector and finds the block that it is within, remapping
+ * it into the primary domain if necessary. Unlike put_locate_block(), this
+ * routine does not modify the container, and it is used to set up ghost
+ * particle computations.
+ * \param[out] ijk the block index that the vector is within.
+ * \param[out] (ci,cj,ck) the coordinates of the block.
+ * \param[in,out] (x,y,z) the position vector to consider, which is remapped
+ *                        into the primary domain during the routine.
+ * \return True if the vector is within the container or can be remapped into
+ * it, false if it lies outside of the container bounds. */
+bool container_base::locate_block(int &ijk,int &ci,int &cj,int &ck,double &x,double &y,double &z) const {
+	int ai,aj,ak;
+	return remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk);
+}
+
+/** Finds the block that a vector is within, remapping it into the primary
+ * domain if necessary.
+ * \param[in] (x,y,z) the vector.
+ * \return The block index, or -1 if the vector lies outside the container
+ * bounds. */
+int container_base::query_block(double x,double y,double z) const {
+	int ijk,ci,cj,ck;
+	return locate_block(ijk,ci,cj,ck,x,y,z)?ijk:-1;
+}
+
 /** Takes a vector and finds the particle whose Voronoi cell contains that
  * vector. This is equivalent to finding the particle which is nearest to the
  * vector. Additional wall classes are not considered by this routine.
@@ -232,37 +393,63 @@ inline bool container_base::remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &c
  *                        this may point to a particle in a periodic image of
  *                        the primary domain.
  * \param[out] pid the ID of the particle.
+ * \param[in] ws the workspace to use for the search.
  * \return True if a particle was found. If the container has no particles,
  * then the search will not find a Voronoi cell and false is returned. */
-bool container::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
-	int ai,aj,ak,ci,cj,ck,ijk;
+bool container::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const {
+	int ijk,l,ai,aj,ak;
+	if(!find_owner(ws,x,y,z,ijk,l,ai,aj,ak)) return false;
+	rx=p[ijk][3*l]+ai*(bx-ax);
+	ry=p[ijk][3*l+1]+aj*(by-ay);
+	rz=p[ijk][3*l+2]+ak*(bz-az);
+	pid=id[ijk][l];
+	return true;
+}
+
+/** Takes a vector and finds the block and slot of the particle whose Voronoi
+ * cell contains it, and the periodic image of the particle.
+ * \param[in] ws the workspace to use for the search.
+ * \param[in] (x,y,z) the vector to test.
+ * \param[out] (ijk,l) the block and slot of the particle.
+ * \param[out] (ai,aj,ak) the periodic image of the particle that is closest
+ *                        to the vector.
+ * \return True if a particle was found, false otherwise. */
+bool container::find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const {
+	int ci,cj,ck;
 	particle_record w;
 	double mrs;
 
 	// If the given vector lies outside the domain, but the container
 	// is periodic, then remap it back into the domain
 	if(!remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk)) return false;
-	vc.find_voronoi_cell(x,y,z,ci,cj,ck,ijk,w,mrs);
-
-	if(w.ijk!=-1) {
-
-		// Assemble the position vector of the particle to be returned,
-		// applying a periodic remapping if necessary
-		if(xperiodic) {ci+=w.di;if(ci<0||ci>=nx) ai+=step_div(ci,nx);}
-		if(yperiodic) {cj+=w.dj;if(cj<0||cj>=ny) aj+=step_div(cj,ny);}
-		if(zperiodic) {ck+=w.dk;if(ck<0||ck>=nz) ak+=step_div(ck,nz);}
-		rx=p[w.ijk][3*w.l]+ai*(bx-ax);
-		ry=p[w.ijk][3*w.l+1]+aj*(by-ay);
-		rz=p[w.ijk][3*w.l+2]+ak*(bz-az);
-		pid=id[w.ijk][w.l];
-		return true;
-	}
+	vc.find_voronoi_cell(ws,x,y,z,ci,cj,ck,ijk,w,mrs);
 
 	// If no particle if found then just return false
-	return false;
+	if(w.ijk==-1) return false;
+
+	// Find the periodic image of the particle
+	if(xperiodic) {ci+=w.di;if(ci<0||ci>=nx) ai+=step_div(ci,nx);}
+	if(yperiodic) {cj+=w.dj;if(cj<0||cj>=ny) aj+=step_div(cj,ny);}
+	if(zperiodic) {ck+=w.dk;if(ck<0||ck>=nz) ak+=step_div(ck,nz);}
+	ijk=w.ijk;l=w.l;
+	return true;
+}
+
+/** Finds the particles whose Voronoi cells contain a list of vectors. See
+ * voro_compute::find_voronoi_cells() for details.
+ * \param[in] n the number of vectors.
+ * \param[in] pos an array of 3*n floating point numbers holding the vectors.
+ * \param[out] pid an array of n integers in which to store the IDs of the
+ *                 particles, or -1 for vectors outside the container.
+ * \param[out] sh an array of 3*n integers in which to store the periodic image
+ *                of each particle that is closest to the vector, in units of
+ *                the container lengths, or NULL if this is not required. */
+void container::find_voronoi_cells(int n,const double *pos,int *pid,int *sh) {
+	vc.find_voronoi_cells(n,pos,pid,sh);
 }
 
 /** Takes a vector and finds the particle whose Voronoi cell contains that
+ * vector. This is equivalent to finding the particle which is nearest to the
  * vector. Additional wall classes are not considered by this routine.
  * \param[in] (x,y,z) the vector to test.
  * \param[out] (rx,ry,rz) the position of the particle whose Voronoi cell
@@ -270,40 +457,74 @@ bool container::find_voronoi_cell(double x,double y,double z,double &rx,double &
  *                        this may point to a particle in a periodic image of
  *                        the primary domain.
  * \param[out] pid the ID of the particle.
+ * \param[in] ws the workspace to use for the search.
  * \return True if a particle was found. If the container has no particles,
  * then the search will not find a Voronoi cell and false is returned. */
-bool container_poly::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
-	int ai,aj,ak,ci,cj,ck,ijk;
+bool container_poly::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const {
+	int ijk,l,ai,aj,ak;
+	if(!find_owner(ws,x,y,z,ijk,l,ai,aj,ak)) return false;
+	rx=p[ijk][4*l]+ai*(bx-ax);
+	ry=p[ijk][4*l+1]+aj*(by-ay);
+	rz=p[ijk][4*l+2]+ak*(bz-az);
+	pid=id[ijk][l];
+	return true;
+}
+
+/** Takes a vector and finds the block and slot of the particle whose Voronoi
+ * cell contains it, and the periodic image of the particle.
+ * \param[in] ws the workspace to use for the search.
+ * \param[in] (x,y,z) the vector to test.
+ * \param[out] (ijk,l) the block and slot of the particle.
+ * \param[out] (ai,aj,ak) the periodic image of the particle that is closest
+ *                        to the vector.
+ * \return True if a particle was found, false otherwise. */
+bool container_poly::find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const {
+	int ci,cj,ck;
 	particle_record w;
 	double mrs;
 
 	// If the given vector lies outside the domain, but the container
 	// is periodic, then remap it back into the domain
 	if(!remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk)) return false;
-	vc.find_voronoi_cell(x,y,z,ci,cj,ck,ijk,w,mrs);
-
-	if(w.ijk!=-1) {
-
-		// Assemble the position vector of the particle to be returned,
-		// applying a periodic remapping if necessary
-		if(xperiodic) {ci+=w.di;if(ci<0||ci>=nx) ai+=step_div(ci,nx);}
-		if(yperiodic) {cj+=w.dj;if(cj<0||cj>=ny) aj+=step_div(cj,ny);}
-		if(zperiodic) {ck+=w.dk;if(ck<0||ck>=nz) ak+=step_div(ck,nz);}
-		rx=p[w.ijk][4*w.l]+ai*(bx-ax);
-		ry=p[w.ijk][4*w.l+1]+aj*(by-ay);
-		rz=p[w.ijk][4*w.l+2]+ak*(bz-az);
-		pid=id[w.ijk][w.l];
-		return true;
-	}
+	vc.find_voronoi_cell(ws,x,y,z,ci,cj,ck,ijk,w,mrs);
 
 	// If no particle if found then just return false
-	return false;
+	if(w.ijk==-1) return false;
+
+	// Find the periodic image of the particle
+	if(xperiodic) {ci+=w.di;if(ci<0||ci>=nx) ai+=step_div(ci,nx);}
+	if(yperiodic) {cj+=w.dj;if(cj<0||cj>=ny) aj+=step_div(cj,ny);}
+	if(zperiodic) {ck+=w.dk;if(ck<0||ck>=nz) ak+=step_div(ck,nz);}
+	ijk=w.ijk;l=w.l;
+	return true;
+}
+
+/** Finds the particles whose Voronoi cells contain a list of vectors. See
+ * voro_compute::find_voronoi_cells() for details.
+ * \param[in] n the number of vectors.
+ * \param[in] pos an array of 3*n floating point numbers holding the vectors.
+ * \param[out] pid an array of n integers in which to store the IDs of the
+ *                 particles, or -1 for vectors outside the container.
+ * \param[out] sh an array of 3*n integers in which to store the periodic image
+ *                of each particle that is closest to the vector, in units of
+ *                the container lengths, or NULL if this is not required. */
+void container_poly::find_voronoi_cells(int n,const double *pos,int *pid,int *sh) {
+	vc.find_voronoi_cells(n,pos,pid,sh);
 }
 
 /** Increase memory for a particular region.
  * \param[in] i the index of the region to reallocate. */
 void container_base::add_particle_memory(int i) {
-	int l,nmem=mem[i]<<1;
+	set_particle_memory(i,mem[i]<<1);
+}
+
+/** Sets the memory for a particular region to a given size, retaining the
+ * particles that are already stored in it.
+ * \param[in] i the index of the region to reallocate.
+ * \param[in] nmem the new memory size, which must be at least the number of
+ *                 particles currently in the region. */
+void container_base::set_particle_memory(int i,int nmem) {
+	int l;
 
 	// Carry out a check on the memory allocation size, and
 	// print a status message if requested
@@ -325,16 +546,303 @@ void container_base::add_particle_memory(int i) {
 	delete [] p[i];p[i]=pp;
 }
 
+/** Removes a particle from the container. The last particle in the same block
+ * is moved into its slot, so the order of the particles within the block
+ * changes, and any particle_order records of the block become invalid. The
+ * first call to this routine, or to the move() routines, builds an index from
+ * each particle ID to the block and slot that it is stored in, so that later
+ * calls take constant time. The particle IDs must be unique.
+ * \param[in] n the numerical ID of the particle to remove.
+ * \return True if the particle was removed, false if there was no particle
+ * with this ID. */
+bool container_base::remove(int n) {
+	int ijk,q;
+	if(!find_particle(n,ijk,q)) return false;
+	remove_slot(ijk,q);
+	return true;
+}
+
+/** Finds the block and slot that a particle is stored in, building the ID
+ * index if it is out of date.
+ * \param[in] n the numerical ID of the particle.
+ * \param[out] (ijk,q) the block and slot of the particle.
+ * \return True if the particle was found, false otherwise. */
+bool container_base::find_particle(int n,int &ijk,int &q) {
+	check_unfrozen();
+	if(!indexed) build_index();
+	if(n>=0&&n<max_index_size) {
+		if(n>=ixmem||ixb[n]<0) return false;
+		ijk=ixb[n];q=ixq[n];
+	} else {
+		std::map<int,std::pair<int,int> >::iterator it=ixs.find(n);
+		if(it==ixs.end()) return false;
+		ijk=it->second.first;q=it->second.second;
+	}
+	return true;
+}
+
+/** Removes the particle in a given slot by moving the last particle in the
+ * block into its place, and updates the ID index.
+ * \param[in] (ijk,q) the block and slot of the particle to remove. */
+void container_base::remove_slot(int ijk,int q) {
+	int n=id[ijk][q],l=--co[ijk];
+	if(q<l) {
+		int m=id[ijk][q]=id[ijk][l];
+		double *pp=p[ijk]+ps*q,*pe=pp+ps,*ql=p[ijk]+ps*l;
+		while(pp<pe) *(pp++)=*(ql++);
+		set_index(m,ijk,q);
+	}
+	clear_index(n);
+}
+
+/** Records the block and slot of a particle in the ID index. IDs from 0 up to
+ * max_index_size are stored in arrays, whose memory is increased if
+ * necessary. Other IDs, which would make the arrays too large, are stored in
+ * a map.
+ * \param[in] n the numerical ID of the particle.
+ * \param[in] (ijk,q) the block and slot of the particle. */
+void container_base::set_index(int n,int ijk,int q) {
+	if(n<0||n>=max_index_size) {
+		ixs[n]=std::pair<int,int>(ijk,q);
+		return;
+	}
+	if(n>=ixmem) {
+		int l,nmem=ixmem==0?init_index_size:ixmem;
+		while(nmem<=n) nmem<<=1;
+#if VOROPP_VERBOSE >=3
+		fprintf(stderr,"Particle index memory scaled up to %d\n",nmem);
+#endif
+		int *nb=new int[nmem],*nq=new int[nmem];
+		for(l=0;l<ixmem;l++) {nb[l]=ixb[l];nq[l]=ixq[l];}
+		for(;l<nmem;l++) nb[l]=-1;
+		delete [] ixq;delete [] ixb;
+		ixb=nb;ixq=nq;ixmem=nmem;
+	}
+	ixb[n]=ijk;ixq[n]=q;
+}
+
+/** Builds the index from each particle ID to the block and slot that it is
+ * stored in, by scanning all of the particles. */
+void container_base::build_index() {
+	int ijk,q;
+	for(q=0;q<ixmem;q++) ixb[q]=-1;
+	ixs.clear();
+	for(ijk=0;ijk<nxyz;ijk++) for(q=0;q<co[ijk];q++) set_index(id[ijk][q],ijk,q);
+	indexed=true;
+}
+
+/** Adds a list of particles to the container in two passes. In the first
+ * pass, the block that each particle belongs to is found, and the number of
+ * particles going into each block is counted. The memory for each block is
+ * then increased to exactly the required size, and in the second pass the
+ * particles are copied into place. This avoids the repeated reallocation that
+ * occurs when many particles are added one at a time. If a block already holds
+ * particles, then its memory is at least doubled, so that adding a long list
+ * in several calls, as the import() functions do, does not copy the earlier
+ * particles many times. If more than one thread has been requested using
+ * set_threads(), then both passes are carried out in parallel, with each
+ * thread handling a contiguous range of the input. The particles are stored
+ * in the same order as if they had been added sequentially using put().
+ * \param[in] n the number of particles.
+ * \param[in] pid an array of the particles' numerical IDs. If this is NULL,
+ *                then the particles are numbered from 0 to n-1.
+ * \param[in] pos an array of n*ps floating point numbers holding the position
+ *                (and radius, for the container_poly class) of each particle.
+ * \param[in] vo a pointer to an ordering class in which to record the regions
+ *               that the particles are stored in, or NULL if this is not
+ *               required. */
+void container_base::bulk_put(int n,const int *pid,const double *pos,particle_order *vo) {
+	check_unfrozen();
+	if(n<=0) return;
+	indexed=false;
+	int nt=nthreads<1?1:(nthreads>n?n:nthreads),ijk,t;
+	std::vector<int> blk(n),cnt(nt*nxyz,0);
+
+	// First pass: find the block for each particle and count the number
+	// of particles that each thread will place in each block
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		int i,lijk,lt=block_scheduler::thread_num(),*cp=&cnt[lt*nxyz],
+		    ia=bulk_bound(n,lt,nt),ib=bulk_bound(n,lt+1,nt);
+		double x,y,z;
+		for(i=ia;i<ib;i++) {
+			x=pos[ps*i];y=pos[ps*i+1];z=pos[ps*i+2];
+			if(put_remap(lijk,x,y,z)) {blk[i]=lijk;cp[lijk]++;}
+			else {
+				blk[i]=-1;
+#if VOROPP_REPORT_OUT_OF_BOUNDS ==1
+				fprintf(stderr,"Out of bounds: (x,y,z)=(%g,%g,%g)\n",x,y,z);
+#endif
+			}
+		}
+	}
+
+	// Convert the counts into the position in each block where each thread
+	// starts writing, and allocate exactly enough memory for each block
+	for(ijk=0;ijk<nxyz;ijk++) {
+		int s=co[ijk],c;
+		for(t=0;t<nt;t++) {c=cnt[t*nxyz+ijk];cnt[t*nxyz+ijk]=s;s+=c;}
+		if(s>mem[ijk]) set_particle_memory(ijk,co[ijk]>0&&s<(mem[ijk]<<1)?mem[ijk]<<1:s);
+		co[ijk]=s;
+	}
+
+	// Second pass: copy the particles into place, overwriting the block
+	// index with the particle's position within the block
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		int i,l,q,lijk,lt=block_scheduler::thread_num(),*cp=&cnt[lt*nxyz],
+		    ia=bulk_bound(n,lt,nt),ib=bulk_bound(n,lt+1,nt);
+		double x,y,z,*pp;
+		for(i=ia;i<ib;i++) if(blk[i]>=0) {
+			x=pos[ps*i];y=pos[ps*i+1];z=pos[ps*i+2];
+			put_remap(lijk,x,y,z);
+			q=cp[lijk]++;
+			id[lijk][q]=pid==NULL?i:pid[i];
+			pp=p[lijk]+ps*q;
+			*pp=x;pp[1]=y;pp[2]=z;
+			for(l=3;l<ps;l++) pp[l]=pos[ps*i+l];
+			blk[i]=q;
+		}
+	}
+
+	// Record the particle positions in the ordering class, in the order
+	// that they were supplied
+	if(vo!=NULL) for(int i=0;i<n;i++) if(blk[i]>=0) {
+		double x=pos[ps*i],y=pos[ps*i+1],z=pos[ps*i+2];
+		put_remap(ijk,x,y,z);
+		vo->add(ijk,blk[i]);
+	}
+}
+
+/** Reorders the particle memory according to a space-filling curve. The
+ * memory for the blocks is first reallocated in the order that the blocks are
+ * visited by the c_loop_curve class, so that blocks that are close together
+ * on the curve tend to be close together in memory. The particles within each
+ * block are then sorted according to their position along the same curve. If
+ * more than one thread has been requested using set_threads(), the blocks are
+ * sorted in parallel. The particle IDs are moved with the particles, so the
+ * computed cells are unchanged, but any particle_order classes that refer to
+ * this container become invalid. The old memory is freed only after the new
+ * memory has been filled, so the memory usage temporarily doubles.
+ * \param[in] ct the space-filling curve to use. */
+void container_base::sort_particles(c_loop_curve_type ct) {
+	check_unfrozen();
+	int l,b,**nid=new int*[nxyz];
+	double **np=new double*[nxyz];
+
+	// Allocate the new memory in the order of the curve
+	c_loop_curve vl(*this,ct);
+	for(l=0;l<nxyz;l++) {
+		b=vl.bl[l];
+		nid[b]=new int[mem[b]];
+		np[b]=new double[ps*mem[b]];
+	}
+
+	// Sort the particles in each block into the new memory
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic,16)
+#endif
+	for(int ijk=0;ijk<nxyz;ijk++) sort_block(ijk,ct,nid[ijk],np[ijk]);
+
+	// Free the old memory and switch to the new memory
+	for(b=0;b<nxyz;b++) {
+		delete [] id[b];id[b]=nid[b];
+		delete [] p[b];p[b]=np[b];
+	}
+	delete [] np;
+	delete [] nid;
+	indexed=false;
+}
+
+/** Packs all of the particles into two contiguous arrays, one for the IDs and
+ * one for the positions (and radii), in block order, and frees the separate
+ * memory of each block. The blocks are usually larger than they need to be,
+ * since their memory is doubled as particles are added, and packing them
+ * removes this slack and the overhead of the separate allocations. The
+ * particles of neighboring blocks are then close together in memory, which
+ * helps the cell computations. The id and p pointers of each block are set to
+ * point into the packed arrays, so that all of the routines that read the
+ * particles work unchanged. A frozen container is immutable: any later call
+ * that adds, moves, removes, or rearranges particles causes a fatal error.
+ * Calling this routine on a frozen container has no effect. */
+void container_base::freeze() {
+	if(bo!=NULL) return;
+	int l,k,n;
+
+	// Compute the offsets of the blocks in the packed arrays
+	bo=new int[nxyz+1];
+	*bo=0;
+	for(l=0;l<nxyz;l++) bo[l+1]=bo[l]+co[l];
+	n=bo[nxyz];
+
+	// Copy the particles into the packed arrays, freeing the memory of
+	// each block once it has been copied
+	int *idp=new int[n>0?n:1],*ip;
+	double *pp=new double[n>0?ps*n:1],*qp;
+	for(l=0;l<nxyz;l++) {
+		ip=idp+bo[l];qp=pp+ps*bo[l];
+		for(k=0;k<co[l];k++) ip[k]=id[l][k];
+		for(k=0;k<ps*co[l];k++) qp[k]=p[l][k];
+		delete [] id[l];id[l]=ip;
+		delete [] p[l];p[l]=qp;
+		mem[l]=co[l];
+	}
+
+	// The ID index is only needed for removing and moving particles, so
+	// it can be freed
+	delete [] ixq;ixq=NULL;
+	delete [] ixb;ixb=NULL;
+	ixs.clear();
+	ixmem=0;indexed=false;
+}
+
+/** Computes the memory used to store the particles, including the spare
+ * memory in each block and the per-block arrays. The ID index that is used
+ * for removing and moving particles is not included.
+ * \return The number of bytes. */
+size_t container_base::particle_memory() {
+	size_t n=0,b=static_cast<size_t>(nxyz)*(sizeof(int*)+sizeof(double*)+2*sizeof(int));
+	if(bo!=NULL) return b+sizeof(int)*(nxyz+1)+(sizeof(int)+ps*sizeof(double))*bo[nxyz];
+	for(int l=0;l<nxyz;l++) n+=mem[l];
+	return b+(sizeof(int)+ps*sizeof(double))*n;
+}
+
+/** Sorts the particles in a block according to their position along a
+ * space-filling curve, relative to the block.
+ * \param[in] ijk the block to sort.
+ * \param[in] ct the space-filling curve to use.
+ * \param[out] idn the array in which to store the sorted particle IDs.
+ * \param[out] pn the array in which to store the sorted particle positions
+ *                (and radii). */
+void container_base::sort_block(int ijk,c_loop_curve_type ct,int *idn,double *pn) {
+	int l,m,q,n=co[ijk],k=ijk/nxy,j=(ijk-k*nxy)/nx,i=ijk-k*nxy-j*nx;
+	double *pp=p[ijk];
+	std::vector<std::pair<unsigned int,int> > ke(n);
+	for(l=0;l<n;l++,pp+=ps)
+		ke[l]=std::make_pair(curve_key(ct,curve_coord((*pp-ax)*xsp-i),
+			curve_coord((pp[1]-ay)*ysp-j),curve_coord((pp[2]-az)*zsp-k),10),l);
+	std::sort(ke.begin(),ke.end());
+	for(l=0;l<n;l++) {
+		q=ke[l].second;
+		idn[l]=id[ijk][q];
+		for(m=0;m<ps;m++) pn[ps*l+m]=p[ijk][ps*q+m];
+	}
+}
+
 /** Import a list of particles from an open file stream into the container.
  * Entries of four numbers (Particle ID, x position, y position, z position)
- * are searched for. If the file cannot be successfully read, then the routine
- * causes a fatal error.
+ * are searched for. The file is read in large buffers that are parsed with
+ * several threads by the text_importer class, and the particles are added with
+ * put_bulk(). If the file cannot be successfully read, then the routine causes
+ * a fatal error.
  * \param[in] fp the file handle to read from. */
 void container::import(FILE *fp) {
-	int i,j;
-	double x,y,z;
-	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(i,x,y,z);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,4,nthreads);
+	while(ti.next()) put_bulk(ti.n,&ti.id[0],&ti.pos[0]);
 }
 
 /** Import a list of particles from an open file stream, also storing the order
@@ -344,22 +852,20 @@ void container::import(FILE *fp) {
  * \param[in,out] vo a reference to an ordering class to use.
  * \param[in] fp the file handle to read from. */
 void container::import(particle_order &vo,FILE *fp) {
-	int i,j;
-	double x,y,z;
-	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(vo,i,x,y,z);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,4,nthreads);
+	while(ti.next()) put_bulk(vo,ti.n,&ti.id[0],&ti.pos[0]);
 }
 
 /** Import a list of particles from an open file stream into the container.
  * Entries of five numbers (Particle ID, x position, y position, z position,
- * radius) are searched for. If the file cannot be successfully read, then the
- * routine causes a fatal error.
+ * radius) are searched for. The file is read in large buffers that are parsed
+ * with several threads by the text_importer class, and the particles are added
+ * with put_bulk(). If the file cannot be successfully read, then the routine
+ * causes a fatal error.
  * \param[in] fp the file handle to read from. */
 void container_poly::import(FILE *fp) {
-	int i,j;
-	double x,y,z,r;
-	while((j=fscanf(fp,"%d %lg %lg %lg %lg",&i,&x,&y,&z,&r))==5) put(i,x,y,z,r);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,5,nthreads);
+	while(ti.next()) put_bulk(ti.n,&ti.id[0],&ti.pos[0]);
 }
 
 /** Import a list of particles from an open file stream, also storing the order
@@ -369,10 +875,52 @@ void container_poly::import(FILE *fp) {
  * \param[in,out] vo a reference to an ordering class to use.
  * \param[in] fp the file handle to read from. */
 void container_poly::import(particle_order &vo,FILE *fp) {
-	int i,j;
-	double x,y,z,r;
-	while((j=fscanf(fp,"%d %lg %lg %lg %lg",&i,&x,&y,&z,&r))==5) put(vo,i,x,y,z,r);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,5,nthreads);
+	while(ti.next()) put_bulk(vo,ti.n,&ti.id[0],&ti.pos[0]);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * which is described in the particle_file class. The file is mapped into
+ * memory, and the particles are added with put_bulk() without any parsing. If
+ * the file cannot be read, or it contains radii, then the routine causes a fatal
+ * error.
+ * \param[in] filename the name of the file to read from. */
+void container::import_binary(const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(false,filename);
+	put_bulk(pf.n,pf.id,pf.pos);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * also storing the order in which the particles are read.
+ * \param[in,out] vo the ordering class to use.
+ * \param[in] filename the name of the file to read from. */
+void container::import_binary(particle_order &vo,const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(false,filename);
+	put_bulk(vo,pf.n,pf.id,pf.pos);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * which is described in the particle_file class. The file is mapped into
+ * memory, and the particles are added with put_bulk() without any parsing. If
+ * the file cannot be read, or it does not contain radii, then the routine
+ * causes a fatal error.
+ * \param[in] filename the name of the file to read from. */
+void container_poly::import_binary(const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(true,filename);
+	put_bulk(pf.n,pf.id,pf.pos);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * also storing the order in which the particles are read.
+ * \param[in,out] vo the ordering class to use.
+ * \param[in] filename the name of the file to read from. */
+void container_poly::import_binary(particle_order &vo,const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(true,filename);
+	put_bulk(vo,pf.n,pf.id,pf.pos);
 }
 
 /** Outputs the a list of all the container regions along with the number of
@@ -385,14 +933,18 @@ void container_base::region_count() {
 
 /** Clears a container of particles. */
 void container::clear() {
+	check_unfrozen();
 	for(int *cop=co;cop<co+nxyz;cop++) *cop=0;
+	indexed=false;
 }
 
 /** Clears a container of particles, also clearing resetting the maximum radius
  * to zero. */
 void container_poly::clear() {
+	check_unfrozen();
 	for(int *cop=co;cop<co+nxyz;cop++) *cop=0;
 	max_radius=0;
+	indexed=false;
 }
 
 /** Computes all the Voronoi cells and saves customized information about them.
@@ -431,15 +983,71 @@ void container_poly::print_custom(const char *format,const char *filename) {
 	fclose(fp);
 }
 
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all vl(*this);
+	print_columns(vl,cw);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_poly::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all vl(*this);
+	print_columns(vl,cw);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] fp a file handle to write to. */
+void container::print_face_graph(FILE *fp) {
+	c_loop_all vl(*this);
+	print_face_graph(vl,fp);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] filename the name of the file to write to. */
+void container::print_face_graph(const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_face_graph(fp);
+	fclose(fp);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] fp a file handle to write to. */
+void container_poly::print_face_graph(FILE *fp) {
+	c_loop_all vl(*this);
+	print_face_graph(vl,fp);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] filename the name of the file to write to. */
+void container_poly::print_face_graph(const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_face_graph(fp);
+	fclose(fp);
+}
+
 /** Computes all of the Voronoi cells in the container, but does nothing
  * with the output. It is useful for measuring the pure computation time
  * of the Voronoi algorithm, without any additional calculations such as
  * volume evaluation or cell output. */
 void container::compute_all_cells() {
-	voronoicell c(*this);
 	c_loop_all vl(*this);
-	if(vl.start()) do compute_cell(c,vl);
-	while(vl.inc());
+	compute_all_cells(vl);
 }
 
 /** Computes all of the Voronoi cells in the container, but does nothing
@@ -447,9 +1055,8 @@ void container::compute_all_cells() {
  * of the Voronoi algorithm, without any additional calculations such as
  * volume evaluation or cell output. */
 void container_poly::compute_all_cells() {
-	voronoicell c(*this);
 	c_loop_all vl(*this);
-	if(vl.start()) do compute_cell(c,vl);while(vl.inc());
+	compute_all_cells(vl);
 }
 
 /** Calculates all of the Voronoi cells and sums their volumes. In most cases
@@ -457,11 +1064,8 @@ void container_poly::compute_all_cells() {
  * of the container to numerical precision.
  * \return The sum of all of the computed Voronoi volumes. */
 double container::sum_cell_volumes() {
-	voronoicell c(*this);
-	double vol=0;
 	c_loop_all vl(*this);
-	if(vl.start()) do if(compute_cell(c,vl)) vol+=c.volume();while(vl.inc());
-	return vol;
+	return sum_cell_volumes(vl);
 }
 
 /** Calculates all of the Voronoi cells and sums their volumes. In most cases
@@ -469,11 +1073,8 @@ double container::sum_cell_volumes() {
  * of the container to numerical precision.
  * \return The sum of all of the computed Voronoi volumes. */
 double container_poly::sum_cell_volumes() {
-	voronoicell c(*this);
-	double vol=0;
 	c_loop_all vl(*this);
-	if(vl.start()) do if(compute_cell(c,vl)) vol+=c.volume();while(vl.inc());
-	return vol;
+	return sum_cell_volumes(vl);
 }
 
 /** This function tests to see if a given vector lies within the container
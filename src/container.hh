@@ -12,6 +12,8 @@
 
 #include <cstdio>
 #include <vector>
+#include <map>
+#include <utility>
 
 #include "config.hh"
 #include "common.hh"
@@ -20,6 +22,8 @@
 #include "c_loops.hh"
 #include "v_compute.hh"
 #include "rad_option.hh"
+#include "cell_ops.hh"
+#include "column_output.hh"
 
 namespace voro {
 
@@ -161,6 +165,13 @@ class container_base : public voro_base, public wall_list {
 		 * class container_poly, then this is set to 4, to also hold
 		 * the particle radii. */
 		const int ps;
+		/** The offsets of the blocks into the packed particle arrays,
+		 * with an extra entry for the end of the last block, or NULL
+		 * if the container has not been frozen. Once the container is
+		 * frozen, id[0] and p[0] point to single arrays that hold all
+		 * of the particles in block order, and block ijk starts at
+		 * entry bo[ijk]. */
+		int *bo;
 		container_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
 				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,
 				int init_mem,int ps_);
@@ -177,7 +188,7 @@ class container_base : public voro_base, public wall_list {
 		 * that have been added are then applied to the cell.
 		 * \param[in,out] c a reference to a voronoicell object.
 		 * \param[in] ijk the block that the particle is within.
-		 * \param[in] q the index of the particle within its block.
+		 * \param[in] pp a pointer to the position of the particle.
 		 * \param[in] (ci,cj,ck) the coordinates of the block in the
 		 * 			 container coordinate system.
 		 * \param[out] (i,j,k) the coordinates of the test block
@@ -189,9 +200,9 @@ class container_base : public voro_base, public wall_list {
 		 * \return False if the plane cuts applied by walls completely
 		 * removed the cell, true otherwise. */
 		template<class v_cell>
-		inline bool initialize_voronoicell(v_cell &c,int ijk,int q,int ci,int cj,int ck,
+		inline bool initialize_voronoicell(v_cell &c,int ijk,double *pp,int ci,int cj,int ck,
 				int &i,int &j,int &k,double &x,double &y,double &z,int &disp) {
-			double x1,x2,y1,y2,z1,z2,*pp=p[ijk]+ps*q;
+			double x1,x2,y1,y2,z1,z2;
 			x=*(pp++);y=*(pp++);z=*pp;
 			if(xperiodic) {x1=-(x2=0.5*(bx-ax));i=nx;} else {x1=ax-x;x2=bx-x;i=ci;}
 			if(yperiodic) {y1=-(y2=0.5*(by-ay));j=ny;} else {y1=ay-y;y2=by-y;j=cj;}
@@ -230,6 +241,13 @@ class container_base : public voro_base, public wall_list {
 			fy=y-ay-boxy*cj;
 			fz=z-az-boxz*ck;
 		}
+		/** Returns a pointer to the position of a particle, which is
+		 * used by the voro_compute template to read the particles of
+		 * a block.
+		 * \param[in] (ijk,q) the block and the index of the particle
+		 *                    within it.
+		 * \return The pointer. */
+		inline double* particle_pos(int ijk,int q) {return p[ijk]+ps*q;}
 		/** Calculates the index of block in the container structure
 		 * corresponding to given coordinates.
 		 * \param[in] (ci,cj,ck) the coordinates of the original block
@@ -272,11 +290,81 @@ class container_base : public voro_base, public wall_list {
 			for(int *cop=co+1;cop<co+nxyz;cop++) tp+=*cop;
 			return tp;
 		}
+		void sort_particles(c_loop_curve_type ct=curve_hilbert);
+		bool remove(int n);
+		void freeze();
+		/** Returns whether the container has been frozen.
+		 * \return True if it is frozen, false otherwise. */
+		inline bool frozen() {return bo!=NULL;}
+		size_t particle_memory();
 	protected:
+		/** Causes a fatal error if the container has been frozen. This
+		 * is called by all of the routines that add, remove, or
+		 * rearrange particles. */
+		inline void check_unfrozen() {
+			if(bo!=NULL) voro_fatal_error("Particles cannot be changed in a frozen container",VOROPP_INTERNAL_ERROR);
+		}
 		void add_particle_memory(int i);
+		void set_particle_memory(int i,int nmem);
+		bool find_particle(int n,int &ijk,int &q);
+		void remove_slot(int ijk,int q);
+		void set_index(int n,int ijk,int q);
+		/** Records the block and slot of a particle that has just been
+		 * stored, if the ID index is in use.
+		 * \param[in] n the numerical ID of the particle.
+		 * \param[in] (ijk,q) the block and slot of the particle. */
+		inline void index_add(int n,int ijk,int q) {
+			if(indexed) set_index(n,ijk,q);
+		}
+		void bulk_put(int n,const int *pid,const double *pos,particle_order *vo);
+		/** Computes the start of the range of input particles that a
+		 * thread handles in bulk_put().
+		 * \param[in] n the total number of particles.
+		 * \param[in] t the thread number.
+		 * \param[in] nt the total number of threads.
+		 * \return The index of the first particle in the range. */
+		static inline int bulk_bound(int n,int t,int nt) {
+			return static_cast<int>((static_cast<double>(n)*t)/nt);
+		}
 		bool put_locate_block(int &ijk,double &x,double &y,double &z);
+		bool locate_block(int &ijk,int &ci,int &cj,int &ck,double &x,double &y,double &z) const;
+		int query_block(double x,double y,double z) const;
 		inline bool put_remap(int &ijk,double &x,double &y,double &z);
-		inline bool remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk);
+		inline bool remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk) const;
+		/** Whether the ID index is up to date. The index is built
+		 * the first time that a particle is removed or moved, and is
+		 * then kept up to date as particles are added. Routines that
+		 * rearrange all of the particles mark it as out of date. */
+		bool indexed;
+	private:
+		/** The number of IDs that the index has memory for. */
+		int ixmem;
+		/** The block that each particle ID is stored in, or -1 if
+		 * there is no particle with that ID. */
+		int *ixb;
+		/** The slot within its block that each particle ID is stored
+		 * in. */
+		int *ixq;
+		/** The block and slot of each particle whose ID is negative,
+		 * or too large to be stored in the ixb and ixq arrays. */
+		std::map<int,std::pair<int,int> > ixs;
+		/** Removes a particle ID from the index.
+		 * \param[in] n the numerical ID of the particle. */
+		inline void clear_index(int n) {
+			if(n>=0&&n<max_index_size) ixb[n]=-1;
+			else ixs.erase(n);
+		}
+		void build_index();
+		void sort_block(int ijk,c_loop_curve_type ct,int *idn,double *pn);
+		/** Converts a fractional position within a block into an
+		 * integer coordinate for the space-filling curve.
+		 * \param[in] f the fractional position, which should be
+		 *              between 0 and 1.
+		 * \return The integer coordinate, between 0 and 1023. */
+		static inline unsigned int curve_coord(double f) {
+			int c=int(f*1024);
+			return c<0?0:(c>1023?1023:c);
+		}
 };
 
 /** \brief Extension of the container_base class for computing regular Voronoi
@@ -292,6 +380,9 @@ class container : public container_base, public radius_mono {
 		void clear();
 		void put(int n,double x,double y,double z);
 		void put(particle_order &vo,int n,double x,double y,double z);
+		void put_bulk(int n,const int *pid,const double *pos);
+		void put_bulk(particle_order &vo,int n,const int *pid,const double *pos);
+		bool move(int n,double x,double y,double z);
 		void import(FILE *fp=stdin);
 		void import(particle_order &vo,FILE *fp=stdin);
 		/** Imports a list of particles from an open file stream into
@@ -320,8 +411,35 @@ class container : public container_base, public radius_mono {
 			import(vo,fp);
 			fclose(fp);
 		}
+		void import_binary(const char *filename);
+		void import_binary(particle_order &vo,const char *filename);
 		void compute_all_cells();
 		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler,
+		 * and each thread uses its own compute_workspace and Voronoi
+		 * cell.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+			return op.vol;
+		}
 		/** Dumps particle IDs and positions to a file.
 		 * \param[in] vl the loop class to use.
 		 * \param[in] fp a file handle to write to. */
@@ -433,24 +551,56 @@ class container : public container_base, public radius_mono {
 		 * \param[in] fp a file handle to write to. */
 		template<class c_loop>
 		void print_custom(c_loop &vl,const char *format,FILE *fp) {
-			int ijk,q;double *pp;
-			if(contains_neighbor(format)) {
-				voronoicell_neighbor c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],default_radius,fp);
-				} while(vl.inc());
-			} else {
-				voronoicell c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],default_radius,fp);
-				} while(vl.inc());
-			}
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
 		}
 		void print_custom(const char *format,FILE *fp=stdout);
 		void print_custom(const char *format,const char *filename);
-		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cells and saves the faces between
+		 * pairs of particles as an edge list. Each face is evaluated
+		 * once, by the cell of the particle with the lower ID, and a
+		 * line is printed containing the two IDs, the face area, the
+		 * unit normal pointing from the first particle to the second,
+		 * and the face centroid. Faces against walls are omitted.
+		 * If more than one thread has been requested, then the output
+		 * of each task of the block scheduler is formatted by an
+		 * ordered_writer, and the output is the same as for a serial
+		 * computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_face_graph(c_loop &vl,FILE *fp) {
+			cell_op_face_graph op(fp);
+			voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+		}
+		void print_face_graph(FILE *fp=stdout);
+		void print_face_graph(const char *filename);
+		/** Takes a vector and finds the particle whose Voronoi cell
+		 * contains that vector, using the container's own workspace.
+		 * See the version of this routine that takes a workspace for
+		 * details. */
+		inline bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
+			return find_voronoi_cell(x,y,z,rx,ry,rz,pid,vc.work);
+		}
+		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const;
+		void find_voronoi_cells(int n,const double *pos,int *pid,int *sh=NULL);
 		/** Computes the Voronoi cell for a particle currently being
 		 * referenced by a loop class.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -461,7 +611,22 @@ class container : public container_base, public radius_mono {
 		 * condition, then the routine returns false. */
 		template<class v_cell,class c_loop>
 		inline bool compute_cell(v_cell &c,c_loop &vl) {
-			return vc.compute_cell(c,vl.ijk,vl.q,vl.i,vl.j,vl.k);
+			return compute_cell(c,vl,vc.work);
+		}
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class, using a given workspace. The
+		 * container is not modified, so several threads can call this
+		 * routine at once if each has its own workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl,compute_workspace &ws) const {
+			return vc.compute_cell(c,ws,vl.ijk,vl.q,vl.i,vl.j,vl.k,p[vl.ijk]+ps*vl.q);
 		}
 		/** Computes the Voronoi cell for given particle.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -473,8 +638,22 @@ class container : public container_base, public radius_mono {
 		 * condition, then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			return compute_cell(c,ijk,q,vc.work);
+		}
+		/** Computes the Voronoi cell for given particle, using a given
+		 * workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,compute_workspace &ws) const {
 			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
-			return vc.compute_cell(c,ijk,q,i,j,k);
+			return vc.compute_cell(c,ws,ijk,q,i,j,k,p[ijk]+ps*q);
 		}
 		/** Computes the Voronoi cell for a ghost particle at a given
 		 * location.
@@ -486,18 +665,29 @@ class container : public container_base, public radius_mono {
 		 * condition, then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z) {
-			int ijk;
-			if(put_locate_block(ijk,x,y,z)) {
-				double *pp=p[ijk]+3*co[ijk]++;
-				*(pp++)=x;*(pp++)=y;*pp=z;
-				bool q=compute_cell(c,ijk,co[ijk]-1);
-				co[ijk]--;
-				return q;
-			}
-			return false;
+			return compute_ghost_cell(c,x,y,z,vc.work);
+		}
+		/** Computes the Voronoi cell for a ghost particle at a given
+		 * location, using a given workspace. The ghost particle is not
+		 * added to the container, so several threads can call this
+		 * routine at once if each has its own workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] (x,y,z) the location of the ghost particle.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z,compute_workspace &ws) const {
+			int ijk,ci,cj,ck;
+			if(!locate_block(ijk,ci,cj,ck,x,y,z)) return false;
+			double pp[3]={x,y,z};
+			return vc.compute_cell(c,ws,ijk,co[ijk],ci,cj,ck,pp);
 		}
 	private:
 		voro_compute<container> vc;
+		bool find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const;
 		friend class voro_compute<container>;
 };
 
@@ -514,6 +704,10 @@ class container_poly : public container_base, public radius_poly {
 		void clear();
 		void put(int n,double x,double y,double z,double r);
 		void put(particle_order &vo,int n,double x,double y,double z,double r);
+		void put_bulk(int n,const int *pid,const double *pos);
+		void put_bulk(particle_order &vo,int n,const int *pid,const double *pos);
+		bool move(int n,double x,double y,double z);
+		bool move(int n,double x,double y,double z,double r);
 		void import(FILE *fp=stdin);
 		void import(particle_order &vo,FILE *fp=stdin);
 		/** Imports a list of particles from an open file stream into
@@ -542,8 +736,35 @@ class container_poly : public container_base, public radius_poly {
 			import(vo,fp);
 			fclose(fp);
 		}
+		void import_binary(const char *filename);
+		void import_binary(particle_order &vo,const char *filename);
 		void compute_all_cells();
 		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler,
+		 * and each thread uses its own compute_workspace and Voronoi
+		 * cell.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+			return op.vol;
+		}
 		/** Dumps particle IDs, positions and radii to a file.
 		 * \param[in] vl the loop class to use.
 		 * \param[in] fp a file handle to write to. */
@@ -657,20 +878,10 @@ class container_poly : public container_base, public radius_poly {
 		 * \param[in] fp a file handle to write to. */
 		template<class c_loop>
 		void print_custom(c_loop &vl,const char *format,FILE *fp) {
-			int ijk,q;double *pp;
-			if(contains_neighbor(format)) {
-				voronoicell_neighbor c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],pp[3],fp);
-				} while(vl.inc());
-			} else {
-				voronoicell c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],pp[3],fp);
-				} while(vl.inc());
-			}
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
 		}
 		/** Computes the Voronoi cell for a particle currently being
 		 * referenced by a loop class.
@@ -682,7 +893,22 @@ class container_poly : public container_base, public radius_poly {
 		 * condition, then the routine returns false. */
 		template<class v_cell,class c_loop>
 		inline bool compute_cell(v_cell &c,c_loop &vl) {
-			return vc.compute_cell(c,vl.ijk,vl.q,vl.i,vl.j,vl.k);
+			return compute_cell(c,vl,vc.work);
+		}
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class, using a given workspace. The
+		 * container is not modified, so several threads can call this
+		 * routine at once if each has its own workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl,compute_workspace &ws) const {
+			return vc.compute_cell(c,ws,vl.ijk,vl.q,vl.i,vl.j,vl.k,p[vl.ijk]+ps*vl.q);
 		}
 		/** Computes the Voronoi cell for given particle.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -694,8 +920,22 @@ class container_poly : public container_base, public radius_poly {
 		 * condition, then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			return compute_cell(c,ijk,q,vc.work);
+		}
+		/** Computes the Voronoi cell for given particle, using a given
+		 * workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,compute_workspace &ws) const {
 			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
-			return vc.compute_cell(c,ijk,q,i,j,k);
+			return vc.compute_cell(c,ws,ijk,q,i,j,k,p[ijk]+ps*q);
 		}
 		/** Computes the Voronoi cell for a ghost particle at a given
 		 * location.
@@ -708,22 +948,76 @@ class container_poly : public container_base, public radius_poly {
 		 * condition, then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z,double r) {
-			int ijk;
-			if(put_locate_block(ijk,x,y,z)) {
-				double *pp=p[ijk]+4*co[ijk]++,tm=max_radius;
-				*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
-				if(r>max_radius) max_radius=r;
-				bool q=compute_cell(c,ijk,co[ijk]-1);
-				co[ijk]--;max_radius=tm;
-				return q;
-			}
-			return false;
+			return compute_ghost_cell(c,x,y,z,r,vc.work);
+		}
+		/** Computes the Voronoi cell for a ghost particle at a given
+		 * location, using a given workspace. The ghost particle is not
+		 * added to the container, so several threads can call this
+		 * routine at once if each has its own workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] (x,y,z) the location of the ghost particle.
+		 * \param[in] r the radius of the ghost particle.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z,double r,compute_workspace &ws) const {
+			int ijk,ci,cj,ck;
+			if(!locate_block(ijk,ci,cj,ck,x,y,z)) return false;
+			double pp[4]={x,y,z,r};
+			return vc.compute_cell(c,ws,ijk,co[ijk],ci,cj,ck,pp);
 		}
 		void print_custom(const char *format,FILE *fp=stdout);
 		void print_custom(const char *format,const char *filename);
-		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cells and saves the faces between
+		 * pairs of particles as an edge list. Each face is evaluated
+		 * once, by the cell of the particle with the lower ID, and a
+		 * line is printed containing the two IDs, the face area, the
+		 * unit normal pointing from the first particle to the second,
+		 * and the face centroid. Faces against walls are omitted.
+		 * If more than one thread has been requested, then the output
+		 * of each task of the block scheduler is formatted by an
+		 * ordered_writer, and the output is the same as for a serial
+		 * computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_face_graph(c_loop &vl,FILE *fp) {
+			cell_op_face_graph op(fp);
+			voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+		}
+		void print_face_graph(FILE *fp=stdout);
+		void print_face_graph(const char *filename);
+		/** Takes a vector and finds the particle whose Voronoi cell
+		 * contains that vector, using the container's own workspace.
+		 * See the version of this routine that takes a workspace for
+		 * details. */
+		inline bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
+			return find_voronoi_cell(x,y,z,rx,ry,rz,pid,vc.work);
+		}
+		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const;
+		void find_voronoi_cells(int n,const double *pos,int *pid,int *sh=NULL);
 	private:
 		voro_compute<container_poly> vc;
+		bool find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const;
+		void update_max_radius();
 		friend class voro_compute<container_poly>;
 };
 
@@ -0,0 +1,430 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file container_oct.cc
+ * \brief Function implementations for the octree container classes. */
+
+#include "container_oct.hh"
+#include "text_import.hh"
+
+namespace voro {
+
+/** The class constructor sets up a node with a given box and no children.
+ * \param[in] (xl,xh) the minimum and maximum x coordinates of the box.
+ * \param[in] (yl,yh) the minimum and maximum y coordinates of the box.
+ * \param[in] (zl,zh) the minimum and maximum z coordinates of the box.
+ * \param[in] depth_ the depth of the node.
+ * \param[in] l_ the index of the block of particles for the node. */
+octree::octree(double xl,double xh,double yl,double yh,double zl,double zh,int depth_,int l_)
+	: depth(depth_), l(l_) {
+	*lo=xl;lo[1]=yl;lo[2]=zl;
+	*hi=xh;hi[1]=yh;hi[2]=zh;
+	for(int k=0;k<8;k++) ch[k]=NULL;
+}
+
+/** The class destructor frees the children of the node. */
+octree::~octree() {
+	for(int k=0;k<8;k++) delete ch[k];
+}
+
+/** The class constructor sets up the geometry of the container, with a single
+ * leaf that covers the whole box.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] lmax_ the maximum number of particles in a leaf.
+ * \param[in] ps_ the number of floating point entries to store for each
+ *                particle. */
+container_octree_base::container_octree_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+		int lmax_,int ps_)
+	: ax(ax_), bx(bx_), ay(ay_), by(by_), az(az_), bz(bz_),
+	max_len_sq((bx-ax)*(bx-ax)+(by-ay)*(by-ay)+(bz-az)*(bz-az)),
+	lmax(lmax_), nx(1), ny(1), nz(1), nxy(1), nxyz(1), id(new int*[8]),
+	p(new double*[8]), co(new int[8]), mem(new int[8]), ps(ps_), nthreads(1),
+	root(new octree(ax_,bx_,ay_,by_,az_,bz_,0,0)), lmem(8), linked(false) {
+	if(lmax<1) voro_fatal_error("The leaf capacity must be at least one",VOROPP_INTERNAL_ERROR);
+	*co=0;*mem=lmax;
+	*id=new int[lmax];
+	*p=new double[ps*lmax];
+	lf.push_back(root);
+}
+
+/** The container destructor frees the dynamically allocated memory. */
+container_octree_base::~container_octree_base() {
+	for(int l=0;l<nx;l++) {
+		delete [] p[l];
+		delete [] id[l];
+	}
+	delete [] id;
+	delete [] p;
+	delete [] co;
+	delete [] mem;
+	delete root;
+}
+
+/** Removes all of the particles and returns the octree to a single leaf. */
+void container_octree_base::clear() {
+	for(int l=1;l<nx;l++) {
+		delete [] p[l];
+		delete [] id[l];
+	}
+	delete root;
+	root=new octree(ax,bx,ay,by,az,bz,0,0);
+	lf.assign(1,root);
+	nb.clear();
+	*co=0;
+	nx=nxy=nxyz=1;
+	linked=false;
+}
+
+/** Sets the number of threads to use in the routines that compute all of the
+ * Voronoi cells. If the library was compiled without OpenMP support, then the
+ * number of threads is always one.
+ * \param[in] nt the number of threads. If this is zero or negative, then the
+ *               maximum number of threads available is used. */
+void container_octree_base::set_threads(int nt) {
+#ifdef _OPENMP
+	nthreads=nt>0?nt:omp_get_max_threads();
+#else
+	nthreads=1;
+#endif
+}
+
+/** Finds the leaf to store a particle in, splitting the leaf if it is full.
+ * \param[in] (x,y,z) the position of the particle.
+ * \return The index of the leaf, or -1 if the particle is outside the
+ *         container. */
+int container_octree_base::put_locate(double x,double y,double z) {
+	if(!put_inside(x,y,z)) return -1;
+	octree *t=root;
+	while(true) {
+		while(t->l<0) t=t->ch[t->child(x,y,z)];
+		if(co[t->l]<lmax) return t->l;
+		if(t->depth<oct_max_depth) split(t);
+		else {
+			if(co[t->l]==mem[t->l]) add_particle_memory(t->l);
+			return t->l;
+		}
+	}
+}
+
+/** Splits a leaf into eight children, and moves its particles into them. The
+ * first child takes over the block of the leaf, and the others are given new
+ * blocks.
+ * \param[in] t the leaf to split. */
+void container_octree_base::split(octree *t) {
+	int l=t->l,n=co[l],k,m,*idp=id[l];
+	double mx=0.5*(*t->lo+*t->hi),my=0.5*(t->lo[1]+t->hi[1]),mz=0.5*(t->lo[2]+t->hi[2]),
+	       *op=p[l],*pp=op,*pe=op+ps*n,*qp;
+
+	// Create the children, giving each one a block
+	for(k=0;k<8;k++) {
+		t->ch[k]=new octree(k&1?mx:*t->lo,k&1?*t->hi:mx,k&2?my:t->lo[1],k&2?t->hi[1]:my,
+				    k&4?mz:t->lo[2],k&4?t->hi[2]:mz,t->depth+1,l);
+		if(k>0) t->ch[k]->l=add_leaf(t->ch[k]);
+	}
+	lf[l]=*t->ch;
+	t->l=-1;
+
+	// Move the particles into the blocks of the children. The block of
+	// the first child is given new memory, so that the old arrays can be
+	// read while it is filled.
+	id[l]=new int[mem[l]];
+	p[l]=new double[ps*mem[l]];
+	co[l]=0;
+	for(int *ip=idp;pp<pe;pp+=ps,ip++) {
+		m=t->ch[t->child(*pp,pp[1],pp[2])]->l;
+		id[m][co[m]]=*ip;
+		qp=p[m]+ps*co[m]++;
+		for(k=0;k<ps;k++) qp[k]=pp[k];
+	}
+	delete [] idp;
+	delete [] op;
+	linked=false;
+}
+
+/** Creates a new block of particles for a leaf, increasing the memory of the
+ * block arrays if necessary.
+ * \param[in] t the leaf.
+ * \return The index of the new block. */
+int container_octree_base::add_leaf(octree *t) {
+	int l;
+	if(nx==lmem) {
+		int nmem=lmem<<1,**idn=new int*[nmem],*con=new int[nmem],*memn=new int[nmem];
+		double **pn=new double*[nmem];
+#if VOROPP_VERBOSE >=3
+		fprintf(stderr,"Octree leaf memory scaled up to %d\n",nmem);
+#endif
+		for(l=0;l<nx;l++) {
+			idn[l]=id[l];pn[l]=p[l];
+			con[l]=co[l];memn[l]=mem[l];
+		}
+		delete [] id;id=idn;
+		delete [] p;p=pn;
+		delete [] co;co=con;
+		delete [] mem;mem=memn;
+		lmem=nmem;
+	}
+	l=nx;
+	id[l]=new int[lmax];
+	p[l]=new double[ps*lmax];
+	co[l]=0;mem[l]=lmax;
+	lf.push_back(t);
+	nx=nxy=++nxyz;
+	return l;
+}
+
+/** Doubles the memory of the block of a leaf. This is only needed for leaves
+ * at the maximum depth, which are not split.
+ * \param[in] l the index of the block. */
+void container_octree_base::add_particle_memory(int l) {
+	int nmem=mem[l]<<1,k;
+	if(nmem>max_particle_memory)
+		voro_fatal_error("Absolute maximum memory allocation exceeded",VOROPP_MEMORY_ERROR);
+#if VOROPP_VERBOSE >=3
+	fprintf(stderr,"Particle memory in leaf %d scaled up to %d\n",l,nmem);
+#endif
+	int *idp=new int[nmem];
+	for(k=0;k<co[l];k++) idp[k]=id[l][k];
+	double *pp=new double[ps*nmem];
+	for(k=0;k<ps*co[l];k++) pp[k]=p[l][k];
+	mem[l]=nmem;
+	delete [] id[l];id[l]=idp;
+	delete [] p[l];p[l]=pp;
+}
+
+/** Finds the leaves that share a face with each leaf, if the octree has
+ * changed since this was last done. */
+void container_octree_base::setup_neighbors() {
+	if(linked) return;
+	nb.assign(nx,std::vector<int>());
+	for(int l=0;l<nx;l++) for(int a=0;a<3;a++) {
+		if(lf[l]->lo[a]>root->lo[a]) find_neighbors(root,l,a,lf[l]->lo[a]);
+		if(lf[l]->hi[a]<root->hi[a]) find_neighbors(root,l,a,lf[l]->hi[a]);
+	}
+	linked=true;
+}
+
+/** Searches a subtree for the leaves that touch a face of a given leaf,
+ * and adds them to its neighbor list.
+ * \param[in] t the root of the subtree to search.
+ * \param[in] l the leaf whose neighbors are being found.
+ * \param[in] a the axis that the face is perpendicular to.
+ * \param[in] v the coordinate of the face along this axis. */
+void container_octree_base::find_neighbors(octree *t,int l,int a,double v) {
+	if(t->lo[a]>v||t->hi[a]<v) return;
+	octree *u=lf[l];
+	for(int b=0;b<3;b++) if(b!=a&&(t->hi[b]<=u->lo[b]||t->lo[b]>=u->hi[b])) return;
+	if(t->l>=0) {
+		if(t->l!=l) nb[l].push_back(t->l);
+	} else for(int k=0;k<8;k++) find_neighbors(t->ch[k],l,a,v);
+}
+
+/** Checks whether a position is within the container and its walls.
+ * \param[in] (x,y,z) the position.
+ * \return True if the position is inside, false otherwise. */
+bool container_octree_base::point_inside(double x,double y,double z) {
+	if(x<ax||x>bx||y<ay||y>by||z<az||z>bz) return false;
+	return point_inside_walls(x,y,z);
+}
+
+/** Finds the maximum depth of the leaves.
+ * \return The maximum depth. */
+int container_octree_base::max_depth() {
+	int d=0;
+	for(int l=0;l<nx;l++) if(lf[l]->depth>d) d=lf[l]->depth;
+	return d;
+}
+
+/** Prints the number of leaves, their depth, and the mean numbers of
+ * particles and neighbors per leaf.
+ * \param[in] fp the file handle to write to. */
+void container_octree_base::print_stats(FILE *fp) {
+	setup_neighbors();
+	int tn=0;
+	for(int l=0;l<nx;l++) tn+=nb[l].size();
+	fprintf(fp,"Leaves             : %d\n"
+		   "Maximum depth      : %d\n"
+		   "Particles per leaf : %g\n"
+		   "Neighbors per leaf : %g\n",nx,max_depth(),
+		double(total_particles())/nx,double(tn)/nx);
+}
+
+/** Draws the boxes of the leaves in gnuplot format.
+ * \param[in] fp the file handle to write to. */
+void container_octree_base::draw_octree_gnuplot(FILE *fp) {
+	for(int l=0;l<nx;l++) {
+		double *lo=lf[l]->lo,*hi=lf[l]->hi,
+		       xl=*lo,xh=*hi,yl=lo[1],yh=hi[1],zl=lo[2],zh=hi[2];
+		fprintf(fp,"%g %g %g\n%g %g %g\n%g %g %g\n%g %g %g\n",xl,yl,zl,xh,yl,zl,xh,yh,zl,xl,yh,zl);
+		fprintf(fp,"%g %g %g\n%g %g %g\n%g %g %g\n%g %g %g\n",xl,yh,zh,xh,yh,zh,xh,yl,zh,xl,yl,zh);
+		fprintf(fp,"%g %g %g\n\n%g %g %g\n%g %g %g\n\n",xl,yh,zh,xl,yl,zl,xl,yl,zh);
+		fprintf(fp,"%g %g %g\n%g %g %g\n\n%g %g %g\n%g %g %g\n\n",xh,yl,zl,xh,yl,zh,xh,yh,zl,xh,yh,zh);
+	}
+}
+
+/** The class constructor sets up the geometry of the container.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] lmax_ the maximum number of particles in a leaf. */
+container_octree::container_octree(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+	int lmax_) : container_octree_base(ax_,bx_,ay_,by_,az_,bz_,lmax_,3), oc(*this) {}
+
+/** The class constructor sets up the geometry of the container.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] lmax_ the maximum number of particles in a leaf. */
+container_octree_poly::container_octree_poly(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+	int lmax_) : container_octree_base(ax_,bx_,ay_,by_,az_,bz_,lmax_,4), oc(*this) {ppr=p;}
+
+/** Put a particle into the leaf that contains it, splitting the leaf if it is
+ * full.
+ * \param[in] n the numerical ID of the inserted particle.
+ * \param[in] (x,y,z) the position vector of the inserted particle. */
+void container_octree::put(int n,double x,double y,double z) {
+	int l=put_locate(x,y,z);
+	if(l>=0) {
+		id[l][co[l]]=n;
+		double *pp=p[l]+3*co[l]++;
+		*(pp++)=x;*(pp++)=y;*pp=z;
+	}
+}
+
+/** Put a particle into the leaf that contains it, splitting the leaf if it is
+ * full.
+ * \param[in] n the numerical ID of the inserted particle.
+ * \param[in] (x,y,z) the position vector of the inserted particle.
+ * \param[in] r the radius of the particle. */
+void container_octree_poly::put(int n,double x,double y,double z,double r) {
+	int l=put_locate(x,y,z);
+	if(l>=0) {
+		id[l][co[l]]=n;
+		double *pp=p[l]+4*co[l]++;
+		*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
+		if(max_radius<r) max_radius=r;
+		ppr=p;
+	}
+}
+
+/** Import a list of particles from an open file stream into the container.
+ * Entries of four numbers (Particle ID, x position, y position, z position)
+ * are searched for. The file is parsed with several threads by the
+ * text_importer class, and the particles are then added to the octree in the
+ * order that they were read. If the file cannot be successfully read, then
+ * the routine causes a fatal error.
+ * \param[in] fp the file handle to read from. */
+void container_octree::import(FILE *fp) {
+	text_importer ti(fp,4,nthreads);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=3) put(ti.id[i],*pp,pp[1],pp[2]);
+	}
+}
+
+/** Import a list of particles from an open file stream into the container.
+ * Entries of five numbers (Particle ID, x position, y position, z position,
+ * radius) are searched for. The file is parsed with several threads by the
+ * text_importer class, and the particles are then added to the octree in the
+ * order that they were read. If the file cannot be successfully read, then
+ * the routine causes a fatal error.
+ * \param[in] fp the file handle to read from. */
+void container_octree_poly::import(FILE *fp) {
+	text_importer ti(fp,5,nthreads);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=4) put(ti.id[i],*pp,pp[1],pp[2],pp[3]);
+	}
+}
+
+/** Computes all of the Voronoi cells in the container, but does nothing
+ * with the output. */
+void container_octree::compute_all_cells() {
+	c_loop_all vl(*this);
+	compute_all_cells(vl);
+}
+
+/** Computes all of the Voronoi cells in the container, but does nothing
+ * with the output. */
+void container_octree_poly::compute_all_cells() {
+	c_loop_all vl(*this);
+	compute_all_cells(vl);
+}
+
+/** Calculates all of the Voronoi cells and sums their volumes.
+ * \return The sum of all of the computed Voronoi volumes. */
+double container_octree::sum_cell_volumes() {
+	c_loop_all vl(*this);
+	return sum_cell_volumes(vl);
+}
+
+/** Calculates all of the Voronoi cells and sums their volumes.
+ * \return The sum of all of the computed Voronoi volumes. */
+double container_octree_poly::sum_cell_volumes() {
+	c_loop_all vl(*this);
+	return sum_cell_volumes(vl);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void container_octree::print_custom(const char *format,FILE *fp) {
+	c_loop_all vl(*this);
+	print_custom(vl,format,fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void container_octree_poly::print_custom(const char *format,FILE *fp) {
+	c_loop_all vl(*this);
+	print_custom(vl,format,fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to. */
+void container_octree::print_custom(const char *format,const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom(format,fp);
+	fclose(fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_octree::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all vl(*this);
+	print_columns(vl,cw);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to. */
+void container_octree_poly::print_custom(const char *format,const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom(format,fp);
+	fclose(fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_octree_poly::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all vl(*this);
+	print_columns(vl,cw);
+}
+
+}
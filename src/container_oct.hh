@@ -0,0 +1,743 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file container_oct.hh
+ * \brief Header file for the octree container classes. */
+
+#ifndef VOROPP_CONTAINER_OCT_HH
+#define VOROPP_CONTAINER_OCT_HH
+
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "config.hh"
+#include "common.hh"
+#include "v_base.hh"
+#include "cell.hh"
+#include "c_loops.hh"
+#include "rad_option.hh"
+#include "container.hh"
+#include "cell_ops.hh"
+
+namespace voro {
+
+/** \brief A node of the octree used by the octree container classes.
+ *
+ * Each node covers a rectangular box. A leaf node refers to a block of
+ * particles in its container, and a node that has been split has eight
+ * children, each covering one octant of its box. */
+class octree {
+	public:
+		/** The minimum coordinates of the box. */
+		double lo[3];
+		/** The maximum coordinates of the box. */
+		double hi[3];
+		/** The depth of the node, which is zero for the root. */
+		const int depth;
+		/** The index of the block of particles for a leaf node, or -1
+		 * if the node has been split. */
+		int l;
+		/** The children of the node, indexed by octant so that bits
+		 * 0, 1, and 2 are set for the upper half in the x, y, and z
+		 * directions respectively. */
+		octree *ch[8];
+		octree(double xl,double xh,double yl,double yh,double zl,double zh,int depth_,int l_);
+		~octree();
+		/** Finds the child that contains a position.
+		 * \param[in] (x,y,z) the position.
+		 * \return The index of the child. */
+		inline int child(double x,double y,double z) {
+			octree *t=*ch;
+			return (x<t->hi[0]?0:1)|(y<t->hi[1]?0:2)|(z<t->hi[2]?0:4);
+		}
+		/** Computes the squared distance from a position to the
+		 * closest point in the box.
+		 * \param[in] (x,y,z) the position.
+		 * \return The squared distance. */
+		inline double min_dist_sq(double x,double y,double z) {
+			double dx=x<*lo?*lo-x:(x>*hi?x-*hi:0),
+			       dy=y<lo[1]?lo[1]-y:(y>hi[1]?y-hi[1]:0),
+			       dz=z<lo[2]?lo[2]-z:(z>hi[2]?z-hi[2]:0);
+			return dx*dx+dy*dy+dz*dz;
+		}
+};
+
+/** \brief A class holding the search state for computing a Voronoi cell in
+ * an octree container.
+ *
+ * Each thread that computes cells in an octree container needs its own
+ * workspace, in the same way as the compute_workspace class is used for the
+ * grid-based containers. */
+class octree_workspace {
+	public:
+		/** The mark of each leaf, used to record which leaves have
+		 * been added to the search. */
+		std::vector<unsigned int> mask;
+		/** The mark for the current search. */
+		unsigned int mv;
+		/** A heap of the leaves that are waiting to be tested,
+		 * ordered by their squared distance from the particle. */
+		std::vector<std::pair<double,int> > hp;
+		octree_workspace() : mv(0) {}
+		/** Prepares for a new search, clearing the heap and choosing
+		 * a new mark.
+		 * \param[in] n the number of leaves. */
+		inline void start(int n) {
+			if(int(mask.size())<n) mask.resize(n,0);
+			if(++mv==0) {
+				std::fill(mask.begin(),mask.end(),0);
+				mv=1;
+			}
+			hp.clear();
+		}
+};
+
+/** \brief A class for computing Voronoi cells in an octree container.
+ *
+ * This class carries out the same role for the octree containers as the
+ * voro_compute template does for the grid-based containers. The particles in
+ * the leaf of the cell's particle are cut first. The neighboring leaves are
+ * then visited in order of their distance from the particle, using a heap,
+ * and the search moves outward through the neighbor links of each leaf. A
+ * leaf is skipped if no point in its box could cut the cell, and the search
+ * ends when the closest remaining leaf is too far away to cut it. Since the
+ * region of space in which a particle can cut the cell is star-shaped about
+ * the cell's particle, every leaf that intersects it can be reached through
+ * leaves that also intersect it, so the computed cell is exact. */
+template<class c_class>
+class octree_compute {
+	public:
+		/** A reference to the container class on which to carry out
+		 * the computations. */
+		c_class &con;
+		/** The workspace used by the serial routines. */
+		octree_workspace work;
+		/** The class constructor stores a reference to the container.
+		 * \param[in] con_ the container to use. */
+		octree_compute(c_class &con_) : con(con_) {}
+		/** Computes the Voronoi cell of a particle. The neighbor links
+		 * of the container must be set up beforehand.
+		 * \param[in,out] c a reference to a Voronoi cell class.
+		 * \param[in] ws the workspace to use.
+		 * \param[in] l the leaf that the particle is in.
+		 * \param[in] q the index of the particle within the leaf.
+		 * \return False if the Voronoi cell was completely removed
+		 *         during the computation and has zero volume, true
+		 *         otherwise. */
+		template<class v_cell>
+		bool compute_cell(v_cell &c,octree_workspace &ws,int l,int q) {
+			double *pp=con.p[l]+con.ps*q,x=*pp,y=pp[1],z=pp[2],mrs,crs,sh;
+			radius_record rr;
+			int m;
+			con.r_init(rr,pp);
+			if(!con.initialize_voronoicell(c,x,y,z)) return false;
+			mrs=c.max_radius_squared();
+			sh=con.r_min_shift(rr);
+
+			// Cut the cell by the other particles in its leaf
+			if(!cut_leaf(c,rr,l,q,x,y,z,mrs)) return false;
+
+			// Visit the other leaves in order of distance, until
+			// the closest remaining leaf is too far away to cut the
+			// cell
+			ws.start(con.nx);
+			ws.mask[l]=ws.mv;
+			add_neighbors(ws,l,x,y,z);
+			while(!ws.hp.empty()) {
+				std::pop_heap(ws.hp.begin(),ws.hp.end(),std::greater<std::pair<double,int> >());
+				crs=ws.hp.back().first;m=ws.hp.back().second;
+				ws.hp.pop_back();
+				if(con.r_ctest(rr,crs,mrs)) break;
+				if(!box_test(c,con.lf[m],x,y,z,crs+sh)) continue;
+				if(!cut_leaf(c,rr,m,-1,x,y,z,mrs)) return false;
+				add_neighbors(ws,m,x,y,z);
+			}
+			return true;
+		}
+	private:
+		/** Cuts a Voronoi cell by the particles in a leaf.
+		 * \param[in,out] c a reference to a Voronoi cell class.
+		 * \param[in] rr the radius information for the cell.
+		 * \param[in] m the leaf.
+		 * \param[in] q the index of the cell's particle, which is
+		 *              skipped, or -1 if the particle is not in the
+		 *              leaf.
+		 * \param[in] (x,y,z) the position of the cell's particle.
+		 * \param[in,out] mrs the maximum radius squared of the cell.
+		 * \return False if the cell was completely removed, true
+		 *         otherwise. */
+		template<class v_cell>
+		inline bool cut_leaf(v_cell &c,radius_record &rr,int m,int q,double x,double y,double z,double &mrs) {
+			double *pp=con.p[m],x1,y1,z1,rs;
+			for(int i=0;i<con.co[m];i++,pp+=con.ps) if(i!=q) {
+				x1=*pp-x;y1=pp[1]-y;z1=pp[2]-z;
+				rs=x1*x1+y1*y1+z1*z1;
+				if(con.r_scale_check(rr,rs,mrs,m,i)) {
+					if(!c.nplane(x1,y1,z1,rs,con.id[m][i])) return false;
+					mrs=c.max_radius_squared();
+				}
+			}
+			return true;
+		}
+		/** Adds the neighbors of a leaf to the heap, if they have not
+		 * already been added in this search.
+		 * \param[in] ws the workspace to use.
+		 * \param[in] m the leaf.
+		 * \param[in] (x,y,z) the position of the cell's particle. */
+		inline void add_neighbors(octree_workspace &ws,int m,double x,double y,double z) {
+			std::vector<int> &nv=con.nb[m];
+			for(std::vector<int>::iterator it=nv.begin();it<nv.end();++it) if(ws.mask[*it]!=ws.mv) {
+				ws.mask[*it]=ws.mv;
+				ws.hp.push_back(std::make_pair(con.lf[*it]->min_dist_sq(x,y,z),*it));
+				std::push_heap(ws.hp.begin(),ws.hp.end(),std::greater<std::pair<double,int> >());
+			}
+		}
+		/** Tests whether any particle in the box of a leaf could cut
+		 * a Voronoi cell. For each vertex of the cell, the largest
+		 * value of its scalar product with a point in the box is
+		 * compared with the smallest value of the right hand side of
+		 * the plane equation, which is found from the closest point
+		 * in the box.
+		 * \param[in] c a reference to a Voronoi cell class.
+		 * \param[in] t the leaf node.
+		 * \param[in] (x,y,z) the position of the cell's particle.
+		 * \param[in] rl the squared distance to the closest point in
+		 *               the box, plus the radius shift.
+		 * \return True if a particle in the box could cut the cell,
+		 *         false otherwise. */
+		template<class v_cell>
+		inline bool box_test(v_cell &c,octree *t,double x,double y,double z,double rl) {
+			double xl=*t->lo-x,xh=*t->hi-x,yl=t->lo[1]-y,yh=t->hi[1]-y,
+			       zl=t->lo[2]-z,zh=t->hi[2]-z;
+			for(double *ptsp=c.pts,*ptse=c.pts+(c.p<<2);ptsp<ptse;ptsp+=4)
+				if((*ptsp>0?*ptsp*xh:*ptsp*xl)+(ptsp[1]>0?ptsp[1]*yh:ptsp[1]*yl)
+				  +(ptsp[2]>0?ptsp[2]*zh:ptsp[2]*zl)>rl) return true;
+			return false;
+		}
+};
+
+/** \brief Class for representing a particle system in a rectangular box,
+ * using an octree that adapts to the particle density.
+ *
+ * The grid-based containers divide the domain into blocks of equal size,
+ * which works poorly when the particle density varies by orders of magnitude,
+ * since the blocks in the sparse regions are mostly empty while those in the
+ * dense regions hold many particles. This class instead stores the particles
+ * in the leaves of an octree, and splits any leaf that exceeds a capacity
+ * limit into eight, so that every leaf holds a similar number of particles.
+ * The leaves are linked to the leaves that share a face with them, which the
+ * cell computation uses to search outward from each particle.
+ *
+ * The leaves are numbered, and the particles of each leaf are stored in the
+ * same id, p, and co arrays as the blocks of the grid-based containers. The
+ * number of leaves is held in nx, with ny and nz equal to one, so that the
+ * standard loop classes such as c_loop_all visit the particles leaf by leaf.
+ * The leaf numbering changes when particles are added, so loop classes must
+ * be created after all of the particles have been added. The class supports
+ * walls but not periodic boundary conditions. It is not intended for direct
+ * use, but forms the base of the container_octree and container_octree_poly
+ * classes. */
+class container_octree_base : public wall_list {
+	public:
+		/** The minimum x coordinate of the container. */
+		const double ax;
+		/** The maximum x coordinate of the container. */
+		const double bx;
+		/** The minimum y coordinate of the container. */
+		const double ay;
+		/** The maximum y coordinate of the container. */
+		const double by;
+		/** The minimum z coordinate of the container. */
+		const double az;
+		/** The maximum z coordinate of the container. */
+		const double bz;
+		/** The maximum length squared that could be encountered in the
+		 * Voronoi cell calculation. */
+		const double max_len_sq;
+		/** The maximum number of particles in a leaf. A leaf that
+		 * exceeds this is split, unless it is at the maximum depth
+		 * oct_max_depth. */
+		const int lmax;
+		/** The number of leaves. */
+		int nx;
+		/** The number of leaves in the second dimension of the block
+		 * arrays, which is always one. */
+		const int ny;
+		/** The number of leaves in the third dimension of the block
+		 * arrays, which is always one. */
+		const int nz;
+		/** The number of leaves, for use by the loop classes. */
+		int nxy;
+		/** The number of leaves, for use by the loop classes. */
+		int nxyz;
+		/** This array holds the numerical IDs of each particle in each
+		 * leaf. */
+		int **id;
+		/** A two dimensional array holding particle positions, and
+		 * radii in the polydisperse case, for each leaf. */
+		double **p;
+		/** This array holds the number of particles within each
+		 * leaf. */
+		int *co;
+		/** This array holds the maximum amount of particle memory for
+		 * each leaf. */
+		int *mem;
+		/** The amount of memory in the array structure for each
+		 * particle. This is set to 3 when the basic class is
+		 * initialized, so that the array holds (x,y,z) positions. If
+		 * the container class is initialized as part of the
+		 * container_octree_poly class, then this is set to 4, to also
+		 * hold the particle radii. */
+		const int ps;
+		/** The node of each leaf. */
+		std::vector<octree*> lf;
+		/** The leaves that share a face with each leaf. */
+		std::vector<std::vector<int> > nb;
+		/** The number of threads to use when computing all of the
+		 * Voronoi cells. */
+		int nthreads;
+		container_octree_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int lmax_,int ps_);
+		~container_octree_base();
+		void clear();
+		void setup_neighbors();
+		void set_threads(int nt);
+		bool point_inside(double x,double y,double z);
+		/** Sums up the total number of stored particles.
+		 * \return The number of particles. */
+		inline int total_particles() {
+			int tp=*co;
+			for(int *cop=co+1;cop<co+nxyz;cop++) tp+=*cop;
+			return tp;
+		}
+		int max_depth();
+		/** Returns a pointer to the position of a particle.
+		 * \param[in] (ijk,q) the leaf and the index of the particle
+		 *                    within it.
+		 * \return The pointer. */
+		inline double* particle_pos(int ijk,int q) {return p[ijk]+ps*q;}
+		void print_stats(FILE *fp=stdout);
+		void draw_octree_gnuplot(FILE *fp=stdout);
+		/** Draws the boxes of the leaves in gnuplot format.
+		 * \param[in] filename the name of the file to write to. */
+		inline void draw_octree_gnuplot(const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			draw_octree_gnuplot(fp);
+			fclose(fp);
+		}
+		/** Initializes a Voronoi cell to the box of the container and
+		 * applies the walls.
+		 * \param[in,out] c a reference to a Voronoi cell class.
+		 * \param[in] (x,y,z) the position of the particle.
+		 * \return False if the cell was completely removed by a wall,
+		 *         true otherwise. */
+		template<class v_cell>
+		inline bool initialize_voronoicell(v_cell &c,double x,double y,double z) {
+			c.init(ax-x,bx-x,ay-y,by-y,az-z,bz-z);
+			return apply_walls(c,x,y,z);
+		}
+	protected:
+		/** The root node of the octree. */
+		octree *root;
+		/** The number of leaves that the block arrays have memory
+		 * for. */
+		int lmem;
+		/** Whether the neighbor links are up to date. */
+		bool linked;
+		int put_locate(double x,double y,double z);
+		/** Checks whether a position is within the container.
+		 * \param[in] (x,y,z) the position.
+		 * \return True if the position is inside, false otherwise. */
+		inline bool put_inside(double x,double y,double z) {
+			if(x>=ax&&x<=bx&&y>=ay&&y<=by&&z>=az&&z<=bz) return true;
+#if VOROPP_REPORT_OUT_OF_BOUNDS ==1
+			fprintf(stderr,"Out of bounds: (x,y,z)=(%g,%g,%g)\n",x,y,z);
+#endif
+			return false;
+		}
+	private:
+		int add_leaf(octree *t);
+		void split(octree *t);
+		void add_particle_memory(int l);
+		void find_neighbors(octree *t,int l,int a,double v);
+};
+
+/** \brief Extension of the container_octree_base class for computing regular
+ * Voronoi tessellations.
+ *
+ * This class is an extension of the container_octree_base class that has
+ * routines specifically for computing the regular Voronoi tessellation with
+ * no dependence on particle radii. */
+class container_octree : public container_octree_base, public radius_mono {
+	public:
+		container_octree(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int lmax_=oct_leaf_max);
+		void put(int n,double x,double y,double z);
+		void import(FILE *fp=stdin);
+		/** Imports a list of particles from an open file stream into
+		 * the container. Entries of four numbers (Particle ID, x
+		 * position, y position, z position) are searched for. If the
+		 * file cannot be successfully read, then the routine causes a
+		 * fatal error.
+		 * \param[in] filename the name of the file to open and read
+		 *                     from. */
+		inline void import(const char* filename) {
+			FILE *fp=safe_fopen(filename,"r");
+			import(fp);
+			fclose(fp);
+		}
+		void compute_all_cells();
+		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler,
+		 * and each thread uses its own workspace and Voronoi cell.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			setup_neighbors();
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			setup_neighbors();
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+			return op.vol;
+		}
+		/** Dumps particle IDs and positions to a file.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_particles(c_loop &vl,FILE *fp) {
+			double *pp;
+			if(vl.start()) do {
+				pp=p[vl.ijk]+3*vl.q;
+				fprintf(fp,"%d %g %g %g\n",id[vl.ijk][vl.q],*pp,pp[1],pp[2]);
+			} while(vl.inc());
+		}
+		/** Dumps all of the particle IDs and positions to a file.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_particles(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_particles(vl,fp);
+		}
+		/** Dumps all of the particle IDs and positions to a file.
+		 * \param[in] filename the name of the file to write to. */
+		inline void draw_particles(const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			draw_particles(fp);
+			fclose(fp);
+		}
+		/** Computes Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_cells_gnuplot(c_loop &vl,FILE *fp) {
+			voronoicell c(*this);double *pp;
+			if(vl.start()) do if(compute_cell(c,vl)) {
+				pp=p[vl.ijk]+ps*vl.q;
+				c.draw_gnuplot(*pp,pp[1],pp[2],fp);
+			} while(vl.inc());
+		}
+		/** Computes all Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_cells_gnuplot(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_cells_gnuplot(vl,fp);
+		}
+		/** Computes all Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] filename the name of the file to write to. */
+		inline void draw_cells_gnuplot(const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			draw_cells_gnuplot(fp);
+			fclose(fp);
+		}
+		/** Computes the Voronoi cells and saves customized information
+		 * about them. If more than one thread has been requested, then
+		 * the output of each task of the block scheduler is formatted
+		 * by an ordered_writer, and the output is the same as for a
+		 * serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_custom(c_loop &vl,const char *format,FILE *fp) {
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			setup_neighbors();
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,octree_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+		}
+		void print_custom(const char *format,FILE *fp=stdout);
+		void print_custom(const char *format,const char *filename);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			setup_neighbors();
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,octree_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall, then the
+		 * routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl) {
+			return compute_cell(c,vl.ijk,vl.q);
+		}
+		/** Computes the Voronoi cell for a given particle, setting up
+		 * the neighbor links of the leaves first if necessary.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the leaf that the particle is within.
+		 * \param[in] q the index of the particle within the leaf.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall, then the
+		 * routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			setup_neighbors();
+			return oc.compute_cell(c,oc.work,ijk,q);
+		}
+		/** Computes the Voronoi cell for a given particle, using a
+		 * given workspace. Several threads can call this routine at
+		 * once if each has its own workspace, as long as the neighbor
+		 * links have been set up beforehand with setup_neighbors().
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the leaf that the particle is within.
+		 * \param[in] q the index of the particle within the leaf.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall, then the
+		 * routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,octree_workspace &ws) {
+			return oc.compute_cell(c,ws,ijk,q);
+		}
+	private:
+		octree_compute<container_octree> oc;
+		friend class octree_compute<container_octree>;
+};
+
+/** \brief Extension of the container_octree_base class for computing radical
+ * Voronoi tessellations.
+ *
+ * This class is an extension of the container_octree_base class that has
+ * routines specifically for computing the radical Voronoi tessellation that
+ * depends on the particle radii. */
+class container_octree_poly : public container_octree_base, public radius_poly {
+	public:
+		container_octree_poly(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int lmax_=oct_leaf_max);
+		void put(int n,double x,double y,double z,double r);
+		void import(FILE *fp=stdin);
+		/** Imports a list of particles from an open file stream into
+		 * the container. Entries of five numbers (Particle ID, x
+		 * position, y position, z position, radius) are searched for.
+		 * If the file cannot be successfully read, then the routine
+		 * causes a fatal error.
+		 * \param[in] filename the name of the file to open and read
+		 *                     from. */
+		inline void import(const char* filename) {
+			FILE *fp=safe_fopen(filename,"r");
+			import(fp);
+			fclose(fp);
+		}
+		void compute_all_cells();
+		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler,
+		 * and each thread uses its own workspace and Voronoi cell.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			setup_neighbors();
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			setup_neighbors();
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+			return op.vol;
+		}
+		/** Dumps particle IDs, positions and radii to a file.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_particles(c_loop &vl,FILE *fp) {
+			double *pp;
+			if(vl.start()) do {
+				pp=p[vl.ijk]+4*vl.q;
+				fprintf(fp,"%d %g %g %g %g\n",id[vl.ijk][vl.q],*pp,pp[1],pp[2],pp[3]);
+			} while(vl.inc());
+		}
+		/** Dumps all of the particle IDs, positions and radii to a
+		 * file.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_particles(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_particles(vl,fp);
+		}
+		/** Dumps all of the particle IDs, positions and radii to a
+		 * file.
+		 * \param[in] filename the name of the file to write to. */
+		inline void draw_particles(const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			draw_particles(fp);
+			fclose(fp);
+		}
+		/** Computes Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_cells_gnuplot(c_loop &vl,FILE *fp) {
+			voronoicell c(*this);double *pp;
+			if(vl.start()) do if(compute_cell(c,vl)) {
+				pp=p[vl.ijk]+ps*vl.q;
+				c.draw_gnuplot(*pp,pp[1],pp[2],fp);
+			} while(vl.inc());
+		}
+		/** Computes all Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_cells_gnuplot(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_cells_gnuplot(vl,fp);
+		}
+		/** Computes all Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] filename the name of the file to write to. */
+		inline void draw_cells_gnuplot(const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			draw_cells_gnuplot(fp);
+			fclose(fp);
+		}
+		/** Computes the Voronoi cells and saves customized information
+		 * about them. If more than one thread has been requested, then
+		 * the output of each task of the block scheduler is formatted
+		 * by an ordered_writer, and the output is the same as for a
+		 * serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_custom(c_loop &vl,const char *format,FILE *fp) {
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			setup_neighbors();
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,octree_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+		}
+		void print_custom(const char *format,FILE *fp=stdout);
+		void print_custom(const char *format,const char *filename);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			setup_neighbors();
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,octree_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,octree_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall, then the
+		 * routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl) {
+			return compute_cell(c,vl.ijk,vl.q);
+		}
+		/** Computes the Voronoi cell for a given particle, setting up
+		 * the neighbor links of the leaves first if necessary.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the leaf that the particle is within.
+		 * \param[in] q the index of the particle within the leaf.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall, then the
+		 * routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			setup_neighbors();
+			return oc.compute_cell(c,oc.work,ijk,q);
+		}
+		/** Computes the Voronoi cell for a given particle, using a
+		 * given workspace. Several threads can call this routine at
+		 * once if each has its own workspace, as long as the neighbor
+		 * links have been set up beforehand with setup_neighbors().
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the leaf that the particle is within.
+		 * \param[in] q the index of the particle within the leaf.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall, then the
+		 * routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,octree_workspace &ws) {
+			return oc.compute_cell(c,ws,ijk,q);
+		}
+	private:
+		octree_compute<container_octree_poly> oc;
+		friend class octree_compute<container_octree_poly>;
+};
+
+}
+
+#endif
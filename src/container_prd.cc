@@ -9,6 +9,8 @@
  * related classes. */
 
 #include "container_prd.hh"
+#include "particle_file.hh"
+#include "text_import.hh"
 
 namespace voro {
 
@@ -32,7 +34,8 @@ container_periodic_base::container_periodic_base(double bx_,double bxy_,double b
 	voro_base(nx_,ny_,nz_,bx_/nx_,by_/ny_,bz_/nz_), max_len_sq(unit_voro.max_radius_squared()),
 	ey(int(max_uv_y*ysp+1)), ez(int(max_uv_z*zsp+1)), wy(ny+ey), wz(nz+ez),
 	oy(ny+2*ey), oz(nz+2*ez), oxyz(nx*oy*oz), id(new int*[oxyz]), p(new double*[oxyz]),
-	co(new int[oxyz]), mem(new int[oxyz]), img(new char[oxyz]), init_mem(init_mem_), ps(ps_) {
+	co(new int[oxyz]), mem(new int[oxyz]), img(new char[oxyz]), init_mem(init_mem_), ps(ps_),
+	indexed(false), imaged(false), ixmem(0), ixb(NULL), ixq(NULL) {
 	int i,j,k,l;
 
 	// Clear the global arrays
@@ -60,6 +63,8 @@ container_periodic_base::~container_periodic_base() {
 	delete [] co;
 	delete [] id;
 	delete [] p;
+	delete [] ixq;
+	delete [] ixb;
 }
 
 /** The class constructor sets up the geometry of container.
@@ -96,6 +101,7 @@ void container_periodic::put(int n,double x,double y,double z) {
 	put_locate_block(ijk,x,y,z);
 	for(int l=0;l<co[ijk];l++) check_duplicate(n,x,y,z,id[ijk][l],p[ijk]+3*l);
 	id[ijk][co[ijk]]=n;
+	index_add(n,ijk,co[ijk]);
 	double *pp=p[ijk]+3*co[ijk]++;
 	*(pp++)=x;*(pp++)=y;*pp=z;
 }
@@ -109,6 +115,7 @@ void container_periodic_poly::put(int n,double x,double y,double z,double r) {
 	put_locate_block(ijk,x,y,z);
 	for(int l=0;l<co[ijk];l++) check_duplicate(n,x,y,z,id[ijk][l],p[ijk]+4*l);
 	id[ijk][co[ijk]]=n;
+	index_add(n,ijk,co[ijk]);
 	double *pp=p[ijk]+4*co[ijk]++;
 	*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
 	if(max_radius<r) max_radius=r;
@@ -125,6 +132,7 @@ void container_periodic::put(int n,double x,double y,double z,int &ai,int &aj,in
 	put_locate_block(ijk,x,y,z,ai,aj,ak);
 	for(int l=0;l<co[ijk];l++) check_duplicate(n,x,y,z,id[ijk][l],p[ijk]+3*l);
 	id[ijk][co[ijk]]=n;
+	index_add(n,ijk,co[ijk]);
 	double *pp=p[ijk]+3*co[ijk]++;
 	*(pp++)=x;*(pp++)=y;*pp=z;
 }
@@ -142,6 +150,7 @@ void container_periodic_poly::put(int n,double x,double y,double z,double r,int
 	for(int l=0;l<co[ijk];l++) check_duplicate(n,x,y,z,id[ijk][l],p[ijk]+4*l);
 
 	id[ijk][co[ijk]]=n;
+	index_add(n,ijk,co[ijk]);
 	double *pp=p[ijk]+4*co[ijk]++;
 	*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
 	if(max_radius<r) max_radius=r;
@@ -156,6 +165,7 @@ void container_periodic::put(particle_order &vo,int n,double x,double y,double z
 	int ijk;
 	put_locate_block(ijk,x,y,z);
 	id[ijk][co[ijk]]=n;
+	index_add(n,ijk,co[ijk]);
 	vo.add(ijk,co[ijk]);
 	double *pp=p[ijk]+3*co[ijk]++;
 	*(pp++)=x;*(pp++)=y;*pp=z;
@@ -171,6 +181,7 @@ void container_periodic_poly::put(particle_order &vo,int n,double x,double y,dou
 	int ijk;
 	put_locate_block(ijk,x,y,z);
 	id[ijk][co[ijk]]=n;
+	index_add(n,ijk,co[ijk]);
 	vo.add(ijk,co[ijk]);
 	double *pp=p[ijk]+4*co[ijk]++;
 	*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
@@ -263,7 +274,7 @@ void container_periodic_base::put_locate_block(int &ijk,double &x,double &y,doub
  * \param[in,out] (x,y,z) the position vector to consider, which is remapped
  *                        into the primary domain during the routine.
  * \param[out] ijk the block index that the vector is within. */
-inline void container_periodic_base::remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk) {
+inline void container_periodic_base::remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk) const {
 
 	// Remap particle in the z direction if necessary
 	ck=step_int(z*zsp);
@@ -290,17 +301,44 @@ inline void container_periodic_base::remap(int &ai,int &aj,int &ak,int &ci,int &
 	ijk=ci+nx*(cj+oy*ck);
 }
 
+/** Takes a position vector and finds the block that it is within, remapping
+ * it into the primary domain. Unlike put_locate_block(), this routine does
+ * not modify the container, and it is used to set up ghost particle
+ * computations.
+ * \param[out] ijk the block index that the vector is within.
+ * \param[out] (ci,cj,ck) the coordinates of the block.
+ * \param[in,out] (x,y,z) the position vector to consider, which is remapped
+ *                        into the primary domain during the routine. */
+void container_periodic_base::locate_block(int &ijk,int &ci,int &cj,int &ck,double &x,double &y,double &z) const {
+	int ai,aj,ak;
+	remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk);
+}
+
+/** Finds the block of the primary domain that a vector is within, after
+ * remapping it into the primary domain.
+ * \param[in] (x,y,z) the vector.
+ * \return The block index, numbering the blocks of the primary domain from 0
+ * to nx*ny*nz-1. */
+int container_periodic_base::query_block(double x,double y,double z) const {
+	int ijk,ci,cj,ck;
+	locate_block(ijk,ci,cj,ck,x,y,z);
+	return ci+nx*(cj-ey+ny*(ck-ez));
+}
+
 /** Takes a vector and finds the particle whose Voronoi cell contains that
  * vector. This is equivalent to finding the particle which is nearest to the
- * vector.
+ * vector. If several threads call this routine at once, then
+ * create_all_images() should be called first, since otherwise the periodic
+ * images are created during the search.
  * \param[in] (x,y,z) the vector to test.
  * \param[out] (rx,ry,rz) the position of the particle whose Voronoi cell
  *                        contains the vector. This may point to a particle in
  *                        a periodic image of the primary domain.
  * \param[out] pid the ID of the particle.
+ * \param[in] ws the workspace to use for the search.
  * \return True if a particle was found. If the container has no particles,
  * then the search will not find a Voronoi cell and false is returned. */
-bool container_periodic::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
+bool container_periodic::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const {
 	int ai,aj,ak,ci,cj,ck,ijk;
 	particle_record w;
 	double mrs;
@@ -308,7 +346,7 @@ bool container_periodic::find_voronoi_cell(double x,double y,double z,double &rx
 	// Remap the vector into the primary domain and then search for the
 	// Voronoi cell that it is within
 	remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk);
-	vc.find_voronoi_cell(x,y,z,ci,cj,ck,ijk,w,mrs);
+	vc.find_voronoi_cell(ws,x,y,z,ci,cj,ck,ijk,w,mrs);
 
 	if(w.ijk!=-1) {
 
@@ -324,17 +362,68 @@ bool container_periodic::find_voronoi_cell(double x,double y,double z,double &rx
 	return false;
 }
 
+/** Takes a vector and finds the block and slot of the particle whose Voronoi
+ * cell contains it, and the periodic image of the particle.
+ * \param[in] ws the workspace to use for the search.
+ * \param[in] (x,y,z) the vector to test.
+ * \param[out] (ijk,l) the block and slot of the particle, which may be a copy
+ *                     in an image block.
+ * \param[out] (ai,aj,ak) the periodic image of the particle that is closest
+ *                        to the vector, relative to its position in the
+ *                        primary domain, in units of the unit cell vectors.
+ * \return True if a particle was found, false otherwise. */
+bool container_periodic::find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const {
+	int ci,cj,ck,bi,bj,bk;
+	particle_record w;
+	double mrs;
+
+	// Remap the vector into the primary domain and then search for the
+	// Voronoi cell that it is within
+	remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk);
+	vc.find_voronoi_cell(ws,x,y,z,ci,cj,ck,ijk,w,mrs);
+	if(w.ijk==-1) return false;
+
+	// Find the periodic image of the particle. If it was found in an
+	// image block, then the stored copy already has a periodic
+	// displacement, which is found by remapping it into the primary
+	// domain.
+	ci+=w.di;if(ci<0||ci>=nx) ai+=step_div(ci,nx);
+	ijk=w.ijk;l=w.l;
+	x=p[ijk][3*l];y=p[ijk][3*l+1];z=p[ijk][3*l+2];
+	remap(bi,bj,bk,ci,cj,ck,x,y,z,w.ijk);
+	ai+=bi;aj+=bj;ak+=bk;
+	return true;
+}
+
+/** Finds the particles whose Voronoi cells contain a list of vectors. See
+ * voro_compute::find_voronoi_cells() for details. If more than one thread is
+ * used, then all of the periodic images are created first.
+ * \param[in] n the number of vectors.
+ * \param[in] pos an array of 3*n floating point numbers holding the vectors.
+ * \param[out] pid an array of n integers in which to store the IDs of the
+ *                 particles, or -1 if the container is empty.
+ * \param[out] sh an array of 3*n integers in which to store the periodic image
+ *                of each particle that is closest to the vector, in units of
+ *                the unit cell vectors, or NULL if this is not required. */
+void container_periodic::find_voronoi_cells(int n,const double *pos,int *pid,int *sh) {
+	if(nthreads>1) create_all_images();
+	vc.find_voronoi_cells(n,pos,pid,sh);
+}
+
 /** Takes a vector and finds the particle whose Voronoi cell contains that
- * vector. Additional wall classes are not considered by this routine.
+ * vector. This is equivalent to finding the particle which is nearest to the
+ * vector. If several threads call this routine at once, then
+ * create_all_images() should be called first, since otherwise the periodic
+ * images are created during the search.
  * \param[in] (x,y,z) the vector to test.
  * \param[out] (rx,ry,rz) the position of the particle whose Voronoi cell
- *                        contains the vector. If the container is periodic,
- *                        this may point to a particle in a periodic image of
- *                        the primary domain.
+ *                        contains the vector. This may point to a particle in
+ *                        a periodic image of the primary domain.
  * \param[out] pid the ID of the particle.
+ * \param[in] ws the workspace to use for the search.
  * \return True if a particle was found. If the container has no particles,
  * then the search will not find a Voronoi cell and false is returned. */
-bool container_periodic_poly::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
+bool container_periodic_poly::find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const {
 	int ai,aj,ak,ci,cj,ck,ijk;
 	particle_record w;
 	double mrs;
@@ -342,7 +431,7 @@ bool container_periodic_poly::find_voronoi_cell(double x,double y,double z,doubl
 	// Remap the vector into the primary domain and then search for the
 	// Voronoi cell that it is within
 	remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk);
-	vc.find_voronoi_cell(x,y,z,ci,cj,ck,ijk,w,mrs);
+	vc.find_voronoi_cell(ws,x,y,z,ci,cj,ck,ijk,w,mrs);
 
 	if(w.ijk!=-1) {
 
@@ -358,6 +447,155 @@ bool container_periodic_poly::find_voronoi_cell(double x,double y,double z,doubl
 	return false;
 }
 
+/** Takes a vector and finds the block and slot of the particle whose Voronoi
+ * cell contains it, and the periodic image of the particle.
+ * \param[in] ws the workspace to use for the search.
+ * \param[in] (x,y,z) the vector to test.
+ * \param[out] (ijk,l) the block and slot of the particle, which may be a copy
+ *                     in an image block.
+ * \param[out] (ai,aj,ak) the periodic image of the particle that is closest
+ *                        to the vector, relative to its position in the
+ *                        primary domain, in units of the unit cell vectors.
+ * \return True if a particle was found, false otherwise. */
+bool container_periodic_poly::find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const {
+	int ci,cj,ck,bi,bj,bk;
+	particle_record w;
+	double mrs;
+
+	// Remap the vector into the primary domain and then search for the
+	// Voronoi cell that it is within
+	remap(ai,aj,ak,ci,cj,ck,x,y,z,ijk);
+	vc.find_voronoi_cell(ws,x,y,z,ci,cj,ck,ijk,w,mrs);
+	if(w.ijk==-1) return false;
+
+	// Find the periodic image of the particle. If it was found in an
+	// image block, then the stored copy already has a periodic
+	// displacement, which is found by remapping it into the primary
+	// domain.
+	ci+=w.di;if(ci<0||ci>=nx) ai+=step_div(ci,nx);
+	ijk=w.ijk;l=w.l;
+	x=p[ijk][4*l];y=p[ijk][4*l+1];z=p[ijk][4*l+2];
+	remap(bi,bj,bk,ci,cj,ck,x,y,z,w.ijk);
+	ai+=bi;aj+=bj;ak+=bk;
+	return true;
+}
+
+/** Finds the particles whose Voronoi cells contain a list of vectors. See
+ * voro_compute::find_voronoi_cells() for details. If more than one thread is
+ * used, then all of the periodic images are created first.
+ * \param[in] n the number of vectors.
+ * \param[in] pos an array of 3*n floating point numbers holding the vectors.
+ * \param[out] pid an array of n integers in which to store the IDs of the
+ *                 particles, or -1 if the container is empty.
+ * \param[out] sh an array of 3*n integers in which to store the periodic image
+ *                of each particle that is closest to the vector, in units of
+ *                the unit cell vectors, or NULL if this is not required. */
+void container_periodic_poly::find_voronoi_cells(int n,const double *pos,int *pid,int *sh) {
+	if(nthreads>1) create_all_images();
+	vc.find_voronoi_cells(n,pos,pid,sh);
+}
+
+/** Removes a particle from the container. The last particle in the same block
+ * is moved into its slot, so the order of the particles within the block
+ * changes, and any particle_order records of the block become invalid. Any
+ * periodic images that have been created are also cleared, so that they are
+ * recreated when they are next needed. The first call to this routine, or to
+ * the move() routines, builds an index from each particle ID to the block and
+ * slot that it is stored in, so that later calls take constant time. The
+ * particle IDs must be unique.
+ * \param[in] n the numerical ID of the particle to remove.
+ * \return True if the particle was removed, false if there was no particle
+ * with this ID. */
+bool container_periodic_base::remove(int n) {
+	int ijk,q;
+	if(!find_particle(n,ijk,q)) return false;
+	remove_slot(ijk,q);
+	clear_images();
+	return true;
+}
+
+/** Finds the block and slot that a particle is stored in, building the ID
+ * index if it is out of date.
+ * \param[in] n the numerical ID of the particle.
+ * \param[out] (ijk,q) the block and slot of the particle.
+ * \return True if the particle was found, false otherwise. */
+bool container_periodic_base::find_particle(int n,int &ijk,int &q) {
+	if(!indexed) build_index();
+	if(n>=0&&n<max_index_size) {
+		if(n>=ixmem||ixb[n]<0) return false;
+		ijk=ixb[n];q=ixq[n];
+	} else {
+		std::map<int,std::pair<int,int> >::iterator it=ixs.find(n);
+		if(it==ixs.end()) return false;
+		ijk=it->second.first;q=it->second.second;
+	}
+	return true;
+}
+
+/** Removes the particle in a given slot by moving the last particle in the
+ * block into its place, and updates the ID index.
+ * \param[in] (ijk,q) the block and slot of the particle to remove. */
+void container_periodic_base::remove_slot(int ijk,int q) {
+	int n=id[ijk][q],l=--co[ijk];
+	if(q<l) {
+		int m=id[ijk][q]=id[ijk][l];
+		double *pp=p[ijk]+ps*q,*pe=pp+ps,*ql=p[ijk]+ps*l;
+		while(pp<pe) *(pp++)=*(ql++);
+		set_index(m,ijk,q);
+	}
+	clear_index(n);
+}
+
+/** Records the block and slot of a particle in the ID index. IDs from 0 up to
+ * max_index_size are stored in arrays, whose memory is increased if
+ * necessary. Other IDs, which would make the arrays too large, are stored in
+ * a map.
+ * \param[in] n the numerical ID of the particle.
+ * \param[in] (ijk,q) the block and slot of the particle. */
+void container_periodic_base::set_index(int n,int ijk,int q) {
+	if(n<0||n>=max_index_size) {
+		ixs[n]=std::pair<int,int>(ijk,q);
+		return;
+	}
+	if(n>=ixmem) {
+		int l,nmem=ixmem==0?init_index_size:ixmem;
+		while(nmem<=n) nmem<<=1;
+#if VOROPP_VERBOSE >=3
+		fprintf(stderr,"Particle index memory scaled up to %d\n",nmem);
+#endif
+		int *nb=new int[nmem],*nq=new int[nmem];
+		for(l=0;l<ixmem;l++) {nb[l]=ixb[l];nq[l]=ixq[l];}
+		for(;l<nmem;l++) nb[l]=-1;
+		delete [] ixq;delete [] ixb;
+		ixb=nb;ixq=nq;ixmem=nmem;
+	}
+	ixb[n]=ijk;ixq[n]=q;
+}
+
+/** Builds the index from each particle ID to the block and slot that it is
+ * stored in, by scanning the particles in the primary domain. */
+void container_periodic_base::build_index() {
+	int i,j,k,ijk,q;
+	for(q=0;q<ixmem;q++) ixb[q]=-1;
+	ixs.clear();
+	for(k=ez;k<wz;k++) for(j=ey;j<wy;j++) for(i=0;i<nx;i++) {
+		ijk=i+nx*(j+oy*k);
+		for(q=0;q<co[ijk];q++) set_index(id[ijk][q],ijk,q);
+	}
+	indexed=true;
+}
+
+/** Removes all of the periodic images that have been created, so that they
+ * are recreated from the current particles when they are next needed. */
+void container_periodic_base::clear_images() {
+	if(!imaged) return;
+	int i,j,k,ijk;
+	for(k=0;k<oz;k++) for(j=0;j<oy;j++) if(k<ez||k>=wz||j<ey||j>=wy)
+		for(i=0,ijk=nx*(j+oy*k);i<nx;i++,ijk++) co[ijk]=0;
+	char *cp=img;while(cp<img+oxyz) *(cp++)=0;
+	imaged=false;
+}
+
 /** Increase memory for a particular region.
  * \param[in] i the index of the region to reallocate. */
 void container_periodic_base::add_particle_memory(int i) {
@@ -398,10 +636,11 @@ void container_periodic_base::add_particle_memory(int i) {
  * causes a fatal error.
  * \param[in] fp the file handle to read from. */
 void container_periodic::import(FILE *fp) {
-	int i,j;
-	double x,y,z;
-	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(i,x,y,z);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,4,nthreads);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=3) put(ti.id[i],*pp,pp[1],pp[2]);
+	}
 }
 
 /** Import a list of particles from an open file stream, also storing the order
@@ -411,10 +650,11 @@ void container_periodic::import(FILE *fp) {
  * \param[in,out] vo a reference to an ordering class to use.
  * \param[in] fp the file handle to read from. */
 void container_periodic::import(particle_order &vo,FILE *fp) {
-	int i,j;
-	double x,y,z;
-	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(vo,i,x,y,z);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,4,nthreads);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=3) put(vo,ti.id[i],*pp,pp[1],pp[2]);
+	}
 }
 
 /** Import a list of particles from an open file stream into the container.
@@ -423,10 +663,11 @@ void container_periodic::import(particle_order &vo,FILE *fp) {
  * routine causes a fatal error.
  * \param[in] fp the file handle to read from. */
 void container_periodic_poly::import(FILE *fp) {
-	int i,j;
-	double x,y,z,r;
-	while((j=fscanf(fp,"%d %lg %lg %lg %lg",&i,&x,&y,&z,&r))==5) put(i,x,y,z,r);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,5,nthreads);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=4) put(ti.id[i],*pp,pp[1],pp[2],pp[3]);
+	}
 }
 
 /** Import a list of particles from an open file stream, also storing the order
@@ -436,10 +677,57 @@ void container_periodic_poly::import(FILE *fp) {
  * \param[in,out] vo a reference to an ordering class to use.
  * \param[in] fp the file handle to read from. */
 void container_periodic_poly::import(particle_order &vo,FILE *fp) {
-	int i,j;
-	double x,y,z,r;
-	while((j=fscanf(fp,"%d %lg %lg %lg %lg",&i,&x,&y,&z,&r))==5) put(vo,i,x,y,z,r);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,5,nthreads);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=4) put(vo,ti.id[i],*pp,pp[1],pp[2],pp[3]);
+	}
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * which is described in the particle_file class. The file is mapped into
+ * memory, and the particles are added without any parsing. If the file cannot
+ * be read, or it contains radii, then the routine causes a fatal error.
+ * \param[in] filename the name of the file to read from. */
+void container_periodic::import_binary(const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(false,filename);
+	const double *pp=pf.pos;
+	for(int i=0;i<pf.n;i++,pp+=pf.ps) put(pf.id[i],*pp,pp[1],pp[2]);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * also storing the order in which the particles are read.
+ * \param[in,out] vo the ordering class to use.
+ * \param[in] filename the name of the file to read from. */
+void container_periodic::import_binary(particle_order &vo,const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(false,filename);
+	const double *pp=pf.pos;
+	for(int i=0;i<pf.n;i++,pp+=pf.ps) put(vo,pf.id[i],*pp,pp[1],pp[2]);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * which is described in the particle_file class. The file is mapped into
+ * memory, and the particles are added without any parsing. If the file cannot
+ * be read, or it does not contain radii, then the routine causes a fatal error.
+ * \param[in] filename the name of the file to read from. */
+void container_periodic_poly::import_binary(const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(true,filename);
+	const double *pp=pf.pos;
+	for(int i=0;i<pf.n;i++,pp+=pf.ps) put(pf.id[i],*pp,pp[1],pp[2],pp[3]);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * also storing the order in which the particles are read.
+ * \param[in,out] vo the ordering class to use.
+ * \param[in] filename the name of the file to read from. */
+void container_periodic_poly::import_binary(particle_order &vo,const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(true,filename);
+	const double *pp=pf.pos;
+	for(int i=0;i<pf.n;i++,pp+=pf.ps) put(vo,pf.id[i],*pp,pp[1],pp[2],pp[3]);
 }
 
 /** Outputs the a list of all the container regions along with the number of
@@ -450,10 +738,72 @@ void container_periodic_base::region_count() {
 		printf("Region (%d,%d,%d): %d particles\n",i,j,k,*(cop++));
 }
 
+/** Moves a particle to a new position, which is remapped into the primary
+ * domain. If the new position is in the same block, then the particle is
+ * updated in place. Otherwise it is removed from its block as described in
+ * container_periodic_base::remove(), and added to the new block. Any periodic
+ * images that have been created are cleared.
+ * \param[in] n the numerical ID of the particle to move.
+ * \param[in] (x,y,z) the new position of the particle.
+ * \return True if the particle was moved, false if there was no particle
+ * with this ID. */
+bool container_periodic::move(int n,double x,double y,double z) {
+	int ijk,q,nijk;
+	if(!find_particle(n,ijk,q)) return false;
+	put_locate_block(nijk,x,y,z);
+	if(nijk!=ijk) {
+		remove_slot(ijk,q);
+		q=co[nijk]++;
+		id[nijk][q]=n;
+		set_index(n,nijk,q);
+	}
+	double *pp=p[nijk]+3*q;
+	*(pp++)=x;*(pp++)=y;*pp=z;
+	clear_images();
+	return true;
+}
+
+/** Moves a particle to a new position, keeping its radius. See
+ * container_periodic::move() for details.
+ * \param[in] n the numerical ID of the particle to move.
+ * \param[in] (x,y,z) the new position of the particle.
+ * \return True if the particle was moved, false if there was no particle
+ * with this ID. */
+bool container_periodic_poly::move(int n,double x,double y,double z) {
+	int ijk,q;
+	return find_particle(n,ijk,q)&&move(n,x,y,z,p[ijk][4*q+3]);
+}
+
+/** Moves a particle to a new position and changes its radius. See
+ * container_periodic::move() for details. The maximum radius is increased if
+ * necessary, but it is not decreased.
+ * \param[in] n the numerical ID of the particle to move.
+ * \param[in] (x,y,z) the new position of the particle.
+ * \param[in] r the new radius of the particle.
+ * \return True if the particle was moved, false if there was no particle
+ * with this ID. */
+bool container_periodic_poly::move(int n,double x,double y,double z,double r) {
+	int ijk,q,nijk;
+	if(!find_particle(n,ijk,q)) return false;
+	put_locate_block(nijk,x,y,z);
+	if(nijk!=ijk) {
+		remove_slot(ijk,q);
+		q=co[nijk]++;
+		id[nijk][q]=n;
+		set_index(n,nijk,q);
+	}
+	double *pp=p[nijk]+4*q;
+	*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
+	if(max_radius<r) max_radius=r;
+	clear_images();
+	return true;
+}
+
 /** Clears a container of particles. */
 void container_periodic::clear() {
 	for(int *cop=co;cop<co+oxyz;cop++) *cop=0;
 	char *cp=img;while(cp<img+oxyz) *(cp++)=0;	
+	indexed=imaged=false;
 }
 
 /** Clears a container of particles, also clearing resetting the maximum radius
@@ -462,6 +812,7 @@ void container_periodic_poly::clear() {
 	for(int *cop=co;cop<co+oxyz;cop++) *cop=0;
 	char *cp=img;while(cp<img+oxyz) *(cp++)=0;	
 	max_radius=0;
+	indexed=imaged=false;
 }
 
 /** Computes all the Voronoi cells and saves customized information about them.
@@ -490,6 +841,18 @@ void container_periodic::print_custom(const char *format,const char *filename) {
 	fclose(fp);
 }
 
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_periodic::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all_periodic vl(*this);
+	print_columns(vl,cw);
+}
+
 /** Computes all the Voronoi cells and saves customized
  * information about them
  * \param[in] format the custom output string to use.
@@ -500,15 +863,59 @@ void container_periodic_poly::print_custom(const char *format,const char *filena
 	fclose(fp);
 }
 
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_periodic_poly::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all_periodic vl(*this);
+	print_columns(vl,cw);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] fp a file handle to write to. */
+void container_periodic::print_face_graph(FILE *fp) {
+	c_loop_all_periodic vl(*this);
+	print_face_graph(vl,fp);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] filename the name of the file to write to. */
+void container_periodic::print_face_graph(const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_face_graph(fp);
+	fclose(fp);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] fp a file handle to write to. */
+void container_periodic_poly::print_face_graph(FILE *fp) {
+	c_loop_all_periodic vl(*this);
+	print_face_graph(vl,fp);
+}
+
+/** Computes all of the Voronoi cells and saves the faces between pairs of
+ * particles as an edge list.
+ * \param[in] filename the name of the file to write to. */
+void container_periodic_poly::print_face_graph(const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_face_graph(fp);
+	fclose(fp);
+}
+
 /** Computes all of the Voronoi cells in the container, but does nothing
  * with the output. It is useful for measuring the pure computation time
  * of the Voronoi algorithm, without any additional calculations such as
  * volume evaluation or cell output. */
 void container_periodic::compute_all_cells() {
-	voronoicell c(*this);
 	c_loop_all_periodic vl(*this);
-	if(vl.start()) do compute_cell(c,vl);
-	while(vl.inc());
+	compute_all_cells(vl);
 }
 
 /** Computes all of the Voronoi cells in the container, but does nothing
@@ -516,9 +923,8 @@ void container_periodic::compute_all_cells() {
  * of the Voronoi algorithm, without any additional calculations such as
  * volume evaluation or cell output. */
 void container_periodic_poly::compute_all_cells() {
-	voronoicell c(*this);
 	c_loop_all_periodic vl(*this);
-	if(vl.start()) do compute_cell(c,vl);while(vl.inc());
+	compute_all_cells(vl);
 }
 
 /** Calculates all of the Voronoi cells and sums their volumes. In most cases
@@ -526,11 +932,8 @@ void container_periodic_poly::compute_all_cells() {
  * of the container to numerical precision.
  * \return The sum of all of the computed Voronoi volumes. */
 double container_periodic::sum_cell_volumes() {
-	voronoicell c(*this);
-	double vol=0;
 	c_loop_all_periodic vl(*this);
-	if(vl.start()) do if(compute_cell(c,vl)) vol+=c.volume();while(vl.inc());
-	return vol;
+	return sum_cell_volumes(vl);
 }
 
 /** Calculates all of the Voronoi cells and sums their volumes. In most cases
@@ -538,11 +941,8 @@ double container_periodic::sum_cell_volumes() {
  * of the container to numerical precision.
  * \return The sum of all of the computed Voronoi volumes. */
 double container_periodic_poly::sum_cell_volumes() {
-	voronoicell c(*this);
-	double vol=0;
 	c_loop_all_periodic vl(*this);
-	if(vl.start()) do if(compute_cell(c,vl)) vol+=c.volume();while(vl.inc());
-	return vol;
+	return sum_cell_volumes(vl);
 }
 
 /** This routine creates all periodic images of the particles. It is meant for
@@ -582,6 +982,7 @@ void container_periodic_base::check_compartmentalized() {
  *			 satisfy ez<=dk<wz. */
 void container_periodic_base::create_side_image(int di,int dj,int dk) {
 	int l,dijk=di+nx*(dj+oy*dk),odijk,ima=step_div(dj-ey,ny);
+	imaged=true;
 	int qua=di+step_int(-ima*bxy*xsp),quadiv=step_div(qua,nx);
 	int fi=qua-quadiv*nx,fijk=fi+nx*(dj-ima*ny+oy*dk);
 	double dis=ima*bxy+quadiv*bx,switchx=di*boxx-ima*bxy-quadiv*bx,adis;
@@ -634,6 +1035,7 @@ void container_periodic_base::create_side_image(int di,int dj,int dk) {
  *			 satisfy dk<ez or dk>=wz. */
 void container_periodic_base::create_vertical_image(int di,int dj,int dk) {
 	int l,dijk=di+nx*(dj+oy*dk),dijkl,dijkr,ima=step_div(dk-ez,nz);
+	imaged=true;
 	int qj=dj+step_int(-ima*byz*ysp),qjdiv=step_div(qj-ey,ny);
 	int qi=di+step_int((-ima*bxz-qjdiv*bxy)*xsp),qidiv=step_div(qi,nx);
 	int fi=qi-qidiv*nx,fj=qj-qjdiv*ny,fijk=fi+nx*(fj+oy*(dk-ima*nz)),fijk2;
@@ -12,6 +12,8 @@
 
 #include <cstdio>
 #include <vector>
+#include <map>
+#include <utility>
 
 #include "config.hh"
 #include "common.hh"
@@ -21,6 +23,7 @@
 #include "v_compute.hh"
 #include "unitcell.hh"
 #include "rad_option.hh"
+#include "cell_ops.hh"
 
 namespace voro {
 
@@ -110,7 +113,7 @@ class container_periodic_base : public unitcell, public voro_base {
 		 * periodic images of the particle.
 		 * \param[in,out] c a reference to a voronoicell object.
 		 * \param[in] ijk the block that the particle is within.
-		 * \param[in] q the index of the particle within its block.
+		 * \param[in] pp a pointer to the position of the particle.
 		 * \param[in] (ci,cj,ck) the coordinates of the block in the
 		 * 			 container coordinate system.
 		 * \param[out] (i,j,k) the coordinates of the test block
@@ -122,9 +125,8 @@ class container_periodic_base : public unitcell, public voro_base {
 		 * \return False if the plane cuts applied by walls completely
 		 * removed the cell, true otherwise. */
 		template<class v_cell>
-		inline bool initialize_voronoicell(v_cell &c,int ijk,int q,int ci,int cj,int ck,int &i,int &j,int &k,double &x,double &y,double &z,int &disp) {
+		inline bool initialize_voronoicell(v_cell &c,int ijk,double *pp,int ci,int cj,int ck,int &i,int &j,int &k,double &x,double &y,double &z,int &disp) {
 			c=unit_voro;
-			double *pp=p[ijk]+ps*q;
 			x=*(pp++);y=*(pp++);z=*pp;
 			i=nx;j=ey;k=ez;
 			return true;
@@ -155,6 +157,13 @@ class container_periodic_base : public unitcell, public voro_base {
 			fy=y-boxy*(cj-ey);
 			fz=z-boxz*(ck-ez);
 		}
+		/** Returns a pointer to the position of a particle, which is
+		 * used by the voro_compute template to read the particles of
+		 * a block.
+		 * \param[in] (ijk,q) the block and the index of the particle
+		 *                    within it.
+		 * \return The pointer. */
+		inline double* particle_pos(int ijk,int q) {return p[ijk]+ps*q;}
 		/** Calculates the index of block in the container structure
 		 * corresponding to given coordinates.
 		 * \param[in] (ci,cj,ck) the coordinates of the original block
@@ -177,10 +186,31 @@ class container_periodic_base : public unitcell, public voro_base {
 		}
 		void create_all_images();
 		void check_compartmentalized();
+		bool remove(int n);
 	protected:
 		void add_particle_memory(int i);
+		bool find_particle(int n,int &ijk,int &q);
+		void remove_slot(int ijk,int q);
+		void set_index(int n,int ijk,int q);
+		void clear_images();
+		/** Records the block and slot of a particle that has just been
+		 * stored, if the ID index is in use.
+		 * \param[in] n the numerical ID of the particle.
+		 * \param[in] (ijk,q) the block and slot of the particle. */
+		inline void index_add(int n,int ijk,int q) {
+			if(indexed) set_index(n,ijk,q);
+		}
+		/** Whether the ID index is up to date. The index is built
+		 * the first time that a particle is removed or moved, and is
+		 * then kept up to date as particles are added. */
+		bool indexed;
+		/** Whether any periodic images may have been created since
+		 * they were last cleared. */
+		bool imaged;
 		void put_locate_block(int &ijk,double &x,double &y,double &z);
 		void put_locate_block(int &ijk,double &x,double &y,double &z,int &ai,int &aj,int &ak);
+		void locate_block(int &ijk,int &ci,int &cj,int &ck,double &x,double &y,double &z) const;
+		int query_block(double x,double y,double z) const;
 		/** Creates particles within an image block by copying them
 		 * from the primary domain and shifting them. If the given
 		 * block is aligned with the primary domain in the z-direction,
@@ -201,7 +231,27 @@ class container_periodic_base : public unitcell, public voro_base {
 		void create_side_image(int di,int dj,int dk);
 		void create_vertical_image(int di,int dj,int dk);
 		void put_image(int reg,int fijk,int l,double dx,double dy,double dz);
-		inline void remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk);
+		inline void remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk) const;
+	private:
+		/** The number of IDs that the index has memory for. */
+		int ixmem;
+		/** The block that each particle ID is stored in, or -1 if
+		 * there is no particle with that ID. Only the blocks of the
+		 * primary domain are indexed. */
+		int *ixb;
+		/** The slot within its block that each particle ID is stored
+		 * in. */
+		int *ixq;
+		/** The block and slot of each particle whose ID is negative,
+		 * or too large to be stored in the ixb and ixq arrays. */
+		std::map<int,std::pair<int,int> > ixs;
+		/** Removes a particle ID from the index.
+		 * \param[in] n the numerical ID of the particle. */
+		inline void clear_index(int n) {
+			if(n>=0&&n<max_index_size) ixb[n]=-1;
+			else ixs.erase(n);
+		}
+		void build_index();
 };
 
 /** \brief Extension of the container_periodic_base class for computing regular
@@ -218,6 +268,7 @@ class container_periodic : public container_periodic_base, public radius_mono {
 		void put(int n,double x,double y,double z);
 		void put(int n,double x,double y,double z,int &ai,int &aj,int &ak);
 		void put(particle_order &vo,int n,double x,double y,double z);
+		bool move(int n,double x,double y,double z);
 		void import(FILE *fp=stdin);
 		void import(particle_order &vo,FILE *fp=stdin);
 		/** Imports a list of particles from an open file stream into
@@ -246,8 +297,41 @@ class container_periodic : public container_periodic_base, public radius_mono {
 			import(vo,fp);
 			fclose(fp);
 		}
+		void import_binary(const char *filename);
+		void import_binary(particle_order &vo,const char *filename);
 		void compute_all_cells();
 		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler,
+		 * and each thread uses its own compute_workspace and Voronoi
+		 * cell. Before the threads start, all of the periodic images
+		 * are created, so that the container is not modified during
+		 * the computation.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			if(nthreads>1) create_all_images();
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error. Before the threads start, all of the periodic images
+		 * are created, so that the container is not modified during
+		 * the computation.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			if(nthreads>1) create_all_images();
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+			return op.vol;
+		}
 		/** Dumps particle IDs and positions to a file.
 		 * \param[in] vl the loop class to use.
 		 * \param[in] fp a file handle to write to. */
@@ -353,30 +437,74 @@ class container_periodic : public container_periodic_base, public radius_mono {
 			fclose(fp);
 		}
 		/** Computes the Voronoi cells and saves customized information
-		 * about them.
+		 * about them. If more than one thread has been requested, then
+		 * all of the periodic images are created first, and the output
+		 * of each task of the block scheduler is formatted by an
+		 * ordered_writer, so that the output is the same as for a
+		 * serial computation.
 		 * \param[in] vl the loop class to use.
 		 * \param[in] format the custom output string to use.
 		 * \param[in] fp a file handle to write to. */
 		template<class c_loop>
 		void print_custom(c_loop &vl,const char *format,FILE *fp) {
-			int ijk,q;double *pp;
-			if(contains_neighbor(format)) {
-				voronoicell_neighbor c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],default_radius,fp);
-				} while(vl.inc());
-			} else {
-				voronoicell c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],default_radius,fp);
-				} while(vl.inc());
-			}
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			if(nthreads>1) create_all_images();
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
 		}
 		void print_custom(const char *format,FILE *fp=stdout);
 		void print_custom(const char *format,const char *filename);
-		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			if(nthreads>1) create_all_images();
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cells and saves the faces between
+		 * pairs of particles as an edge list. Each face is evaluated
+		 * once, by the cell of the particle with the lower ID, and a
+		 * line is printed containing the two IDs, the face area, the
+		 * unit normal pointing from the first particle to the second,
+		 * and the face centroid. Faces against walls are omitted. Since the
+		 * centroids are computed from the cell of the lower ID, a face
+		 * that crosses a periodic boundary is given the centroid next
+		 * to that particle.
+		 * If more than one thread has been requested, then the output
+		 * of each task of the block scheduler is formatted by an
+		 * ordered_writer, and the output is the same as for a serial
+		 * computation. Before the threads start, all of the periodic
+		 * images are created, so that the container is not modified
+		 * during the computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_face_graph(c_loop &vl,FILE *fp) {
+			if(nthreads>1) create_all_images();
+			cell_op_face_graph op(fp);
+			voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+		}
+		void print_face_graph(FILE *fp=stdout);
+		void print_face_graph(const char *filename);
+		/** Takes a vector and finds the particle whose Voronoi cell
+		 * contains that vector, using the container's own workspace.
+		 * See the version of this routine that takes a workspace for
+		 * details. */
+		inline bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
+			return find_voronoi_cell(x,y,z,rx,ry,rz,pid,vc.work);
+		}
+		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const;
+		void find_voronoi_cells(int n,const double *pos,int *pid,int *sh=NULL);
 		/** Computes the Voronoi cell for a particle currently being
 		 * referenced by a loop class.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -387,7 +515,23 @@ class container_periodic : public container_periodic_base, public radius_mono {
 		 * then the routine returns false. */
 		template<class v_cell,class c_loop>
 		inline bool compute_cell(v_cell &c,c_loop &vl) {
-			return vc.compute_cell(c,vl.ijk,vl.q,vl.i,vl.j,vl.k);
+			return compute_cell(c,vl,vc.work);
+		}
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class, using a given workspace. The
+		 * container is not modified, so several threads can call this
+		 * routine at once if each has its own workspace, as long as
+		 * create_all_images() has been called beforehand.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed because it was removed entirely for some reason,
+		 * then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl,compute_workspace &ws) const {
+			return vc.compute_cell(c,ws,vl.ijk,vl.q,vl.i,vl.j,vl.k,p[vl.ijk]+ps*vl.q);
 		}
 		/** Computes the Voronoi cell for given particle.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -399,8 +543,22 @@ class container_periodic : public container_periodic_base, public radius_mono {
 		 * then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			return compute_cell(c,ijk,q,vc.work);
+		}
+		/** Computes the Voronoi cell for given particle, using a given
+		 * workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed because it was removed entirely for some reason,
+		 * then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,compute_workspace &ws) const {
 			int k(ijk/(nx*oy)),ijkt(ijk-(nx*oy)*k),j(ijkt/nx),i(ijkt-j*nx);
-			return vc.compute_cell(c,ijk,q,i,j,k);
+			return vc.compute_cell(c,ws,ijk,q,i,j,k,p[ijk]+ps*q);
 		}
 		/** Computes the Voronoi cell for a ghost particle at a given
 		 * location.
@@ -412,16 +570,30 @@ class container_periodic : public container_periodic_base, public radius_mono {
 		 * condition, then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z) {
-			int ijk;
-			put_locate_block(ijk,x,y,z);
-			double *pp=p[ijk]+3*co[ijk]++;
-			*(pp++)=x;*(pp++)=y;*(pp++)=z;
-			bool q=compute_cell(c,ijk,co[ijk]-1);
-			co[ijk]--;
-			return q;
+			return compute_ghost_cell(c,x,y,z,vc.work);
+		}
+		/** Computes the Voronoi cell for a ghost particle at a given
+		 * location, using a given workspace. The ghost particle is not
+		 * added to the container, so several threads can call this
+		 * routine at once if each has its own workspace, as long as
+		 * create_all_images() has been called beforehand.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] (x,y,z) the location of the ghost particle.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z,compute_workspace &ws) const {
+			int ijk,ci,cj,ck;
+			locate_block(ijk,ci,cj,ck,x,y,z);
+			double pp[3]={x,y,z};
+			return vc.compute_cell(c,ws,ijk,co[ijk],ci,cj,ck,pp);
 		}
 	private:
 		voro_compute<container_periodic> vc;
+		bool find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const;
 		friend class voro_compute<container_periodic>;
 };
 
@@ -439,6 +611,8 @@ class container_periodic_poly : public container_periodic_base, public radius_po
 		void put(int n,double x,double y,double z,double r);
 		void put(int n,double x,double y,double z,double r,int &ai,int &aj,int &ak);
 		void put(particle_order &vo,int n,double x,double y,double z,double r);
+		bool move(int n,double x,double y,double z);
+		bool move(int n,double x,double y,double z,double r);
 		void import(FILE *fp=stdin);
 		void import(particle_order &vo,FILE *fp=stdin);
 		/** Imports a list of particles from an open file stream into
@@ -467,8 +641,41 @@ class container_periodic_poly : public container_periodic_base, public radius_po
 			import(vo,fp);
 			fclose(fp);
 		}
+		void import_binary(const char *filename);
+		void import_binary(particle_order &vo,const char *filename);
 		void compute_all_cells();
 		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler,
+		 * and each thread uses its own compute_workspace and Voronoi
+		 * cell. Before the threads start, all of the periodic images
+		 * are created, so that the container is not modified during
+		 * the computation.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			if(nthreads>1) create_all_images();
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error. Before the threads start, all of the periodic images
+		 * are created, so that the container is not modified during
+		 * the computation.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			if(nthreads>1) create_all_images();
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+			return op.vol;
+		}
 		/** Dumps particle IDs, positions and radii to a file.
 		 * \param[in] vl the loop class to use.
 		 * \param[in] fp a file handle to write to. */
@@ -576,26 +783,21 @@ class container_periodic_poly : public container_periodic_base, public radius_po
 			fclose(fp);
 		}
 		/** Computes the Voronoi cells and saves customized information
-		 * about them.
+		 * about them. If more than one thread has been requested, then
+		 * all of the periodic images are created first, and the output
+		 * of each task of the block scheduler is formatted by an
+		 * ordered_writer, so that the output is the same as for a
+		 * serial computation.
 		 * \param[in] vl the loop class to use.
 		 * \param[in] format the custom output string to use.
 		 * \param[in] fp a file handle to write to. */
 		template<class c_loop>
 		void print_custom(c_loop &vl,const char *format,FILE *fp) {
-			int ijk,q;double *pp;
-			if(contains_neighbor(format)) {
-				voronoicell_neighbor c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],pp[3],fp);
-				} while(vl.inc());
-			} else {
-				voronoicell c(*this);
-				if(vl.start()) do if(compute_cell(c,vl)) {
-					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
-					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],pp[3],fp);
-				} while(vl.inc());
-			}
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			if(nthreads>1) create_all_images();
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
 		}
 		/** Computes the Voronoi cell for a particle currently being
 		 * referenced by a loop class.
@@ -607,7 +809,23 @@ class container_periodic_poly : public container_periodic_base, public radius_po
 		 * then the routine returns false. */
 		template<class v_cell,class c_loop>
 		inline bool compute_cell(v_cell &c,c_loop &vl) {
-			return vc.compute_cell(c,vl.ijk,vl.q,vl.i,vl.j,vl.k);
+			return compute_cell(c,vl,vc.work);
+		}
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class, using a given workspace. The
+		 * container is not modified, so several threads can call this
+		 * routine at once if each has its own workspace, as long as
+		 * create_all_images() has been called beforehand.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed because it was removed entirely for some reason,
+		 * then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl,compute_workspace &ws) const {
+			return vc.compute_cell(c,ws,vl.ijk,vl.q,vl.i,vl.j,vl.k,p[vl.ijk]+ps*vl.q);
 		}
 		/** Computes the Voronoi cell for given particle.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -619,8 +837,22 @@ class container_periodic_poly : public container_periodic_base, public radius_po
 		 * then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			return compute_cell(c,ijk,q,vc.work);
+		}
+		/** Computes the Voronoi cell for given particle, using a given
+		 * workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed because it was removed entirely for some reason,
+		 * then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,compute_workspace &ws) const {
 			int k(ijk/(nx*oy)),ijkt(ijk-(nx*oy)*k),j(ijkt/nx),i(ijkt-j*nx);
-			return vc.compute_cell(c,ijk,q,i,j,k);
+			return vc.compute_cell(c,ws,ijk,q,i,j,k,p[ijk]+ps*q);
 		}
 		/** Computes the Voronoi cell for a ghost particle at a given
 		 * location.
@@ -633,20 +865,83 @@ class container_periodic_poly : public container_periodic_base, public radius_po
 		 * condition, then the routine returns false. */
 		template<class v_cell>
 		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z,double r) {
-			int ijk;
-			put_locate_block(ijk,x,y,z);
-			double *pp=p[ijk]+4*co[ijk]++,tm=max_radius;
-			*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
-			if(r>max_radius) max_radius=r;
-			bool q=compute_cell(c,ijk,co[ijk]-1);
-			co[ijk]--;max_radius=tm;
-			return q;
+			return compute_ghost_cell(c,x,y,z,r,vc.work);
+		}
+		/** Computes the Voronoi cell for a ghost particle at a given
+		 * location, using a given workspace. The ghost particle is not
+		 * added to the container, so several threads can call this
+		 * routine at once if each has its own workspace, as long as
+		 * create_all_images() has been called beforehand.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] (x,y,z) the location of the ghost particle.
+		 * \param[in] r the radius of the ghost particle.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_ghost_cell(v_cell &c,double x,double y,double z,double r,compute_workspace &ws) const {
+			int ijk,ci,cj,ck;
+			locate_block(ijk,ci,cj,ck,x,y,z);
+			double pp[4]={x,y,z,r};
+			return vc.compute_cell(c,ws,ijk,co[ijk],ci,cj,ck,pp);
 		}
 		void print_custom(const char *format,FILE *fp=stdout);
 		void print_custom(const char *format,const char *filename);
-		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			if(nthreads>1) create_all_images();
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cells and saves the faces between
+		 * pairs of particles as an edge list. Each face is evaluated
+		 * once, by the cell of the particle with the lower ID, and a
+		 * line is printed containing the two IDs, the face area, the
+		 * unit normal pointing from the first particle to the second,
+		 * and the face centroid. Faces against walls are omitted. Since the
+		 * centroids are computed from the cell of the lower ID, a face
+		 * that crosses a periodic boundary is given the centroid next
+		 * to that particle.
+		 * If more than one thread has been requested, then the output
+		 * of each task of the block scheduler is formatted by an
+		 * ordered_writer, and the output is the same as for a serial
+		 * computation. Before the threads start, all of the periodic
+		 * images are created, so that the container is not modified
+		 * during the computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_face_graph(c_loop &vl,FILE *fp) {
+			if(nthreads>1) create_all_images();
+			cell_op_face_graph op(fp);
+			voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+		}
+		void print_face_graph(FILE *fp=stdout);
+		void print_face_graph(const char *filename);
+		/** Takes a vector and finds the particle whose Voronoi cell
+		 * contains that vector, using the container's own workspace.
+		 * See the version of this routine that takes a workspace for
+		 * details. */
+		inline bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid) {
+			return find_voronoi_cell(x,y,z,rx,ry,rz,pid,vc.work);
+		}
+		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid,compute_workspace &ws) const;
+		void find_voronoi_cells(int n,const double *pos,int *pid,int *sh=NULL);
 	private:
 		voro_compute<container_periodic_poly> vc;
+		bool find_owner(compute_workspace &ws,double x,double y,double z,int &ijk,int &l,int &ai,int &aj,int &ak) const;
 		friend class voro_compute<container_periodic_poly>;
 };
 
@@ -0,0 +1,251 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file container_view.cc
+ * \brief Function implementations for the container view classes. */
+
+#include "container_view.hh"
+
+namespace voro {
+
+/** The class constructor sets up the geometry of the container and allocates
+ * the block tables. No particles are bound.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] (nx_,ny_,nz_) the number of grid blocks in each of the three
+ *			    coordinate directions.
+ * \param[in] (xperiodic_,yperiodic_,zperiodic_) flags setting whether the
+ *                                               container is periodic in each
+ *                                               coordinate direction.
+ * \param[in] ps_ the number of floating point entries that are read for each
+ *                particle. */
+container_view_base::container_view_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+		int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,int ps_)
+	: voro_base(nx_,ny_,nz_,(bx_-ax_)/nx_,(by_-ay_)/ny_,(bz_-az_)/nz_),
+	ax(ax_), bx(bx_), ay(ay_), by(by_), az(az_), bz(bz_),
+	max_len_sq((bx-ax)*(bx-ax)*(xperiodic_?0.25:1)+(by-ay)*(by-ay)*(yperiodic_?0.25:1)
+		  +(bz-az)*(bz-az)*(zperiodic_?0.25:1)),
+	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_),
+	id(new int*[nxyz]), co(new int[nxyz]), bo(new int[nxyz+1]), ps(ps_),
+	xp(NULL), xs(ps_), ixmem(0), ix(NULL), ib(NULL) {
+
+	int l;
+	for(l=0;l<nxyz;l++) co[l]=0;
+	for(l=0;l<nxyz;l++) id[l]=NULL;
+	for(l=0;l<=nxyz;l++) bo[l]=0;
+}
+
+/** The destructor frees the dynamically allocated memory. The bound array
+ * belongs to the caller and is not freed. */
+container_view_base::~container_view_base() {
+	delete [] ib;
+	delete [] ix;
+	delete [] bo;
+	delete [] co;
+	delete [] id;
+}
+
+/** Binds an array of particles to the container, replacing any array that was
+ * bound before. The particles are sorted into the blocks by a counting sort,
+ * and within each block they are kept in the order of the array. In periodic
+ * directions, particles outside the container are remapped into the primary
+ * domain, and their positions in the array are updated. In non-periodic
+ * directions, particles outside the container are left out, and a warning
+ * giving their number is printed.
+ * \param[in] n the number of particles.
+ * \param[in,out] pos the array of particles.
+ * \param[in] stride the number of floating point numbers between consecutive
+ *                   particles.
+ * \return The number of particles that are bound. */
+int container_view_base::bind_blocks(int n,double *pos,int stride) {
+	if(stride<ps) voro_fatal_error("Stride of the bound particle array is too small",VOROPP_INTERNAL_ERROR);
+	if(n>ixmem) {
+		delete [] ib;
+		delete [] ix;
+		ixmem=n;
+		ix=new int[ixmem];
+		ib=new int[ixmem];
+	}
+	int i,j,k,l,m,ijk,out=0;double *pp=pos;
+
+	// Count the particles in each block, remapping them in the periodic
+	// directions
+	for(l=0;l<nxyz;l++) co[l]=0;
+	for(l=0;l<n;l++,pp+=stride) {
+		i=step_int((*pp-ax)*xsp);
+		if(xperiodic) {m=step_mod(i,nx);*pp+=boxx*(m-i);i=m;}
+		j=step_int((pp[1]-ay)*ysp);
+		if(yperiodic) {m=step_mod(j,ny);pp[1]+=boxy*(m-j);j=m;}
+		k=step_int((pp[2]-az)*zsp);
+		if(zperiodic) {m=step_mod(k,nz);pp[2]+=boxz*(m-k);k=m;}
+		if(i<0||i>=nx||j<0||j>=ny||k<0||k>=nz) {
+			ib[l]=-1;out++;
+#if VOROPP_REPORT_OUT_OF_BOUNDS ==1
+			fprintf(stderr,"Out of bounds: (x,y,z)=(%g,%g,%g)\n",*pp,pp[1],pp[2]);
+#endif
+		} else co[ib[l]=i+nx*(j+ny*k)]++;
+	}
+	if(out>0) fprintf(stderr,"voro++: %d of %d particles are outside the container and are not bound\n",out,n);
+
+	// Set the offsets of the blocks and store the indices
+	*bo=0;
+	for(l=0;l<nxyz;l++) {
+		bo[l+1]=bo[l]+co[l];
+		id[l]=ix+bo[l];
+		co[l]=0;
+	}
+	for(l=0;l<n;l++) if((ijk=ib[l])>=0) id[ijk][co[ijk]++]=l;
+	xp=pos;xs=stride;
+	return bo[nxyz];
+}
+
+/** This function tests to see if a given vector lies within the container
+ * bounds and any walls.
+ * \param[in] (x,y,z) the position vector to be tested.
+ * \return True if the point is inside the container, false if the point is
+ *         outside. */
+bool container_view_base::point_inside(double x,double y,double z) {
+	if(x<ax||x>bx||y<ay||y>by||z<az||z>bz) return false;
+	return point_inside_walls(x,y,z);
+}
+
+/** The class constructor sets up the geometry of container.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] (nx_,ny_,nz_) the number of grid blocks in each of the three
+ *                       coordinate directions.
+ * \param[in] (xperiodic_,yperiodic_,zperiodic_) flags setting whether the
+ *                                               container is periodic in each
+ *                                               coordinate direction. */
+container_view::container_view(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+	int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_)
+	: container_view_base(ax_,bx_,ay_,by_,az_,bz_,nx_,ny_,nz_,xperiodic_,yperiodic_,zperiodic_,3),
+	vc(*this,xperiodic_?2*nx_+1:nx_,yperiodic_?2*ny_+1:ny_,zperiodic_?2*nz_+1:nz_) {}
+
+/** The class constructor sets up the geometry of container.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] (nx_,ny_,nz_) the number of grid blocks in each of the three
+ *                       coordinate directions.
+ * \param[in] (xperiodic_,yperiodic_,zperiodic_) flags setting whether the
+ *                                               container is periodic in each
+ *                                               coordinate direction. */
+container_view_poly::container_view_poly(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+	int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_)
+	: container_view_base(ax_,bx_,ay_,by_,az_,bz_,nx_,ny_,nz_,xperiodic_,yperiodic_,zperiodic_,4),
+	vc(*this,xperiodic_?2*nx_+1:nx_,yperiodic_?2*ny_+1:ny_,zperiodic_?2*nz_+1:nz_) {vid=id;}
+
+/** Binds an array of particle positions and radii to the container. Particle
+ * i has its position at pos[stride*i] and its radius at pos[stride*i+3], and
+ * its index is used as its ID. Particles are remapped in the periodic
+ * directions and left out in the others, as described for bind_blocks(). The
+ * maximum radius is found from the particles that are bound.
+ * \param[in] n the number of particles.
+ * \param[in,out] pos the array of particle positions and radii.
+ * \param[in] stride the number of floating point numbers between consecutive
+ *                   particles, which must be at least 4.
+ * \return The number of particles that are bound. */
+int container_view_poly::bind(int n,double *pos,int stride) {
+	int m=bind_blocks(n,pos,stride);
+	double r;
+	vrp=pos+3;vrs=stride;max_radius=0;
+	for(int *ip=id[0],*ie=ip+m;ip<ie;ip++) {
+		r=vrp[vrs**ip];
+		if(max_radius<r) max_radius=r;
+	}
+	return m;
+}
+
+/** Computes all of the Voronoi cells in the container, but does nothing
+ * with the output. */
+void container_view::compute_all_cells() {
+	c_loop_all vl(*this);
+	compute_all_cells(vl);
+}
+
+/** Computes all of the Voronoi cells in the container, but does nothing
+ * with the output. */
+void container_view_poly::compute_all_cells() {
+	c_loop_all vl(*this);
+	compute_all_cells(vl);
+}
+
+/** Calculates all of the Voronoi cells and sums their volumes.
+ * \return The sum of all of the computed Voronoi volumes. */
+double container_view::sum_cell_volumes() {
+	c_loop_all vl(*this);
+	return sum_cell_volumes(vl);
+}
+
+/** Calculates all of the Voronoi cells and sums their volumes.
+ * \return The sum of all of the computed Voronoi volumes. */
+double container_view_poly::sum_cell_volumes() {
+	c_loop_all vl(*this);
+	return sum_cell_volumes(vl);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void container_view::print_custom(const char *format,FILE *fp) {
+	c_loop_all vl(*this);
+	print_custom(vl,format,fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void container_view_poly::print_custom(const char *format,FILE *fp) {
+	c_loop_all vl(*this);
+	print_custom(vl,format,fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to. */
+void container_view::print_custom(const char *format,const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom(format,fp);
+	fclose(fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_view::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all vl(*this);
+	print_columns(vl,cw);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to. */
+void container_view_poly::print_custom(const char *format,const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom(format,fp);
+	fclose(fp);
+}
+
+/** Computes all the Voronoi cells and saves customized information about them
+ * in the binary columnar format of the column_writer class.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] append whether to add to the end of an existing file, rather
+ *                   than overwriting it. */
+void container_view_poly::print_columns(const char *format,const char *filename,bool append) {
+	column_writer cw(filename,format,append);
+	c_loop_all vl(*this);
+	print_columns(vl,cw);
+}
+
+}
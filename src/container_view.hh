@@ -0,0 +1,556 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file container_view.hh
+ * \brief Header file for the container view classes, which compute Voronoi
+ * cells from particle arrays owned by the caller. */
+
+#ifndef VOROPP_CONTAINER_VIEW_HH
+#define VOROPP_CONTAINER_VIEW_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+#include "common.hh"
+#include "v_base.hh"
+#include "cell.hh"
+#include "c_loops.hh"
+#include "v_compute.hh"
+#include "rad_option.hh"
+#include "container.hh"
+#include "cell_ops.hh"
+
+namespace voro {
+
+class container_view;
+class container_view_poly;
+
+/** \brief Gives the loop classes access to the particles of a view container.
+ *
+ * The view containers have no arrays of positions for each block, and the loop
+ * classes instead read each position from the bound array, using the index
+ * stored for the particle. */
+struct c_loop_view_source {
+	/** Returns NULL, since the positions are not stored in blocks. */
+	template<class c_class>
+	static inline double** blocks(c_class &con) {return NULL;}
+	/** Returns the bound array of particles.
+	 * \param[in] con the container class to use. */
+	template<class c_class>
+	static inline double* external(c_class &con) {return con.xp;}
+	/** Returns the stride of the bound array.
+	 * \param[in] con the container class to use. */
+	template<class c_class>
+	static inline int stride(c_class &con) {return con.xs;}
+};
+
+/** Uses the bound array for the loop classes of the container_view class. */
+template<>
+struct c_loop_source<container_view> : public c_loop_view_source {};
+
+/** Uses the bound array for the loop classes of the container_view_poly
+ * class. */
+template<>
+struct c_loop_source<container_view_poly> : public c_loop_view_source {};
+
+/** \brief Class for representing a particle system whose positions are held
+ * in an array owned by the caller.
+ *
+ * The container_base class copies the position of each particle into the
+ * array of its block. This class instead keeps the caller's array, and only
+ * stores, for each block, the indices of the particles that are within it.
+ * These indices are held in a single array, with the blocks in order, and
+ * they are rebuilt by a counting sort each time that the particles are bound,
+ * so that a simulation can bind the same array at every frame without copying
+ * any positions. The index of a particle in the caller's array is used as its
+ * ID. The caller must not change the array while it is bound. Binding remaps
+ * the positions of particles that are outside the container in a periodic
+ * direction, which is the only change made to the array.
+ *
+ * The class is not intended for direct use, but forms the base of the
+ * container_view and container_view_poly classes. It provides the same
+ * routines that the voro_compute template and the loop classes use from the
+ * container_base class. */
+class container_view_base : public voro_base, public wall_list {
+	public:
+		/** The minimum x coordinate of the container. */
+		const double ax;
+		/** The maximum x coordinate of the container. */
+		const double bx;
+		/** The minimum y coordinate of the container. */
+		const double ay;
+		/** The maximum y coordinate of the container. */
+		const double by;
+		/** The minimum z coordinate of the container. */
+		const double az;
+		/** The maximum z coordinate of the container. */
+		const double bz;
+		/** The maximum length squared that could be encountered in the
+		 * Voronoi cell calculation. */
+		const double max_len_sq;
+		/** A boolean value that determines if the x coordinate in
+		 * periodic or not. */
+		const bool xperiodic;
+		/** A boolean value that determines if the y coordinate in
+		 * periodic or not. */
+		const bool yperiodic;
+		/** A boolean value that determines if the z coordinate in
+		 * periodic or not. */
+		const bool zperiodic;
+		/** This array holds pointers to the indices of the particles
+		 * in each computational box, which are the positions of the
+		 * particles in the bound array. */
+		int **id;
+		/** This array holds the number of particles within each
+		 * computational box of the container. */
+		int *co;
+		/** The offsets of the blocks into the index array, with an
+		 * extra entry for the end of the last block. */
+		int *bo;
+		/** The number of floating point numbers that are read for each
+		 * particle. This is 3 for the container_view class, and 4 for
+		 * the container_view_poly class, where the radius follows the
+		 * position. */
+		const int ps;
+		/** A pointer to the bound array of particles, or NULL if no
+		 * array has been bound. */
+		double *xp;
+		/** The number of floating point numbers between consecutive
+		 * particles in the bound array. */
+		int xs;
+		container_view_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,int ps_);
+		~container_view_base();
+		bool point_inside(double x,double y,double z);
+		/** Initializes the Voronoi cell prior to a compute_cell
+		 * operation for a specific particle being carried out by a
+		 * voro_compute class. The cell is initialized to fill the
+		 * entire container. For non-periodic coordinates, this is set
+		 * by the position of the walls. For periodic coordinates, the
+		 * space is equally divided in either direction from the
+		 * particle's initial position. Plane cuts made by any walls
+		 * that have been added are then applied to the cell.
+		 * \param[in,out] c a reference to a voronoicell object.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] pp a pointer to the position of the particle.
+		 * \param[in] (ci,cj,ck) the coordinates of the block in the
+		 * 			 container coordinate system.
+		 * \param[out] (i,j,k) the coordinates of the test block
+		 * 		       relative to the voro_compute
+		 * 		       coordinate system.
+		 * \param[out] (x,y,z) the position of the particle.
+		 * \param[out] disp a block displacement used internally by the
+		 *		    compute_cell routine.
+		 * \return False if the plane cuts applied by walls completely
+		 * removed the cell, true otherwise. */
+		template<class v_cell>
+		inline bool initialize_voronoicell(v_cell &c,int ijk,double *pp,int ci,int cj,int ck,
+				int &i,int &j,int &k,double &x,double &y,double &z,int &disp) {
+			double x1,x2,y1,y2,z1,z2;
+			x=*(pp++);y=*(pp++);z=*pp;
+			if(xperiodic) {x1=-(x2=0.5*(bx-ax));i=nx;} else {x1=ax-x;x2=bx-x;i=ci;}
+			if(yperiodic) {y1=-(y2=0.5*(by-ay));j=ny;} else {y1=ay-y;y2=by-y;j=cj;}
+			if(zperiodic) {z1=-(z2=0.5*(bz-az));k=nz;} else {z1=az-z;z2=bz-z;k=ck;}
+			c.init(x1,x2,y1,y2,z1,z2);
+			if(!apply_walls(c,x,y,z)) return false;
+			disp=ijk-i-nx*(j+ny*k);
+			return true;
+		}
+		/** Initializes parameters for a find_voronoi_cell call within
+		 * the voro_compute template.
+		 * \param[in] (ci,cj,ck) the coordinates of the test block in
+		 * 			 the container coordinate system.
+		 * \param[in] ijk the index of the test block
+		 * \param[out] (i,j,k) the coordinates of the test block
+		 * 		       relative to the voro_compute
+		 * 		       coordinate system.
+		 * \param[out] disp a block displacement used internally by the
+		 *		    find_voronoi_cell routine. */
+		inline void initialize_search(int ci,int cj,int ck,int ijk,int &i,int &j,int &k,int &disp) {
+			i=xperiodic?nx:ci;
+			j=yperiodic?ny:cj;
+			k=zperiodic?nz:ck;
+			disp=ijk-i-nx*(j+ny*k);
+		}
+		/** Returns the position of a particle currently being computed
+		 * relative to the computational block that it is within. It is
+		 * used to select the optimal worklist entry to use.
+		 * \param[in] (x,y,z) the position of the particle.
+		 * \param[in] (ci,cj,ck) the block that the particle is within.
+		 * \param[out] (fx,fy,fz) the position relative to the block.
+		 */
+		inline void frac_pos(double x,double y,double z,double ci,double cj,double ck,
+				double &fx,double &fy,double &fz) {
+			fx=x-ax-boxx*ci;
+			fy=y-ay-boxy*cj;
+			fz=z-az-boxz*ck;
+		}
+		/** Returns a pointer to the position of a particle in the
+		 * bound array.
+		 * \param[in] (ijk,q) the block and the index of the particle
+		 *                    within it.
+		 * \return The pointer. */
+		inline double* particle_pos(int ijk,int q) {return xp+xs*id[ijk][q];}
+		/** Calculates the index of block in the container structure
+		 * corresponding to given coordinates.
+		 * \param[in] (ci,cj,ck) the coordinates of the original block
+		 * 			 in the current computation, relative
+		 * 			 to the container coordinate system.
+		 * \param[in] (ei,ej,ek) the displacement of the current block
+		 * 			 from the original block.
+		 * \param[in,out] (qx,qy,qz) the periodic displacement that
+		 * 			     must be added to the particles
+		 * 			     within the computed block.
+		 * \param[in] disp a block displacement used internally by the
+		 * 		    find_voronoi_cell and compute_cell routines.
+		 * \return The block index. */
+		inline int region_index(int ci,int cj,int ck,int ei,int ej,int ek,double &qx,double &qy,double &qz,int &disp) {
+			if(xperiodic) {if(ci+ei<nx) {ei+=nx;qx=-(bx-ax);} else if(ci+ei>=(nx<<1)) {ei-=nx;qx=bx-ax;} else qx=0;}
+			if(yperiodic) {if(cj+ej<ny) {ej+=ny;qy=-(by-ay);} else if(cj+ej>=(ny<<1)) {ej-=ny;qy=by-ay;} else qy=0;}
+			if(zperiodic) {if(ck+ek<nz) {ek+=nz;qz=-(bz-az);} else if(ck+ek>=(nz<<1)) {ek-=nz;qz=bz-az;} else qz=0;}
+			return disp+ei+nx*(ej+ny*ek);
+		}
+		/** Returns the number of particles that are bound.
+		 * \return The number of particles. */
+		inline int total_particles() {return bo[nxyz];}
+		/** Returns the amount of memory used to store the particle
+		 * indices, not including the bound array.
+		 * \return The number of bytes. */
+		inline size_t particle_memory() {
+			return sizeof(int)*(size_t(nxyz)*2+1+size_t(ixmem)*2)+sizeof(int*)*nxyz;
+		}
+	protected:
+		int bind_blocks(int n,double *pos,int stride);
+	private:
+		/** The current number of particles that the index arrays can
+		 * hold. */
+		int ixmem;
+		/** The indices of the bound particles, in block order. */
+		int *ix;
+		/** The block of each particle in the bound array, or -1 if the
+		 * particle is outside the container. */
+		int *ib;
+};
+
+/** \brief Extension of the container_view_base class for computing regular
+ * Voronoi tessellations.
+ *
+ * This class computes the Voronoi cells of particles whose positions are
+ * stored by the caller as (x,y,z) triplets, using the voro_compute template
+ * and the loop classes in the same way as the container class. */
+class container_view : public container_view_base, public radius_mono {
+	public:
+		container_view(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_);
+		/** Binds an array of particle positions to the container.
+		 * Particle i has its position at pos[stride*i], and this is
+		 * used as its ID. In periodic directions, particles outside
+		 * the container are remapped into the primary domain, and
+		 * their positions in the array are updated. In non-periodic
+		 * directions, particles outside the container are left out,
+		 * and a warning giving their number is printed.
+		 * \param[in] n the number of particles.
+		 * \param[in,out] pos the array of particle positions.
+		 * \param[in] stride the number of floating point numbers
+		 *                   between consecutive particles, which must
+		 *                   be at least 3.
+		 * \return The number of particles that are bound. */
+		inline int bind(int n,double *pos,int stride=3) {
+			return bind_blocks(n,pos,stride);
+		}
+		void compute_all_cells();
+		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+			return op.vol;
+		}
+		/** Dumps particle IDs and positions to a file.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_particles(c_loop &vl,FILE *fp) {
+			double *pp;
+			if(vl.start()) do {
+				pp=particle_pos(vl.ijk,vl.q);
+				fprintf(fp,"%d %g %g %g\n",id[vl.ijk][vl.q],*pp,pp[1],pp[2]);
+			} while(vl.inc());
+		}
+		/** Dumps all of the particle IDs and positions to a file.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_particles(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_particles(vl,fp);
+		}
+		/** Computes Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_cells_gnuplot(c_loop &vl,FILE *fp) {
+			voronoicell c(*this);double *pp;
+			if(vl.start()) do if(compute_cell(c,vl)) {
+				pp=particle_pos(vl.ijk,vl.q);
+				c.draw_gnuplot(*pp,pp[1],pp[2],fp);
+			} while(vl.inc());
+		}
+		/** Computes all Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_cells_gnuplot(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_cells_gnuplot(vl,fp);
+		}
+		/** Computes the Voronoi cells and saves customized information
+		 * about them. If more than one thread has been requested, the
+		 * output of each task of the block scheduler is formatted by
+		 * an ordered_writer, so that the output is the same as for a
+		 * serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_custom(c_loop &vl,const char *format,FILE *fp) {
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_custom(const char *format,FILE *fp=stdout);
+		void print_custom(const char *format,const char *filename);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl) {
+			return vc.compute_cell(c,vc.work,vl.ijk,vl.q,vl.i,vl.j,vl.k,particle_pos(vl.ijk,vl.q));
+		}
+		/** Computes the Voronoi cell for given particle.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			return compute_cell(c,ijk,q,vc.work);
+		}
+		/** Computes the Voronoi cell for given particle, using a given
+		 * workspace, so that several threads can call this routine at
+		 * once if each has its own workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,compute_workspace &ws) {
+			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
+			return vc.compute_cell(c,ws,ijk,q,i,j,k,particle_pos(ijk,q));
+		}
+	private:
+		voro_compute<container_view> vc;
+		friend class voro_compute<container_view>;
+};
+
+/** \brief Extension of the container_view_base class for computing radical
+ * Voronoi tessellations.
+ *
+ * This class computes the radical Voronoi cells of particles whose positions
+ * and radii are stored by the caller as (x,y,z,r) entries, using the
+ * voro_compute template and the loop classes in the same way as the
+ * container_poly class. */
+class container_view_poly : public container_view_base, public radius_view {
+	public:
+		container_view_poly(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_);
+		int bind(int n,double *pos,int stride=4);
+		void compute_all_cells();
+		double sum_cell_volumes();
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class, but does nothing with the output. If more
+		 * than one thread has been requested with set_threads(), then
+		 * the particles are divided into tasks by the block scheduler.
+		 * \param[in] vl the loop class to use. */
+		template<class c_loop>
+		void compute_all_cells(c_loop &vl) {
+			cell_op_compute op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		/** Calculates the Voronoi cells for all of the particles
+		 * visited by a loop class and sums their volumes. In the
+		 * multithreaded case, the volumes are summed task by task, so
+		 * the result may differ from the serial result by a roundoff
+		 * error.
+		 * \param[in] vl the loop class to use.
+		 * \return The sum of all of the computed Voronoi volumes. */
+		template<class c_loop>
+		double sum_cell_volumes(c_loop &vl) {
+			cell_op_volume op;
+			voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+			return op.vol;
+		}
+		/** Dumps particle IDs, positions and radii to a file.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_particles(c_loop &vl,FILE *fp) {
+			double *pp;
+			if(vl.start()) do {
+				pp=particle_pos(vl.ijk,vl.q);
+				fprintf(fp,"%d %g %g %g %g\n",id[vl.ijk][vl.q],*pp,pp[1],pp[2],pp[3]);
+			} while(vl.inc());
+		}
+		/** Dumps all of the particle IDs, positions and radii to a
+		 * file.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_particles(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_particles(vl,fp);
+		}
+		/** Computes Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void draw_cells_gnuplot(c_loop &vl,FILE *fp) {
+			voronoicell c(*this);double *pp;
+			if(vl.start()) do if(compute_cell(c,vl)) {
+				pp=particle_pos(vl.ijk,vl.q);
+				c.draw_gnuplot(*pp,pp[1],pp[2],fp);
+			} while(vl.inc());
+		}
+		/** Computes all Voronoi cells and saves the output in gnuplot
+		 * format.
+		 * \param[in] fp a file handle to write to. */
+		inline void draw_cells_gnuplot(FILE *fp=stdout) {
+			c_loop_all vl(*this);
+			draw_cells_gnuplot(vl,fp);
+		}
+		/** Computes the Voronoi cells and saves customized information
+		 * about them. If more than one thread has been requested, the
+		 * output of each task of the block scheduler is formatted by
+		 * an ordered_writer, so that the output is the same as for a
+		 * serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_loop>
+		void print_custom(c_loop &vl,const char *format,FILE *fp) {
+			custom_plan cp(format);
+			cell_op_custom op(cp,fp);
+			if(cp.neighbors) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_custom(const char *format,FILE *fp=stdout);
+		void print_custom(const char *format,const char *filename);
+		/** Computes the Voronoi cells and saves customized information
+		 * about them in the binary columnar format of the
+		 * column_writer class. In a multithreaded computation, the
+		 * cells of each task are buffered separately and appended to
+		 * the file in task order, so that the file is the same as for
+		 * a serial computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] cw the column writer to add the cells to. */
+		template<class c_loop>
+		void print_columns(c_loop &vl,column_writer &cw) {
+			cell_op_columns op(cw);
+			if(cw.neighbors()) voro_cell_loop<voronoicell_neighbor,compute_workspace>(*this,vl,op);
+			else voro_cell_loop<voronoicell,compute_workspace>(*this,vl,op);
+		}
+		void print_columns(const char *format,const char *filename,bool append=false);
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl) {
+			return vc.compute_cell(c,vc.work,vl.ijk,vl.q,vl.i,vl.j,vl.k,particle_pos(vl.ijk,vl.q));
+		}
+		/** Computes the Voronoi cell for given particle.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			return compute_cell(c,ijk,q,vc.work);
+		}
+		/** Computes the Voronoi cell for given particle, using a given
+		 * workspace, so that several threads can call this routine at
+		 * once if each has its own workspace.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q,compute_workspace &ws) {
+			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
+			return vc.compute_cell(c,ws,ijk,q,i,j,k,particle_pos(ijk,q));
+		}
+	private:
+		voro_compute<container_view_poly> vc;
+		friend class voro_compute<container_view_poly>;
+};
+
+}
+
+#endif
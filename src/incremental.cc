@@ -0,0 +1,171 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file incremental.cc
+ * \brief Function implementations for the voro_incremental class. */
+
+#include <algorithm>
+#include <utility>
+
+#include "incremental.hh"
+
+namespace voro {
+
+/** The class constructor initializes the cached data to be empty, so that
+ * every cell is computed with the full search the first time.
+ * \param[in] con_ a reference to the container to compute cells for.
+ * \param[in] skin_ the skin distance to add to the security radius of each
+ *                  list. */
+voro_incremental::voro_incremental(container &con_,double skin_)
+	: con(con_), skin(skin_), cached(0), full(0), mem(0), epoch(0), nref(0),
+	dmax(0), lx(con.xperiodic?con.bx-con.ax:0), ly(con.yperiodic?con.by-con.ay:0),
+	lz(con.zperiodic?con.bz-con.az:0), cur(NULL), ref(NULL), rep(NULL), lep(NULL),
+	lr(NULL), ld(NULL), ln(NULL), l(NULL) {
+	hl=large_number;
+	if(lx>0&&0.5*lx<hl) hl=0.5*lx;
+	if(ly>0&&0.5*ly<hl) hl=0.5*ly;
+	if(lz>0&&0.5*lz<hl) hl=0.5*lz;
+	if(skin<0) voro_fatal_error("Negative skin distance",VOROPP_INTERNAL_ERROR);
+}
+
+/** The class destructor frees the dynamically allocated memory. */
+voro_incremental::~voro_incremental() {
+	for(int i=0;i<mem;i++) if(l[i]!=NULL) delete [] l[i];
+	delete [] l;delete [] ln;delete [] ld;delete [] lr;
+	delete [] lep;delete [] rep;delete [] ref;delete [] cur;
+}
+
+/** Increases the number of particle IDs that the cached data can hold.
+ * \param[in] nmem the new number of IDs, which must be larger than the
+ *                 current number. */
+void voro_incremental::add_memory(int nmem) {
+	int i;
+	if(nmem>max_incremental_memory)
+		voro_fatal_error("Absolute maximum memory allocation exceeded",VOROPP_MEMORY_ERROR);
+#if VOROPP_VERBOSE >=3
+	fprintf(stderr,"Incremental particle memory scaled up to %d\n",nmem);
+#endif
+	double *ncur=new double[3*nmem],*nref=new double[3*nmem],*nlr=new double[nmem],*nld=new double[nmem];
+	int *nrep=new int[nmem],*nlep=new int[nmem],*nln=new int[nmem],**nl=new int*[nmem];
+	for(i=0;i<3*mem;i++) {ncur[i]=cur[i];nref[i]=ref[i];}
+	for(i=0;i<mem;i++) {
+		nlr[i]=lr[i];nld[i]=ld[i];nrep[i]=rep[i];
+		nlep[i]=lep[i];nln[i]=ln[i];nl[i]=l[i];
+	}
+	for(;i<nmem;i++) {nrep[i]=nlep[i]=-1;nln[i]=0;nl[i]=NULL;}
+	delete [] l;delete [] ln;delete [] ld;delete [] lr;
+	delete [] lep;delete [] rep;delete [] ref;delete [] cur;
+	cur=ncur;ref=nref;lr=nlr;ld=nld;rep=nrep;lep=nlep;ln=nln;l=nl;
+	mem=nmem;
+}
+
+/** Records the current positions of the particles in the container. This
+ * must be called after the particles have been changed, and before any cells
+ * are computed. If particles have been added or removed, or if any particle
+ * has moved more than a quarter of the skin distance from its reference
+ * position, then a new epoch is started, and every list is rebuilt the next
+ * time that its cell is computed. */
+void voro_incremental::update() {
+	int ijk,q,i,n=0,mid=mem-1;
+	bool fresh=false;
+	double dx,dy,dz,rs,mrs=0,*pp,*cp;
+
+	// Find the largest particle ID, and allocate enough memory to
+	// index the cached data by it
+	for(ijk=0;ijk<con.nxyz;ijk++) for(q=0;q<con.co[ijk];q++) {
+		i=con.id[ijk][q];
+		if(i<0) voro_fatal_error("Negative particle ID in incremental computation",VOROPP_INTERNAL_ERROR);
+		if(i>mid) mid=i;
+	}
+	if(mid>=mem) {
+		int nmem=mem==0?init_incremental_memory:mem;
+		while(nmem<=mid) nmem<<=1;
+		add_memory(nmem);
+	}
+
+	// Store the current positions, and find how far the particles have
+	// moved from their reference positions
+	for(ijk=0;ijk<con.nxyz;ijk++) for(q=0,pp=con.p[ijk];q<con.co[ijk];q++,pp+=3) {
+		i=con.id[ijk][q];n++;
+		cp=cur+3*i;*cp=*pp;cp[1]=pp[1];cp[2]=pp[2];
+		if(rep[i]!=epoch) fresh=true;
+		else {
+			dx=*pp-ref[3*i];dy=pp[1]-ref[3*i+1];dz=pp[2]-ref[3*i+2];
+			image(dx,dy,dz);
+			rs=dx*dx+dy*dy+dz*dz;
+			if(rs>mrs) mrs=rs;
+		}
+	}
+	dmax=sqrt(mrs);
+
+	// If the lists can no longer be trusted, then start a new epoch
+	// with the current positions as the reference
+	if(fresh||n!=nref||4*dmax>skin) {
+		epoch++;nref=n;dmax=0;
+		for(ijk=0;ijk<con.nxyz;ijk++) for(q=0;q<con.co[ijk];q++) {
+			i=con.id[ijk][q];rep[i]=epoch;
+			ref[3*i]=cur[3*i];ref[3*i+1]=cur[3*i+1];ref[3*i+2]=cur[3*i+2];
+		}
+	}
+}
+
+/** Invalidates all of the lists, so that every cell is computed with the full
+ * search the next time. The update() function must be called afterwards. */
+void voro_incremental::reset() {
+	for(int i=0;i<mem;i++) rep[i]=-1;
+	nref=-1;
+}
+
+/** Makes the list of particles that are within the security radius of a cell
+ * plus the skin distance. The neighbors of the cell are put first, and the
+ * particles are otherwise sorted by distance.
+ * \param[in] pid the ID of the particle.
+ * \param[in] pp a pointer to the position of the particle.
+ * \param[in] mrs the maximum radius squared of the particle's cell, as
+ *                returned by voronoicell_base::max_radius_squared().
+ * \param[in] nv the neighbors of the cell, which may be empty. */
+void voro_incremental::make_list(int pid,double *pp,double mrs,std::vector<int> &nv) {
+	double r=sqrt(mrs)+skin,x=*pp,y=pp[1],z=pp[2],dx,dy,dz,rs,sx,sy,sz,*qp;
+	int li,lj,lk,ui,uj,uk,ci,cj,ck,ai,aj,ak,ijk,q,i;
+	std::vector<std::pair<double,int> > v;
+	if(r>hl) r=hl;
+
+	// Find the range of blocks that could contain particles within the
+	// list radius
+	li=step_int((x-r-con.ax)*con.xsp);ui=step_int((x+r-con.ax)*con.xsp);
+	lj=step_int((y-r-con.ay)*con.ysp);uj=step_int((y+r-con.ay)*con.ysp);
+	lk=step_int((z-r-con.az)*con.zsp);uk=step_int((z+r-con.az)*con.zsp);
+	if(!con.xperiodic) {if(li<0) li=0;if(ui>=con.nx) ui=con.nx-1;}
+	if(!con.yperiodic) {if(lj<0) lj=0;if(uj>=con.ny) uj=con.ny-1;}
+	if(!con.zperiodic) {if(lk<0) lk=0;if(uk>=con.nz) uk=con.nz-1;}
+
+	// Scan the blocks, taking into account the periodic images
+	for(ck=lk;ck<=uk;ck++) {
+		ak=step_mod(ck,con.nz);sz=step_div(ck,con.nz)*lz-z;
+		for(cj=lj;cj<=uj;cj++) {
+			aj=step_mod(cj,con.ny);sy=step_div(cj,con.ny)*ly-y;
+			for(ci=li;ci<=ui;ci++) {
+				ai=step_mod(ci,con.nx);sx=step_div(ci,con.nx)*lx-x;
+				ijk=ai+con.nx*(aj+con.ny*ak);
+				for(q=0,qp=con.p[ijk];q<con.co[ijk];q++,qp+=3) {
+					dx=*qp+sx;dy=qp[1]+sy;dz=qp[2]+sz;
+					rs=dx*dx+dy*dy+dz*dz;
+					if(rs<r*r&&(i=con.id[ijk][q])!=pid)
+						v.push_back(std::make_pair(std::find(nv.begin(),nv.end(),i)!=nv.end()?rs-2*r*r:rs,i));
+				}
+			}
+		}
+	}
+	std::sort(v.begin(),v.end());
+
+	// Store the list
+	if(l[pid]!=NULL) delete [] l[pid];
+	l[pid]=new int[v.size()];
+	for(q=0;q<static_cast<int>(v.size());q++) l[pid][q]=v[q].second;
+	ln[pid]=v.size();lr[pid]=r;ld[pid]=dmax;lep[pid]=epoch;
+}
+
+}
@@ -0,0 +1,233 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file incremental.hh
+ * \brief Header file for the voro_incremental class. */
+
+#ifndef VOROPP_INCREMENTAL_HH
+#define VOROPP_INCREMENTAL_HH
+
+#include <cmath>
+#include <vector>
+
+#include "config.hh"
+#include "container.hh"
+#include "v_compute.hh"
+
+namespace voro {
+
+/** \brief A class for recomputing the Voronoi cells of a slowly evolving
+ * particle configuration.
+ *
+ * In a molecular dynamics trajectory, the particles move only a small distance
+ * between frames, so the particles that cut a given Voronoi cell barely
+ * change. When a cell is computed with the full search, this class caches the
+ * list of particles that are within the cell's security radius plus a skin
+ * distance. This list contains the cell's neighbors, and if these are
+ * tracked by the Voronoi cell class then they are put first, followed by the
+ * other particles in order of distance. This means that most of the other
+ * particles can be rejected quickly, since the cell is close to its final
+ * shape once the neighbors have been cut. On later frames, the cell is
+ * built by cutting only with the cached particles. The result is accepted if
+ * the new security radius, enlarged by the distance that the particles could
+ * have moved since the list was made, is still inside the cached region. In
+ * that case, every particle that could cut the cell is in the list, and the
+ * cell matches a full computation. Otherwise the cell is computed with the
+ * full search, and its list is rebuilt.
+ *
+ * The class works with the container class. The particle IDs must be
+ * non-negative and unique, and since the cached data is indexed by ID, they
+ * should be reasonably compact. After the particles in the container are
+ * changed, the update() function must be called before any cells are
+ * computed. */
+class voro_incremental {
+	public:
+		/** A reference to the container that the cells are computed
+		 * for. */
+		container &con;
+		/** The skin distance that is added to the security radius of
+		 * a cell when its list is made. Larger values let the lists
+		 * stay valid for more frames, but make each cell computation
+		 * test more particles. */
+		const double skin;
+		/** The number of cells that have been computed from the
+		 * cached lists. */
+		int cached;
+		/** The number of cells that have been computed with the full
+		 * search. */
+		int full;
+		voro_incremental(container &con_,double skin_);
+		~voro_incremental();
+		void update();
+		void reset();
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class, using the cached list if it is
+		 * still valid.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell,class c_loop>
+		inline bool compute_cell(v_cell &c,c_loop &vl) {
+			return compute_cell(c,vl,work);
+		}
+		/** Computes the Voronoi cell for a particle currently being
+		 * referenced by a loop class, using a given workspace for the
+		 * full search. Several threads can call this routine at once,
+		 * as long as each has its own workspace and they compute
+		 * different particles.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] ws the workspace to use.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell,class c_loop>
+		bool compute_cell(v_cell &c,c_loop &vl,compute_workspace &ws) {
+			int pid=vl.pid(),ca;
+			double *pp=con.p[vl.ijk]+3*vl.q;
+			if(lep[pid]==epoch) {
+				ca=compute_cached(c,pid,pp);
+				if(ca!=0) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+					cached++;
+					return ca==1;
+				}
+			}
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+			full++;
+			if(!con.compute_cell(c,vl,ws)) return false;
+			std::vector<int> nv;
+			cell_neighbors(c,nv);
+			make_list(pid,pp,c.max_radius_squared(),nv);
+			return true;
+		}
+	private:
+		/** The workspace used by the serial compute_cell routine. */
+		compute_workspace work;
+		/** The number of particle IDs that memory is allocated
+		 * for. */
+		int mem;
+		/** The current epoch. A new epoch starts whenever the
+		 * particles have moved too far from their reference positions,
+		 * or particles are added or removed, and all of the lists are
+		 * then invalidated. */
+		int epoch;
+		/** The number of particles when the current epoch started. */
+		int nref;
+		/** The maximum distance that a particle has moved from its
+		 * reference position. */
+		double dmax;
+		/** The lengths of the container in the periodic directions,
+		 * or zero for non-periodic directions. */
+		double lx,ly,lz;
+		/** Half of the shortest periodic length. Lists are never made
+		 * with a larger radius, so that each particle has at most one
+		 * periodic image that can cut a cell. */
+		double hl;
+		/** The current positions of the particles, indexed by ID. */
+		double *cur;
+		/** The reference positions of the particles at the start of
+		 * the epoch, indexed by ID. */
+		double *ref;
+		/** The epoch in which each particle's reference position was
+		 * recorded. */
+		int *rep;
+		/** The epoch in which each particle's list was made, or -1 if
+		 * it has no list. */
+		int *lep;
+		/** The radius of each particle's list. */
+		double *lr;
+		/** The maximum displacement from the reference positions at
+		 * the time that each list was made. */
+		double *ld;
+		/** The number of particles in each list. */
+		int *ln;
+		/** The IDs of the particles in each list. */
+		int **l;
+		void add_memory(int nmem);
+		void make_list(int pid,double *pp,double mrs,std::vector<int> &nv);
+		/** Returns the neighbors of a Voronoi cell, so that they can
+		 * be put at the start of its list. The voronoicell class does
+		 * not track neighbors, so the list is left empty.
+		 * \param[in] c the Voronoi cell.
+		 * \param[out] v the vector to store the neighbors in. */
+		inline void cell_neighbors(voronoicell &c,std::vector<int> &v) {v.clear();}
+		/** Returns the neighbors of a Voronoi cell, so that they can
+		 * be put at the start of its list.
+		 * \param[in] c the Voronoi cell.
+		 * \param[out] v the vector to store the neighbors in. */
+		inline void cell_neighbors(voronoicell_neighbor &c,std::vector<int> &v) {c.neighbors(v);}
+		/** Computes the integer part of a number, rounding down for
+		 * negative numbers. */
+		inline int step_int(double a) const {return a<0?int(a)-1:int(a);}
+		/** Computes the modulo of two integers, giving a positive
+		 * result for negative numbers. */
+		inline int step_mod(int a,int b) const {return a>=0?a%b:b-1-(b-1-a)%b;}
+		/** Computes the integer division of two integers, rounding
+		 * down for negative numbers. */
+		inline int step_div(int a,int b) const {return a>=0?a/b:-1+(a+1)/b;}
+		/** Applies the minimum image convention to a vector between
+		 * two particles in the periodic directions.
+		 * \param[in,out] (x,y,z) the vector. */
+		inline void image(double &x,double &y,double &z) const {
+			if(lx>0) {if(x>0.5*lx) x-=lx;else if(x<-0.5*lx) x+=lx;}
+			if(ly>0) {if(y>0.5*ly) y-=ly;else if(y<-0.5*ly) y+=ly;}
+			if(lz>0) {if(z>0.5*lz) z-=lz;else if(z<-0.5*lz) z+=lz;}
+		}
+		/** Computes a Voronoi cell by cutting it with the particles
+		 * in its cached list, and checks whether the result is
+		 * exact.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] pid the ID of the particle.
+		 * \param[in] pp a pointer to the position of the particle.
+		 * \return 1 if the cell was computed and is exact, -1 if the
+		 * cell was removed by a wall, and 0 if the cell must be
+		 * computed with the full search. */
+		template<class v_cell>
+		int compute_cached(v_cell &c,int pid,double *pp) {
+			int q,*lp=l[pid],*le=lp+ln[pid];
+			double x=*pp,y=pp[1],z=pp[2],dx,dy,dz,rs,mrs,*cp,r,h;
+
+			// Start with a cube that is small enough for the final
+			// check to fail if any of its faces are still part of
+			// the cell, clipped to the container and the walls
+			r=lr[pid]-2*(dmax+ld[pid]);
+			if(r<=0) return 0;
+			h=0.5*r;
+			c.init(lx>0||con.ax-x<-h?-h:con.ax-x,lx>0||con.bx-x>h?h:con.bx-x,
+			       ly>0||con.ay-y<-h?-h:con.ay-y,ly>0||con.by-y>h?h:con.by-y,
+			       lz>0||con.az-z<-h?-h:con.az-z,lz>0||con.bz-z>h?h:con.bz-z);
+			if(!con.apply_walls(c,x,y,z)) return -1;
+			mrs=c.max_radius_squared();
+			while(lp<le) {
+				q=*(lp++);cp=cur+3*q;
+				dx=*cp-x;dy=cp[1]-y;dz=cp[2]-z;
+				image(dx,dy,dz);
+				rs=dx*dx+dy*dy+dz*dz;
+				if(rs<mrs) {
+					if(!c.nplane(dx,dy,dz,rs,q)) return 0;
+					mrs=c.max_radius_squared();
+				}
+			}
+
+			// Check that every particle that could cut the cell
+			// was within the list
+			return mrs<r*r?1:0;
+		}
+};
+
+}
+
+#endif
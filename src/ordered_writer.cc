@@ -0,0 +1,170 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file ordered_writer.cc
+ * \brief Function implementations for the ordered_writer class. */
+
+#include <cstdlib>
+
+#include "ordered_writer.hh"
+#include "common.hh"
+
+namespace voro {
+
+/** The class constructor sets up the table of the file handles that the
+ * threads write to.
+ * \param[in] nt_ the number of threads that will write to the class. */
+ordered_writer::ordered_writer(int nt_) : nt(nt_<1?1:nt_), fp(NULL), tf(new FILE*[nt]) {
+	for(int t=0;t<nt;t++) tf[t]=NULL;
+#if VOROPP_MEMSTREAM ==1
+	nxt=0;
+#endif
+}
+
+#if VOROPP_MEMSTREAM ==1
+
+/** The class destructor closes any open memory streams and frees the memory
+ * buffers of any chunks that have not been written. */
+ordered_writer::~ordered_writer() {
+	for(int t=0;t<nt;t++) if(tf[t]!=NULL) fclose(tf[t]);
+	free_chunks();
+	delete [] tf;
+}
+
+/** Frees the memory buffers of any chunks that have not been written. */
+void ordered_writer::free_chunks() {
+	for(unsigned int ch=0;ch<cb.size();ch++) if(cb[ch]!=NULL) {
+		free(cb[ch]);
+		cb[ch]=NULL;
+	}
+}
+
+/** Sets the number of chunks that the output is divided into, and the file
+ * to write them to. Any previously recorded chunks are cleared.
+ * \param[in] nch the number of chunks.
+ * \param[in] fp_ the file handle to write to. */
+void ordered_writer::setup(int nch,FILE *fp_) {
+	free_chunks();
+	fp=fp_;
+	cb.assign(nch,(char*) NULL);
+	cl.assign(nch,0);
+	done.assign(nch,0);
+	nxt=0;
+}
+
+/** Starts writing a chunk of output, by opening a memory stream for it.
+ * \param[in] t the number of the thread writing the chunk.
+ * \param[in] ch the number of the chunk.
+ * \return A file handle that the output of the chunk should be written to. */
+FILE* ordered_writer::start_chunk(int t,int ch) {
+	tf[t]=open_memstream(&cb[ch],&cl[ch]);
+	if(tf[t]==NULL) voro_fatal_error("Unable to open memory stream for ordered output",VOROPP_MEMORY_ERROR);
+	return tf[t];
+}
+
+/** Finishes writing a chunk of output. The chunk, and any following chunks
+ * that are already finished, are written to the file if all of the chunks
+ * before them have been written. Several threads can call this routine at
+ * once.
+ * \param[in] t the number of the thread writing the chunk.
+ * \param[in] ch the number of the chunk. */
+void ordered_writer::end_chunk(int t,int ch) {
+	fclose(tf[t]);
+	tf[t]=NULL;
+#ifdef _OPENMP
+#pragma omp critical(voro_ordered_writer)
+#endif
+	{
+		done[ch]=1;
+		while(nxt<int(done.size())&&done[nxt]) {
+			fwrite(cb[nxt],1,cl[nxt],fp);
+			free(cb[nxt]);
+			cb[nxt++]=NULL;
+		}
+	}
+}
+
+/** Writes any remaining chunks to the file in order, skipping chunks that
+ * were never started. This should be called once all of the threads have
+ * finished. */
+void ordered_writer::finish() {
+	for(;nxt<int(done.size());nxt++) if(done[nxt]) {
+		fwrite(cb[nxt],1,cl[nxt],fp);
+		free(cb[nxt]);
+		cb[nxt]=NULL;
+	}
+}
+
+#else
+
+/** The class destructor closes the temporary files, which causes them to be
+ * removed. */
+ordered_writer::~ordered_writer() {
+	for(int t=0;t<nt;t++) if(tf[t]!=NULL) fclose(tf[t]);
+	delete [] tf;
+}
+
+/** Sets the number of chunks that the output is divided into, and the file
+ * to write them to. Any previously recorded chunks are cleared.
+ * \param[in] nch the number of chunks.
+ * \param[in] fp_ the file handle to write to. */
+void ordered_writer::setup(int nch,FILE *fp_) {
+	fp=fp_;
+	ct.assign(nch,-1);
+	cs.resize(nch);
+	ce.resize(nch);
+}
+
+/** Starts writing a chunk of output.
+ * \param[in] t the number of the thread writing the chunk.
+ * \param[in] ch the number of the chunk.
+ * \return A file handle that the output of the chunk should be written to. */
+FILE* ordered_writer::start_chunk(int t,int ch) {
+	if(tf[t]==NULL) {
+		tf[t]=tmpfile();
+		if(tf[t]==NULL) voro_fatal_error("Unable to open temporary file for ordered output",VOROPP_FILE_ERROR);
+	}
+	ct[ch]=t;
+	cs[ch]=ftell(tf[t]);
+	return tf[t];
+}
+
+/** Finishes writing a chunk of output.
+ * \param[in] t the number of the thread writing the chunk.
+ * \param[in] ch the number of the chunk. */
+void ordered_writer::end_chunk(int t,int ch) {
+	ce[ch]=ftell(tf[t]);
+}
+
+/** Copies all of the chunks to the file in order. This should be called once
+ * all of the threads have finished. */
+void ordered_writer::finish() {
+	const int bsize=65536;
+	char *buf=new char[bsize];
+	int t,ch;
+	long l;
+	size_t m;
+	for(t=0;t<nt;t++) if(tf[t]!=NULL) fflush(tf[t]);
+	for(ch=0;ch<(int) ct.size();ch++) {
+		if(ct[ch]<0) continue;
+		FILE *f=tf[ct[ch]];
+		fseek(f,cs[ch],SEEK_SET);
+		for(l=ce[ch]-cs[ch];l>0;l-=m) {
+			m=l<bsize?size_t(l):size_t(bsize);
+			if(fread(buf,1,m,f)!=m) voro_fatal_error("Unable to read temporary file for ordered output",VOROPP_FILE_ERROR);
+			fwrite(buf,1,m,fp);
+		}
+	}
+	delete [] buf;
+
+	// Move back to the end of each temporary file, so that the class can
+	// be used again
+	for(t=0;t<nt;t++) if(tf[t]!=NULL) fseek(tf[t],0,SEEK_END);
+}
+
+#endif
+
+}
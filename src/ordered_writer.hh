@@ -0,0 +1,82 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file ordered_writer.hh
+ * \brief Header file for the ordered_writer class. */
+
+#ifndef VOROPP_ORDERED_WRITER_HH
+#define VOROPP_ORDERED_WRITER_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+
+namespace voro {
+
+/** \brief A class for writing output from several threads in a fixed order.
+ *
+ * The output of a multithreaded computation is divided into numbered chunks,
+ * such as the tasks of a block_scheduler. Each thread formats the chunks that
+ * it carries out using the standard output routines, so the formatting is
+ * carried out in parallel, and the chunks are written to the output file in
+ * order, so that the output is the same as a serial computation would
+ * produce.
+ *
+ * If VOROPP_MEMSTREAM is set to 1, then each chunk is formatted into its own
+ * growable memory buffer with open_memstream(). When a chunk is finished, it
+ * is written to the file along with any following chunks that are already
+ * finished, and its buffer is freed. The file is therefore written while the
+ * computation is running, and only the chunks that are finished ahead of an
+ * unfinished one are held in memory. Otherwise, each thread formats its
+ * chunks into its own temporary file, and the chunks are copied to the
+ * output file in order once all of the threads have finished. */
+class ordered_writer {
+	public:
+		/** The number of threads that write to the class. */
+		const int nt;
+		ordered_writer(int nt_);
+		~ordered_writer();
+		void setup(int nch,FILE *fp_);
+		FILE* start_chunk(int t,int ch);
+		void end_chunk(int t,int ch);
+		void finish();
+	private:
+		/** The file handle to write to. */
+		FILE *fp;
+#if VOROPP_MEMSTREAM ==1
+		/** The memory stream that each thread is writing its current
+		 * chunk to, or NULL if the thread is not writing a chunk. */
+		FILE **tf;
+		/** The memory buffer holding the output of each chunk, or NULL
+		 * if the chunk has not been written or has been copied to the
+		 * file. */
+		std::vector<char*> cb;
+		/** The length of the output of each chunk. */
+		std::vector<size_t> cl;
+		/** Whether each chunk has been finished. */
+		std::vector<char> done;
+		/** The first chunk that has not been copied to the file. */
+		int nxt;
+		void free_chunks();
+#else
+		/** The temporary files that each thread writes to, which are
+		 * opened the first time that a thread starts a chunk. */
+		FILE **tf;
+		/** The thread that wrote each chunk, or -1 if the chunk has
+		 * not been written. */
+		std::vector<int> ct;
+		/** The offset of the start of each chunk within the file of
+		 * the thread that wrote it. */
+		std::vector<long> cs;
+		/** The offset of the end of each chunk. */
+		std::vector<long> ce;
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file particle_file.cc
+ * \brief Function implementations for the particle_file class. */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "particle_file.hh"
+#include "common.hh"
+
+#if VOROPP_MMAP ==1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace voro {
+
+const size_t particle_file::header_size;
+const unsigned int particle_file::version;
+
+/** The class constructor opens a binary particle file and checks its header.
+ * If the file cannot be read, or it is not a valid binary particle file, then
+ * the routine causes a fatal error.
+ * \param[in] filename the name of the file to read. */
+particle_file::particle_file(const char *filename) : buf(NULL), len(0), mapped(false) {
+	load(filename);
+
+	// Check the header
+	unsigned int hd[4];
+	if(len<header_size||memcmp(buf,"VORO++PF",8)!=0) {
+		fprintf(stderr,"voro++: File '%s' is not a binary particle file\n",filename);
+		exit(VOROPP_FILE_ERROR);
+	}
+	memcpy(hd,buf+8,4*sizeof(unsigned int));
+	if(*hd!=0x01020304u) {
+		fprintf(stderr,"voro++: Binary particle file '%s' has the wrong byte order\n",filename);
+		exit(VOROPP_FILE_ERROR);
+	}
+	if(hd[1]!=version) {
+		fprintf(stderr,"voro++: Binary particle file '%s' has unknown version %u\n",filename,hd[1]);
+		exit(VOROPP_FILE_ERROR);
+	}
+	n=int(hd[3]);ps=hd[2]&1?4:3;
+	if(n<0||len!=pos_offset(n)+sizeof(double)*ps*size_t(n)) {
+		fprintf(stderr,"voro++: Binary particle file '%s' has the wrong length\n",filename);
+		exit(VOROPP_FILE_ERROR);
+	}
+	id=reinterpret_cast<const int*>(buf+header_size);
+	pos=reinterpret_cast<const double*>(buf+pos_offset(n));
+}
+
+/** The class destructor unmaps or frees the file. */
+particle_file::~particle_file() {
+#if VOROPP_MMAP ==1
+	if(mapped) {
+		munmap(buf,len);
+		return;
+	}
+#endif
+	delete [] reinterpret_cast<double*>(buf);
+}
+
+/** Maps a file into memory, or reads it into a buffer if mapping is not
+ * available or fails.
+ * \param[in] filename the name of the file to read. */
+void particle_file::load(const char *filename) {
+#if VOROPP_MMAP ==1
+	int fd=open(filename,O_RDONLY);
+	if(fd<0) {
+		fprintf(stderr,"voro++: Unable to open file '%s'\n",filename);
+		exit(VOROPP_FILE_ERROR);
+	}
+	struct stat st;
+	if(fstat(fd,&st)==0&&st.st_size>0) {
+		len=size_t(st.st_size);
+		void *m=mmap(NULL,len,PROT_READ,MAP_PRIVATE,fd,0);
+		if(m!=MAP_FAILED) {
+			buf=static_cast<char*>(m);mapped=true;
+#ifdef MADV_SEQUENTIAL
+			madvise(m,len,MADV_SEQUENTIAL);
+#endif
+		}
+	}
+	close(fd);
+	if(mapped) return;
+#endif
+
+	// Read the file into a buffer of doubles, so that the positions are
+	// correctly aligned
+	FILE *fp=safe_fopen(filename,"rb");
+	fseek(fp,0,SEEK_END);
+	len=size_t(ftell(fp));
+	fseek(fp,0,SEEK_SET);
+	buf=reinterpret_cast<char*>(new double[(len+7)>>3]);
+	if(fread(buf,1,len,fp)!=len) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	fclose(fp);
+}
+
+/** Checks that the file contains radii if and only if they are required, and
+ * causes a fatal error otherwise.
+ * \param[in] radii whether radii are required.
+ * \param[in] filename the name of the file, used in the error message. */
+void particle_file::check_radii(bool radii,const char *filename) {
+	if((ps==4)!=radii) {
+		fprintf(stderr,"voro++: Binary particle file '%s' %s radii\n",filename,radii?"does not contain":"contains");
+		exit(VOROPP_FILE_ERROR);
+	}
+}
+
+/** Writes a list of particles to a file in the binary particle format.
+ * \param[in] filename the name of the file to write.
+ * \param[in] n the number of particles.
+ * \param[in] id an array of the n particle IDs.
+ * \param[in] pos an array holding the (x,y,z) position of each particle in
+ *                turn, or the (x,y,z,r) position and radius if radii are
+ *                written.
+ * \param[in] radii whether to write radii. */
+void particle_file::write(const char *filename,int n,const int *id,const double *pos,bool radii) {
+	unsigned int hd[4]={0x01020304u,version,radii?1u:0u,static_cast<unsigned int>(n)};
+	int ps=radii?4:3,pad=0;
+	FILE *fp=safe_fopen(filename,"wb");
+	fwrite("VORO++PF",1,8,fp);
+	fwrite(hd,sizeof(unsigned int),4,fp);
+	fwrite(id,sizeof(int),n,fp);
+	if(n&1) fwrite(&pad,sizeof(int),1,fp);
+	if(fwrite(pos,sizeof(double),size_t(ps)*n,fp)!=size_t(ps)*n)
+		voro_fatal_error("File output error",VOROPP_FILE_ERROR);
+	fclose(fp);
+}
+
+}
@@ -0,0 +1,83 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file particle_file.hh
+ * \brief Header file for the particle_file class, which reads the binary
+ * particle format. */
+
+#ifndef VOROPP_PARTICLE_FILE_HH
+#define VOROPP_PARTICLE_FILE_HH
+
+#include <cstddef>
+
+#include "config.hh"
+
+namespace voro {
+
+/** \brief A class for reading a file in the binary particle format.
+ *
+ * The binary particle format stores the same information as the text files
+ * read by the import() functions, in a layout that can be passed straight to
+ * the container classes without any parsing. All numbers are stored in the
+ * byte order of the machine that wrote the file, and the file has four
+ * parts:
+ *
+ * - A 24-byte header, made up of the eight characters "VORO++PF", followed by
+ *   four 32-bit integers: the byte-order mark 0x01020304, the format version,
+ *   the flags, and the number of particles n. If bit 0 of the flags is set,
+ *   then the file contains particle radii.
+ * - An array of n 32-bit integers holding the particle IDs.
+ * - Zero padding to the next multiple of eight bytes, which is four bytes if
+ *   n is odd and none otherwise.
+ * - An array of double precision numbers holding the (x,y,z) position of each
+ *   particle in turn, or the (x,y,z,r) position and radius if the file
+ *   contains radii.
+ *
+ * The class maps the file into memory with mmap() where this is available,
+ * so that the positions are read directly from the page cache. Otherwise the
+ * file is read into a buffer. Files written on a machine with a different
+ * byte order are rejected. */
+class particle_file {
+	public:
+		/** The number of particles in the file. */
+		int n;
+		/** The number of floating point numbers stored for each
+		 * particle, which is 3, or 4 if the file contains radii. */
+		int ps;
+		/** A pointer to the particle IDs. */
+		const int *id;
+		/** A pointer to the particle positions, and radii if present.
+		 */
+		const double *pos;
+		particle_file(const char *filename);
+		~particle_file();
+		void check_radii(bool radii,const char *filename);
+		static void write(const char *filename,int n,const int *id,const double *pos,bool radii);
+		/** Returns the offset of the positions from the start of a
+		 * file.
+		 * \param[in] n the number of particles.
+		 * \return The offset in bytes. */
+		static inline size_t pos_offset(int n) {
+			return header_size+((size_t(n)*sizeof(int)+7)&~size_t(7));
+		}
+		/** The size of the header, in bytes. */
+		static const size_t header_size=24;
+		/** The version of the format that is written. */
+		static const unsigned int version=1;
+	private:
+		/** A pointer to the start of the file in memory. */
+		char *buf;
+		/** The length of the file, in bytes. */
+		size_t len;
+		/** Whether the file is mapped, in which case it is unmapped
+		 * by the destructor, rather than being freed. */
+		bool mapped;
+		void load(const char *filename);
+};
+
+}
+
+#endif
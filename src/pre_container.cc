@@ -9,9 +9,12 @@
  */
 
 #include <cmath>
+#include <vector>
 
 #include "config.hh"
 #include "pre_container.hh"
+#include "particle_file.hh"
+#include "text_import.hh"
 
 namespace voro {
 
@@ -29,7 +32,8 @@ namespace voro {
 pre_container_base::pre_container_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
 	bool xperiodic_,bool yperiodic_,bool zperiodic_,int ps_) :
 	ax(ax_), bx(bx_), ay(ay_), by(by_), az(az_), bz(bz_),
-	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_), ps(ps_),
+	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_),
+	opt(optimal_particles), fx(1), fy(1), fz(1), tune_time(0), tune_spread(0), ps(ps_),
 	index_sz(init_chunk_size), pre_id(new int*[index_sz]), end_id(pre_id),
 	pre_p(new double*[index_sz]), end_p(pre_p) {
 		ch_id=*end_id=new int[pre_container_chunk_size];
@@ -51,15 +55,142 @@ pre_container_base::~pre_container_base() {
 	delete [] pre_id;
 }
 
-/** Makes a guess at the optimal grid of blocks to use, computing in
- * a way that
+/** Makes a guess at the optimal grid of blocks to use, choosing the block
+ * size so that each block contains opt particles on average, and scaling the
+ * block lengths by the factors fx, fy, and fz.
  * \param[out] (nx,ny,nz) the number of blocks to use. */
 void pre_container_base::guess_optimal(int &nx,int &ny,int &nz) {
 	double dx=bx-ax,dy=by-ay,dz=bz-az;
-	double ilscale=pow(total_particles()/(optimal_particles*dx*dy*dz),1/3.0);
-	nx=int(dx*ilscale+1);
-	ny=int(dy*ilscale+1);
-	nz=int(dz*ilscale+1);
+	double ilscale=pow(total_particles()/(opt*dx*dy*dz),1/3.0);
+	nx=int(dx*ilscale/fx+1);
+	ny=int(dy*ilscale/fy+1);
+	nz=int(dz*ilscale/fz+1);
+}
+
+/** Estimates the number of particles per block from the particle
+ * distribution. The particles are binned into a coarse grid with around
+ * tune_bin_particles in each bin, and the geometric mean of the density that
+ * each particle sees is measured. For a clustered distribution, or one that
+ * only fills part of the container, this is larger than the mean density,
+ * since most particles are in the denser regions. The number of particles per
+ * block is reduced by the ratio of the two, so that the blocks in the regions
+ * where most of the cells are computed have around optimal_particles in them.
+ * The block shape factors are reset to one. */
+void pre_container_base::sample_optimal() {
+	int nx,ny,nz,i,j,k,n=total_particles();
+	double **c_p=pre_p,*pp,*pe,xs,ys,zs,s=0,r;
+	opt=tune_bin_particles;fx=fy=fz=1;
+	if(n>0) {
+		guess_optimal(nx,ny,nz);
+		std::vector<int> cnt(nx*ny*nz,0);
+		xs=nx/(bx-ax);ys=ny/(by-ay);zs=nz/(bz-az);
+		while(c_p<=end_p) {
+			pp=*c_p;pe=c_p==end_p?ch_p:pp+ps*pre_container_chunk_size;
+			for(c_p++;pp<pe;pp+=ps) {
+				i=sample_index(*pp-ax,xs,nx);
+				j=sample_index(pp[1]-ay,ys,ny);
+				k=sample_index(pp[2]-az,zs,nz);
+				cnt[i+nx*(j+ny*k)]++;
+			}
+		}
+		for(i=0;i<nx*ny*nz;i++) if(cnt[i]>0) s+=cnt[i]*log(double(cnt[i]));
+		r=exp(s/n)*nx*ny*nz/n;
+	} else r=1;
+	opt=r>1?optimal_particles/r:optimal_particles;
+}
+
+/** Tunes the number of particles per block, and optionally the block shape,
+ * by timing the computation of a subset of the cells. The tuning starts from
+ * the estimate of sample_optimal(), and changes the number of particles per
+ * block by tune_factor in whichever direction is faster, for as long as the
+ * time keeps decreasing. If anisotropic blocks are requested, then the blocks
+ * are then stretched and compressed along each axis in turn by tune_stretch.
+ * Each trial is repeated, and a change is only kept if it is faster by more
+ * than the spread of the repeated timings, so that timing noise does not
+ * change the grid. For the block shape, the required reduction is multiplied
+ * by tune_aniso_margin.
+ * \param[in] aniso whether to search for anisotropic block shapes. */
+void pre_container_base::tune_optimal(bool aniso) {
+	int nx,ny,nz;
+	sample_optimal();
+	guess_optimal(nx,ny,nz);
+	tune_time=trial(nx,ny,nz);
+	tune_spread=trial_spread;
+	if(try_setting(opt*tune_factor,fx,fy,fz)) {
+		while(try_setting(opt*tune_factor,fx,fy,fz));
+	} else while(try_setting(opt/tune_factor,fx,fy,fz));
+	if(aniso) {
+		double s=tune_stretch,is=1/sqrt(s),m=tune_aniso_margin;
+		if(!try_setting(opt,fx*s,fy*is,fz*is,m)) try_setting(opt,fx/s,fy/is,fz/is,m);
+		if(!try_setting(opt,fx*is,fy*s,fz*is,m)) try_setting(opt,fx/is,fy/s,fz/is,m);
+		if(!try_setting(opt,fx*is,fy*is,fz*s,m)) try_setting(opt,fx/is,fy/is,fz/s,m);
+	}
+}
+
+/** Carries out a trial of a grid setting, and keeps it if it is clearly
+ * faster than the current one. The reduction in time must be larger than the
+ * sum of the spreads of the two trials' repeated timings, and at least a
+ * fraction tune_threshold of the current time, and both are multiplied by a
+ * given margin.
+ * \param[in] o the number of particles per block.
+ * \param[in] (gx,gy,gz) the block shape factors.
+ * \param[in] margin the factor to multiply the required reduction by.
+ * \return True if the setting was kept, false if it was not clearly faster
+ *         or gave the same grid as the current setting. */
+bool pre_container_base::try_setting(double o,double gx,double gy,double gz,double margin) {
+	int nx,ny,nz,mx,my,mz;
+	double so=opt,sx=fx,sy=fy,sz=fz,t,d;
+	guess_optimal(mx,my,mz);
+	opt=o;fx=gx;fy=gy;fz=gz;
+	guess_optimal(nx,ny,nz);
+	if(nx!=mx||ny!=my||nz!=mz) {
+		t=trial(nx,ny,nz);
+#if VOROPP_VERBOSE >=3
+		fprintf(stderr,"Grid trial %d %d %d: %g s per cell, spread %g s\n",nx,ny,nz,t,trial_spread);
+#endif
+		d=tune_spread+trial_spread;
+		if(d<tune_threshold*tune_time) d=tune_threshold*tune_time;
+		if(t<tune_time-margin*d) {
+			tune_time=t;tune_spread=trial_spread;
+			return true;
+		}
+	}
+	opt=so;fx=sx;fy=sy;fz=sz;
+	return false;
+}
+
+/** Prints the grid setting, so that it can be recorded and reused for
+ * similar datasets.
+ * \param[in] fp the file handle to write to. */
+void pre_container_base::print_tuning(FILE *fp) {
+	int nx,ny,nz;
+	guess_optimal(nx,ny,nz);
+	fprintf(fp,"Particles per block : %g\n"
+		   "Block shape factors : %g %g %g\n"
+		   "Grid size           : %d %d %d\n",opt,fx,fy,fz,nx,ny,nz);
+	if(tune_time>0) fprintf(fp,"Time per cell       : %g s (spread %g s)\n",tune_time,tune_spread);
+}
+
+/** Sets up a container with a trial grid, transfers the particles to it, and
+ * times the computation of a subset of the cells.
+ * \param[in] (nx,ny,nz) the number of blocks to use.
+ * \return The time per cell in seconds. */
+double pre_container::trial(int nx,int ny,int nz) {
+	container con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,8);
+	particle_order vo;
+	setup(vo,con);
+	return time_cells(con,vo);
+}
+
+/** Sets up a container_poly with a trial grid, transfers the particles to it,
+ * and times the computation of a subset of the cells.
+ * \param[in] (nx,ny,nz) the number of blocks to use.
+ * \return The time per cell in seconds. */
+double pre_container_poly::trial(int nx,int ny,int nz) {
+	container_poly con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,8);
+	particle_order vo;
+	setup(vo,con);
+	return time_cells(con,vo);
 }
 
 /** Stores a particle ID and position, allocating a new memory chunk if
@@ -188,10 +319,11 @@ void pre_container_poly::setup(particle_order &vo,container_poly &con) {
  * causes a fatal error.
  * \param[in] fp the file handle to read from. */
 void pre_container::import(FILE *fp) {
-	int i,j;
-	double x,y,z;
-	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(i,x,y,z);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,4,1);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=3) put(ti.id[i],*pp,pp[1],pp[2]);
+	}
 }
 
 /** Import a list of particles from an open file stream, also storing the order
@@ -200,10 +332,35 @@ void pre_container::import(FILE *fp) {
  * successfully read, then the routine causes a fatal error.
  * \param[in] fp the file handle to read from. */
 void pre_container_poly::import(FILE *fp) {
-	int i,j;
-	double x,y,z,r;
-	while((j=fscanf(fp,"%d %lg %lg %lg %lg",&i,&x,&y,&z,&r))==5) put(i,x,y,z,r);
-	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	text_importer ti(fp,5,1);
+	while(ti.next()) {
+		const double *pp=&ti.pos[0];
+		for(int i=0;i<ti.n;i++,pp+=4) put(ti.id[i],*pp,pp[1],pp[2],pp[3]);
+	}
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * which is described in the particle_file class. The file is mapped into
+ * memory, and the particles are added without any parsing. If the file cannot
+ * be read, or it contains radii, then the routine causes a fatal error.
+ * \param[in] filename the name of the file to read from. */
+void pre_container::import_binary(const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(false,filename);
+	const double *pp=pf.pos;
+	for(int i=0;i<pf.n;i++,pp+=pf.ps) put(pf.id[i],*pp,pp[1],pp[2]);
+}
+
+/** Imports a list of particles from a file in the binary particle format,
+ * which is described in the particle_file class. The file is mapped into
+ * memory, and the particles are added without any parsing. If the file cannot
+ * be read, or it does not contain radii, then the routine causes a fatal error.
+ * \param[in] filename the name of the file to read from. */
+void pre_container_poly::import_binary(const char *filename) {
+	particle_file pf(filename);
+	pf.check_radii(true,filename);
+	const double *pp=pf.pos;
+	for(int i=0;i<pf.n;i++,pp+=pf.ps) put(pf.id[i],*pp,pp[1],pp[2],pp[3]);
 }
 
 /** Allocates a new chunk of memory for storing particles. */
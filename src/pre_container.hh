@@ -11,6 +11,7 @@
 #define VOROPP_PRE_CONTAINER_HH
 
 #include <cstdio>
+#include <ctime>
 
 #include "c_loops.hh"
 #include "container.hh"
@@ -25,6 +26,13 @@ namespace voro {
  * container class can be set up with the optimal grid size, and the particles
  * can be transferred.
  *
+ * The grid is chosen to give a certain number of particles per block. This
+ * number can be estimated from the particle distribution with
+ * sample_optimal(), or tuned with tune_optimal() by timing the computation of
+ * a subset of the cells for several trial grids. The chosen values are kept
+ * in public variables, so that they can be recorded and reused for similar
+ * datasets.
+ *
  * The pre_container_base class is not intended for direct use, but forms the
  * base of the pre_container and pre_container_poly classes, that add routines
  * depending on whether particle radii need to be tracked or not. */
@@ -51,9 +59,34 @@ class pre_container_base {
 		/** A boolean value that determines if the z coordinate in
 		 * periodic or not. */
 		const bool zperiodic;
+		/** The number of particles per block that guess_optimal()
+		 * aims for. This is initially set to optimal_particles, and is
+		 * changed by sample_optimal() and tune_optimal(). */
+		double opt;
+		/** The factor by which the block length in the x direction is
+		 * scaled. The three factors multiply to one, so that they
+		 * change the block shape but not the block volume. */
+		double fx;
+		/** The factor by which the block length in the y direction is
+		 * scaled. */
+		double fy;
+		/** The factor by which the block length in the z direction is
+		 * scaled. */
+		double fz;
+		/** The time per cell of the best trial carried out by
+		 * tune_optimal(), or zero if no trials have been carried
+		 * out. */
+		double tune_time;
+		/** The spread of the repeated timings of the best trial, as
+		 * the difference between the longest and shortest time per
+		 * cell. */
+		double tune_spread;
 		void guess_optimal(int &nx,int &ny,int &nz);
+		void sample_optimal();
+		void tune_optimal(bool aniso=false);
+		void print_tuning(FILE *fp=stdout);
 		pre_container_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,int ps_);
-		~pre_container_base();
+		virtual ~pre_container_base();
 		/** Calculates and returns the total number of particles stored
 		 * within the class.
 		 * \return The number of particles. */
@@ -91,6 +124,59 @@ class pre_container_base {
 		/** A pointer to the next available slot on the current
 		 * floating point chunk. */
 		double *ch_p;
+		/** The spread of the repeated timings of the most recent
+		 * trial, per cell. */
+		double trial_spread;
+		/** Sets up a container with a trial grid, transfers the
+		 * particles to it, and times the computation of a subset of
+		 * the cells.
+		 * \param[in] (nx,ny,nz) the number of blocks to use.
+		 * \return The time per cell in seconds. */
+		virtual double trial(int nx,int ny,int nz)=0;
+		/** Times the computation of a subset of the cells in a
+		 * container. The cells are taken at a fixed stride through
+		 * the order in which the particles were stored, so that each
+		 * trial computes the same cells. The computation is repeated
+		 * tune_repeats times, and the shortest time is used. The
+		 * difference between the longest and shortest times is stored
+		 * in trial_spread.
+		 * \param[in] con the container to use.
+		 * \param[in] vo the order in which the particles were stored.
+		 * \return The time per cell in seconds. */
+		template<class c_class>
+		double time_cells(c_class &con,particle_order &vo) {
+			int k,n=0,stride=total_particles()/tune_samples+1;
+			double t,tb=large_number,tw=0;
+			voronoicell c(con);
+			c_loop_order vl(con,vo);
+			for(int r=0;r<tune_repeats;r++) {
+				clock_t t0=clock();
+				k=n=0;
+				if(vl.start()) do if(k++%stride==0) {
+					con.compute_cell(c,vl);n++;
+				} while(vl.inc());
+				t=double(clock()-t0)/CLOCKS_PER_SEC;
+				if(t<tb) tb=t;
+				if(t>tw) tw=t;
+			}
+			trial_spread=n>0?(tw-tb)/n:0;
+			return n>0?tb/n:0;
+		}
+	private:
+		bool try_setting(double o,double gx,double gy,double gz,double margin=1);
+		/** Computes the block that a coordinate is in when binning the
+		 * particles, wrapping it into range.
+		 * \param[in] x the coordinate relative to the container
+		 *              minimum.
+		 * \param[in] xs the number of blocks per unit length.
+		 * \param[in] n the number of blocks.
+		 * \return The block index. */
+		inline int sample_index(double x,double xs,int n) {
+			int i=int(x*xs);
+			if(x<0) i--;
+			i%=n;
+			return i<0?i+n:i;
+		}
 };
 
 /** \brief A class for storing an arbitrary number of particles without radius
@@ -121,8 +207,11 @@ class pre_container : public pre_container_base {
 			import(fp);
 			fclose(fp);
 		}
+		void import_binary(const char *filename);
 		void setup(container &con);
 		void setup(particle_order &vo,container &con);
+	protected:
+		double trial(int nx,int ny,int nz);
 };
 
 /** \brief A class for storing an arbitrary number of particles with radius
@@ -153,8 +242,11 @@ class pre_container_poly : public pre_container_base {
 			import(fp);
 			fclose(fp);
 		}
+		void import_binary(const char *filename);
 		void setup(container_poly &con);
 		void setup(particle_order &vo,container_poly &con);
+	protected:
+		double trial(int nx,int ny,int nz);
 };
 
 }
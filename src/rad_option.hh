@@ -12,9 +12,28 @@
 #define VOROPP_RAD_OPTION_HH
 
 #include <cmath>
+#include <cstddef>
 
 namespace voro {
 
+/** \brief Structure for holding the radius-dependent constants of the cell
+ * currently being computed.
+ *
+ * The radical Voronoi computation needs several constants that depend on the
+ * radius of the particle whose cell is being computed. These are kept in this
+ * structure, which is owned by the voro_compute class rather than by the
+ * container, so that several cells can be computed at the same time by
+ * separate voro_compute objects. */
+struct radius_record {
+	/** The radius squared of the particle being computed. */
+	double r_rad;
+	/** The difference between r_rad and the square of the maximum
+	 * particle radius. */
+	double r_mul;
+	/** A scaling factor used during plane bounds checks. */
+	double r_val;
+};
+
 /** \brief Class containing all of the routines that are specific to computing
  * the regular Voronoi tessellation.
  *
@@ -25,27 +44,38 @@ class radius_mono {
 	protected:
 		/** This is called prior to computing a Voronoi cell for a
 		 * given particle to initialize any required constants.
-		 * \param[in] ijk the block that the particle is within.
-		 * \param[in] s the index of the particle within the block. */
-		inline void r_init(int ijk,int s) {}
+		 * \param[out] rr the record in which to store the constants.
+		 * \param[in] pp a pointer to the particle's position. */
+		inline void r_init(radius_record &rr,double *pp) {}
 		/** Sets a required constant to be used when carrying out a
-		 * plane bounds check. */
-		inline void r_prime(double rv) {}
+		 * plane bounds check.
+		 * \param[in,out] rr the record in which to store the constant. */
+		inline void r_prime(radius_record &rr,double rv) {}
 		/** Carries out a radius bounds check.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in] crs the radius squared to be tested.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
 		 * \return True if particles at this radius could not possibly
 		 * cut the cell, false otherwise. */
-		inline bool r_ctest(double crs,double mrs) {return crs>mrs;}
+		inline bool r_ctest(radius_record &rr,double crs,double mrs) {return crs>mrs;}
 		/** Scales a plane displacement during a plane bounds check.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in] lrs the plane displacement.
 		 * \return The scaled value. */
-		inline double r_cutoff(double lrs) {return lrs;}
+		inline double r_cutoff(radius_record &rr,double lrs) {return lrs;}
 		/** Adds the maximum radius squared to a given value.
 		 * \param[in] rs the value to consider.
 		 * \return The value with the radius squared added. */
 		inline double r_max_add(double rs) {return rs;}
+		/** Returns the smallest amount that the squared radius of the
+		 * cell's particle minus that of another particle can be,
+		 * which lowers the distance at which the other particle can
+		 * cut the cell.
+		 * \param[in] rr the radius information for the cell.
+		 * \return The amount, which is zero in the monodisperse
+		 * case. */
+		inline double r_min_shift(radius_record &rr) {return 0;}
 		/** Subtracts the radius squared of a particle from a given
 		 * value.
 		 * \param[in] rs the value to consider.
@@ -55,14 +85,16 @@ class radius_mono {
 		inline double r_current_sub(double rs,int ijk,int q) {return rs;}
 		/** Scales a plane displacement prior to use in the plane cutting
 		 * algorithm.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in] rs the initial plane displacement.
 		 * \param[in] ijk the block that the particle is within.
 		 * \param[in] q the index of the particle within the block.
 		 * \return The scaled plane displacement. */
-		inline double r_scale(double rs,int ijk,int q) {return rs;}
+		inline double r_scale(radius_record &rr,double rs,int ijk,int q) {return rs;}
 		/** Scales a plane displacement prior to use in the plane
 		 * cutting algorithm, and also checks if it could possibly cut
 		 * the cell.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in,out] rs the plane displacement to be scaled.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
@@ -70,7 +102,7 @@ class radius_mono {
 		 * \param[in] q the index of the particle within the block.
 		 * \return True if the cell could possibly cut the cell, false
 		 * otherwise. */
-		inline bool r_scale_check(double &rs,double mrs,int ijk,int q) {return rs<mrs;}
+		inline bool r_scale_check(radius_record &rr,double &rs,double mrs,int ijk,int q) {return rs<mrs;}
 };
 
 /**  \brief Class containing all of the routines that are specific to computing
@@ -93,30 +125,45 @@ class radius_poly {
 	protected:
 		/** This is called prior to computing a Voronoi cell for a
 		 * given particle to initialize any required constants.
-		 * \param[in] ijk the block that the particle is within.
-		 * \param[in] s the index of the particle within the block. */
-		inline void r_init(int ijk,int s) {
-			r_rad=ppr[ijk][4*s+3]*ppr[ijk][4*s+3];
-			r_mul=r_rad-max_radius*max_radius;
+		 * If the particle is larger than any in the container, which
+		 * can happen for ghost particles, then its radius is used as
+		 * the maximum radius.
+		 * \param[out] rr the record in which to store the constants.
+		 * \param[in] pp a pointer to the particle's position and
+		 *               radius. */
+		inline void r_init(radius_record &rr,double *pp) {
+			double mr=pp[3]>max_radius?pp[3]:max_radius;
+			rr.r_rad=pp[3]*pp[3];
+			rr.r_mul=rr.r_rad-mr*mr;
 		}
 		/** Sets a required constant to be used when carrying out a
-		 * plane bounds check. */
-		inline void r_prime(double rv) {r_val=1+r_mul/rv;}
+		 * plane bounds check.
+		 * \param[in,out] rr the record in which to store the constant. */
+		inline void r_prime(radius_record &rr,double rv) {rr.r_val=1+rr.r_mul/rv;}
 		/** Carries out a radius bounds check.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in] crs the radius squared to be tested.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
 		 * \return True if particles at this radius could not possibly
 		 * cut the cell, false otherwise. */
-		inline bool r_ctest(double crs,double mrs) {return crs+r_mul>sqrt(mrs*crs);}
+		inline bool r_ctest(radius_record &rr,double crs,double mrs) {return crs+rr.r_mul>sqrt(mrs*crs);}
 		/** Scales a plane displacement during a plane bounds check.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in] lrs the plane displacement.
 		 * \return The scaled value. */
-		inline double r_cutoff(double lrs) {return lrs*r_val;}
+		inline double r_cutoff(radius_record &rr,double lrs) {return lrs*rr.r_val;}
 		/** Adds the maximum radius squared to a given value.
 		 * \param[in] rs the value to consider.
 		 * \return The value with the radius squared added. */
 		inline double r_max_add(double rs) {return rs+max_radius*max_radius;}
+		/** Returns the smallest amount that the squared radius of the
+		 * cell's particle minus that of another particle can be,
+		 * which lowers the distance at which the other particle can
+		 * cut the cell.
+		 * \param[in] rr the radius information for the cell.
+		 * \return The amount. */
+		inline double r_min_shift(radius_record &rr) {return rr.r_mul;}
 		/** Subtracts the radius squared of a particle from a given
 		 * value.
 		 * \param[in] rs the value to consider.
@@ -128,16 +175,18 @@ class radius_poly {
 		}
 		/** Scales a plane displacement prior to use in the plane cutting
 		 * algorithm.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in] rs the initial plane displacement.
 		 * \param[in] ijk the block that the particle is within.
 		 * \param[in] q the index of the particle within the block.
 		 * \return The scaled plane displacement. */
-		inline double r_scale(double rs,int ijk,int q) {
-			return rs+r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
+		inline double r_scale(radius_record &rr,double rs,int ijk,int q) {
+			return rs+rr.r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
 		}
 		/** Scales a plane displacement prior to use in the plane
 		 * cutting algorithm, and also checks if it could possibly cut
 		 * the cell.
+		 * \param[in] rr the constants for the cell being computed.
 		 * \param[in,out] rs the plane displacement to be scaled.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
@@ -145,13 +194,118 @@ class radius_poly {
 		 * \param[in] q the index of the particle within the block.
 		 * \return True if the cell could possibly cut the cell, false
 		 * otherwise. */
-		inline bool r_scale_check(double &rs,double mrs,int ijk,int q) {
+		inline bool r_scale_check(radius_record &rr,double &rs,double mrs,int ijk,int q) {
 			double trs=rs;
-			rs+=r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
+			rs+=rr.r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
+			return rs<sqrt(mrs*trs);
+		}
+};
+
+
+/** \brief Class containing the radical Voronoi routines for containers that
+ * read their particles from a caller-owned array.
+ *
+ * This is the same as the radius_poly class, except that the radius of a
+ * particle is looked up through the block's index list into an external array
+ * with a fixed stride. The container_view_poly class is derived from this
+ * class. */
+class radius_view {
+	public:
+		/** A pointer to the radius of the first particle in the
+		 * external array. */
+		double *vrp;
+		/** The number of floating point numbers between the radii of
+		 * consecutive particles in the external array. */
+		int vrs;
+		/** The index lists of the blocks, giving the position of each
+		 * particle in the external array. */
+		int **vid;
+		/** The current maximum radius of any particle, used to
+		 * determine when to cut off the radical Voronoi computation.
+		 * */
+		double max_radius;
+		/** The class constructor sets the maximum particle radius to
+		 * be zero. */
+		radius_view() : vrp(NULL), vrs(0), vid(NULL), max_radius(0) {}
+	protected:
+		/** Returns the radius of a particle.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return The radius. */
+		inline double r_look(int ijk,int q) {return vrp[vrs*vid[ijk][q]];}
+		/** This is called prior to computing a Voronoi cell for a
+		 * given particle to initialize any required constants.
+		 * \param[out] rr the record in which to store the constants.
+		 * \param[in] pp a pointer to the particle's position and
+		 *               radius. */
+		inline void r_init(radius_record &rr,double *pp) {
+			double mr=pp[3]>max_radius?pp[3]:max_radius;
+			rr.r_rad=pp[3]*pp[3];
+			rr.r_mul=rr.r_rad-mr*mr;
+		}
+		/** Sets a required constant to be used when carrying out a
+		 * plane bounds check.
+		 * \param[in,out] rr the record in which to store the constant. */
+		inline void r_prime(radius_record &rr,double rv) {rr.r_val=1+rr.r_mul/rv;}
+		/** Carries out a radius bounds check.
+		 * \param[in] rr the constants for the cell being computed.
+		 * \param[in] crs the radius squared to be tested.
+		 * \param[in] mrs the current maximum distance to a Voronoi
+		 *                vertex multiplied by two.
+		 * \return True if particles at this radius could not possibly
+		 * cut the cell, false otherwise. */
+		inline bool r_ctest(radius_record &rr,double crs,double mrs) {return crs+rr.r_mul>sqrt(mrs*crs);}
+		/** Scales a plane displacement during a plane bounds check.
+		 * \param[in] rr the constants for the cell being computed.
+		 * \param[in] lrs the plane displacement.
+		 * \return The scaled value. */
+		inline double r_cutoff(radius_record &rr,double lrs) {return lrs*rr.r_val;}
+		/** Adds the maximum radius squared to a given value.
+		 * \param[in] rs the value to consider.
+		 * \return The value with the radius squared added. */
+		inline double r_max_add(double rs) {return rs+max_radius*max_radius;}
+		/** Returns the smallest amount that the squared radius of the
+		 * cell's particle minus that of another particle can be.
+		 * \param[in] rr the radius information for the cell.
+		 * \return The amount. */
+		inline double r_min_shift(radius_record &rr) {return rr.r_mul;}
+		/** Subtracts the radius squared of a particle from a given
+		 * value.
+		 * \param[in] rs the value to consider.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return The value with the radius squared subtracted. */
+		inline double r_current_sub(double rs,int ijk,int q) {
+			double r=r_look(ijk,q);
+			return rs-r*r;
+		}
+		/** Scales a plane displacement prior to use in the plane cutting
+		 * algorithm.
+		 * \param[in] rr the constants for the cell being computed.
+		 * \param[in] rs the initial plane displacement.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return The scaled plane displacement. */
+		inline double r_scale(radius_record &rr,double rs,int ijk,int q) {
+			double r=r_look(ijk,q);
+			return rs+rr.r_rad-r*r;
+		}
+		/** Scales a plane displacement prior to use in the plane
+		 * cutting algorithm, and also checks if it could possibly cut
+		 * the cell.
+		 * \param[in] rr the constants for the cell being computed.
+		 * \param[in,out] rs the plane displacement to be scaled.
+		 * \param[in] mrs the current maximum distance to a Voronoi
+		 *                vertex multiplied by two.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return True if the cell could possibly cut the cell, false
+		 * otherwise. */
+		inline bool r_scale_check(radius_record &rr,double &rs,double mrs,int ijk,int q) {
+			double trs=rs,r=r_look(ijk,q);
+			rs+=rr.r_rad-r*r;
 			return rs<sqrt(mrs*trs);
 		}
-	private:
-		double r_rad,r_mul,r_val;
 };
 
 }
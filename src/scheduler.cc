@@ -0,0 +1,172 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file scheduler.cc
+ * \brief Function implementations for the block_scheduler class. */
+
+#include <ctime>
+
+#include "scheduler.hh"
+
+namespace voro {
+
+/** Returns the current wall clock time in seconds. If OpenMP is not available,
+ * the processor time is used instead.
+ * \return The time. */
+static inline double sched_time() {
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return double(clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+/** The class constructor sets up an empty scheduler for a single thread. */
+block_scheduler::block_scheduler() : nt(0), ntasks(0) {
+#ifdef _OPENMP
+	lk=NULL;
+#endif
+}
+
+/** The class destructor frees the locks used by the task lists. */
+block_scheduler::~block_scheduler() {
+#ifdef _OPENMP
+	if(lk!=NULL) {
+		for(int t=0;t<nt;t++) omp_destroy_lock(lk+t);
+		delete [] lk;
+	}
+#endif
+}
+
+/** Groups the particle ranges into tasks of roughly equal cost, splitting any
+ * range that is larger than a single task, and then gives each thread a
+ * contiguous set of tasks.
+ * \param[in] co the array of the number of particles in each block, used to
+ *               estimate the cost of each particle.
+ * \param[in] nt_ the number of threads to divide the tasks between. */
+void block_scheduler::make_tasks(int *co,int nt_) {
+	int l,n=ra.size()/3,m,q,qn;
+	double cw,w=0,tot=0;
+
+	// Compute the total cost, and the target cost of each task
+	for(l=0;l<n;l++) {
+		cw=co[ra[3*l]];if(cw<1) cw=1;
+		tot+=cw*(ra[3*l+2]-ra[3*l+1]);
+	}
+	if(nt_<1) nt_=1;
+	double target=tot/(nt_*tasks_per_thread);
+
+	// Assemble the tasks, splitting any range whose cost is bigger than
+	// the target
+	std::vector<int> nra;
+	nra.reserve(ra.size());
+	ta.clear();tw.clear();
+	for(l=0;l<n;l++) {
+		int *rp=&ra[3*l];
+		cw=co[*rp];if(cw<1) cw=1;
+		m=int(target/cw);if(m<1) m=1;
+		for(q=rp[1];q<rp[2];q=qn) {
+			qn=q+m;if(qn>rp[2]) qn=rp[2];
+			if(w==0) ta.push_back(nra.size()/3);
+			nra.push_back(*rp);nra.push_back(q);nra.push_back(qn);
+			w+=cw*(qn-q);
+			if(w>=target) {tw.push_back(w);w=0;}
+		}
+	}
+	if(w>0) tw.push_back(w);
+	ntasks=ta.size();
+	ta.push_back(nra.size()/3);
+	ra.swap(nra);
+
+	// Set up the per-thread arrays and locks
+#ifdef _OPENMP
+	int t;
+	if(lk!=NULL) {
+		for(t=0;t<nt;t++) omp_destroy_lock(lk+t);
+		delete [] lk;
+	}
+	lk=new omp_lock_t[nt_];
+	for(t=0;t<nt_;t++) omp_init_lock(lk+t);
+#endif
+	nt=nt_;
+	qs.resize(nt);qe.resize(nt);
+	busy.resize(nt);tcount.resize(nt);scount.resize(nt);tst.resize(nt);
+	restart();
+}
+
+/** Hands the tasks out to the threads again and clears the timing statistics,
+ * so that the same set of tasks can be carried out a second time. Each thread
+ * is given a contiguous set of tasks whose total cost is as close as possible
+ * to an equal share. */
+void block_scheduler::restart() {
+	int t,tk=0;
+	double tot=0,cum=0;
+	for(t=0;t<ntasks;t++) tot+=tw[t];
+	for(t=0;t<nt;t++) {
+		qs[t]=tk;
+		while(tk<ntasks&&cum+0.5*tw[tk]<tot*(t+1)/nt) cum+=tw[tk++];
+		if(t==nt-1) tk=ntasks;
+		qe[t]=tk;
+		busy[t]=0;tcount[t]=scount[t]=0;tst[t]=-1;
+	}
+}
+
+/** Finds the next task for a thread to carry out. The thread first takes the
+ * next task from its own list. If that is empty, it steals the last task from
+ * the list of another thread. The time since the previous call is added to
+ * the thread's busy time.
+ * \param[in] t the number of the thread.
+ * \param[out] tk the task to carry out.
+ * \return True if a task was found, false if all of the tasks have been
+ * handed out. */
+bool block_scheduler::next_task(int t,int &tk) {
+	double now=sched_time();
+	if(tst[t]>=0) busy[t]+=now-tst[t];
+	tst[t]=-1;
+
+	// Try to take a task from the start of the thread's own list
+#ifdef _OPENMP
+	omp_set_lock(lk+t);
+#endif
+	bool found=qs[t]<qe[t];
+	if(found) tk=qs[t]++;
+#ifdef _OPENMP
+	omp_unset_lock(lk+t);
+#endif
+
+	// Otherwise, try to steal a task from the end of another thread's
+	// list, starting with the next thread along
+	for(int u=1;!found&&u<nt;u++) {
+		int v=(t+u)%nt;
+#ifdef _OPENMP
+		omp_set_lock(lk+v);
+#endif
+		if(qs[v]<qe[v]) {tk=--qe[v];found=true;scount[t]++;}
+#ifdef _OPENMP
+		omp_unset_lock(lk+v);
+#endif
+	}
+	if(!found) return false;
+	tcount[t]++;
+	tst[t]=now;
+	return true;
+}
+
+/** Prints the number of tasks carried out by each thread and the time that it
+ * spent on them, followed by the load imbalance, which is the maximum busy
+ * time divided by the mean busy time.
+ * \param[in] fp the file handle to write to. */
+void block_scheduler::print_report(FILE *fp) {
+	double tot=0,mx=0;
+	for(int t=0;t<nt;t++) {
+		fprintf(fp,"Thread %d: %d tasks (%d stolen), busy %g s\n",t,tcount[t],scount[t],busy[t]);
+		tot+=busy[t];
+		if(busy[t]>mx) mx=busy[t];
+	}
+	fprintf(fp,"Total tasks: %d, load imbalance: %g\n",ntasks,tot>0?mx*nt/tot:1);
+}
+
+}
@@ -0,0 +1,123 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file scheduler.hh
+ * \brief Header file for the block_scheduler class. */
+
+#ifndef VOROPP_SCHEDULER_HH
+#define VOROPP_SCHEDULER_HH
+
+#include <cstdio>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "config.hh"
+
+namespace voro {
+
+/** \brief A class for dividing the cells visited by a loop into tasks, and
+ * handing them out to threads with work stealing.
+ *
+ * The block_scheduler class is used by the multithreaded container routines.
+ * It first walks through a loop class, recording the particles that it visits
+ * as ranges of consecutive particles within a single block. The ranges are
+ * then grouped into tasks of roughly equal estimated cost. The cost of
+ * computing a cell is taken to be proportional to the number of particles in
+ * its block, since the neighboring blocks that need to be searched have a
+ * similar density. Large blocks are split between several tasks.
+ *
+ * Each thread is initially given a contiguous set of tasks with roughly equal
+ * total cost. Threads take tasks from the start of their own list, and once
+ * it is empty, they steal tasks from the end of the lists of other threads.
+ * The class records the time that each thread spends carrying out tasks, so
+ * that the load balance can be examined after a computation. */
+class block_scheduler {
+	public:
+		/** The number of threads that the tasks are divided between. */
+		int nt;
+		/** The total number of tasks. */
+		int ntasks;
+		/** The list of particle ranges. Each range is made up of three
+		 * integers: the block index, and the indices of the first
+		 * particle and one past the last particle. */
+		std::vector<int> ra;
+		/** The index of the first range in each task. The array has
+		 * ntasks+1 entries, with the last one marking the end of the
+		 * range list. */
+		std::vector<int> ta;
+		/** The estimated cost of each task. */
+		std::vector<double> tw;
+		/** The time that each thread has spent carrying out tasks. */
+		std::vector<double> busy;
+		/** The number of tasks carried out by each thread. */
+		std::vector<int> tcount;
+		/** The number of tasks that each thread has stolen from
+		 * other threads. */
+		std::vector<int> scount;
+		block_scheduler();
+		~block_scheduler();
+		/** Records the particles visited by a loop class and divides
+		 * them into tasks.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] nt_ the number of threads to divide the tasks
+		 *                between. */
+		template<class c_loop>
+		void setup(c_loop &vl,int nt_) {
+			int n;
+			ra.clear();
+			if(vl.start()) do {
+				n=ra.size();
+				if(n>0&&ra[n-1]==vl.q&&ra[n-3]==vl.ijk) ra[n-1]++;
+				else {
+					ra.push_back(vl.ijk);
+					ra.push_back(vl.q);ra.push_back(vl.q+1);
+				}
+			} while(vl.inc());
+			make_tasks(vl.co,nt_);
+		}
+		void restart();
+		bool next_task(int t,int &tk);
+		/** Returns a pointer to the first particle range of a task.
+		 * \param[in] tk the task to consider.
+		 * \return The pointer. */
+		inline int* task_begin(int tk) {return &ra[0]+3*ta[tk];}
+		/** Returns a pointer to the end of the particle ranges of a
+		 * task.
+		 * \param[in] tk the task to consider.
+		 * \return The pointer. */
+		inline int* task_end(int tk) {return &ra[0]+3*ta[tk+1];}
+		/** Returns the number of the calling thread, or zero if the
+		 * code has been compiled without OpenMP support. */
+		static inline int thread_num() {
+#ifdef _OPENMP
+			return omp_get_thread_num();
+#else
+			return 0;
+#endif
+		}
+		void print_report(FILE *fp=stdout);
+	private:
+		void make_tasks(int *co,int nt_);
+		/** The index of the next task to be taken by each thread. */
+		std::vector<int> qs;
+		/** The index one past the last task owned by each thread. */
+		std::vector<int> qe;
+		/** The start time of the task that each thread is currently
+		 * carrying out, or a negative value if the thread has no
+		 * task. */
+		std::vector<double> tst;
+#ifdef _OPENMP
+		/** The locks protecting the task list of each thread. */
+		omp_lock_t *lk;
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file tessellation.cc
+ * \brief Function implementations for the tessellation class. */
+
+#include "tessellation.hh"
+
+namespace voro {
+
+/** The class constructor sets up an empty tessellation. */
+tessellation::tessellation() {
+	clear();
+}
+
+/** Removes all of the stored cells. */
+void tessellation::clear() {
+	id.clear();pos.clear();vol.clear();
+	pts.clear();fv.clear();ne.clear();
+	vo.assign(1,0);fo.assign(1,0);fvo.assign(1,0);
+}
+
+/** Computes and stores the Voronoi cells of all of the particles in a
+ * container.
+ * \param[in] con the container to use. */
+void tessellation::compute(container &con) {
+	c_loop_all vl(con);
+	compute(con,vl);
+}
+
+/** Computes and stores the Voronoi cells of all of the particles in a
+ * container.
+ * \param[in] con the container to use. */
+void tessellation::compute(container_poly &con) {
+	c_loop_all vl(con);
+	compute(con,vl);
+}
+
+/** Computes and stores the Voronoi cells of all of the particles in a
+ * container.
+ * \param[in] con the container to use. */
+void tessellation::compute(container_periodic &con) {
+	c_loop_all_periodic vl(con);
+	compute(con,vl);
+}
+
+/** Computes and stores the Voronoi cells of all of the particles in a
+ * container.
+ * \param[in] con the container to use. */
+void tessellation::compute(container_periodic_poly &con) {
+	c_loop_all_periodic vl(con);
+	compute(con,vl);
+}
+
+/** Adds a computed Voronoi cell to the end of the tables.
+ * \param[in] c the Voronoi cell.
+ * \param[in] pid the ID of the particle.
+ * \param[in] pp a pointer to the position of the particle.
+ * \param[in] (v,w) scratch vectors to use for the cell's output. */
+void tessellation::add_cell(voronoicell_neighbor &c,int pid,double *pp,std::vector<int> &v,std::vector<double> &w) {
+	id.push_back(pid);
+	pos.push_back(*pp);pos.push_back(pp[1]);pos.push_back(pp[2]);
+	vol.push_back(c.volume());
+
+	// Store the vertices in absolute coordinates
+	c.vertices(*pp,pp[1],pp[2],w);
+	pts.insert(pts.end(),w.begin(),w.end());
+	vo.push_back(int(pts.size()/3));
+
+	// Store the faces. The face_vertices routine gives the order of each
+	// face followed by its vertices, and the neighbors routine gives the
+	// faces in the same order.
+	c.face_vertices(v);
+	for(unsigned int k=0;k<v.size();k+=v[k]+1) {
+		fv.insert(fv.end(),v.begin()+k+1,v.begin()+k+1+v[k]);
+		fvo.push_back(fv.size());
+	}
+	c.neighbors(v);
+	ne.insert(ne.end(),v.begin(),v.end());
+	fo.push_back(ne.size());
+}
+
+/** Adds the cells of another tessellation to the end of this one.
+ * \param[in] t the tessellation to add. */
+void tessellation::append(tessellation &t) {
+	int vb=vo.back(),fb=fo.back(),fvb=fvo.back();
+	unsigned int k;
+	id.insert(id.end(),t.id.begin(),t.id.end());
+	pos.insert(pos.end(),t.pos.begin(),t.pos.end());
+	vol.insert(vol.end(),t.vol.begin(),t.vol.end());
+	pts.insert(pts.end(),t.pts.begin(),t.pts.end());
+	fv.insert(fv.end(),t.fv.begin(),t.fv.end());
+	ne.insert(ne.end(),t.ne.begin(),t.ne.end());
+	for(k=1;k<t.vo.size();k++) vo.push_back(vb+t.vo[k]);
+	for(k=1;k<t.fo.size();k++) fo.push_back(fb+t.fo[k]);
+	for(k=1;k<t.fvo.size();k++) fvo.push_back(fvb+t.fvo[k]);
+}
+
+/** Sums the volumes of the stored cells.
+ * \return The total volume. */
+double tessellation::total_volume() {
+	double s=0;
+	for(unsigned int i=0;i<vol.size();i++) s+=vol[i];
+	return s;
+}
+
+/** Computes the memory used by the tables.
+ * \return The number of bytes used, including any spare capacity in the
+ *         vectors. */
+size_t tessellation::memory_used() {
+	return sizeof(int)*(id.capacity()+vo.capacity()+fo.capacity()+fvo.capacity()+fv.capacity()+ne.capacity())
+	      +sizeof(double)*(pos.capacity()+vol.capacity()+pts.capacity());
+}
+
+/** Prints the sizes of the tables and the memory that they use.
+ * \param[in] fp the file handle to write to. */
+void tessellation::print_stats(FILE *fp) {
+	fprintf(fp,"Cells              : %d\n"
+		   "Vertices           : %d\n"
+		   "Faces              : %d\n"
+		   "Face vertices      : %d\n"
+		   "Bytes used         : %lu\n",cells(),vo.back(),fo.back(),
+		fvo.back(),static_cast<unsigned long>(memory_used()));
+}
+
+}
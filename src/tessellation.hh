@@ -0,0 +1,142 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file tessellation.hh
+ * \brief Header file for the tessellation class. */
+
+#ifndef VOROPP_TESSELLATION_HH
+#define VOROPP_TESSELLATION_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+#include "cell.hh"
+#include "c_loops.hh"
+#include "container.hh"
+#include "container_prd.hh"
+
+namespace voro {
+
+/** \brief A class for storing all of the Voronoi cells of a container.
+ *
+ * The container classes compute each Voronoi cell into a voronoicell class
+ * that is overwritten by the next computation, so a program that analyzes the
+ * cells in several ways must compute them several times. This class computes
+ * every cell once and stores them in flat arrays in compressed sparse row
+ * format. Cell i has vertices vo[i] to vo[i+1]-1, whose absolute coordinates
+ * are stored in pts, and faces fo[i] to fo[i+1]-1. Face f has the neighbor
+ * ID ne[f], and the vertices fv[fvo[f]] to fv[fvo[f+1]-1], which are indices
+ * into the vertices of its cell, ordered counterclockwise when viewed from
+ * outside the cell. The cells are stored in the order that the loop visits
+ * them, and the result of a multithreaded computation is identical to that of
+ * a serial one. */
+class tessellation {
+	public:
+		/** The IDs of the particles. */
+		std::vector<int> id;
+		/** The positions of the particles, three per cell. */
+		std::vector<double> pos;
+		/** The volumes of the cells. */
+		std::vector<double> vol;
+		/** The offsets of the cells into the vertex table, with an
+		 * extra entry for the end of the last cell. */
+		std::vector<int> vo;
+		/** The absolute coordinates of the vertices, three per
+		 * vertex. */
+		std::vector<double> pts;
+		/** The offsets of the cells into the face tables, with an
+		 * extra entry for the end of the last cell. */
+		std::vector<int> fo;
+		/** The offsets of the faces into the face vertex list, with
+		 * an extra entry for the end of the last face. */
+		std::vector<int> fvo;
+		/** The vertices of the faces, as indices into the vertices of
+		 * their cell. */
+		std::vector<int> fv;
+		/** The IDs of the neighboring particles or walls for each
+		 * face. */
+		std::vector<int> ne;
+		tessellation();
+		void clear();
+		void compute(container &con);
+		void compute(container_poly &con);
+		void compute(container_periodic &con);
+		void compute(container_periodic_poly &con);
+		/** Computes the Voronoi cells for all of the particles visited
+		 * by a loop class and stores them, replacing any cells that
+		 * were stored before. If more than one thread has been
+		 * requested with the container's set_threads() routine, then
+		 * the tasks of the block scheduler are stored into separate
+		 * tessellations, which are then joined in task order.
+		 * \param[in] con the container to use.
+		 * \param[in] vl the loop class to use. */
+		template<class c_class,class c_loop>
+		void compute(c_class &con,c_loop &vl) {
+			clear();
+			if(con.nthreads>1) {
+				setup_images(con);
+				block_scheduler sched;
+				sched.setup(vl,con.nthreads);
+				std::vector<tessellation> tt(sched.ntasks);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(con.nthreads)
+#endif
+				{
+					compute_workspace ws;
+					voronoicell_neighbor c(con);
+					std::vector<int> v;
+					std::vector<double> w;
+					int t=sched.thread_num(),tk,*rp,*re,q;
+					while(sched.next_task(t,tk))
+						for(rp=sched.task_begin(tk),re=sched.task_end(tk);rp<re;rp+=3)
+							for(q=rp[1];q<rp[2];q++) if(con.compute_cell(c,*rp,q,ws))
+								tt[tk].add_cell(c,con.id[*rp][q],con.p[*rp]+con.ps*q,v,w);
+				}
+				for(unsigned int tk=0;tk<tt.size();tk++) append(tt[tk]);
+			} else {
+				voronoicell_neighbor c(con);
+				std::vector<int> v;
+				std::vector<double> w;
+				if(vl.start()) do if(con.compute_cell(c,vl))
+					add_cell(c,vl.pid(),con.p[vl.ijk]+con.ps*vl.q,v,w);
+				while(vl.inc());
+			}
+		}
+		void append(tessellation &t);
+		double total_volume();
+		size_t memory_used();
+		void print_stats(FILE *fp=stdout);
+		/** Returns the number of cells that are stored. */
+		inline int cells() {return id.size();}
+		/** Returns the number of vertices of a cell.
+		 * \param[in] i the index of the cell. */
+		inline int vertices(int i) {return vo[i+1]-vo[i];}
+		/** Returns the number of faces of a cell.
+		 * \param[in] i the index of the cell. */
+		inline int faces(int i) {return fo[i+1]-fo[i];}
+		/** Returns the number of vertices of a face.
+		 * \param[in] f the index of the face in the face tables. */
+		inline int face_order(int f) {return fvo[f+1]-fvo[f];}
+		/** Returns a pointer to the coordinates of a vertex.
+		 * \param[in] i the index of the cell.
+		 * \param[in] k the index of the vertex within the cell. */
+		inline double *vertex(int i,int k) {return &pts[3*(vo[i]+k)];}
+	private:
+		void add_cell(voronoicell_neighbor &c,int pid,double *pp,std::vector<int> &v,std::vector<double> &w);
+		/** Prepares a non-periodic container for a multithreaded
+		 * computation, which requires no work. */
+		inline void setup_images(container_base &con) {}
+		/** Creates all of the periodic images in a periodic container,
+		 * so that the cells can be computed by several threads at
+		 * once.
+		 * \param[in] con the container. */
+		inline void setup_images(container_periodic_base &con) {con.create_all_images();}
+};
+
+}
+
+#endif
@@ -0,0 +1,257 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file text_import.cc
+ * \brief Function implementations for the text_importer class. */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "text_import.hh"
+#include "common.hh"
+#include "scheduler.hh"
+
+namespace voro {
+
+/** The powers of ten that can be represented exactly, which are used by the
+ * fast number conversion. */
+static const double tenpow[23]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,
+	1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+/** The class constructor allocates the buffer.
+ * \param[in] fp_ the file handle to read from.
+ * \param[in] nf_ the number of numbers in each record, including the ID.
+ * \param[in] nt_ the number of threads to use. */
+text_importer::text_importer(FILE *fp_,int nf_,int nt_) : n(0), fp(fp_), nf(nf_),
+	nt(nt_<1?1:nt_), buf(new char[import_buffer_size+1]), mem(import_buffer_size),
+	len(0), eof(false), ph(0) {
+#ifndef _OPENMP
+	nt=1;
+#endif
+}
+
+/** The class destructor frees the buffer. */
+text_importer::~text_importer() {
+	delete [] buf;
+}
+
+/** Reads the next group of particles from the file. If the file contains a
+ * number that cannot be read, or it ends partway through a record, then the
+ * routine causes a fatal error.
+ * \return True if some particles were read, false if the end of the file has
+ * been reached. */
+bool text_importer::next() {
+	int cut;
+	n=0;
+	while(n==0) {
+		if(eof&&len==0) {
+			if(ph>0) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+			return false;
+		}
+		cut=fill();
+		parse(cut);
+		memmove(buf,buf+cut,len-cut);
+		len-=cut;
+	}
+	return true;
+}
+
+/** Fills the buffer from the file, and finds where to cut it so that no
+ * number is split. If the buffer is full and contains no whitespace, its size
+ * is doubled.
+ * \return The number of bytes to parse. */
+int text_importer::fill() {
+	int c;
+	while(true) {
+		if(!eof) {
+			len+=int(fread(buf+len,1,mem-len,fp));
+			if(len<mem) {
+				if(ferror(fp)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+				eof=true;
+			}
+		}
+		if(eof) return len;
+		for(c=len;c>0&&!is_ws(buf[c-1]);c--);
+		if(c>0) return c;
+		char *nbuf=new char[2*mem+1];
+		memcpy(nbuf,buf,len);
+		delete [] buf;
+		buf=nbuf;mem<<=1;
+	}
+}
+
+/** Parses the numbers at the start of the buffer, and assembles them into
+ * particle records, keeping any numbers of an incomplete record for the next
+ * buffer.
+ * \param[in] cut the number of bytes to parse. */
+void text_importer::parse(int cut) {
+	int t,k,tot;
+	std::vector<int> b(nt+1),o(nt+1,0);
+	std::vector<char> irr(nt,0);
+	buf[len]=0;
+
+	// Divide the buffer between the threads at whitespace, so that no
+	// number is split between two threads
+	b[0]=0;b[nt]=cut;
+	for(t=1;t<nt;t++) {
+		k=int(double(cut)*t/nt);
+		if(k<b[t-1]) k=b[t-1];
+		while(k<cut&&!is_ws(buf[k])) k++;
+		b[t]=k;
+	}
+
+	// Count the numbers in each part, and then parse them, using their
+	// positions to find which ones are IDs
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		int lt=block_scheduler::thread_num(),c=0;
+		const char *p=buf+b[lt],*e=buf+b[lt+1];
+		for(;p<e;p++) if(!is_ws(*p)&&(p==buf||is_ws(p[-1]))) c++;
+		o[lt+1]=c;
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+		{
+			for(int l=0;l<nt;l++) o[l+1]+=o[l];
+			f.resize(o[nt]);
+		}
+
+		const char *q;char *qe;
+		int g=o[lt];
+		double v;
+		p=buf+b[lt];
+		while(true) {
+			while(p<e&&is_ws(*p)) p++;
+			if(p==e) break;
+			for(q=p;q<e&&!is_ws(*q);q++);
+			if((ph+g)%nf==0) {
+				if(!fast_int(p,q,v)) {v=int(strtol(p,&qe,10));if(qe!=q) irr[lt]=1;}
+			} else if(!fast_double(p,q,v)) {v=strtod(p,&qe);if(qe!=q) irr[lt]=1;}
+			f[g++]=v;p=q;
+		}
+	}
+
+	// If any number was not followed by whitespace, then parse the buffer
+	// again in the same way as fscanf()
+	for(t=0;t<nt;t++) if(irr[t]) {
+		f.clear();
+		scan(buf,buf+cut,ph);
+		break;
+	}
+
+	// Assemble the records
+	tot=ph+int(f.size());n=tot/nf;
+	id.resize(n);pos.resize(n*(nf-1));
+	double *fp0=f.empty()?NULL:&f[0];
+	if(n>0) {
+		double *pp=&pos[0];
+		for(k=0;k<ph;k++) if(k==0) id[0]=int(*pend); else pp[k-1]=pend[k];
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt)
+#endif
+		for(int r=0;r<n;r++) {
+			for(int l=(r==0?ph:0);l<nf;l++) {
+				double w=fp0[r*nf+l-ph];
+				if(l==0) id[r]=int(w); else pp[r*(nf-1)+l-1]=w;
+			}
+		}
+	}
+	double tp[8];
+	for(k=n*nf;k<tot;k++) tp[k-n*nf]=k<ph?pend[k]:fp0[k-ph];
+	ph=tot-n*nf;
+	for(k=0;k<ph;k++) pend[k]=tp[k];
+}
+
+/** Parses a region of the buffer in the same way as a loop of fscanf() calls,
+ * which accept numbers that are not separated by whitespace. If a number
+ * cannot be read, then the routine causes a fatal error.
+ * \param[in] (p,e) the start and end of the region.
+ * \param[in] s the position within a record of the first number. */
+void text_importer::scan(const char *p,const char *e,int s) {
+	char *q;
+	while(true) {
+		while(p<e&&is_ws(*p)) p++;
+		if(p==e) return;
+		if(s%nf==0) f.push_back(int(strtol(p,&q,10)));
+		else {
+			f.push_back(strtod(p,&q));
+
+			// The C library's fscanf() also consumes an exponent
+			// marker and sign with no digits after them, which
+			// strtod() leaves in place
+			if(q>p&&(*q=='e'||*q=='E')&&(q[-1]=='.'||(q[-1]>='0'&&q[-1]<='9'))) {
+				q++;
+				if(*q=='+'||*q=='-') q++;
+			}
+		}
+		if(q==p) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+		p=q;s++;
+	}
+}
+
+/** Converts a decimal number of up to fifteen significant digits with a
+ * small exponent. In this case the digits and the power of ten are both
+ * exactly representable, so a single multiplication or division gives the
+ * correctly rounded result, which is the same as strtod().
+ * \param[in] (p,e) the start and end of the number.
+ * \param[out] v the converted number.
+ * \return True if the number was converted, false if it must be converted by
+ * strtod(). */
+bool text_importer::fast_double(const char *p,const char *e,double &v) {
+	bool neg=false,dig=false;
+	int nd=0,ex=0,ee=0;
+	double m=0;
+	if(p<e&&(*p=='-'||*p=='+')) neg=*(p++)=='-';
+	for(;p<e&&*p>='0'&&*p<='9';p++) {
+		dig=true;
+		if(m==0&&*p=='0') continue;
+		if(++nd>15) return false;
+		m=10*m+(*p-'0');
+	}
+	if(p<e&&*p=='.') for(p++;p<e&&*p>='0'&&*p<='9';p++) {
+		dig=true;ex--;
+		if(m==0&&*p=='0') continue;
+		if(++nd>15) return false;
+		m=10*m+(*p-'0');
+	}
+	if(!dig) return false;
+	if(p<e&&(*p=='e'||*p=='E')) {
+		bool eneg=false;
+		if(++p<e&&(*p=='-'||*p=='+')) eneg=*(p++)=='-';
+		if(p==e) return false;
+		for(;p<e&&*p>='0'&&*p<='9';p++) if(ee<1000) ee=10*ee+(*p-'0');
+		ex+=eneg?-ee:ee;
+	}
+	if(p!=e) return false;
+	if(m==0) {v=neg?-0.:0.;return true;}
+	if(ex<-22||ex>22) return false;
+	v=ex<0?m/tenpow[-ex]:m*tenpow[ex];
+	if(neg) v=-v;
+	return true;
+}
+
+/** Converts a decimal integer of up to nine digits.
+ * \param[in] (p,e) the start and end of the number.
+ * \param[out] v the converted number.
+ * \return True if the number was converted, false if it must be converted by
+ * strtol(). */
+bool text_importer::fast_int(const char *p,const char *e,double &v) {
+	bool neg=false;
+	int i=0;
+	if(p<e&&(*p=='-'||*p=='+')) neg=*(p++)=='-';
+	if(p==e||e-p>9) return false;
+	for(;p<e;p++) {
+		if(*p<'0'||*p>'9') return false;
+		i=10*i+(*p-'0');
+	}
+	v=neg?-i:i;
+	return true;
+}
+
+}
@@ -0,0 +1,84 @@
+// Voro++, a 3D cell-based Voronoi library
+//
+// Author   : Chris H. Rycroft (Harvard University / LBL)
+// Email    : chr@alum.mit.edu
+// Date     : August 30th 2011
+
+/** \file text_import.hh
+ * \brief Header file for the text_importer class, which reads text files of
+ * particles using several threads. */
+
+#ifndef VOROPP_TEXT_IMPORT_HH
+#define VOROPP_TEXT_IMPORT_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+
+namespace voro {
+
+/** \brief A class for reading text files of particles in large buffers,
+ * using several threads.
+ *
+ * This class reads the same text format as the fscanf() loops that the
+ * import() functions used originally, with each particle given as an integer
+ * ID followed by a number of floating point values. The file is read in
+ * buffers of import_buffer_size bytes, which are cut at whitespace. Each
+ * buffer is divided between the threads, which first count the numbers in
+ * their part, so that each number's place in a record is known, and then
+ * parse them. Most numbers are converted by a fast routine that gives exactly
+ * the same result as strtod(), and the remainder are passed to strtod() and
+ * strtol(). If any number is not separated from the next by whitespace, then
+ * the buffer is parsed again by a single thread, in the same way as fscanf(),
+ * so that the accepted input and the stored values are the same as before. */
+class text_importer {
+	public:
+		/** The number of particles read by the last call to next(). */
+		int n;
+		/** The IDs of the particles read by the last call to next(). */
+		std::vector<int> id;
+		/** The positions (and radii) of the particles read by the last
+		 * call to next(). */
+		std::vector<double> pos;
+		text_importer(FILE *fp_,int nf_,int nt_);
+		~text_importer();
+		bool next();
+	private:
+		/** The file handle to read from. */
+		FILE *fp;
+		/** The number of numbers in each record, including the ID. */
+		const int nf;
+		/** The number of threads to use, which is one if OpenMP is
+		 * not enabled. */
+		int nt;
+		/** The buffer that the file is read into. */
+		char *buf;
+		/** The size of the buffer. */
+		int mem;
+		/** The number of bytes currently in the buffer. */
+		int len;
+		/** Whether the end of the file has been reached. */
+		bool eof;
+		/** The number of values in pend. */
+		int ph;
+		/** The values of a record that was cut off at the end of the
+		 * last buffer. */
+		double pend[8];
+		/** The numbers parsed from the current buffer. */
+		std::vector<double> f;
+		int fill();
+		void parse(int cut);
+		void scan(const char *p,const char *e,int s);
+		static bool fast_double(const char *p,const char *e,double &v);
+		static bool fast_int(const char *p,const char *e,double &v);
+		/** Tests whether a character is whitespace, in the same way as
+		 * isspace() in the C locale.
+		 * \param[in] c the character to test.
+		 * \return True if it is whitespace, false otherwise. */
+		static inline bool is_ws(char c) {return c==' '||(c>='\t'&&c<='\r');}
+};
+
+}
+
+#endif
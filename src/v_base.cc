@@ -7,6 +7,10 @@
 /** \file v_base.cc
  * \brief Function implementations for the base Voronoi container class. */
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "v_base.hh"
 #include "config.hh"
 
@@ -22,7 +26,8 @@ namespace voro {
  * reverse order by considering the distance to \f$w_{i+1}\f$. */
 voro_base::voro_base(int nx_,int ny_,int nz_,double boxx_,double boxy_,double boxz_) :
 	nx(nx_), ny(ny_), nz(nz_), nxy(nx_*ny_), nxyz(nxy*nz_), boxx(boxx_), boxy(boxy_), boxz(boxz_),
-	xsp(1/boxx_), ysp(1/boxy_), zsp(1/boxz_), mrad(new double[wl_hgridcu*wl_seq_length]) {
+	xsp(1/boxx_), ysp(1/boxy_), zsp(1/boxz_), mrad(new double[wl_hgridcu*wl_seq_length]),
+	nthreads(1) {
 	const unsigned int b1=1<<21,b2=1<<22,b3=1<<24,b4=1<<25,b5=1<<27,b6=1<<28;
 	const double xstep=boxx/wl_fgrid,ystep=boxy/wl_fgrid,zstep=boxz/wl_fgrid;
 	int i,j,k,lx,ly,lz,q;
@@ -93,6 +98,19 @@ void voro_base::compute_minimum(double &minr,double &xlo,double &xhi,double &ylo
 	if(radsq<minr) minr=radsq;
 }
 
+/** Sets the number of threads to use in the routines that compute all of the
+ * Voronoi cells in a container. If the library was compiled without OpenMP
+ * support, then the number of threads is always one.
+ * \param[in] nt the number of threads. If this is zero or negative, then the
+ *               maximum number of threads available is used. */
+void voro_base::set_threads(int nt) {
+#ifdef _OPENMP
+	nthreads=nt>0?nt:omp_get_max_threads();
+#else
+	nthreads=1;
+#endif
+}
+
 /** Checks to see whether "%n" appears in a format sequence to determine
  * whether neighbor information is required or not.
  * \param[in] format the format string to check.
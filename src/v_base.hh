@@ -11,6 +11,7 @@
 #define VOROPP_V_BASE_HH
 
 #include "worklist.hh"
+#include "scheduler.hh"
 
 namespace voro {
 
@@ -55,7 +56,13 @@ class voro_base {
 		double *mrad;
 		/** The pre-computed block worklists. */
 		static const unsigned int wl[wl_seq_length*wl_hgridcu];
-		bool contains_neighbor(const char* format);
+		/** The number of threads to use in the routines that compute
+		 * all of the Voronoi cells in a container. This is one by
+		 * default, and can only be increased if the library is
+		 * compiled with OpenMP support. */
+		int nthreads;
+		static bool contains_neighbor(const char* format);
+		void set_threads(int nt);
 		voro_base(int nx_,int ny_,int nz_,double boxx_,double boxy_,double boxz_);
 		~voro_base() {delete [] mrad;}
 	protected:
@@ -64,21 +71,21 @@ class voro_base {
 		 * to (-2,-1,0,1).
 		 * \param[in] a the number to consider.
 		 * \return The value of the custom int operation. */
-		inline int step_int(double a) {return a<0?int(a)-1:int(a);}
+		inline int step_int(double a) const {return a<0?int(a)-1:int(a);}
 		/** A custom modulo function that returns consistent stepping
 		 * for negative numbers. For example, (-2,-1,0,1,2) step_mod 2
 		 * is (0,1,0,1,0).
 		 * \param[in] (a,b) the input integers.
 		 * \return The value of a modulo b, consistent for negative
 		 * numbers. */
-		inline int step_mod(int a,int b) {return a>=0?a%b:b-1-(b-1-a)%b;}
+		inline int step_mod(int a,int b) const {return a>=0?a%b:b-1-(b-1-a)%b;}
 		/** A custom integer division function that returns consistent
 		 * stepping for negative numbers. For example, (-2,-1,0,1,2)
 		 * step_div 2 is (-1,-1,0,0,1).
 		 * \param[in] (a,b) the input integers.
 		 * \return The value of a div b, consistent for negative
 		 * numbers. */
-		inline int step_div(int a,int b) {return a>=0?a/b:-1+(a+1)/b;}
+		inline int step_div(int a,int b) const {return a>=0?a/b:-1+(a+1)/b;}
 	private:
 		void compute_minimum(double &minr,double &xlo,double &xhi,double &ylo,double &yhi,double &zlo,double &zhi,int ti,int tj,int tk);
 };
@@ -7,28 +7,55 @@
 /** \file v_compute.cc
  * \brief Function implementantions for the voro_compute template. */
 
+#include <vector>
+
 #include "worklist.hh"
 #include "v_compute.hh"
 #include "rad_option.hh"
 #include "container.hh"
 #include "container_prd.hh"
+#include "container_view.hh"
 
 namespace voro {
 
-/** The class constructor initializes constants from the container class, and
- * sets up the mask and queue used for Voronoi computations.
+/** The class constructor sets up an empty workspace. The memory for the mask
+ * and queue is allocated when the workspace is first used. */
+compute_workspace::compute_workspace() : hxyz(0), mv(0), qu_size(0),
+	mask(NULL), qu(NULL), qu_l(NULL) {}
+
+/** The class destructor frees the dynamically allocated memory for the mask
+ * and queue. */
+compute_workspace::~compute_workspace() {
+	delete [] qu;
+	delete [] mask;
+}
+
+/** Allocates the mask and queue if they have not been set up for a mask of the
+ * given size.
+ * \param[in] hxyz_ the total number of blocks in the mask.
+ * \param[in] qu_size_ the initial size of the queue. */
+void compute_workspace::allocate(int hxyz_,int qu_size_) {
+	if(hxyz!=hxyz_) {
+		delete [] mask;
+		mask=new unsigned int[hxyz=hxyz_];
+		reset_mask();mv=0;
+	}
+	if(qu==NULL) {
+		qu=new int[qu_size=qu_size_];
+		qu_l=qu+qu_size;
+	}
+}
+
+/** The class constructor initializes constants from the container class.
  * \param[in] con_ a reference to the container class to use.
  * \param[in] (hx_,hy_,hz_) the size of the mask to use. */
 template<class c_class>
 voro_compute<c_class>::voro_compute(c_class &con_,int hx_,int hy_,int hz_) :
 	con(con_), boxx(con_.boxx), boxy(con_.boxy), boxz(con_.boxz),
 	xsp(con_.xsp), ysp(con_.ysp), zsp(con_.zsp),
-	hx(hx_), hy(hy_), hz(hz_), hxy(hx_*hy_), hxyz(hxy*hz_), ps(con_.ps),
-	id(con_.id), p(con_.p), co(con_.co), bxsq(boxx*boxx+boxy*boxy+boxz*boxz),
-	mv(0), qu_size(3*(3+hxy+hz*(hx+hy))), wl(con_.wl), mrad(con_.mrad),
-	mask(new unsigned int[hxyz]), qu(new int[qu_size]), qu_l(qu+qu_size) {
-	reset_mask();
-}
+	hx(hx_), hy(hy_), hz(hz_), hxy(hx_*hy_), hxyz(hxy*hz_),
+	id(con_.id), co(con_.co), bxsq(boxx*boxx+boxy*boxy+boxz*boxz),
+	wl(con_.wl), mrad(con_.mrad) {}
 
 /** Scans all of the particles within a block to see if any of them have a
  * smaller distance to the given test vector. If one is found, the routine
@@ -44,12 +71,11 @@ voro_compute<c_class>::voro_compute(c_class &con_,int hx_,int hy_,int hz_) :
  * \param[in,out] mrs the current minimum distance, that may be updated if a
  * 		      closer particle is found. */
 template<class c_class>
-inline void voro_compute<c_class>::scan_all(int ijk,double x,double y,double z,int di,int dj,int dk,particle_record &w,double &mrs) {
-	double x1,y1,z1,rs;bool in_block=false;
+inline void voro_compute<c_class>::scan_all(int ijk,double x,double y,double z,int di,int dj,int dk,particle_record &w,double &mrs) const {
+	double x1,y1,z1,rs,*pp;bool in_block=false;
 	for(int l=0;l<co[ijk];l++) {
-		x1=p[ijk][ps*l]-x;
-		y1=p[ijk][ps*l+1]-y;
-		z1=p[ijk][ps*l+2]-z;
+		pp=con.particle_pos(ijk,l);
+		x1=*pp-x;y1=pp[1]-y;z1=pp[2]-z;
 		rs=con.r_current_sub(x1*x1+y1*y1+z1*z1,ijk,l);
 		if(rs<mrs) {mrs=rs;w.l=l;in_block=true;}
 	}
@@ -60,6 +86,7 @@ inline void voro_compute<c_class>::scan_all(int ijk,double x,double y,double z,i
  * not radially dependent, this corresponds to findig the particle that is
  * closest to the vector; for the radical tessellation containers, this
  * corresponds to a finding the minimum weighted distance.
+ * \param[in] ws the workspace to use for the search.
  * \param[in] (x,y,z) the vector to consider.
  * \param[in] (ci,cj,ck) the coordinates of the block that the test particle is
  *                       in relative to the container data structure.
@@ -68,13 +95,14 @@ inline void voro_compute<c_class>::scan_all(int ijk,double x,double y,double z,i
  * 		 about the particle whose Voronoi cell the vector is within.
  * \param[out] mrs the minimum computed distance. */
 template<class c_class>
-void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,int cj,int ck,int ijk,particle_record &w,double &mrs) {
+void voro_compute<c_class>::find_voronoi_cell(compute_workspace &ws,double x,double y,double z,int ci,int cj,int ck,int ijk,particle_record &w,double &mrs) const {
 	double qx=0,qy=0,qz=0,rs;
 	int i,j,k,di,dj,dk,ei,ej,ek,f,g,disp;
 	double fx,fy,fz,mxs,mys,mzs,*radp;
 	unsigned int q,*e,*mijk;
 
 	// Init setup for parameters to return
+	ws.setup(hxyz,3*(3+hxy+hz*(hx+hy)));
 	w.ijk=-1;mrs=large_number;
 
 	con.initialize_search(ci,cj,ck,ijk,i,j,k,disp);
@@ -162,9 +190,9 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 	} while(g<f);
 
 	// Update mask value and initialize queue
-	mv++;
-	if(mv==0) {reset_mask();mv=1;}
-	int *qu_s=qu,*qu_e=qu;
+	ws.mv++;
+	if(ws.mv==0) {ws.reset_mask();ws.mv=1;}
+	int *qu_s=ws.qu,*qu_e=ws.qu;
 
 	while(g<wl_seq_length-1) {
 
@@ -187,8 +215,8 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 		ei=di+i;if(ei<0||ei>=hx) continue;
 		ej=dj+j;if(ej<0||ej>=hy) continue;
 		ek=dk+k;if(ek<0||ek>=hz) continue;
-		mijk=mask+ei+hx*(ej+hy*ek);
-		*mijk=mv;
+		mijk=ws.mask+ei+hx*(ej+hy*ek);
+		*mijk=ws.mv;
 
 		// Skip this block if it is further away than the current
 		// minimum radius
@@ -199,8 +227,8 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 		ijk=con.region_index(ci,cj,ck,ei,ej,ek,qx,qy,qz,disp);
 		scan_all(ijk,x-qx,y-qy,z-qz,di,dj,dk,w,mrs);
 
-		if(qu_e>qu_l-18) add_list_memory(qu_s,qu_e);
-		scan_bits_mask_add(q,mijk,ei,ej,ek,qu_e);
+		if(qu_e>ws.qu_l-18) ws.add_list_memory(qu_s,qu_e);
+		scan_bits_mask_add(ws,q,mijk,ei,ej,ek,qu_e);
 	}
 
 	// Do a check to see if we've reached the radius cutoff
@@ -212,7 +240,7 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 	while(qu_s!=qu_e) {
 
 		// Read the next entry of the queue
-		if(qu_s==qu_l) qu_s=qu;
+		if(qu_s==ws.qu_l) qu_s=ws.qu;
 		ei=*(qu_s++);ej=*(qu_s++);ek=*(qu_s++);
 		di=ei-i;dj=ej-j;dk=ek-k;
 		if(compute_min_radius(di,dj,dk,fx,fy,fz,mrs)) continue;
@@ -222,8 +250,65 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 
 		// Test the neighbors of the current block, and add them to the
 		// block list if they haven't already been tested
-		if((qu_s<=qu_e?(qu_l-qu_e)+(qu_s-qu):qu_s-qu_e)<18) add_list_memory(qu_s,qu_e);
-		add_to_mask(ei,ej,ek,qu_e);
+		if((qu_s<=qu_e?(ws.qu_l-qu_e)+(qu_s-ws.qu):qu_s-qu_e)<18) ws.add_list_memory(qu_s,qu_e);
+		add_to_mask(ws,ei,ej,ek,qu_e);
+	}
+}
+
+/** Finds the particles whose Voronoi cells contain a list of vectors. The
+ * vectors are first sorted by the block that they are in, using a counting
+ * sort, so that consecutive searches visit the same particles. The sorted
+ * vectors are then divided into chunks that are handed out to the threads
+ * requested by the container's set_threads() function, and each thread uses
+ * its own workspace for the search.
+ * \param[in] n the number of vectors.
+ * \param[in] pos an array of 3*n floating point numbers holding the vectors.
+ * \param[out] pid an array of n integers in which to store the IDs of the
+ *                 particles, or -1 for vectors where no particle is found.
+ * \param[out] sh an array of 3*n integers in which to store the periodic image
+ *                of each particle that is closest to the vector, or NULL if
+ *                this is not required. */
+template<class c_class>
+void voro_compute<c_class>::find_voronoi_cells(int n,const double *pos,int *pid,int *sh) const {
+	if(n<=0) return;
+	int nb=con.nxyz,i;
+	std::vector<int> key(n),st(nb+2,0),ord(n);
+#ifdef _OPENMP
+	int nt=con.nthreads<1?1:con.nthreads;
+#endif
+
+	// Find the block of each vector, with the vectors outside the
+	// container being given a key after all of the blocks
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+	for(i=0;i<n;i++) {
+		int b=con.query_block(pos[3*i],pos[3*i+1],pos[3*i+2]);
+		key[i]=b<0?nb:b;
+	}
+
+	// Sort the vectors by block
+	for(i=0;i<n;i++) st[key[i]+1]++;
+	for(i=0;i<=nb;i++) st[i+1]+=st[i];
+	for(i=0;i<n;i++) ord[st[key[i]]++]=i;
+
+	// Search for the particles in chunks of the sorted vectors
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		compute_workspace lws;
+		int j,q,ijk,l,ai,aj,ak;
+		const double *pp;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,256)
+#endif
+		for(j=0;j<n;j++) {
+			q=ord[j];pp=pos+3*q;
+			if(con.find_owner(lws,*pp,pp[1],pp[2],ijk,l,ai,aj,ak)) pid[q]=id[ijk][l];
+			else {pid[q]=-1;ai=aj=ak=0;}
+			if(sh!=NULL) {sh[3*q]=ai;sh[3*q+1]=aj;sh[3*q+2]=ak;}
+		}
 	}
 }
 
@@ -233,34 +318,34 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
  * \param[in] (ei,ej,ek) the block to consider.
  * \param[in,out] qu_e a pointer to the end of the queue. */
 template<class c_class>
-inline void voro_compute<c_class>::add_to_mask(int ei,int ej,int ek,int *&qu_e) {
-	unsigned int *mijk=mask+ei+hx*(ej+hy*ek);
-	if(ek>0) if(*(mijk-hxy)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
-	if(ej>0) if(*(mijk-hx)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
-	if(ei>0) if(*(mijk-1)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-1)=mv;*(qu_e++)=ei-1;*(qu_e++)=ej;*(qu_e++)=ek;}
-	if(ei<hx-1) if(*(mijk+1)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+1)=mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
-	if(ej<hy-1) if(*(mijk+hx)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
-	if(ek<hz-1) if(*(mijk+hxy)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
+inline void voro_compute<c_class>::add_to_mask(compute_workspace &ws,int ei,int ej,int ek,int *&qu_e) const {
+	unsigned int *mijk=ws.mask+ei+hx*(ej+hy*ek);
+	if(ek>0) if(*(mijk-hxy)!=ws.mv) {if(qu_e==ws.qu_l) qu_e=ws.qu;*(mijk-hxy)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
+	if(ej>0) if(*(mijk-hx)!=ws.mv) {if(qu_e==ws.qu_l) qu_e=ws.qu;*(mijk-hx)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
+	if(ei>0) if(*(mijk-1)!=ws.mv) {if(qu_e==ws.qu_l) qu_e=ws.qu;*(mijk-1)=ws.mv;*(qu_e++)=ei-1;*(qu_e++)=ej;*(qu_e++)=ek;}
+	if(ei<hx-1) if(*(mijk+1)!=ws.mv) {if(qu_e==ws.qu_l) qu_e=ws.qu;*(mijk+1)=ws.mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
+	if(ej<hy-1) if(*(mijk+hx)!=ws.mv) {if(qu_e==ws.qu_l) qu_e=ws.qu;*(mijk+hx)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
+	if(ek<hz-1) if(*(mijk+hxy)!=ws.mv) {if(qu_e==ws.qu_l) qu_e=ws.qu;*(mijk+hxy)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
 }
 
 /** Scans a worklist entry and adds any blocks to the queue
  * \param[in] (ei,ej,ek) the block to consider.
  * \param[in,out] qu_e a pointer to the end of the queue. */
 template<class c_class>
-inline void voro_compute<c_class>::scan_bits_mask_add(unsigned int q,unsigned int *mijk,int ei,int ej,int ek,int *&qu_e) {
+inline void voro_compute<c_class>::scan_bits_mask_add(compute_workspace &ws,unsigned int q,unsigned int *mijk,int ei,int ej,int ek,int *&qu_e) const {
 	const unsigned int b1=1<<21,b2=1<<22,b3=1<<24,b4=1<<25,b5=1<<27,b6=1<<28;
 	if((q&b2)==b2) {
-		if(ei>0) {*(mijk-1)=mv;*(qu_e++)=ei-1;*(qu_e++)=ej;*(qu_e++)=ek;}
-		if((q&b1)==0&&ei<hx-1) {*(mijk+1)=mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
-	} else if((q&b1)==b1&&ei<hx-1) {*(mijk+1)=mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
+		if(ei>0) {*(mijk-1)=ws.mv;*(qu_e++)=ei-1;*(qu_e++)=ej;*(qu_e++)=ek;}
+		if((q&b1)==0&&ei<hx-1) {*(mijk+1)=ws.mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
+	} else if((q&b1)==b1&&ei<hx-1) {*(mijk+1)=ws.mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
 	if((q&b4)==b4) {
-		if(ej>0) {*(mijk-hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
-		if((q&b3)==0&&ej<hy-1) {*(mijk+hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
-	} else if((q&b3)==b3&&ej<hy-1) {*(mijk+hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
+		if(ej>0) {*(mijk-hx)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
+		if((q&b3)==0&&ej<hy-1) {*(mijk+hx)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
+	} else if((q&b3)==b3&&ej<hy-1) {*(mijk+hx)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
 	if((q&b6)==b6) {
-		if(ek>0) {*(mijk-hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
-		if((q&b5)==0&&ek<hz-1) {*(mijk+hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
-	} else if((q&b5)==b5&&ek<hz-1) {*(mijk+hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
+		if(ek>0) {*(mijk-hxy)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
+		if((q&b5)==0&&ek<hz-1) {*(mijk+hxy)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
+	} else if((q&b5)==b5&&ek<hz-1) {*(mijk+hxy)=ws.mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
 }
 
 /** This routine computes a Voronoi cell for a single particle in the
@@ -280,24 +365,29 @@ inline void voro_compute<c_class>::scan_bits_mask_add(unsigned int q,unsigned in
  * the particles in that block, and then adds the block neighbors to the list
  * of potential places to consider.
  * \param[in,out] c a reference to a voronoicell object.
+ * \param[in] ws the workspace to use for the search.
  * \param[in] ijk the index of the block that the test particle is in.
- * \param[in] s the index of the particle within the test block.
+ * \param[in] s the index of the particle within the test block. If this is
+ *              set to the number of particles in the block, then no
+ *              particles are skipped, which is used for ghost particles.
  * \param[in] (ci,cj,ck) the coordinates of the block that the test particle is
  *                       in relative to the container data structure.
+ * \param[in] pp a pointer to the position (and radius) of the test particle.
  * \return False if the Voronoi cell was completely removed during the
  *         computation and has zero volume, true otherwise. */
 template<class c_class>
 template<class v_cell>
-bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,int ck) {
+bool voro_compute<c_class>::compute_cell(v_cell &c,compute_workspace &ws,int ijk,int s,int ci,int cj,int ck,double *pp) const {
 	static const int count_list[8]={7,11,15,19,26,35,45,59},*count_e=count_list+8;
 	double x,y,z,x1,y1,z1,qx=0,qy=0,qz=0;
 	double xlo,ylo,zlo,xhi,yhi,zhi,x2,y2,z2,rs;
 	int i,j,k,di,dj,dk,ei,ej,ek,f,g,l,disp;
-	double fx,fy,fz,gxs,gys,gzs,*radp;
+	double fx,fy,fz,gxs,gys,gzs,*radp,*qp;
 	unsigned int q,*e,*mijk;
 
-	if(!con.initialize_voronoicell(c,ijk,s,ci,cj,ck,i,j,k,x,y,z,disp)) return false;
-	con.r_init(ijk,s);
+	ws.setup(hxyz,3*(3+hxy+hz*(hx+hy)));
+	if(!con.initialize_voronoicell(c,ijk,pp,ci,cj,ck,i,j,k,x,y,z,disp)) return false;
+	con.r_init(ws.rr,pp);
 
 	// Initialize the Voronoi cell to fill the entire container
 	double crs,mrs;
@@ -306,18 +396,16 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 
 	// Test all particles in the particle's local region first
 	for(l=0;l<s;l++) {
-		x1=p[ijk][ps*l]-x;
-		y1=p[ijk][ps*l+1]-y;
-		z1=p[ijk][ps*l+2]-z;
-		rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+		qp=con.particle_pos(ijk,l);
+		x1=*qp-x;y1=qp[1]-y;z1=qp[2]-z;
+		rs=con.r_scale(ws.rr,x1*x1+y1*y1+z1*z1,ijk,l);
 		if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 	}
 	l++;
 	while(l<co[ijk]) {
-		x1=p[ijk][ps*l]-x;
-		y1=p[ijk][ps*l+1]-y;
-		z1=p[ijk][ps*l+2]-z;
-		rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+		qp=con.particle_pos(ijk,l);
+		x1=*qp-x;y1=qp[1]-y;z1=qp[2]-z;
+		rs=con.r_scale(ws.rr,x1*x1+y1*y1+z1*z1,ijk,l);
 		if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 		l++;
 	}
@@ -375,7 +463,7 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 
 		// If mrs is less than the minimum distance to any untested
 		// block, then we are done
-		if(con.r_ctest(radp[g],mrs)) return true;
+		if(con.r_ctest(ws.rr,radp[g],mrs)) return true;
 		g++;
 
 		// Load in a block off the worklist, permute it with the
@@ -396,7 +484,7 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		// current mrs, in which case we skip this block and move on.
 		// Otherwise, it computes the maximum distance to the block and
 		// returns it in crs.
-		if(compute_min_max_radius(di,dj,dk,fx,fy,fz,gxs,gys,gzs,crs,mrs)) continue;
+		if(compute_min_max_radius(ws,di,dj,dk,fx,fy,fz,gxs,gys,gzs,crs,mrs)) continue;
 
 		// Now compute which region we are going to loop over, adding a
 		// displacement for the periodic cases
@@ -408,22 +496,20 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		// those particles which can't possibly intersect the block.
 		if(co[ijk]>0) {
 			l=0;x2=x-qx;y2=y-qy;z2=z-qz;
-			if(!con.r_ctest(crs,mrs)) {
+			if(!con.r_ctest(ws.rr,crs,mrs)) {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
-					rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+					qp=con.particle_pos(ijk,l);
+					x1=*qp-x2;y1=qp[1]-y2;z1=qp[2]-z2;
+					rs=con.r_scale(ws.rr,x1*x1+y1*y1+z1*z1,ijk,l);
 					if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			} else {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
+					qp=con.particle_pos(ijk,l);
+					x1=*qp-x2;y1=qp[1]-y2;z1=qp[2]-z2;
 					rs=x1*x1+y1*y1+z1*z1;
-					if(con.r_scale_check(rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
+					if(con.r_scale_check(ws.rr,rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			}
@@ -440,11 +526,11 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 	// points in a list in case we have to go block by block. Update the
 	// mask counter, and if it wraps around then reset the whole mask; that
 	// will only happen once every 2^32 tries.
-	mv++;
-	if(mv==0) {reset_mask();mv=1;}
+	ws.mv++;
+	if(ws.mv==0) {ws.reset_mask();ws.mv=1;}
 
 	// Set the queue pointers
-	int *qu_s=qu,*qu_e=qu;
+	int *qu_s=ws.qu,*qu_e=ws.qu;
 
 	while(g<wl_seq_length-1) {
 
@@ -457,7 +543,7 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 
 		// If mrs is less than the minimum distance to any untested
 		// block, then we are done
-		if(con.r_ctest(radp[g],mrs)) return true;
+		if(con.r_ctest(ws.rr,radp[g],mrs)) return true;
 		g++;
 
 		// Load in a block off the worklist, permute it with the
@@ -474,15 +560,15 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		ei=di+i;if(ei<0||ei>=hx) continue;
 		ej=dj+j;if(ej<0||ej>=hy) continue;
 		ek=dk+k;if(ek<0||ek>=hz) continue;
-		mijk=mask+ei+hx*(ej+hy*ek);
-		*mijk=mv;
+		mijk=ws.mask+ei+hx*(ej+hy*ek);
+		*mijk=ws.mv;
 
 		// Call the compute_min_max_radius() function. This returns
 		// true if the minimum distance to the block is bigger than the
 		// current mrs, in which case we skip this block and move on.
 		// Otherwise, it computes the maximum distance to the block and
 		// returns it in crs.
-		if(compute_min_max_radius(di,dj,dk,fx,fy,fz,gxs,gys,gzs,crs,mrs)) continue;
+		if(compute_min_max_radius(ws,di,dj,dk,fx,fy,fz,gxs,gys,gzs,crs,mrs)) continue;
 
 		// Now compute which region we are going to loop over, adding a
 		// displacement for the periodic cases
@@ -494,22 +580,20 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		// those particles which can't possibly intersect the block.
 		if(co[ijk]>0) {
 			l=0;x2=x-qx;y2=y-qy;z2=z-qz;
-			if(!con.r_ctest(crs,mrs)) {
+			if(!con.r_ctest(ws.rr,crs,mrs)) {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
-					rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+					qp=con.particle_pos(ijk,l);
+					x1=*qp-x2;y1=qp[1]-y2;z1=qp[2]-z2;
+					rs=con.r_scale(ws.rr,x1*x1+y1*y1+z1*z1,ijk,l);
 					if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			} else {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
+					qp=con.particle_pos(ijk,l);
+					x1=*qp-x2;y1=qp[1]-y2;z1=qp[2]-z2;
 					rs=x1*x1+y1*y1+z1*z1;
-					if(con.r_scale_check(rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
+					if(con.r_scale_check(ws.rr,rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			}
@@ -517,16 +601,16 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 
 		// If there might not be enough memory on the list for these
 		// additions, then add more
-		if(qu_e>qu_l-18) add_list_memory(qu_s,qu_e);
+		if(qu_e>ws.qu_l-18) ws.add_list_memory(qu_s,qu_e);
 
 		// Test the parts of the worklist element which tell us what
 		// neighbors of this block are not on the worklist. Store them
 		// on the block list, and mark the mask.
-		scan_bits_mask_add(q,mijk,ei,ej,ek,qu_e);
+		scan_bits_mask_add(ws,q,mijk,ei,ej,ek,qu_e);
 	}
 
 	// Do a check to see if we've reached the radius cutoff
-	if(con.r_ctest(radp[g],mrs)) return true;
+	if(con.r_ctest(ws.rr,radp[g],mrs)) return true;
 
 	// We were unable to completely compute the cell based on the blocks in
 	// the worklist, so now we have to go block by block, reading in items
@@ -535,7 +619,7 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 
 		// If we reached the end of the list memory loop back to the
 		// start
-		if(qu_s==qu_l) qu_s=qu;
+		if(qu_s==ws.qu_l) qu_s=ws.qu;
 
 		// Read in a block off the list, and compute the upper and lower
 		// coordinates in each of the three dimensions
@@ -548,44 +632,44 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		// could possibly intersect the cell
 		if(ei>i) {
 			if(ej>j) {
-				if(ek>k) {if(corner_test(c,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
-				else if(ek<k) {if(corner_test(c,xlo,ylo,zhi,xhi,yhi,zlo)) continue;}
-				else {if(edge_z_test(c,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
+				if(ek>k) {if(corner_test(c,ws,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
+				else if(ek<k) {if(corner_test(c,ws,xlo,ylo,zhi,xhi,yhi,zlo)) continue;}
+				else {if(edge_z_test(c,ws,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
 			} else if(ej<j) {
-				if(ek>k) {if(corner_test(c,xlo,yhi,zlo,xhi,ylo,zhi)) continue;}
-				else if(ek<k) {if(corner_test(c,xlo,yhi,zhi,xhi,ylo,zlo)) continue;}
-				else {if(edge_z_test(c,xlo,yhi,zlo,xhi,ylo,zhi)) continue;}
+				if(ek>k) {if(corner_test(c,ws,xlo,yhi,zlo,xhi,ylo,zhi)) continue;}
+				else if(ek<k) {if(corner_test(c,ws,xlo,yhi,zhi,xhi,ylo,zlo)) continue;}
+				else {if(edge_z_test(c,ws,xlo,yhi,zlo,xhi,ylo,zhi)) continue;}
 			} else {
-				if(ek>k) {if(edge_y_test(c,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
-				else if(ek<k) {if(edge_y_test(c,xlo,ylo,zhi,xhi,yhi,zlo)) continue;}
-				else {if(face_x_test(c,xlo,ylo,zlo,yhi,zhi)) continue;}
+				if(ek>k) {if(edge_y_test(c,ws,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
+				else if(ek<k) {if(edge_y_test(c,ws,xlo,ylo,zhi,xhi,yhi,zlo)) continue;}
+				else {if(face_x_test(c,ws,xlo,ylo,zlo,yhi,zhi)) continue;}
 			}
 		} else if(ei<i) {
 			if(ej>j) {
-				if(ek>k) {if(corner_test(c,xhi,ylo,zlo,xlo,yhi,zhi)) continue;}
-				else if(ek<k) {if(corner_test(c,xhi,ylo,zhi,xlo,yhi,zlo)) continue;}
-				else {if(edge_z_test(c,xhi,ylo,zlo,xlo,yhi,zhi)) continue;}
+				if(ek>k) {if(corner_test(c,ws,xhi,ylo,zlo,xlo,yhi,zhi)) continue;}
+				else if(ek<k) {if(corner_test(c,ws,xhi,ylo,zhi,xlo,yhi,zlo)) continue;}
+				else {if(edge_z_test(c,ws,xhi,ylo,zlo,xlo,yhi,zhi)) continue;}
 			} else if(ej<j) {
-				if(ek>k) {if(corner_test(c,xhi,yhi,zlo,xlo,ylo,zhi)) continue;}
-				else if(ek<k) {if(corner_test(c,xhi,yhi,zhi,xlo,ylo,zlo)) continue;}
-				else {if(edge_z_test(c,xhi,yhi,zlo,xlo,ylo,zhi)) continue;}
+				if(ek>k) {if(corner_test(c,ws,xhi,yhi,zlo,xlo,ylo,zhi)) continue;}
+				else if(ek<k) {if(corner_test(c,ws,xhi,yhi,zhi,xlo,ylo,zlo)) continue;}
+				else {if(edge_z_test(c,ws,xhi,yhi,zlo,xlo,ylo,zhi)) continue;}
 			} else {
-				if(ek>k) {if(edge_y_test(c,xhi,ylo,zlo,xlo,yhi,zhi)) continue;}
-				else if(ek<k) {if(edge_y_test(c,xhi,ylo,zhi,xlo,yhi,zlo)) continue;}
-				else {if(face_x_test(c,xhi,ylo,zlo,yhi,zhi)) continue;}
+				if(ek>k) {if(edge_y_test(c,ws,xhi,ylo,zlo,xlo,yhi,zhi)) continue;}
+				else if(ek<k) {if(edge_y_test(c,ws,xhi,ylo,zhi,xlo,yhi,zlo)) continue;}
+				else {if(face_x_test(c,ws,xhi,ylo,zlo,yhi,zhi)) continue;}
 			}
 		} else {
 			if(ej>j) {
-				if(ek>k) {if(edge_x_test(c,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
-				else if(ek<k) {if(edge_x_test(c,xlo,ylo,zhi,xhi,yhi,zlo)) continue;}
-				else {if(face_y_test(c,xlo,ylo,zlo,xhi,zhi)) continue;}
+				if(ek>k) {if(edge_x_test(c,ws,xlo,ylo,zlo,xhi,yhi,zhi)) continue;}
+				else if(ek<k) {if(edge_x_test(c,ws,xlo,ylo,zhi,xhi,yhi,zlo)) continue;}
+				else {if(face_y_test(c,ws,xlo,ylo,zlo,xhi,zhi)) continue;}
 			} else if(ej<j) {
-				if(ek>k) {if(edge_x_test(c,xlo,yhi,zlo,xhi,ylo,zhi)) continue;}
-				else if(ek<k) {if(edge_x_test(c,xlo,yhi,zhi,xhi,ylo,zlo)) continue;}
-				else {if(face_y_test(c,xlo,yhi,zlo,xhi,zhi)) continue;}
+				if(ek>k) {if(edge_x_test(c,ws,xlo,yhi,zlo,xhi,ylo,zhi)) continue;}
+				else if(ek<k) {if(edge_x_test(c,ws,xlo,yhi,zhi,xhi,ylo,zlo)) continue;}
+				else {if(face_y_test(c,ws,xlo,yhi,zlo,xhi,zhi)) continue;}
 			} else {
-				if(ek>k) {if(face_z_test(c,xlo,ylo,zlo,xhi,yhi)) continue;}
-				else if(ek<k) {if(face_z_test(c,xlo,ylo,zhi,xhi,yhi)) continue;}
+				if(ek>k) {if(face_z_test(c,ws,xlo,ylo,zlo,xhi,yhi)) continue;}
+				else if(ek<k) {if(face_z_test(c,ws,xlo,ylo,zhi,xhi,yhi)) continue;}
 				else voro_fatal_error("Compute cell routine revisiting central block, which should never\nhappen.",VOROPP_INTERNAL_ERROR);
 			}
 		}
@@ -600,21 +684,20 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		if(co[ijk]>0) {
 			l=0;x2=x-qx;y2=y-qy;z2=z-qz;
 			do {
-				x1=p[ijk][ps*l]-x2;
-				y1=p[ijk][ps*l+1]-y2;
-				z1=p[ijk][ps*l+2]-z2;
-				rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+				qp=con.particle_pos(ijk,l);
+				x1=*qp-x2;y1=qp[1]-y2;z1=qp[2]-z2;
+				rs=con.r_scale(ws.rr,x1*x1+y1*y1+z1*z1,ijk,l);
 				if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 				l++;
 			} while (l<co[ijk]);
 		}
 
 		// If there's not much memory on the block list then add more
-		if((qu_s<=qu_e?(qu_l-qu_e)+(qu_s-qu):qu_s-qu_e)<18) add_list_memory(qu_s,qu_e);
+		if((qu_s<=qu_e?(ws.qu_l-qu_e)+(qu_s-ws.qu):qu_s-qu_e)<18) ws.add_list_memory(qu_s,qu_e);
 
 		// Test the neighbors of the current block, and add them to the
 		// block list if they haven't already been tested
-		add_to_mask(ei,ej,ek,qu_e);
+		add_to_mask(ws,ei,ej,ek,qu_e);
 	}
 
 	return true;
@@ -631,14 +714,14 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-bool voro_compute<c_class>::corner_test(v_cell &c,double xl,double yl,double zl,double xh,double yh,double zh) {
-	con.r_prime(xl*xl+yl*yl+zl*zl);
-	if(c.plane_intersects_guess(xh,yl,zl,con.r_cutoff(xl*xh+yl*yl+zl*zl))) return false;
-	if(c.plane_intersects(xh,yh,zl,con.r_cutoff(xl*xh+yl*yh+zl*zl))) return false;
-	if(c.plane_intersects(xl,yh,zl,con.r_cutoff(xl*xl+yl*yh+zl*zl))) return false;
-	if(c.plane_intersects(xl,yh,zh,con.r_cutoff(xl*xl+yl*yh+zl*zh))) return false;
-	if(c.plane_intersects(xl,yl,zh,con.r_cutoff(xl*xl+yl*yl+zl*zh))) return false;
-	if(c.plane_intersects(xh,yl,zh,con.r_cutoff(xl*xh+yl*yl+zl*zh))) return false;
+bool voro_compute<c_class>::corner_test(v_cell &c,compute_workspace &ws,double xl,double yl,double zl,double xh,double yh,double zh) const {
+	con.r_prime(ws.rr,xl*xl+yl*yl+zl*zl);
+	if(c.plane_intersects_guess(xh,yl,zl,con.r_cutoff(ws.rr,xl*xh+yl*yl+zl*zl))) return false;
+	if(c.plane_intersects(xh,yh,zl,con.r_cutoff(ws.rr,xl*xh+yl*yh+zl*zl))) return false;
+	if(c.plane_intersects(xl,yh,zl,con.r_cutoff(ws.rr,xl*xl+yl*yh+zl*zl))) return false;
+	if(c.plane_intersects(xl,yh,zh,con.r_cutoff(ws.rr,xl*xl+yl*yh+zl*zh))) return false;
+	if(c.plane_intersects(xl,yl,zh,con.r_cutoff(ws.rr,xl*xl+yl*yl+zl*zh))) return false;
+	if(c.plane_intersects(xh,yl,zh,con.r_cutoff(ws.rr,xl*xh+yl*yl+zl*zh))) return false;
 	return true;
 }
 
@@ -656,14 +739,14 @@ bool voro_compute<c_class>::corner_test(v_cell &c,double xl,double yl,double zl,
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-inline bool voro_compute<c_class>::edge_x_test(v_cell &c,double x0,double yl,double zl,double x1,double yh,double zh) {
-	con.r_prime(yl*yl+zl*zl);
-	if(c.plane_intersects_guess(x0,yl,zh,con.r_cutoff(yl*yl+zl*zh))) return false;
-	if(c.plane_intersects(x1,yl,zh,con.r_cutoff(yl*yl+zl*zh))) return false;
-	if(c.plane_intersects(x1,yl,zl,con.r_cutoff(yl*yl+zl*zl))) return false;
-	if(c.plane_intersects(x0,yl,zl,con.r_cutoff(yl*yl+zl*zl))) return false;
-	if(c.plane_intersects(x0,yh,zl,con.r_cutoff(yl*yh+zl*zl))) return false;
-	if(c.plane_intersects(x1,yh,zl,con.r_cutoff(yl*yh+zl*zl))) return false;
+inline bool voro_compute<c_class>::edge_x_test(v_cell &c,compute_workspace &ws,double x0,double yl,double zl,double x1,double yh,double zh) const {
+	con.r_prime(ws.rr,yl*yl+zl*zl);
+	if(c.plane_intersects_guess(x0,yl,zh,con.r_cutoff(ws.rr,yl*yl+zl*zh))) return false;
+	if(c.plane_intersects(x1,yl,zh,con.r_cutoff(ws.rr,yl*yl+zl*zh))) return false;
+	if(c.plane_intersects(x1,yl,zl,con.r_cutoff(ws.rr,yl*yl+zl*zl))) return false;
+	if(c.plane_intersects(x0,yl,zl,con.r_cutoff(ws.rr,yl*yl+zl*zl))) return false;
+	if(c.plane_intersects(x0,yh,zl,con.r_cutoff(ws.rr,yl*yh+zl*zl))) return false;
+	if(c.plane_intersects(x1,yh,zl,con.r_cutoff(ws.rr,yl*yh+zl*zl))) return false;
 	return true;
 }
 
@@ -681,14 +764,14 @@ inline bool voro_compute<c_class>::edge_x_test(v_cell &c,double x0,double yl,dou
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-inline bool voro_compute<c_class>::edge_y_test(v_cell &c,double xl,double y0,double zl,double xh,double y1,double zh) {
-	con.r_prime(xl*xl+zl*zl);
-	if(c.plane_intersects_guess(xl,y0,zh,con.r_cutoff(xl*xl+zl*zh))) return false;
-	if(c.plane_intersects(xl,y1,zh,con.r_cutoff(xl*xl+zl*zh))) return false;
-	if(c.plane_intersects(xl,y1,zl,con.r_cutoff(xl*xl+zl*zl))) return false;
-	if(c.plane_intersects(xl,y0,zl,con.r_cutoff(xl*xl+zl*zl))) return false;
-	if(c.plane_intersects(xh,y0,zl,con.r_cutoff(xl*xh+zl*zl))) return false;
-	if(c.plane_intersects(xh,y1,zl,con.r_cutoff(xl*xh+zl*zl))) return false;
+inline bool voro_compute<c_class>::edge_y_test(v_cell &c,compute_workspace &ws,double xl,double y0,double zl,double xh,double y1,double zh) const {
+	con.r_prime(ws.rr,xl*xl+zl*zl);
+	if(c.plane_intersects_guess(xl,y0,zh,con.r_cutoff(ws.rr,xl*xl+zl*zh))) return false;
+	if(c.plane_intersects(xl,y1,zh,con.r_cutoff(ws.rr,xl*xl+zl*zh))) return false;
+	if(c.plane_intersects(xl,y1,zl,con.r_cutoff(ws.rr,xl*xl+zl*zl))) return false;
+	if(c.plane_intersects(xl,y0,zl,con.r_cutoff(ws.rr,xl*xl+zl*zl))) return false;
+	if(c.plane_intersects(xh,y0,zl,con.r_cutoff(ws.rr,xl*xh+zl*zl))) return false;
+	if(c.plane_intersects(xh,y1,zl,con.r_cutoff(ws.rr,xl*xh+zl*zl))) return false;
 	return true;
 }
 
@@ -705,14 +788,14 @@ inline bool voro_compute<c_class>::edge_y_test(v_cell &c,double xl,double y0,dou
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-inline bool voro_compute<c_class>::edge_z_test(v_cell &c,double xl,double yl,double z0,double xh,double yh,double z1) {
-	con.r_prime(xl*xl+yl*yl);
-	if(c.plane_intersects_guess(xl,yh,z0,con.r_cutoff(xl*xl+yl*yh))) return false;
-	if(c.plane_intersects(xl,yh,z1,con.r_cutoff(xl*xl+yl*yh))) return false;
-	if(c.plane_intersects(xl,yl,z1,con.r_cutoff(xl*xl+yl*yl))) return false;
-	if(c.plane_intersects(xl,yl,z0,con.r_cutoff(xl*xl+yl*yl))) return false;
-	if(c.plane_intersects(xh,yl,z0,con.r_cutoff(xl*xh+yl*yl))) return false;
-	if(c.plane_intersects(xh,yl,z1,con.r_cutoff(xl*xh+yl*yl))) return false;
+inline bool voro_compute<c_class>::edge_z_test(v_cell &c,compute_workspace &ws,double xl,double yl,double z0,double xh,double yh,double z1) const {
+	con.r_prime(ws.rr,xl*xl+yl*yl);
+	if(c.plane_intersects_guess(xl,yh,z0,con.r_cutoff(ws.rr,xl*xl+yl*yh))) return false;
+	if(c.plane_intersects(xl,yh,z1,con.r_cutoff(ws.rr,xl*xl+yl*yh))) return false;
+	if(c.plane_intersects(xl,yl,z1,con.r_cutoff(ws.rr,xl*xl+yl*yl))) return false;
+	if(c.plane_intersects(xl,yl,z0,con.r_cutoff(ws.rr,xl*xl+yl*yl))) return false;
+	if(c.plane_intersects(xh,yl,z0,con.r_cutoff(ws.rr,xl*xh+yl*yl))) return false;
+	if(c.plane_intersects(xh,yl,z1,con.r_cutoff(ws.rr,xl*xh+yl*yl))) return false;
 	return true;
 }
 
@@ -728,12 +811,12 @@ inline bool voro_compute<c_class>::edge_z_test(v_cell &c,double xl,double yl,dou
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-inline bool voro_compute<c_class>::face_x_test(v_cell &c,double xl,double y0,double z0,double y1,double z1) {
-	con.r_prime(xl*xl);
-	if(c.plane_intersects_guess(xl,y0,z0,con.r_cutoff(xl*xl))) return false;
-	if(c.plane_intersects(xl,y0,z1,con.r_cutoff(xl*xl))) return false;
-	if(c.plane_intersects(xl,y1,z1,con.r_cutoff(xl*xl))) return false;
-	if(c.plane_intersects(xl,y1,z0,con.r_cutoff(xl*xl))) return false;
+inline bool voro_compute<c_class>::face_x_test(v_cell &c,compute_workspace &ws,double xl,double y0,double z0,double y1,double z1) const {
+	con.r_prime(ws.rr,xl*xl);
+	if(c.plane_intersects_guess(xl,y0,z0,con.r_cutoff(ws.rr,xl*xl))) return false;
+	if(c.plane_intersects(xl,y0,z1,con.r_cutoff(ws.rr,xl*xl))) return false;
+	if(c.plane_intersects(xl,y1,z1,con.r_cutoff(ws.rr,xl*xl))) return false;
+	if(c.plane_intersects(xl,y1,z0,con.r_cutoff(ws.rr,xl*xl))) return false;
 	return true;
 }
 
@@ -749,12 +832,12 @@ inline bool voro_compute<c_class>::face_x_test(v_cell &c,double xl,double y0,dou
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-inline bool voro_compute<c_class>::face_y_test(v_cell &c,double x0,double yl,double z0,double x1,double z1) {
-	con.r_prime(yl*yl);
-	if(c.plane_intersects_guess(x0,yl,z0,con.r_cutoff(yl*yl))) return false;
-	if(c.plane_intersects(x0,yl,z1,con.r_cutoff(yl*yl))) return false;
-	if(c.plane_intersects(x1,yl,z1,con.r_cutoff(yl*yl))) return false;
-	if(c.plane_intersects(x1,yl,z0,con.r_cutoff(yl*yl))) return false;
+inline bool voro_compute<c_class>::face_y_test(v_cell &c,compute_workspace &ws,double x0,double yl,double z0,double x1,double z1) const {
+	con.r_prime(ws.rr,yl*yl);
+	if(c.plane_intersects_guess(x0,yl,z0,con.r_cutoff(ws.rr,yl*yl))) return false;
+	if(c.plane_intersects(x0,yl,z1,con.r_cutoff(ws.rr,yl*yl))) return false;
+	if(c.plane_intersects(x1,yl,z1,con.r_cutoff(ws.rr,yl*yl))) return false;
+	if(c.plane_intersects(x1,yl,z0,con.r_cutoff(ws.rr,yl*yl))) return false;
 	return true;
 }
 
@@ -770,12 +853,12 @@ inline bool voro_compute<c_class>::face_y_test(v_cell &c,double x0,double yl,dou
  * \return False if the block may intersect, true if does not. */
 template<class c_class>
 template<class v_cell>
-inline bool voro_compute<c_class>::face_z_test(v_cell &c,double x0,double y0,double zl,double x1,double y1) {
-	con.r_prime(zl*zl);
-	if(c.plane_intersects_guess(x0,y0,zl,con.r_cutoff(zl*zl))) return false;
-	if(c.plane_intersects(x0,y1,zl,con.r_cutoff(zl*zl))) return false;
-	if(c.plane_intersects(x1,y1,zl,con.r_cutoff(zl*zl))) return false;
-	if(c.plane_intersects(x1,y0,zl,con.r_cutoff(zl*zl))) return false;
+inline bool voro_compute<c_class>::face_z_test(v_cell &c,compute_workspace &ws,double x0,double y0,double zl,double x1,double y1) const {
+	con.r_prime(ws.rr,zl*zl);
+	if(c.plane_intersects_guess(x0,y0,zl,con.r_cutoff(ws.rr,zl*zl))) return false;
+	if(c.plane_intersects(x0,y1,zl,con.r_cutoff(ws.rr,zl*zl))) return false;
+	if(c.plane_intersects(x1,y1,zl,con.r_cutoff(ws.rr,zl*zl))) return false;
+	if(c.plane_intersects(x1,y0,zl,con.r_cutoff(ws.rr,zl*zl))) return false;
 	return true;
 }
 
@@ -794,7 +877,7 @@ inline bool voro_compute<c_class>::face_z_test(v_cell &c,double x0,double y0,dou
  * \return True if the region is further away than mrs, false if the region in
  *         within mrs. */
 template<class c_class>
-bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double fx,double fy,double fz,double gxs,double gys,double gzs,double &crs,double mrs) {
+bool voro_compute<c_class>::compute_min_max_radius(compute_workspace &ws,int di,int dj,int dk,double fx,double fy,double fz,double gxs,double gys,double gzs,double &crs,double mrs) const {
 	double xlo,ylo,zlo;
 	if(di>0) {
 		xlo=di*boxx-fx;
@@ -804,14 +887,14 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo+boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo+boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxx*(2*xlo+boxx)+boxy*(2*ylo+boxy)+gzs;
 			}
 		} else if(dj<0) {
@@ -819,27 +902,27 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo-boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo-boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxx*(2*xlo+boxx)+boxy*(-2*ylo+boxy)+gzs;
 			}
 		} else {
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=gys+boxx*(2*xlo+boxx);
@@ -852,14 +935,14 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo+boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo+boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxx*(-2*xlo+boxx)+boxy*(2*ylo+boxy)+gzs;
 			}
 		} else if(dj<0) {
@@ -867,27 +950,27 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo-boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo-boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxx*(-2*xlo+boxx)+boxy*(-2*ylo+boxy)+gzs;
 			}
 		} else {
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=gys+boxx*(-2*xlo+boxx);
@@ -898,14 +981,14 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=boxy*(2*ylo+boxy);
@@ -914,23 +997,23 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=boxy*(-2*ylo+boxy);
 		} else {
 			if(dk>0) {
-				zlo=dk*boxz-fz;crs=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				zlo=dk*boxz-fz;crs=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
-				zlo=(dk+1)*boxz-fz;crs=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				zlo=(dk+1)*boxz-fz;crs=zlo*zlo;if(con.r_ctest(ws.rr,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
 				crs=0;
@@ -944,7 +1027,7 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 }
 
 template<class c_class>
-bool voro_compute<c_class>::compute_min_radius(int di,int dj,int dk,double fx,double fy,double fz,double mrs) {
+bool voro_compute<c_class>::compute_min_radius(int di,int dj,int dk,double fx,double fy,double fz,double mrs) const {
 	double t,crs;
 
 	if(di>0) {t=di*boxx-fx;crs=t*t;}
@@ -963,8 +1046,7 @@ bool voro_compute<c_class>::compute_min_radius(int di,int dj,int dk,double fx,do
 /** Adds memory to the queue.
  * \param[in,out] qu_s a reference to the queue start pointer.
  * \param[in,out] qu_e a reference to the queue end pointer. */
-template<class c_class>
-inline void voro_compute<c_class>::add_list_memory(int*& qu_s,int*& qu_e) {
+void compute_workspace::add_list_memory(int*& qu_s,int*& qu_e) {
 	qu_size<<=1;
 	int *qu_n=new int[qu_size],*qu_c=qu_n;
 #if VOROPP_VERBOSE >=2
@@ -986,21 +1068,33 @@ inline void voro_compute<c_class>::add_list_memory(int*& qu_s,int*& qu_e) {
 // Explicit template instantiation
 template voro_compute<container>::voro_compute(container&,int,int,int);
 template voro_compute<container_poly>::voro_compute(container_poly&,int,int,int);
-template bool voro_compute<container>::compute_cell(voronoicell&,int,int,int,int,int);
-template bool voro_compute<container>::compute_cell(voronoicell_neighbor&,int,int,int,int,int);
-template void voro_compute<container>::find_voronoi_cell(double,double,double,int,int,int,int,particle_record&,double&);
-template bool voro_compute<container_poly>::compute_cell(voronoicell&,int,int,int,int,int);
-template bool voro_compute<container_poly>::compute_cell(voronoicell_neighbor&,int,int,int,int,int);
-template void voro_compute<container_poly>::find_voronoi_cell(double,double,double,int,int,int,int,particle_record&,double&);
+template bool voro_compute<container>::compute_cell(voronoicell&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container>::compute_cell(voronoicell_neighbor&,compute_workspace&,int,int,int,int,int,double*) const;
+template void voro_compute<container>::find_voronoi_cell(compute_workspace&,double,double,double,int,int,int,int,particle_record&,double&) const;
+template void voro_compute<container>::find_voronoi_cells(int,const double*,int*,int*) const;
+template bool voro_compute<container_poly>::compute_cell(voronoicell&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container_poly>::compute_cell(voronoicell_neighbor&,compute_workspace&,int,int,int,int,int,double*) const;
+template void voro_compute<container_poly>::find_voronoi_cell(compute_workspace&,double,double,double,int,int,int,int,particle_record&,double&) const;
+template void voro_compute<container_poly>::find_voronoi_cells(int,const double*,int*,int*) const;
 
 // Explicit template instantiation
 template voro_compute<container_periodic>::voro_compute(container_periodic&,int,int,int);
 template voro_compute<container_periodic_poly>::voro_compute(container_periodic_poly&,int,int,int);
-template bool voro_compute<container_periodic>::compute_cell(voronoicell&,int,int,int,int,int);
-template bool voro_compute<container_periodic>::compute_cell(voronoicell_neighbor&,int,int,int,int,int);
-template void voro_compute<container_periodic>::find_voronoi_cell(double,double,double,int,int,int,int,particle_record&,double&);
-template bool voro_compute<container_periodic_poly>::compute_cell(voronoicell&,int,int,int,int,int);
-template bool voro_compute<container_periodic_poly>::compute_cell(voronoicell_neighbor&,int,int,int,int,int);
-template void voro_compute<container_periodic_poly>::find_voronoi_cell(double,double,double,int,int,int,int,particle_record&,double&);
+template bool voro_compute<container_periodic>::compute_cell(voronoicell&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container_periodic>::compute_cell(voronoicell_neighbor&,compute_workspace&,int,int,int,int,int,double*) const;
+template void voro_compute<container_periodic>::find_voronoi_cell(compute_workspace&,double,double,double,int,int,int,int,particle_record&,double&) const;
+template void voro_compute<container_periodic>::find_voronoi_cells(int,const double*,int*,int*) const;
+template bool voro_compute<container_periodic_poly>::compute_cell(voronoicell&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container_periodic_poly>::compute_cell(voronoicell_neighbor&,compute_workspace&,int,int,int,int,int,double*) const;
+template void voro_compute<container_periodic_poly>::find_voronoi_cell(compute_workspace&,double,double,double,int,int,int,int,particle_record&,double&) const;
+template void voro_compute<container_periodic_poly>::find_voronoi_cells(int,const double*,int*,int*) const;
+
+// Explicit template instantiation
+template voro_compute<container_view>::voro_compute(container_view&,int,int,int);
+template voro_compute<container_view_poly>::voro_compute(container_view_poly&,int,int,int);
+template bool voro_compute<container_view>::compute_cell(voronoicell&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container_view>::compute_cell(voronoicell_neighbor&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container_view_poly>::compute_cell(voronoicell&,compute_workspace&,int,int,int,int,int,double*) const;
+template bool voro_compute<container_view_poly>::compute_cell(voronoicell_neighbor&,compute_workspace&,int,int,int,int,int,double*) const;
 
 }
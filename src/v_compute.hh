@@ -13,6 +13,7 @@
 #include "config.hh"
 #include "worklist.hh"
 #include "cell.hh"
+#include "rad_option.hh"
 
 namespace voro {
 
@@ -34,6 +35,57 @@ struct particle_record {
 	int dk;
 };
 
+/** \brief Class holding the search state for Voronoi cell computations.
+ *
+ * This class holds the mutable information that the voro_compute template
+ * uses while searching outwards from a particle: the mask of blocks that have
+ * been tested, the queue of blocks still to test, and the radius-dependent
+ * constants of the current cell. The container is not modified during a
+ * computation, so several threads can compute cells in the same container at
+ * once, as long as each thread has its own workspace. The memory is allocated
+ * on first use, so a single workspace can be used with any container. */
+class compute_workspace {
+	public:
+		/** The total number of blocks in the mask. */
+		int hxyz;
+		/** This sets the current value being used to mark tested blocks
+		 * in the mask. */
+		unsigned int mv;
+		/** The current size of the search list. */
+		int qu_size;
+		/** The radius-dependent constants for the cell currently
+		 * being computed. */
+		radius_record rr;
+		/** This array is used during the cell computation to determine
+		 * which blocks have been considered. */
+		unsigned int *mask;
+		/** An array is used to store the queue of blocks to test
+		 * during the Voronoi cell computation. */
+		int *qu;
+		/** A pointer to the end of the queue array, used to determine
+		 * when the queue is full. */
+		int *qu_l;
+		compute_workspace();
+		~compute_workspace();
+		/** Makes sure that the mask and queue are set up for a mask of
+		 * the given size.
+		 * \param[in] hxyz_ the total number of blocks in the mask.
+		 * \param[in] qu_size_ the initial size of the queue. */
+		inline void setup(int hxyz_,int qu_size_) {
+			if(hxyz!=hxyz_||qu==NULL) allocate(hxyz_,qu_size_);
+		}
+		void add_list_memory(int*& qu_s,int*& qu_e);
+		/** Resets the mask in cases where the mask counter wraps
+		 * around. */
+		inline void reset_mask() {
+			for(unsigned int *mp(mask);mp<mask+hxyz;mp++) *mp=0;
+		}
+	private:
+		void allocate(int hxyz_,int qu_size_);
+		compute_workspace(const compute_workspace &);
+		compute_workspace& operator=(const compute_workspace &);
+};
+
 /** \brief Template for carrying out Voronoi cell computations. */
 template <class c_class>
 class voro_compute {
@@ -71,77 +123,48 @@ class voro_compute {
 		/** A constant, set to the value of hx*hy*hz, which is used in
 		 * the routines which step through mask boxes in sequence. */
 		const int hxyz;
-		/** The number of floating point entries to store for each
-		 * particle. */
-		const int ps;
 		/** This array holds the numerical IDs of each particle in each
 		 * computational box. */
 		int **id;
-		/** A two dimensional array holding particle positions. For the
-		 * derived container_poly class, this also holds particle
-		 * radii. */
-		double **p;
 		/** An array holding the number of particles within each
 		 * computational box of the container. */
 		int *co;
+		/** A workspace for the routines that do not supply their
+		 * own. */
+		compute_workspace work;
 		voro_compute(c_class &con_,int hx_,int hy_,int hz_);
-		/** The class destructor frees the dynamically allocated memory
-		 * for the mask and queue. */
-		~voro_compute() {
-			delete [] qu;
-			delete [] mask;
-		}
 		template<class v_cell>
-		bool compute_cell(v_cell &c,int ijk,int s,int ci,int cj,int ck);
-		void find_voronoi_cell(double x,double y,double z,int ci,int cj,int ck,int ijk,particle_record &w,double &mrs);
+		bool compute_cell(v_cell &c,compute_workspace &ws,int ijk,int s,int ci,int cj,int ck,double *pp) const;
+		void find_voronoi_cell(compute_workspace &ws,double x,double y,double z,int ci,int cj,int ck,int ijk,particle_record &w,double &mrs) const;
+		void find_voronoi_cells(int n,const double *pos,int *pid,int *sh) const;
 	private:
 		/** A constant set to boxx*boxx+boxy*boxy+boxz*boxz, which is
 		 * frequently used in the computation. */
 		const double bxsq;
-		/** This sets the current value being used to mark tested blocks
-		 * in the mask. */
-		unsigned int mv;
-		/** The current size of the search list. */
-		int qu_size;
 		/** A pointer to the array of worklists. */
 		const unsigned int *wl;
 		/** An pointer to the array holding the minimum distances
 		 * associated with the worklists. */
 		double *mrad;
-		/** This array is used during the cell computation to determine
-		 * which blocks have been considered. */
-		unsigned int *mask;
-		/** An array is used to store the queue of blocks to test
-		 * during the Voronoi cell computation. */
-		int *qu;
-		/** A pointer to the end of the queue array, used to determine
-		 * when the queue is full. */
-		int *qu_l;
 		template<class v_cell>
-		bool corner_test(v_cell &c,double xl,double yl,double zl,double xh,double yh,double zh);
+		bool corner_test(v_cell &c,compute_workspace &ws,double xl,double yl,double zl,double xh,double yh,double zh) const;
 		template<class v_cell>
-		inline bool edge_x_test(v_cell &c,double x0,double yl,double zl,double x1,double yh,double zh);
+		inline bool edge_x_test(v_cell &c,compute_workspace &ws,double x0,double yl,double zl,double x1,double yh,double zh) const;
 		template<class v_cell>
-		inline bool edge_y_test(v_cell &c,double xl,double y0,double zl,double xh,double y1,double zh);
+		inline bool edge_y_test(v_cell &c,compute_workspace &ws,double xl,double y0,double zl,double xh,double y1,double zh) const;
 		template<class v_cell>
-		inline bool edge_z_test(v_cell &c,double xl,double yl,double z0,double xh,double yh,double z1);
+		inline bool edge_z_test(v_cell &c,compute_workspace &ws,double xl,double yl,double z0,double xh,double yh,double z1) const;
 		template<class v_cell>
-		inline bool face_x_test(v_cell &c,double xl,double y0,double z0,double y1,double z1);
+		inline bool face_x_test(v_cell &c,compute_workspace &ws,double xl,double y0,double z0,double y1,double z1) const;
 		template<class v_cell>
-		inline bool face_y_test(v_cell &c,double x0,double yl,double z0,double x1,double z1);
+		inline bool face_y_test(v_cell &c,compute_workspace &ws,double x0,double yl,double z0,double x1,double z1) const;
 		template<class v_cell>
-		inline bool face_z_test(v_cell &c,double x0,double y0,double zl,double x1,double y1);
-		bool compute_min_max_radius(int di,int dj,int dk,double fx,double fy,double fz,double gx,double gy,double gz,double& crs,double mrs);
-		bool compute_min_radius(int di,int dj,int dk,double fx,double fy,double fz,double mrs);
-		inline void add_to_mask(int ei,int ej,int ek,int *&qu_e);
-		inline void scan_bits_mask_add(unsigned int q,unsigned int *mijk,int ei,int ej,int ek,int *&qu_e);
-		inline void scan_all(int ijk,double x,double y,double z,int di,int dj,int dk,particle_record &w,double &mrs);
-		void add_list_memory(int*& qu_s,int*& qu_e);
-		/** Resets the mask in cases where the mask counter wraps
-		 * around. */
-		inline void reset_mask() {
-			for(unsigned int *mp(mask);mp<mask+hxyz;mp++) *mp=0;
-		}
+		inline bool face_z_test(v_cell &c,compute_workspace &ws,double x0,double y0,double zl,double x1,double y1) const;
+		bool compute_min_max_radius(compute_workspace &ws,int di,int dj,int dk,double fx,double fy,double fz,double gx,double gy,double gz,double& crs,double mrs) const;
+		bool compute_min_radius(int di,int dj,int dk,double fx,double fy,double fz,double mrs) const;
+		inline void add_to_mask(compute_workspace &ws,int ei,int ej,int ek,int *&qu_e) const;
+		inline void scan_bits_mask_add(compute_workspace &ws,unsigned int q,unsigned int *mijk,int ei,int ej,int ek,int *&qu_e) const;
+		inline void scan_all(int ijk,double x,double y,double z,int di,int dj,int dk,particle_record &w,double &mrs) const;
 };
 
 }
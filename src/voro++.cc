@@ -17,3 +17,13 @@
 #include "v_compute.cc"
 #include "c_loops.cc"
 #include "wall.cc"
+#include "scheduler.cc"
+#include "ordered_writer.cc"
+#include "incremental.cc"
+#include "arena.cc"
+#include "tessellation.cc"
+#include "container_oct.cc"
+#include "container_view.cc"
+#include "particle_file.cc"
+#include "text_import.cc"
+#include "column_output.cc"
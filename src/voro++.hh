@@ -60,12 +60,13 @@
  * There are several wall classes that can be used to apply certain boundary
  * conditions using additional plane cuts during the Voronoi cell compution.
  * The code also contains a number of small loop classes, c_loop_all,
- * c_loop_subset, c_loop_all_periodic, and c_loop_order that can be used to
- * iterate over a certain subset of particles in a container. The latter class
- * makes use of a special particle_order class that stores a specific order of
- * particles within the container. The library also contains the classes
- * pre_container_base, pre_container, and pre_container_poly, that can be used
- * as temporary storage when importing data of unknown size.
+ * c_loop_subset, c_loop_all_periodic, c_loop_order, and c_loop_curve that can
+ * be used to iterate over a certain subset of particles in a container. The
+ * c_loop_order class makes use of a special particle_order class that stores
+ * a specific order of particles within the container. The library also
+ * contains the classes pre_container_base, pre_container, and
+ * pre_container_poly, that can be used as temporary storage when importing
+ * data of unknown size.
  *
  * \section voronoicell The voronoicell classes
  * The voronoicell class represents a single Voronoi cell as a convex
@@ -159,6 +160,20 @@
  * creation of additional low-order vertices, so the process is applied
  * recursively until no more are left.
  *
+ * \subsection arena Memory arenas
+ * A newly constructed Voronoi cell allocates around a hundred arrays, most of
+ * them for the edge tables of the different vertex orders. This cost is
+ * negligible when a cell is reused for many computations, but it is
+ * significant for code that creates a fresh cell for each of many short
+ * computations, such as a ghost cell for each query point. The voronoicell
+ * classes can therefore be constructed with a cell_arena class, from which
+ * all of their arrays are then taken. The arena carves its blocks from large
+ * slabs, and keeps the blocks that cells release on free lists, so that later
+ * cells reuse them without calling the heap allocator. The arena records the
+ * number of blocks allocated and reused, the number of slabs taken from the
+ * heap, and the peak memory use. An arena must only be used by one thread at
+ * a time, and the cell_arena_pool class holds one arena for each thread.
+ *
  * \section container The container classes
  * There are four container classes available for general usage: container,
  * container_poly, container_periodic, and container_periodic_poly. Each of
@@ -170,13 +185,30 @@
  * Each container class contains routines that tell the voro_compute template
  * about the specific geometry of this container.
  *
+ * Individual particles can be deleted with the remove() routine, and moved
+ * with the move() routine, without rebuilding the container. The first call
+ * to either routine builds an index from each particle ID to the block and
+ * slot that it is stored in, which is then kept up to date as particles are
+ * added, so that later calls take constant time. A particle is removed from
+ * its block by moving the last particle of the block into its slot.
+ *
+ * The print_face_graph() routine writes the faces between pairs of particles
+ * as an edge list, with the area, unit normal, and centroid of each face.
+ * Each face is evaluated once, by the cell of the particle with the lower ID,
+ * using the shared_faces() routine of the voronoicell_neighbor class. This
+ * evaluates half as many faces as the neighbors(), face_areas(), and normals()
+ * routines, in a single traversal, although the overall time is dominated by
+ * the cell computation. The normals agree with those of the normals() routine,
+ * except on degenerate faces that are too small for normals() to find, where
+ * it gives (0,0,0).
+ *
  * \section voro_compute The voro_compute template
  * The voro_compute template encapsulates the routines for carrying out the
- * Voronoi cell computations. It contains data structures suchs as a mask and a
- * queue that are used in the computations. The voro_compute template is
- * associated with a specific container class, and during the computation, it
- * calls routines in the container class to access the particle positions that
- * are stored there.
+ * Voronoi cell computations. The data structures that change during a
+ * computation, such as a mask and a queue, are kept separately in a
+ * compute_workspace class. The voro_compute template is associated with a
+ * specific container class, and during the computation, it calls routines in
+ * the container class to access the particle positions that are stored there.
  *
  * The key routine in this class is compute_cell(), which makes use of a
  * voronoicell class to construct a Voronoi cell for a specific particle in the
@@ -268,7 +300,7 @@
  * is desirable to iterate over a specific subset of particles. This can be
  * achieved with the c_loop classes that are all derived from the c_loop_base
  * class. Each class can iterate over a specific subset of particles in a
- * container. There are three loop classes for use with the container and
+ * container. There are four loop classes for use with the container and
  * container_poly classes:
  *
  * - c_loop_all will loop over all of the particles in a container.
@@ -278,6 +310,12 @@
  *   specific internal computational blocks.
  * - c_loop_order will loop over a specific list of particles that were
  *   previously stored in a particle_order class.
+ * - c_loop_curve will loop over all of the particles in a container, visiting
+ *   the computational blocks in the order of a Morton or Hilbert
+ *   space-filling curve. This keeps consecutive cell computations close
+ *   together in space. The sort_particles() routine of the container can be
+ *   used to reorder the block memory and the particles within each block
+ *   along the same curve.
  *
  * Several of the key routines within the container classes (such as
  * draw_cells_gnuplot and print_custom) have versions where they can be passed
@@ -308,17 +346,178 @@
  * default, this procedure is used by the command-line utility to enable it to
  * work well with arbitrary sizes of input data.
  *
+ * The guess assumes that the particles are spread uniformly. For clustered
+ * data, the sample_optimal() routine bins the particles and reduces the number
+ * of particles per block according to how much denser the regions are where
+ * most of the particles lie. The tune_optimal() routine goes further, timing
+ * the computation of a subset of the cells for a sequence of trial grids, and
+ * optionally for blocks that are stretched along each axis. Each trial is
+ * repeated, and a grid is only accepted if it is faster by more than the
+ * spread of the repeated timings, with a larger margin for a change of block
+ * shape, since the differences between good grids are often within the timing
+ * noise. The chosen number of particles per block and block shape are stored
+ * in public variables, so that they can be printed with print_tuning() and
+ * reused for similar datasets. The command-line utility uses tune_optimal()
+ * when the -a option is given.
+ *
  * The pre_container class can be used when no particle radius information is
  * available, and the pre_container_poly class can be used when radius
  * information is available. At present, the pre_container classes can only be
  * used with the container and container_poly classes. They do not support
- * the container_periodic and container_periodic_poly classes. */
+ * the container_periodic and container_periodic_poly classes.
+ *
+ * \section threads Multithreaded computation
+ * If the library is compiled with OpenMP enabled, several of the container
+ * routines can be carried out in parallel. The number of threads is set using
+ * the set_threads() function of the container, and by default only a single
+ * thread is used. The compute_all_cells() and sum_cell_volumes() routines,
+ * which can also be restricted to the particles in a loop class, make use of
+ * the block_scheduler class. This divides the particles into many small tasks
+ * whose sizes are chosen according to the number of particles in each block,
+ * and threads that run out of work steal tasks from other threads. Each
+ * computation sets up its own scheduler, so a container can be used by
+ * several threaded computations at once. If VOROPP_VERBOSE is set to 3 or
+ * more, then the print_report() function of the scheduler is called after
+ * each computation, printing the number of tasks carried out by each thread
+ * and the load imbalance.
+ *
+ * The print_custom() routines can also be multithreaded. Since the cells are
+ * computed out of order, each thread formats the output of each task into a
+ * memory buffer using the ordered_writer class, and the buffers are written
+ * to the output file in task order as soon as the tasks before them are
+ * finished. The output is therefore identical to the single-threaded case,
+ * for both the c_loop_all and c_loop_order loop classes. On systems without
+ * open_memstream(), temporary files are used instead. The containers share a
+ * single threaded loop for these routines, which is the voro_cell_loop()
+ * template in cell_ops.hh, along with a small class for each operation that
+ * is carried out on the computed cells. The command-line utility uses the same
+ * loop when the -t option is given.
+ *
+ * The compute_cell() and compute_ghost_cell() routines of the containers can
+ * also be given a compute_workspace class. In this case the container is not
+ * modified, so that several threads can compute cells in the same container at
+ * once, as long as each thread uses its own workspace and Voronoi cell. For
+ * the periodic containers, create_all_images() should be called first, since
+ * otherwise the periodic images are created during the computation.
+ *
+ * Large numbers of particles can be added to the container and
+ * container_poly classes using the put_bulk() routines. These first count the
+ * number of particles in each block, so that the memory for each block is
+ * allocated once at exactly the right size, and then copy the particles into
+ * place. Both passes use multiple threads if requested, and the particles are
+ * stored in the same order as if put() had been called for each one.
+ *
+ * The find_voronoi_cell() routine can likewise be given a compute_workspace
+ * class. To locate many points at once, the find_voronoi_cells() routine takes
+ * an array of positions and returns the ID of the particle whose Voronoi cell
+ * contains each one, plus optionally its periodic image. The points are first
+ * sorted by block, so that the searches for nearby points reuse the same
+ * particle data, and the searches are then divided between the threads.
+ *
+ * \section incremental Incremental computation
+ * For molecular dynamics trajectories, where the particles move a small
+ * distance between frames, the voro_incremental class can be used to compute
+ * the cells of the container class more quickly. Whenever a cell is computed
+ * with the full search, the class caches the list of particles that are within
+ * the cell's security radius plus a skin distance. On later frames the cell is
+ * built from this list alone, and the full search is only used if the
+ * particles have moved far enough that the list might be missing a particle
+ * that cuts the cell. The cells therefore match those of a full computation.
+ * After the particles in the container are changed, the update() function of
+ * the class must be called before the cells are computed.
+ *
+ * \section tessellation Stored tessellations
+ * The tessellation class computes the Voronoi cells of all of the particles in
+ * a container once and stores them, so that several analyses can be carried
+ * out without recomputing the cells. The vertex coordinates, face vertex
+ * lists, neighbor IDs, and volumes of all of the cells are held in a small
+ * number of flat arrays in compressed sparse row format, which take much less
+ * memory than keeping a voronoicell_neighbor class for each particle. If
+ * several threads have been requested from the container, then the cells are
+ * computed in parallel, and the stored result is the same as for a serial
+ * computation.
+ *
+ * \section freeze Frozen containers
+ * For programs that add all of the particles to a container before analyzing
+ * them, the freeze() function of the container and container_poly classes
+ * packs the particles into a single ID array and a single position array in
+ * block order, with an array of block offsets. This removes the spare memory
+ * that each block has from doubling its allocation as particles are added.
+ * The cell computations and loop classes work unchanged on a frozen
+ * container, but no particles can be added, moved, or removed afterwards.
+ *
+ * \section octree Octree containers
+ * The container_octree and container_octree_poly classes store the particles
+ * in the leaves of an octree, rather than in a grid of equal blocks. A leaf is
+ * split into eight when it holds more than a set number of particles, so the
+ * leaves are small where the particles are dense and large where they are
+ * sparse. This avoids the choice of a single grid size, which can be poor for
+ * systems whose density varies by orders of magnitude. Each leaf is linked to
+ * the leaves that share a face with it, and the cells are computed by a search
+ * that moves outward through these links in order of distance, skipping any
+ * leaf whose box could not cut the cell. The leaves take the place of the
+ * blocks of the grid-based containers, so the c_loop_all class and the
+ * multithreaded routines work with these classes in the same way. For
+ * particles of roughly uniform density, the grid-based containers remain
+ * faster.
+ *
+ * \section view Container views
+ * The container_view and container_view_poly classes compute Voronoi cells
+ * directly from an array of particles that is owned by the caller, such as
+ * the coordinate array of a simulation code. The bind() function sorts the
+ * indices of the particles into the blocks by a counting sort, and the
+ * positions themselves are never copied, so the same array can be bound again
+ * at each frame. The particles can be stored with a stride, so that other
+ * data can sit between them, and the index of each particle in the array is
+ * used as its ID. The voro_compute template and the loop classes work with
+ * these classes in the same way as with the container and container_poly
+ * classes.
+ *
+ * \section binary Binary particle files
+ * Reading a large text file of particles with fscanf() can take longer than
+ * computing its Voronoi cells. The container, pre_container, and periodic
+ * container classes therefore have import_binary() functions, which read the
+ * binary particle format described in the particle_file class. The file is
+ * mapped into memory, and the container and container_poly classes add the
+ * particles directly from the mapping with put_bulk(). Files can be written
+ * with particle_file::write(), and the command-line utility reads them with
+ * the -b option.
+ *
+ * \section textimport Text import
+ * The import() functions of the container classes read text files with the
+ * text_importer class, rather than with a loop of fscanf() calls. The file is
+ * read in large buffers, which are divided between the threads at whitespace,
+ * and each thread converts its numbers with a fast routine that gives the same
+ * results as strtod(). The container and container_poly classes then add each
+ * buffer of particles with put_bulk(). The accepted input is the same as
+ * before, and malformed files cause the same fatal error.
+ *
+ * \section customplan Compiled custom output
+ * A custom output string can be compiled into a custom_plan, which is passed
+ * to voronoicell_base::output_custom() in place of the string. The plan is
+ * parsed once, and the per-face and per-cell quantities that it needs are then
+ * computed in a single traversal of each cell. The print_custom() functions
+ * of the container classes and the command-line utility compile their format
+ * once before looping over the cells.
+ *
+ * \section columns Binary columnar output
+ * The column_writer class saves the quantities selected by a custom output
+ * string in a binary file, at full precision, rather than as text. Each
+ * directive becomes a column, with fixed-size quantities stored in fixed-width
+ * columns, and variable-length lists such as the neighbors and face areas
+ * stored as offset and value arrays. The cells are written in chunks, so that
+ * a file can be streamed and appended to, and every array is aligned so that
+ * the file can be mapped into memory by analysis tools. All of the container
+ * classes have print_columns() functions that use it. When several threads
+ * are used, the cells of each task are buffered separately and appended in
+ * task order, so the file is the same as for a serial computation. */
 
 #ifndef VOROPP_HH
 #define VOROPP_HH
 
 #include "config.hh"
 #include "common.hh"
+#include "arena.hh"
 #include "cell.hh"
 #include "v_base.hh"
 #include "rad_option.hh"
@@ -329,5 +528,15 @@
 #include "v_compute.hh"
 #include "c_loops.hh"
 #include "wall.hh"
+#include "scheduler.hh"
+#include "ordered_writer.hh"
+#include "cell_ops.hh"
+#include "incremental.hh"
+#include "tessellation.hh"
+#include "container_oct.hh"
+#include "container_view.hh"
+#include "particle_file.hh"
+#include "text_import.hh"
+#include "column_output.hh"
 
 #endif